@@ -3,10 +3,18 @@
  * Version: 1.21
  */
 
+#include <math.h>
 #include "accel.h"
 #include "config.h"
+#include "log.h"
 #include "memor.h"
 #include "lora.h"
+#include "spectrum.h"
+#include "crc32.h"
+#include "scheduler.h"
+#include "imu.h"
+#include "perf.h"
+#include "manifest.h"
 
 // Global recording context
 AccelRecording accelRecording;
@@ -16,55 +24,107 @@ bool firstAccelRecordingDone = false;
 
 // Note: EEPROM address for first recording flag is defined in config.h (EEPROM_ADDR_FIRST_ACCEL)
 
-// Interval between samples in milliseconds (30Hz = ~33.33ms)
-#define SAMPLE_INTERVAL_MS   (1000 / ACCEL_SAMPLE_RATE)
-
 // Progress update interval (every 10 seconds)
 #define PROGRESS_INTERVAL_MS 10000
 
-// File handle kept open during recording for efficiency
+// SparkFun LSM9DS1 accel sampleRate codes (accelerometer-only mode)
+#define XL_ODR_119   3
+#define XL_ODR_238   4
+#define XL_ODR_476   5
+#define XL_ODR_952   6   // Library default (restored after capture)
+
+// File handles kept open during recording for efficiency
 static File accelFile;
+static File accelIdxFile;
+static char accelIdxName[64];
+
+// Double buffer: one block fills from the FIFO while the other waits for SD
+static uint8_t accelBlocks[2][ACCEL_BLOCK_SIZE];
+static uint8_t accelBlkCount = 0;       // Samples in the active block
+static uint16_t accelBlkFirst = 0;      // Index of its first sample
+static uint8_t accelBlkFlags = 0;
+static uint8_t accelDrainFlags = 0;     // Flags of the drain in progress
+static uint8_t accelActive = 0;         // Block being filled
+static bool accelPending[2] = {false, false};
+
+// Timestamp sidecar, also written a whole block at a time
+static uint8_t accelIdxBlock[ACCEL_BLOCK_SIZE];
+static uint16_t accelIdxFill = 0;
+
+// On-board analysis: the recording is read back a chunk at a time
+static SpectrumAnalyzer accelSpec;
+static File accelAnaFile;
+static char accelAnaName[64];
+static uint32_t accelAnaRemaining = 0;   // Samples still to read (v1)
+static uint8_t accelAnaVersion = 0;
+static float accelAnaScale = 0;          // g per LSB (v2)
+static uint16_t accelAnaNext = 0;        // Next expected sample index (v2)
+static uint16_t accelAnaTotal = 0;       // Planned samples (header)
+static uint32_t accelAnaLost = 0;        // Samples in gaps and bad blocks (v2)
+static bool accelAnaHdrBad = false;      // v2 header failed its CRC
+static bool accelAnalyzing = false;
+static float accelAnaBuf[(ACCEL_BLK_SAMPLES > ACCEL_ANALYZE_CHUNK ? ACCEL_BLK_SAMPLES : ACCEL_ANALYZE_CHUNK) * SPEC_AXES];
+static char accelLastSummary[48] = "";   // Appended to getAccelStatus()
+
+static SchedJob accelJob = SCHED_NONE;
+
+// Runs while a capture or analysis is active, then disarms itself
+static void accelJobTick(unsigned long now) {
+    accelRecordingTick();
+    if (accelRecording.state != ACCEL_RECORDING && !accelAnalyzing) {
+        schedCancel(accelJob);
+    }
+}
 
 void initAccelRecording() {
     accelRecording.state = ACCEL_IDLE;
     accelRecording.filename[0] = '\0';
     accelRecording.samplesRecorded = 0;
     accelRecording.startTime = 0;
-    accelRecording.lastSampleTime = 0;
+    accelRecording.totalSamples = 0;
+    accelRecording.sampleRate = 0;
+    accelRecording.fifoFullEvents = 0;
+    accelRecording.bufferOverruns = 0;
+    accelRecording.lastDrainTime = 0;
     accelRecording.lastProgressTime = 0;
 
+    if (accelJob == SCHED_NONE) {
+        accelJob = schedRegister("accel", accelJobTick, ACCEL_TICK_INTERVAL);
+    }
+
     // Load first recording flag from EEPROM
     uint8_t flag = EEPROM.read(EEPROM_ADDR_FIRST_ACCEL);
     firstAccelRecordingDone = (flag == 0xAA);  // 0xAA = recording done
-    Serial.printf("[ACCEL] First recording flag: %s\n",
-                  firstAccelRecordingDone ? "DONE" : "PENDING");
+    LOG_I("ACCEL", "First recording flag: %s",
+          firstAccelRecordingDone ? "DONE" : "PENDING");
 
     // Create /accel directory if it doesn't exist
     if (SDOK) {
-        if (!SD.exists("/accel")) {
-            SD.mkdir("/accel");
-            Serial.println("[ACCEL] Created /accel directory");
+        if (!SD.exists(ACCEL_DIR)) {
+            SD.mkdir(ACCEL_DIR);
+            manifestNoteChanged(ACCEL_DIR);
+            LOG_I("ACCEL", "Created /accel directory");
         }
     }
 
-    Serial.println("[ACCEL] Accelerometer recording system initialized");
+    LOG_I("ACCEL", "Accelerometer recording system initialized");
 }
 
 // Called when first ground contact is established
 void checkFirstContactRecording() {
     // Only trigger once per satellite lifetime
     if (firstAccelRecordingDone) {
-        Serial.println("[ACCEL] First recording already done, skipping");
+        LOG_I("ACCEL", "First recording already done, skipping");
         return;
     }
 
     // Check if we can record (not already recording, SD and IMU available)
     if (accelRecording.state == ACCEL_RECORDING) {
-        Serial.println("[ACCEL] Already recording, skipping auto-record");
+        LOG_I("ACCEL", "Already recording, skipping auto-record");
         return;
     }
 
-    Serial.println("[ACCEL] === FIRST GROUND CONTACT - AUTO RECORDING ===");
+    LOG_I("ACCEL", "=== FIRST GROUND CONTACT - AUTO RECORDING ===");
 
     // Start recording
     if (accelStartRecording()) {
@@ -72,225 +132,780 @@ void checkFirstContactRecording() {
         firstAccelRecordingDone = true;
         EEPROM.write(EEPROM_ADDR_FIRST_ACCEL, 0xAA);
         EEPROM.commit();
-        Serial.println("[ACCEL] First contact recording started and flag persisted");
+        LOG_I("ACCEL", "First contact recording started and flag persisted");
     } else {
-        Serial.println("[ACCEL] Auto-recording failed (will retry on next contact)");
+        LOG_E("ACCEL", "Auto-recording failed (will retry on next contact)");
     }
 }
 
-bool accelStartRecording() {
+static uint8_t accelRateCode(uint16_t sampleRate) {
+    switch (sampleRate) {
+        case 119: return XL_ODR_119;
+        case 238: return XL_ODR_238;
+        case 476: return XL_ODR_476;
+        default:  return 0;
+    }
+}
+
+// Accelerometer-only mode at the capture ODR with the FIFO streaming
+static void accelConfigureCapture(uint8_t rateCode) {
+    imu.settings.gyro.enabled = false;      // Accel then runs at its own ODR
+    imu.settings.accel.sampleRate = rateCode;
+    imu.begin();
+    imu.enableFIFO(true);
+    imu.setFIFO(FIFO_CONT, ACCEL_FIFO_DEPTH - 1);
+    imuSetCaptureMode(true);               // Accel registers belong to the FIFO now
+}
+
+// Back to the configuration BeginIMU() leaves (gyro on, FIFO bypassed)
+static void accelRestoreIMU() {
+    imuSetCaptureMode(false);
+    imu.setFIFO(FIFO_OFF, 0);
+    imu.enableFIFO(false);
+    imu.settings.gyro.enabled = true;
+    imu.settings.accel.sampleRate = XL_ODR_952;
+    imu.begin();
+}
+
+static bool accelWriteBlock(File &file, const uint8_t* data, size_t length) {
+    PerfScope perf(PERF_SD_WRITE);
     feedWatchdog();
+    size_t written = file.write(data, length);
+    sdSpaceAccount(written);
+    return written == length;
+}
 
-    // Check if already recording
-    if (accelRecording.state == ACCEL_RECORDING) {
-        Serial.println("[ACCEL] ERROR: Recording already in progress");
+// CRC over the block header and samples (the CRC field itself excluded)
+static uint32_t accelBlockCRC(const uint8_t* block) {
+    uint32_t crc = crc32Begin();
+    crc = crc32Update(crc, block, 4);
+    crc = crc32Update(crc, block + ACCEL_BLK_HEADER_SIZE, ACCEL_BLOCK_SIZE - ACCEL_BLK_HEADER_SIZE);
+    return crc32Final(crc);
+}
+
+static bool accelBlockValid(const uint8_t* block) {
+    uint32_t stored;
+    memcpy(&stored, block + 4, 4);
+    return block[2] <= ACCEL_BLK_SAMPLES && stored == accelBlockCRC(block);
+}
+
+static void accelFail(const char* reason) {
+    LOG_E("ACCEL", "ERROR: %s", reason);
+    accelFile.close();
+    accelIdxFile.close();
+    manifestNoteChanged(accelRecording.filename);
+    manifestNoteChanged(accelIdxName);
+    accelRestoreIMU();
+    accelRecording.state = ACCEL_ERROR;
+    sendMessage("ERR:ACCEL_WRITE_FAILED");
+}
+
+bool accelStartRecording(uint16_t sampleRate) {
+    feedWatchdog();
+
+    // Check if already recording (or reading a recording back)
+    if (accelRecording.state == ACCEL_RECORDING || accelAnalyzing) {
+        LOG_E("ACCEL", "ERROR: Recording already in progress");
         sendMessage("ERR:ACCEL_BUSY");
         return false;
     }
 
+    uint8_t rateCode = accelRateCode(sampleRate);
+    if (rateCode == 0) {
+        LOG_E("ACCEL", "ERROR: Unsupported rate %u Hz", sampleRate);
+        sendMessage("ERR:ACCEL_INVALID_RATE");
+        return false;
+    }
+
     // Check SD card
     if (!SDOK) {
-        Serial.println("[ACCEL] ERROR: SD card not available");
+        LOG_E("ACCEL", "ERROR: SD card not available");
         sendMessage("ERR:SD_NOT_AVAILABLE");
         return false;
     }
 
     // Check IMU
     if (!IMUOK) {
-        Serial.println("[ACCEL] ERROR: IMU not available");
+        LOG_E("ACCEL", "ERROR: IMU not available");
         sendMessage("ERR:IMU_NOT_AVAILABLE");
         return false;
     }
 
-    // Calculate required space: header + samples
-    size_t requiredSpace = ACCEL_HEADER_SIZE + (ACCEL_TOTAL_SAMPLES * sizeof(AccelSample));
+    // Calculate required space: header block + data blocks + timestamp sidecar
+    uint16_t totalSamples = sampleRate * ACCEL_DURATION_SEC;
+    size_t dataBlocks = (totalSamples + ACCEL_BLK_SAMPLES - 1) / ACCEL_BLK_SAMPLES;
+    size_t requiredSpace = (dataBlocks + 1) * ACCEL_BLOCK_SIZE +
+                           (totalSamples / 4) * ACCEL_IDX_ENTRY_SIZE;
     if (!hasSDSpace(requiredSpace + 1024)) {
-        Serial.println("[ACCEL] ERROR: Not enough SD space");
+        LOG_E("ACCEL", "ERROR: Not enough SD space");
         sendMessage("ERR:SD_FULL");
         return false;
     }
 
-    // Generate filename with timestamp
+    // Generate filenames with timestamp
     unsigned long timestamp = millis();
     snprintf(accelRecording.filename, sizeof(accelRecording.filename),
              "/accel/rec_%lu.bin", timestamp);
+    snprintf(accelIdxName, sizeof(accelIdxName), "/accel/rec_%lu.idx", timestamp);
 
-    // Create file and write header
+    // Create files
     accelFile = SD.open(accelRecording.filename, FILE_WRITE);
-    if (!accelFile) {
-        Serial.println("[ACCEL] ERROR: Cannot create file");
+    accelIdxFile = SD.open(accelIdxName, FILE_WRITE);
+    manifestNoteChanged(accelRecording.filename);
+    manifestNoteChanged(accelIdxName);
+    if (!accelFile || !accelIdxFile) {
+        LOG_E("ACCEL", "ERROR: Cannot create file");
+        if (accelFile) accelFile.close();
+        if (accelIdxFile) accelIdxFile.close();
+        SD.remove(accelRecording.filename);
+        SD.remove(accelIdxName);
+        manifestNoteRemoved(accelRecording.filename);
+        manifestNoteRemoved(accelIdxName);
+        sdSpaceInvalidate();
         sendMessage("ERR:ACCEL_FILE_ERROR");
         return false;
     }
 
-    // Write header
-    uint8_t header[ACCEL_HEADER_SIZE];
-    memset(header, 0, ACCEL_HEADER_SIZE);
+    // Start the FIFO here - samples accumulate from now on, and the scale
+    // in the header is the capture configuration's
+    accelConfigureCapture(rateCode);
+
+    // Header gets a whole block so every SD write is a whole, aligned
+    // 512-byte sector
+
+    uint8_t* header = accelBlocks[0];
+    float scale = imu.calcAccel(1);
+    memset(header, 0, ACCEL_BLOCK_SIZE);
     memcpy(header, ACCEL_MAGIC, 7);
     header[7] = ACCEL_VERSION;
-    uint16_t sampleRate = ACCEL_SAMPLE_RATE;
-    uint16_t sampleCount = ACCEL_TOTAL_SAMPLES;
     memcpy(header + 8, &sampleRate, 2);
-    memcpy(header + 10, &sampleCount, 2);
+    memcpy(header + 10, &totalSamples, 2);
+    memcpy(header + 12, &scale, 4);
+    uint32_t headerCRC = crc32Final(crc32Update(crc32Begin(), header, ACCEL_HEADER_SIZE));
+    memcpy(header + ACCEL_HEADER_SIZE, &headerCRC, 4);
 
-    if (accelFile.write(header, ACCEL_HEADER_SIZE) != ACCEL_HEADER_SIZE) {
-        Serial.println("[ACCEL] ERROR: Failed to write header");
+    if (!accelWriteBlock(accelFile, header, ACCEL_BLOCK_SIZE)) {
         accelFile.close();
+        accelIdxFile.close();
+        accelRestoreIMU();
         SD.remove(accelRecording.filename);
-        sendMessage("ERR:ACCEL_WRITE_ERROR");
+        SD.remove(accelIdxName);
+        manifestNoteRemoved(accelRecording.filename);
+        manifestNoteRemoved(accelIdxName);
+        sdSpaceInvalidate();
+        LOG_E("ACCEL", "ERROR: Header write failed");
+        sendMessage("ERR:ACCEL_WRITE_FAILED");
         return false;
     }
 
+    accelActive = 0;
+    accelBlkCount = 0;
+    accelBlkFlags = 0;
+    accelPending[0] = accelPending[1] = false;
+    accelIdxFill = 0;
+
     // Initialize recording state
     accelRecording.state = ACCEL_RECORDING;
     accelRecording.samplesRecorded = 0;
+    accelRecording.totalSamples = totalSamples;
+    accelRecording.sampleRate = sampleRate;
+    accelRecording.fifoFullEvents = 0;
+    accelRecording.bufferOverruns = 0;
     accelRecording.startTime = millis();
-    accelRecording.lastSampleTime = 0;
-    accelRecording.lastProgressTime = millis();
+    accelRecording.lastDrainTime = accelRecording.startTime;
+    accelRecording.lastProgressTime = accelRecording.startTime;
 
-    Serial.printf("[ACCEL] Recording started: %s\n", accelRecording.filename);
-    Serial.printf("[ACCEL] %d samples @ %d Hz for %d seconds\n",
-                  ACCEL_TOTAL_SAMPLES, ACCEL_SAMPLE_RATE, ACCEL_DURATION_SEC);
+    schedAfter(accelJob, ACCEL_TICK_INTERVAL, millis());
 
-    sendMessage("OK:ACCEL_RECORDING:" + String(ACCEL_DURATION_SEC) + "s");
+    LOG_I("ACCEL", "Recording started: %s", accelRecording.filename);
+    LOG_I("ACCEL", "%d samples @ %d Hz for %d seconds (FIFO capture)",
+          totalSamples, sampleRate, ACCEL_DURATION_SEC);
+
+    char reply[48];
+    snprintf(reply, sizeof(reply), "OK:ACCEL_RECORDING:%ds@%uHz", ACCEL_DURATION_SEC, sampleRate);
+    sendMessage(reply);
 
     return true;
 }
 
-void accelRecordingTick() {
-    // Only process if recording
-    if (accelRecording.state != ACCEL_RECORDING) {
+bool accelCaptureActive() {
+    return accelRecording.state == ACCEL_RECORDING;
+}
+
+// Fill in the header and CRC of the active block (unused slots stay zero)
+static void accelSealBlock() {
+    uint8_t* block = accelBlocks[accelActive];
+    memcpy(block, &accelBlkFirst, 2);
+    block[2] = accelBlkCount;
+    block[3] = accelBlkFlags;
+    memset(block + ACCEL_BLK_HEADER_SIZE + accelBlkCount * ACCEL_RAW_SAMPLE_SIZE, 0,
+           (ACCEL_BLK_SAMPLES - accelBlkCount) * ACCEL_RAW_SAMPLE_SIZE +
+           (ACCEL_BLOCK_SIZE - ACCEL_BLK_HEADER_SIZE) % ACCEL_RAW_SAMPLE_SIZE);
+    uint32_t crc = accelBlockCRC(block);
+    memcpy(block + 4, &crc, 4);
+
+    accelPending[accelActive] = true;
+    accelActive ^= 1;
+    accelBlkCount = 0;
+    accelBlkFlags = 0;
+}
+
+// Append one raw sample to the double buffer, switching blocks when full
+static void accelStoreSample(uint16_t index, int16_t x, int16_t y, int16_t z) {
+    if (accelPending[accelActive]) {
+        // Neither block is free - SD is behind; the next block records the gap
+        accelRecording.bufferOverruns++;
+        accelBlkFlags |= ACCEL_BLK_GAP;
         return;
     }
 
-    unsigned long now = millis();
+    if (accelBlkCount == 0) {
+        accelBlkFirst = index;
+    }
+    accelBlkFlags |= accelDrainFlags;
 
-    // Check if it's time for a new sample
-    if (now - accelRecording.lastSampleTime < SAMPLE_INTERVAL_MS) {
-        return;
+    int16_t raw[3] = { x, y, z };
+    memcpy(accelBlocks[accelActive] + ACCEL_BLK_HEADER_SIZE + accelBlkCount * ACCEL_RAW_SAMPLE_SIZE,
+           raw, ACCEL_RAW_SAMPLE_SIZE);
+
+    if (++accelBlkCount == ACCEL_BLK_SAMPLES) {
+        accelSealBlock();
     }
+}
 
-    // Feed watchdog during long recording
+// Oldest block waiting for SD, -1 if none. When both are pending the
+// writer has fallen a full block behind and the active one is the older.
+static int accelOldestPending() {
+    if (accelPending[accelActive]) return accelActive;
+    if (accelPending[accelActive ^ 1]) return accelActive ^ 1;
+    return -1;
+}
+
+static void accelStoreIdx(uint32_t elapsed, uint16_t firstSample, uint8_t count, uint8_t flags) {
+    uint8_t* e = accelIdxBlock + accelIdxFill;
+    memcpy(e, &elapsed, 4);
+    memcpy(e + 4, &firstSample, 2);
+    e[6] = count;
+    e[7] = flags;
+    accelIdxFill += ACCEL_IDX_ENTRY_SIZE;
+}
+
+// Move everything the FIFO holds into the active block
+static void accelDrainFIFO(unsigned long now) {
+    int16_t fifo[ACCEL_FIFO_DEPTH][3];
+    uint8_t available;
+    uint8_t popped = imuReadAccelFifo(fifo, ACCEL_FIFO_DEPTH, &available);
+    if (popped == 0) return;
+
+    uint8_t flags = 0;
+    if (available >= ACCEL_FIFO_DEPTH) {
+        flags |= ACCEL_IDX_FIFO_FULL;   // Oldest samples may have been overwritten
+        accelRecording.fifoFullEvents++;
+    }
+    accelDrainFlags = (flags & ACCEL_IDX_FIFO_FULL) ? ACCEL_BLK_FIFO_FULL : 0;
+
+    uint16_t firstSample = accelRecording.samplesRecorded;
+    uint8_t drained = 0;
+
+    for (uint8_t i = 0; i < popped; i++) {
+        if (accelRecording.samplesRecorded >= accelRecording.totalSamples) {
+            break;        // Recording is full - the rest is just emptied
+        }
+
+        // Raw counts - scaled on the ground (or by AccelAnalyze)
+        accelStoreSample(accelRecording.samplesRecorded, fifo[i][0], fifo[i][1], fifo[i][2]);
+
+        accelRecording.samplesRecorded++;
+        drained++;
+    }
+
+    if (drained > 0) {
+        accelStoreIdx(now - accelRecording.startTime, firstSample, drained, flags);
+    }
+    accelRecording.lastDrainTime = now;
+}
+
+// rec_N.bin -> rec_N<ext> (".sum", ".idx"), false if the path isn't a .bin recording
+static bool accelSidecarPath(const char* path, const char* ext, char* out, size_t outSize) {
+    size_t len = strlen(path);
+    if (len < 5 || len >= outSize || strcmp(path + len - 4, ".bin") != 0) {
+        return false;
+    }
+    memcpy(out, path, len - 4);
+    strcpy(out + len - 4, ext);
+    return true;
+}
+
+// Capture rate and samples recorded as the .idx sidecar saw them, for a v2
+// file whose header can't be trusted. False if the sidecar is missing or
+// too short to time.
+static bool accelIdxTiming(const char* path, uint16_t* rate, uint16_t* samples) {
+    char idxPath[64];
+    if (!accelSidecarPath(path, ".idx", idxPath, sizeof(idxPath))) {
+        return false;
+    }
+    File idx = SD.open(idxPath, FILE_READ);
+    if (!idx) {
+        return false;
+    }
+    uint32_t entries = idx.size() / ACCEL_IDX_ENTRY_SIZE;
+    uint8_t first[ACCEL_IDX_ENTRY_SIZE], last[ACCEL_IDX_ENTRY_SIZE];
+    bool ok = entries >= 2 &&
+              idx.read(first, sizeof(first)) == sizeof(first) &&
+              idx.seek((entries - 1) * ACCEL_IDX_ENTRY_SIZE) &&
+              idx.read(last, sizeof(last)) == sizeof(last);
+    idx.close();
+    if (!ok) {
+        return false;
+    }
+
+    // Samples drained between the first and last drain over the time between them
+    uint32_t t0, t1;
+    uint16_t s0, s1;
+    memcpy(&t0, first, 4);
+    memcpy(&s0, first + 4, 2);
+    memcpy(&t1, last, 4);
+    memcpy(&s1, last + 4, 2);
+    uint32_t end0 = s0 + first[6], end1 = s1 + last[6];
+    if (t1 <= t0 || end1 <= end0 || end1 > 0xFFFF) {
+        return false;
+    }
+    float measured = (end1 - end0) * 1000.0f / (t1 - t0);
+
+    // Snap to the capture rate - drains land a tick or so late
+    static const uint16_t rates[] = { 119, 238, 476 };
+    uint16_t best = rates[0];
+    for (size_t i = 1; i < sizeof(rates) / sizeof(rates[0]); i++) {
+        if (fabsf(measured - rates[i]) < fabsf(measured - best)) best = rates[i];
+    }
+    *rate = best;
+    *samples = (uint16_t)end1;
+    return true;
+}
+
+static const char* accelBaseName(const char* path) {
+    const char* slash = strrchr(path, '/');
+    return slash ? slash + 1 : path;
+}
+
+// Open a recording and check its header; announce = reply OK:ACCEL_ANALYZING
+static bool accelAnalyzeStart(const char* path, bool announce) {
+    accelAnaFile = SD.open(path, FILE_READ);
+    if (!accelAnaFile) {
+        sendMessage("ERR:OPEN_FILE_FAILED");
+        return false;
+    }
+
+    uint8_t header[ACCEL_HEADER_SIZE + 4];
+    uint16_t sampleRate = 0, totalSamples = 0;
+    uint8_t version = accelFileVersion(accelAnaFile);
+    accelAnaFile.seek(0);
+    accelAnaFile.read(header, sizeof(header));
+    memcpy(&sampleRate, header + 8, 2);
+    memcpy(&totalSamples, header + 10, 2);
+    accelAnaHdrBad = false;
+    if (version == ACCEL_VERSION) {
+        // One read per data block
+        accelAnaRemaining = accelAnaFile.size() / ACCEL_BLOCK_SIZE - 1;
+        accelAnaFile.seek(ACCEL_BLOCK_SIZE);
+        memcpy(&accelAnaScale, header + 12, 4);
+
+        uint32_t stored;
+        memcpy(&stored, header + ACCEL_HEADER_SIZE, 4);
+        if (stored != crc32Final(crc32Update(crc32Begin(), header, ACCEL_HEADER_SIZE))) {
+            // Every block checks on its own, so only the header fields are
+            // in doubt: timing from the sidecar, else the header as read,
+            // bounded by what the file can hold
+            LOG_W("ACCEL", "WARNING: %s header CRC mismatch, analysing valid blocks", path);
+            accelAnaHdrBad = true;
+            if (!accelIdxTiming(path, &sampleRate, &totalSamples)) {
+                if (accelRateCode(sampleRate) == 0) sampleRate = ACCEL_RATE_DEFAULT;
+                uint32_t capacity = accelAnaRemaining * ACCEL_BLK_SAMPLES;
+                if (totalSamples > capacity) totalSamples = (uint16_t)capacity;
+            }
+            if (!(accelAnaScale > 0 && accelAnaScale < 1)) {
+                accelAnaScale = imu.calcAccel(1);   // Range is never changed in flight
+            }
+        }
+    } else if (version == ACCEL_VERSION_FLOAT) {
+        accelAnaFile.seek(ACCEL_HEADER_SIZE);
+        accelAnaRemaining = totalSamples;
+    } else {
+        sampleRate = 0;   // Wrong magic or unknown layout
+    }
+    if (sampleRate == 0) {
+        accelAnaFile.close();
+        LOG_E("ACCEL", "ERROR: %s is not a recording", path);
+        sendMessage("ERR:ACCEL_BAD_HEADER");
+        return false;
+    }
+
+    strncpy(accelAnaName, path, sizeof(accelAnaName) - 1);
+    accelAnaName[sizeof(accelAnaName) - 1] = '\0';
+    accelAnaVersion = version;
+    accelAnaNext = 0;
+    accelAnaTotal = totalSamples;
+    accelAnaLost = 0;
+    spectrumBegin(accelSpec, sampleRate, totalSamples);
+    accelAnalyzing = true;
+    schedAfter(accelJob, 0, millis());
+
+    LOG_I("ACCEL", "Analysing %s (v%u%s): %u samples @ %u Hz",
+          path, version, accelAnaHdrBad ? ", bad header" : "", totalSamples, sampleRate);
+    if (announce) {
+        char reply[80];
+        snprintf(reply, sizeof(reply), "OK:ACCEL_ANALYZING:%s", accelBaseName(path));
+        sendMessage(reply);
+    }
+    return true;
+}
+
+static void accelAnalyzeFinish() {
+    AxisResult r[SPEC_AXES];
+    spectrumFinish(accelSpec, r);
+    accelAnaFile.close();
+    accelAnalyzing = false;
+
+    static const char axisName[SPEC_AXES] = { 'X', 'Y', 'Z' };
+    char msg[TX_MAX_PACKET + 1];
+    int len = snprintf(msg, sizeof(msg), "ACCELA:%s|N:%lu@%u", accelBaseName(accelAnaName),
+                       (unsigned long)accelSpec.count, (unsigned)accelSpec.sampleRate);
+    if (accelAnaHdrBad) {
+        len += snprintf(msg + len, sizeof(msg) - len, "|HDR:BAD");
+    }
+
+    // Amplitudes in mg keep the line inside one packet
+    int tumbleAxis = 0, vibAxis = 0;
+    for (int a = 0; a < SPEC_AXES && len < (int)sizeof(msg); a++) {
+        len += snprintf(msg + len, sizeof(msg) - len, "|%c:%.3f,%.3f,%.2f,%.2f", axisName[a],
+                        r[a].mean, r[a].rms, r[a].min, r[a].max);
+        for (int p = 0; p < SPEC_PEAKS && len < (int)sizeof(msg); p++) {
+            len += snprintf(msg + len, sizeof(msg) - len, ",%.1f:%d",
+                            r[a].peakHz[p], (int)(r[a].peakAmp[p] * 1000.0f + 0.5f));
+        }
+        if (r[a].tumbleAmp > r[tumbleAxis].tumbleAmp) tumbleAxis = a;
+        if (r[a].peakAmp[0] > r[vibAxis].peakAmp[0]) vibAxis = a;
+    }
+    if (len < (int)sizeof(msg)) {
+        len += snprintf(msg + len, sizeof(msg) - len, "|TUMBLE:%.3f,%d,%c", r[tumbleAxis].tumbleHz,
+                        (int)(r[tumbleAxis].tumbleAmp * 1000.0f + 0.5f), axisName[tumbleAxis]);
+    }
+    if (accelAnaLost > 0 && len < (int)sizeof(msg)) {
+        snprintf(msg + len, sizeof(msg) - len, "|LOST:%lu", (unsigned long)accelAnaLost);
+    }
+
+    snprintf(accelLastSummary, sizeof(accelLastSummary), "TUMBLE:%.3fHz|VIB:%.1fHz",
+             r[tumbleAxis].tumbleHz, r[vibAxis].peakHz[0]);
+
+    // Sidecar, so the next request doesn't re-read the recording
+    char sumPath[64];
+    if (accelSidecarPath(accelAnaName, ".sum", sumPath, sizeof(sumPath))) {
+        File sum = SD.open(sumPath, FILE_WRITE);
+        if (sum) {
+            size_t written = sum.print(msg);
+            written += sum.print('\n');
+            sdSpaceAccount(written);
+            sum.close();
+            manifestNoteChanged(sumPath);
+        } else {
+            LOG_W("ACCEL", "WARNING: Cannot write %s", sumPath);
+        }
+    }
+
+    LOG_I("ACCEL", "Analysis: %s", msg);
+    sendMessage(msg);
+}
+
+// One v2 block: check it, scale to g and feed the kernel
+// Returns false at end of file
+static bool accelAnalyzeBlock() {
+    uint8_t* block = accelBlocks[0];   // Free - no capture while analysing
+    if (accelAnaFile.read(block, ACCEL_BLOCK_SIZE) != ACCEL_BLOCK_SIZE) {
+        return false;
+    }
+    if (!accelBlockValid(block)) {
+        // Bad block - the next good one's index accounts for its samples
+        LOG_W("ACCEL", "WARNING: Skipping corrupt block");
+        return true;
+    }
+
+    uint16_t first;
+    memcpy(&first, block, 2);
+    uint8_t count = block[2];
+    if (first > accelAnaNext) {
+        accelAnaLost += first - accelAnaNext;
+    }
+    accelAnaNext = first + count;
+
+    for (uint8_t i = 0; i < count; i++) {
+        int16_t raw[3];
+        memcpy(raw, block + ACCEL_BLK_HEADER_SIZE + i * ACCEL_RAW_SAMPLE_SIZE, ACCEL_RAW_SAMPLE_SIZE);
+        for (int a = 0; a < SPEC_AXES; a++) {
+            accelAnaBuf[i * SPEC_AXES + a] = raw[a] * accelAnaScale;
+        }
+    }
+    spectrumAdd(accelSpec, accelAnaBuf, count);
+    return true;
+}
+
+// A few chunks per tick keep the main loop responsive
+static void accelAnalyzeStep() {
     feedWatchdog();
 
-    // Read accelerometer
-    if (imu.accelAvailable()) {
-        imu.readAccel();
+    if (accelAnaVersion == ACCEL_VERSION) {
+        for (int i = 0; i < ACCEL_ANALYZE_READS && accelAnaRemaining > 0; i++) {
+            accelAnaRemaining = accelAnalyzeBlock() ? accelAnaRemaining - 1 : 0;
+        }
+        if (accelAnaRemaining == 0) {
+            if (accelAnaNext < accelAnaTotal) {
+                accelAnaLost += accelAnaTotal - accelAnaNext;   // Bad or missing tail
+            }
+            accelAnalyzeFinish();
+        }
+        return;
     }
 
-    // Create sample
-    AccelSample sample;
-    sample.x = imu.calcAccel(imu.ax);
-    sample.y = imu.calcAccel(imu.ay);
-    sample.z = imu.calcAccel(imu.az);
+    for (int i = 0; i < ACCEL_ANALYZE_READS && accelAnaRemaining > 0; i++) {
+        uint32_t want = accelAnaRemaining < ACCEL_ANALYZE_CHUNK ? accelAnaRemaining : ACCEL_ANALYZE_CHUNK;
+        size_t got = accelAnaFile.read((uint8_t*)accelAnaBuf, want * sizeof(AccelSample)) /
+                     sizeof(AccelSample);
+        spectrumAdd(accelSpec, accelAnaBuf, got);
+        accelAnaRemaining -= got;
+        if (got < want) {
+            accelAnaRemaining = 0;   // Short file - analyse what is there
+        }
+    }
 
-    // Write to file
-    size_t written = accelFile.write((uint8_t*)&sample, sizeof(AccelSample));
-    if (written != sizeof(AccelSample)) {
-        Serial.println("[ACCEL] ERROR: Write failed");
-        accelFile.close();
-        accelRecording.state = ACCEL_ERROR;
-        sendMessage("ERR:ACCEL_WRITE_FAILED");
+    if (accelAnaRemaining == 0) {
+        accelAnalyzeFinish();
+    }
+}
+
+void accelRecordingTick() {
+    if (accelAnalyzing) {
+        accelAnalyzeStep();
+    }
+
+    // Only process if recording
+    if (accelRecording.state != ACCEL_RECORDING) {
         return;
     }
 
-    accelRecording.samplesRecorded++;
-    accelRecording.lastSampleTime = now;
+    unsigned long now = millis();
+
+    // Drain first - the FIFO is the part that cannot wait
+    accelDrainFIFO(now);
+
+    // Then write at most one full data block per tick
+    int block = accelOldestPending();
+    if (block >= 0) {
+        if (!accelWriteBlock(accelFile, accelBlocks[block], ACCEL_BLOCK_SIZE)) {
+            accelFail("Write failed");
+            return;
+        }
+        accelPending[block] = false;
+    }
+
+    if (accelIdxFill == ACCEL_BLOCK_SIZE) {
+        if (!accelWriteBlock(accelIdxFile, accelIdxBlock, ACCEL_BLOCK_SIZE)) {
+            accelFail("Index write failed");
+            return;
+        }
+        accelIdxFill = 0;
+    }
 
     // Send progress update every 10 seconds
     if (now - accelRecording.lastProgressTime >= PROGRESS_INTERVAL_MS) {
-        int percent = (accelRecording.samplesRecorded * 100) / ACCEL_TOTAL_SAMPLES;
-        Serial.printf("[ACCEL] Progress: %d/%d (%d%%)\n",
-                      accelRecording.samplesRecorded, ACCEL_TOTAL_SAMPLES, percent);
-        sendMessage("ACCEL:PROGRESS:" + String(percent) + "%");
+        int percent = ((uint32_t)accelRecording.samplesRecorded * 100) / accelRecording.totalSamples;
+        LOG_I("ACCEL", "Progress: %d/%d (%d%%), FIFO full: %u, dropped: %u",
+              accelRecording.samplesRecorded, accelRecording.totalSamples, percent,
+              accelRecording.fifoFullEvents, accelRecording.bufferOverruns);
+        char progress[32];
+        snprintf(progress, sizeof(progress), "ACCEL:PROGRESS:%d%%", percent);
+        sendMessage(progress, TX_PRIO_TELEMETRY);
         accelRecording.lastProgressTime = now;
     }
 
     // Check if recording complete
-    if (accelRecording.samplesRecorded >= ACCEL_TOTAL_SAMPLES) {
-        // Flush and close file
+    if (accelRecording.samplesRecorded >= accelRecording.totalSamples) {
+        accelRestoreIMU();
+
+        // Flush whatever is still buffered: full blocks oldest first, then
+        // the partial one (sealed and written whole to keep the geometry)
+        bool ok = true;
+        int pending;
+        while (ok && (pending = accelOldestPending()) >= 0) {
+            ok = accelWriteBlock(accelFile, accelBlocks[pending], ACCEL_BLOCK_SIZE);
+            accelPending[pending] = false;
+        }
+        if (ok && accelBlkCount > 0) {
+            uint8_t last = accelActive;
+            accelSealBlock();
+            ok = accelWriteBlock(accelFile, accelBlocks[last], ACCEL_BLOCK_SIZE);
+        }
+        if (accelIdxFill > 0) {
+            ok = ok && accelWriteBlock(accelIdxFile, accelIdxBlock, accelIdxFill);
+        }
+        accelPending[0] = accelPending[1] = false;
+
         accelFile.flush();
+        size_t fileSize = accelFile.size();
         accelFile.close();
+        accelIdxFile.close();
+        manifestNoteChanged(accelRecording.filename);
+        manifestNoteChanged(accelIdxName);
+
+        if (!ok) {
+            accelRecording.state = ACCEL_ERROR;
+            LOG_E("ACCEL", "ERROR: Final flush failed");
+            sendMessage("ERR:ACCEL_WRITE_FAILED");
+            return;
+        }
 
         accelRecording.state = ACCEL_COMPLETE;
 
         unsigned long duration = now - accelRecording.startTime;
-        size_t fileSize = ACCEL_HEADER_SIZE + (accelRecording.samplesRecorded * sizeof(AccelSample));
 
-        Serial.printf("[ACCEL] Recording complete: %d samples in %lu ms\n",
-                      accelRecording.samplesRecorded, duration);
-        Serial.printf("[ACCEL] File: %s (%d bytes)\n",
-                      accelRecording.filename, fileSize);
+        LOG_I("ACCEL", "Recording complete: %d samples in %lu ms",
+              accelRecording.samplesRecorded, duration);
+        LOG_I("ACCEL", "File: %s (%d bytes), FIFO full: %u, dropped: %u",
+              accelRecording.filename, (int)fileSize,
+              accelRecording.fifoFullEvents, accelRecording.bufferOverruns);
 
-        sendMessage("OK:ACCEL_COMPLETE:" + String(accelRecording.filename) +
-                    ":" + String(fileSize) + "B");
+        char reply[96];
+        snprintf(reply, sizeof(reply), "OK:ACCEL_COMPLETE:%s:%uB|GAPS:%u",
+                 accelRecording.filename, (unsigned)fileSize,
+                 accelRecording.fifoFullEvents + accelRecording.bufferOverruns);
+        sendMessage(reply);
 
         // Reset for next recording
         accelRecording.state = ACCEL_IDLE;
+
+        // Summary follows on its own a moment later
+        accelAnalyzeStart(accelRecording.filename, false);
     }
 }
 
 void accelCancelRecording() {
     if (accelRecording.state == ACCEL_RECORDING) {
+        accelRestoreIMU();
         accelFile.close();
+        accelIdxFile.close();
         SD.remove(accelRecording.filename);
-        Serial.println("[ACCEL] Recording cancelled");
+        SD.remove(accelIdxName);
+        manifestNoteRemoved(accelRecording.filename);
+        manifestNoteRemoved(accelIdxName);
+        sdSpaceInvalidate();
+        LOG_I("ACCEL", "Recording cancelled");
         sendMessage("OK:ACCEL_CANCELLED");
     }
     accelRecording.state = ACCEL_IDLE;
 }
 
-String getAccelStatus() {
-    String status = "ACCEL:";
+void getAccelStatus(MsgBuilder& status) {
+    status.add("ACCEL:");
 
     switch (accelRecording.state) {
         case ACCEL_IDLE:
-            status += "IDLE";
+            status.add("IDLE");
             break;
         case ACCEL_RECORDING:
             {
-                int percent = (accelRecording.samplesRecorded * 100) / ACCEL_TOTAL_SAMPLES;
-                status += "REC:" + String(percent) + "%";
+                int percent = ((uint32_t)accelRecording.samplesRecorded * 100) / accelRecording.totalSamples;
+                status.add("REC:").addI(percent).add('%');
             }
             break;
         case ACCEL_COMPLETE:
-            status += "COMPLETE";
+            status.add("COMPLETE");
             break;
         case ACCEL_ERROR:
-            status += "ERROR";
+            status.add("ERROR");
             break;
     }
 
-    return status;
+    if (accelAnalyzing) {
+        status.add("|ANALYZING");
+    } else if (accelLastSummary[0] != '\0') {
+        status.add('|').add(accelLastSummary);
+    }
 }
 
-void accelListRecordings() {
+void accelListRecordings(const char* spec) {
     if (!SDOK) {
         sendMessage("ERR:SD_NOT_AVAILABLE");
         return;
     }
 
-    File dir = SD.open("/accel");
-    if (!dir || !dir.isDirectory()) {
+    ListPage page;
+    if (!parseListPage(spec, page)) {
+        sendMessage("ERR:LIST_BAD_PAGE");
+        return;
+    }
+
+    // Frames are sent from bulkDownlinkTick()
+    if (!bulkStartPage(ACCEL_DIR, "ACCEL:LS:", true, page)) {
         sendMessage("ACCEL:NO_RECORDINGS");
+    }
+}
+
+bool accelAnalyzeActive() {
+    return accelAnalyzing;
+}
+
+void accelAnalyze(const char* path) {
+    if (!SDOK) {
+        sendMessage("ERR:SD_NOT_AVAILABLE");
         return;
     }
 
-    sendMessage("ACCEL:RECORDINGS");
-    delay(50);
+    if (accelRecording.state == ACCEL_RECORDING || accelAnalyzing) {
+        sendMessage("ERR:ACCEL_BUSY");
+        return;
+    }
 
-    int count = 0;
-    File file = dir.openNextFile();
-    while (file && count < 20) {  // Limit to 20 files
-        if (!file.isDirectory()) {
-            String info = "ACCEL:F:" + String(file.name()) + "," + String(file.size());
-            sendMessage(info);
-            delay(50);
-            count++;
+    // Empty = last recording; bare names are looked up in /accel
+    char fullPath[64];
+    if (path == NULL || path[0] == '\0') {
+        if (accelRecording.filename[0] == '\0') {
+            sendMessage("ERR:ACCEL_NO_RECORDING");
+            return;
         }
-        file = dir.openNextFile();
+        snprintf(fullPath, sizeof(fullPath), "%s", accelRecording.filename);
+    } else if (path[0] == '/') {
+        snprintf(fullPath, sizeof(fullPath), "%s", path);
+    } else {
+        snprintf(fullPath, sizeof(fullPath), "/accel/%s", path);
     }
 
-    dir.close();
-    sendMessage("ACCEL:END:" + String(count));
+    char sumPath[64];
+    if (!accelSidecarPath(fullPath, ".sum", sumPath, sizeof(sumPath))) {
+        sendMessage("ERR:ACCEL_BAD_HEADER");
+        return;
+    }
+
+    // Already analysed - the sidecar holds the packet
+    if (SD.exists(sumPath)) {
+        File sum = SD.open(sumPath, FILE_READ);
+        if (sum) {
+            char line[TX_MAX_PACKET + 1];
+            size_t n = sum.readBytesUntil('\n', line, sizeof(line) - 1);
+            sum.close();
+            if (n > 0) {
+                line[n] = '\0';
+                sendMessage(line);
+                return;
+            }
+        }
+    }
+
+    accelAnalyzeStart(fullPath, true);
+}
+
+uint8_t accelFileVersion(File &file) {
+    uint8_t header[8];
+    if (file.read(header, sizeof(header)) != sizeof(header) ||
+        memcmp(header, ACCEL_MAGIC, 7) != 0) {
+        return 0;
+    }
+    return header[7];
 }
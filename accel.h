@@ -2,47 +2,111 @@
  * Orbital Temple Satellite - Accelerometer Recording Module
  * Version: 1.21
  *
- * Records accelerometer data (30Hz) for 60 seconds
+ * Records accelerometer data (119/238/476 Hz) for 60 seconds
  * when requested by ground station. Data is stored to SD card
  * and can be downloaded via ReadFile command.
  *
+ * CAPTURE: the gyro is powered down so the accelerometer runs at its own
+ * ODR, and the LSM9DS1's 32-sample hardware FIFO fills at the true rate.
+ * accelRecordingTick() drains it through the IMU service (imu.h) into a
+ * double buffer; whole
+ * 512-byte blocks go to SD. Main loop stalls shorter than one FIFO
+ * (67 ms at 476 Hz) no longer lose samples.
+ *
  * First recording is automatically triggered after initial ground contact.
  *
- * DATA FORMAT (Binary):
- *   Header: 16 bytes
+ * DATA FORMAT v2 (Binary, 512-byte blocks = one SD sector each):
+ *   Header block (block -1, file offset 0):
  *     - Magic: "ACCEL30" (7 bytes)
- *     - Version: 1 byte
+ *     - Version: 1 byte (2)
  *     - Sample rate: 2 bytes (uint16_t, Hz)
- *     - Sample count: 2 bytes (uint16_t)
- *     - Reserved: 4 bytes
- *   Data: 12 bytes per sample
- *     - X: 4 bytes (float, in g)
- *     - Y: 4 bytes (float, in g)
- *     - Z: 4 bytes (float, in g)
+ *     - Sample count: 2 bytes (uint16_t, planned)
+ *     - Scale: 4 bytes (float, g per LSB - imu.calcAccel(1))
+ *     - Header CRC32: 4 bytes (over the 16 bytes above)
+ *     - Zero padding to 512 bytes
+ *   Data block n (file offset (n + 1) * 512):
+ *     - First sample index: 2 bytes (uint16_t)
+ *     - Samples in block: 1 byte (ACCEL_BLK_SAMPLES except the last block)
+ *     - Flags: 1 byte (ACCEL_BLK_FIFO_FULL, ACCEL_BLK_GAP)
+ *     - CRC32: 4 bytes (over bytes 0-3 and 8-511)
+ *     - 84 samples x 6 bytes: raw int16 X, Y, Z, zero padded
+ *   Every block checks on its own, so a torn or partly corrupt file loses
+ *   only the bad blocks, and the index in each block shows where gaps are.
+ *   Block n is burst frames (n+1)*512/249 .. ((n+2)*512-1)/249, so
+ *   ReadFileRange can fetch single blocks.
+ *
+ * DATA FORMAT v1 (V1.21 recordings, still readable by AccelAnalyze):
+ *   16-byte header as above with the scale reserved, then 12 bytes per
+ *   sample (float X, Y, Z in g)
+ *
+ * TIMESTAMP SIDECAR (rec_N.idx, 8 bytes per FIFO drain):
+ *     - Time since start: 4 bytes (uint32_t, ms)
+ *     - First sample index: 2 bytes (uint16_t)
+ *     - Samples drained: 1 byte
+ *     - Flags: 1 byte (ACCEL_IDX_FIFO_FULL = FIFO was full, samples may be lost)
  *
  * USAGE:
- *   1. Send AccelRecord command to start recording
+ *   1. Send AccelRecord&@119 (or 238 / 476, empty = 119) to start recording
  *   2. Wait 60 seconds (satellite sends progress updates)
  *   3. Send AccelList to see available recordings
- *   4. Send ReadFile&/accel/[filename] to download
+ *   4. Send AccelAnalyze (or AccelAnalyze&/accel/[filename]) for a summary
+ *   5. Send ReadFile&/accel/[filename] to download the raw data if needed
+ *
+ * ON-BOARD ANALYSIS (spectrum.h):
+ *   Finished recordings are streamed back through the spectrum kernel a few
+ *   blocks per tick. The result goes out as one packet and is kept next to
+ *   the recording as rec_N.sum, so asking again costs one small read:
+ *     "ACCELA:rec_N.bin|N:count@rate|X:mean,rms,min,max,f1:a1,f2:a2,f3:a3|
+ *      Y:...|Z:...|TUMBLE:hz,amp,axis"
+ *   f = vibration peak (Hz), a = its amplitude (mg). Every recording is
+ *   analysed automatically when it completes. A v2 header that fails its
+ *   CRC doesn't stop the analysis: the valid blocks still go through, the
+ *   rate comes from the .idx timestamps and the line carries |HDR:BAD after
+ *   N:. Only a wrong magic or unknown version is refused
+ *   (ERR:ACCEL_BAD_HEADER).
  */
 
 #ifndef ACCEL_H
 #define ACCEL_H
 
 #include <Arduino.h>
+#include "FS.h"
+#include "msgbuf.h"
 
 // Recording configuration
-#define ACCEL_SAMPLE_RATE    30      // Hz (reduced from 60 for reliability)
+#define ACCEL_RATE_DEFAULT   119     // Hz (FIFO capture; 238 and 476 also selectable)
+#define ACCEL_RATE_MAX       476     // Hz
 #define ACCEL_DURATION_SEC   60      // seconds
-#define ACCEL_TOTAL_SAMPLES  (ACCEL_SAMPLE_RATE * ACCEL_DURATION_SEC)  // 1800
+#define ACCEL_MAX_SAMPLES    (ACCEL_RATE_MAX * ACCEL_DURATION_SEC)  // 28560
+
+// FIFO capture
+#define ACCEL_FIFO_DEPTH     32      // LSM9DS1 hardware FIFO (samples)
+#define ACCEL_BLOCK_SIZE     512     // SD write unit (one sector)
+#define ACCEL_IDX_ENTRY_SIZE 8       // Timestamp sidecar entry
+#define ACCEL_IDX_FIFO_FULL  0x01    // Drain found the FIFO full (possible overrun)
 
 // File header
+#define ACCEL_DIR            "/accel"
 #define ACCEL_MAGIC          "ACCEL30"
-#define ACCEL_VERSION        1
+#define ACCEL_VERSION        2       // Raw int16 samples in CRC blocks
+#define ACCEL_VERSION_FLOAT  1       // V1.21 float samples
 #define ACCEL_HEADER_SIZE    16
 
-// Data structure for one sample
+// v2 data blocks
+#define ACCEL_BLK_HEADER_SIZE 8
+#define ACCEL_RAW_SAMPLE_SIZE 6
+#define ACCEL_BLK_SAMPLES    ((ACCEL_BLOCK_SIZE - ACCEL_BLK_HEADER_SIZE) / ACCEL_RAW_SAMPLE_SIZE)  // 84
+#define ACCEL_BLK_FIFO_FULL  0x01    // A drain feeding this block found the FIFO full
+#define ACCEL_BLK_GAP        0x02    // Samples were dropped just before this block
+
+// Capture/analysis job (scheduler.h), armed only while either is running
+#define ACCEL_TICK_INTERVAL  20      // ms, well inside one FIFO fill at 476 Hz
+
+// On-board analysis
+#define ACCEL_ANALYZE_CHUNK  42      // Samples per SD read (504 bytes)
+#define ACCEL_ANALYZE_READS  4       // Reads per accelRecordingTick()
+
+// v1 sample (float, in g)
 struct AccelSample {
     float x;
     float y;
@@ -62,8 +126,12 @@ struct AccelRecording {
     AccelRecordingState state;
     char filename[64];
     uint16_t samplesRecorded;
+    uint16_t totalSamples;          // sampleRate * ACCEL_DURATION_SEC
+    uint16_t sampleRate;            // Hz (accelerometer ODR)
+    uint16_t fifoFullEvents;        // Drains that found the FIFO full
+    uint16_t bufferOverruns;        // Samples dropped because both buffers were full
     unsigned long startTime;
-    unsigned long lastSampleTime;
+    unsigned long lastDrainTime;
     unsigned long lastProgressTime;
 };
 
@@ -78,21 +146,36 @@ void initAccelRecording();
 // Check if first recording should be triggered (called on first ground contact)
 void checkFirstContactRecording();
 
-// Start a new 60-second recording
+// Start a new 60-second recording at 119, 238 or 476 Hz
 // Returns true if recording started
-bool accelStartRecording();
+bool accelStartRecording(uint16_t sampleRate = ACCEL_RATE_DEFAULT);
 
-// Called from main loop to record samples
-// Must be called frequently (at least 30Hz)
+// Drain the FIFO and write full blocks; also advances a running analysis
+// Must run at least once per FIFO fill (270 ms at 119 Hz, 67 ms at 476 Hz) -
+// the scheduler job calls it every ACCEL_TICK_INTERVAL while active
 void accelRecordingTick();
 
+// True while a capture owns the IMU (other readers must not pop the FIFO)
+bool accelCaptureActive();
+
 // Cancel current recording
 void accelCancelRecording();
 
-// Get recording status string
-String getAccelStatus();
+// Append the recording status ("ACCEL:REC:40%|...")
+void getAccelStatus(MsgBuilder& status);
+
+// List the recordings in ACCEL_DIR, a page at a time ("offset,count,version"
+// as for ListDir): "ACCEL:LS:<version>,<first>,<total>|F:name,size,v<version>..."
+void accelListRecordings(const char* spec);
+
+// Format version of an open recording (reads its header), 0 if not one
+uint8_t accelFileVersion(File &file);
+
+// Analyse a recording (empty path = the last one) and send "ACCELA:..."
+// Replies from the .sum sidecar if the recording was analysed before
+void accelAnalyze(const char* path);
 
-// List available recordings in /accel folder
-void accelListRecordings();
+// True while an analysis is being streamed
+bool accelAnalyzeActive();
 
 #endif // ACCEL_H
@@ -0,0 +1,56 @@
+/*
+ * Orbital Temple Satellite - Bloom Filter Implementation
+ * Version: 1.21
+ */
+
+#include <string.h>
+#include "bloom.h"
+#include "crc32.h"
+
+#define FNV_OFFSET  2166136261u
+#define FNV_PRIME   16777619u
+
+BloomKey bloomHash(const uint8_t* data, size_t length) {
+    uint32_t fnv = FNV_OFFSET;
+    for (size_t i = 0; i < length; i++) {
+        fnv = (fnv ^ data[i]) * FNV_PRIME;
+    }
+
+    BloomKey key;
+    key.h1 = crc32Final(crc32Update(crc32Begin(), data, length));
+    key.h2 = fnv | 1;
+    return key;
+}
+
+void bloomInit(Bloom& b, uint8_t* storage, size_t bytes) {
+    memset(storage, 0, bytes);
+    b.bits = storage;
+    b.mask = (uint32_t)(bytes * 8 - 1);
+    b.count = 0;
+}
+
+void bloomAdd(Bloom& b, const BloomKey& key) {
+    uint32_t pos = key.h1;
+    for (int i = 0; i < BLOOM_K; i++) {
+        uint32_t bit = pos & b.mask;
+        b.bits[bit >> 3] |= (uint8_t)(1 << (bit & 7));
+        pos += key.h2;
+    }
+    b.count++;
+}
+
+bool bloomMayContain(const Bloom& b, const BloomKey& key) {
+    if (b.bits == NULL) return true;        // No filter: everything is a maybe
+
+    uint32_t pos = key.h1;
+    for (int i = 0; i < BLOOM_K; i++) {
+        uint32_t bit = pos & b.mask;
+        if ((b.bits[bit >> 3] & (1 << (bit & 7))) == 0) return false;
+        pos += key.h2;
+    }
+    return true;
+}
+
+bool bloomFull(const Bloom& b) {
+    return (uint64_t)b.count * BLOOM_BITS_PER_ENTRY > (uint64_t)b.mask + 1;
+}
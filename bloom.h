@@ -0,0 +1,60 @@
+#ifndef BLOOM_H
+#define BLOOM_H
+
+/*
+ * Orbital Temple Satellite - Bloom Filter
+ * Version: 1.21
+ *
+ * Set membership in a few bits per entry: bloomMayContain() is false only
+ * for keys never added, and true for keys that were added or, with a
+ * small probability, collide with them. The name ledger (names.h) keeps
+ * one in RAM so "has this name ascended?" is answered without the card
+ * whenever the answer is no.
+ *
+ * A key is two 32-bit hashes (bloomHash(): CRC32 and FNV-1a); the k bit
+ * positions are h1 + i * h2 (double hashing), so no further hashing is
+ * done per probe. The bit array is a power of two in size and owned by
+ * the caller.
+ *
+ * With BLOOM_BITS_PER_ENTRY bits per entry and BLOOM_K probes the false
+ * positive rate is about 1%, rising slowly once more entries are added
+ * than that (bloomFull()).
+ *
+ * Host-portable: no Arduino dependencies, so the test suite compiles it
+ * directly (test/test_bloom.cpp).
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ==================== CONFIGURATION ====================
+
+#define BLOOM_BITS_PER_ENTRY  10
+#define BLOOM_K               7
+
+// ==================== FILTER ====================
+
+struct Bloom {
+    uint8_t* bits;
+    uint32_t mask;          // Bit count - 1
+    uint32_t count;         // Keys added
+};
+
+struct BloomKey {
+    uint32_t h1;
+    uint32_t h2;            // Odd, so the probes cover the whole array
+};
+
+// Hash a key (call crc32Init() first)
+BloomKey bloomHash(const uint8_t* data, size_t length);
+
+// Use 'bytes' of storage (a power of two), cleared
+void bloomInit(Bloom& b, uint8_t* storage, size_t bytes);
+
+void bloomAdd(Bloom& b, const BloomKey& key);
+bool bloomMayContain(const Bloom& b, const BloomKey& key);
+
+// More than BLOOM_BITS_PER_ENTRY bits per entry used up
+bool bloomFull(const Bloom& b);
+
+#endif // BLOOM_H
@@ -0,0 +1,87 @@
+/*
+ * Orbital Temple Satellite - Analog Sensor Calibration Implementation
+ * Version: 1.21
+ *
+ * The thermistor table is a constant expression: a C++11 constexpr
+ * natural log (range reduction by 2, then a short atanh series) feeds
+ * the B-parameter equation once per entry, and an index pack expands the
+ * entries into the initializer. The table lands in flash; nothing is
+ * computed at boot.
+ */
+
+#include <math.h>
+#include "calib.h"
+
+// ==================== CONSTEXPR LOG ====================
+
+#define CALIB_LN2  0.69314718055994530942
+
+// 2 * atanh(y) = ln((1 + y) / (1 - y)), |y| <= 1/3 after reduction
+static constexpr double lnSeries(double term, double y2, int k) {
+    return k > 41 ? 0.0 : term / k + lnSeries(term * y2, y2, k + 2);
+}
+
+static constexpr double lnReduced(double m) {
+    return 2.0 * lnSeries((m - 1.0) / (m + 1.0),
+                          ((m - 1.0) / (m + 1.0)) * ((m - 1.0) / (m + 1.0)), 1);
+}
+
+// ln(x) = k * ln(2) + ln(m), m in [1, 2)
+static constexpr double calibLn(double x, int k) {
+    return x >= 2.0 ? calibLn(x / 2.0, k + 1)
+         : x < 1.0  ? calibLn(x * 2.0, k - 1)
+         : k * CALIB_LN2 + lnReduced(x);
+}
+
+// ==================== THERMISTOR TABLE ====================
+
+// The end entries (0 and 4096 counts) have no finite resistance; they
+// bound only intervals outside [THERM_ADC_MIN, THERM_ADC_MAX] and are
+// clamped to stay finite
+static constexpr double thermClamp(double adc) {
+    return adc < 1.0 ? 1.0 : adc > ADC_MAX_COUNT - 1.0 ? ADC_MAX_COUNT - 1.0 : adc;
+}
+
+// Rt = R_series * Vout / (Vs - Vout); Vs cancels in counts
+static constexpr double thermKelvin(double adc) {
+    return 1.0 / (1.0 / THERM_T0 +
+                  calibLn(THERM_R_SERIES * adc / (ADC_MAX_COUNT - adc) / THERM_R0, 0) / THERM_BETA);
+}
+
+static constexpr float thermEntry(int i) {
+    return (float)(thermKelvin(thermClamp((double)i * THERM_LUT_STEP)) - 273.15);
+}
+
+struct ThermTable {
+    float c[THERM_LUT_SIZE];
+};
+
+template <int... I> struct IndexSeq {};
+template <int N, int... I> struct MakeIndexSeq : MakeIndexSeq<N - 1, N - 1, I...> {};
+template <int... I> struct MakeIndexSeq<0, I...> { typedef IndexSeq<I...> type; };
+
+template <int... I>
+static constexpr ThermTable makeThermTable(IndexSeq<I...>) {
+    return ThermTable{{ thermEntry(I)... }};
+}
+
+static constexpr ThermTable thermTable = makeThermTable(MakeIndexSeq<THERM_LUT_SIZE>::type());
+
+// 10k/10k divider at mid-scale is the B-parameter reference point
+static_assert(thermTable.c[2048 / THERM_LUT_STEP] > 24.9f && thermTable.c[2048 / THERM_LUT_STEP] < 25.1f,
+              "Thermistor table: mid-scale must be ~25 C");
+
+float calibThermistorC(float adc) {
+    if (!(adc >= (float)THERM_ADC_MIN && adc <= (float)THERM_ADC_MAX)) {
+        return THERM_ERROR;
+    }
+    float pos = adc / THERM_LUT_STEP;
+    int i = (int)pos;
+    float frac = pos - i;
+    return thermTable.c[i] + (thermTable.c[i + 1] - thermTable.c[i]) * frac;
+}
+
+double calibThermistorExactC(double adc) {
+    double rt = THERM_R_SERIES * adc / (ADC_MAX_COUNT - adc);
+    return 1.0 / (1.0 / THERM_T0 + log(rt / THERM_R0) / THERM_BETA) - 273.15;
+}
@@ -0,0 +1,64 @@
+#ifndef CALIB_H
+#define CALIB_H
+
+/*
+ * Orbital Temple Satellite - Analog Sensor Calibration
+ * Version: 1.21
+ *
+ * Raw ADC counts to engineering units for the battery divider, the
+ * luminosity sensor and the thermistor. The linear channels are a single
+ * precomputed factor; the thermistor's B-parameter curve is tabulated at
+ * compile time (constexpr, no log() at run time) every THERM_LUT_STEP
+ * counts and interpolated linearly - under 0.02 C off the exact curve
+ * between -20 and 100 C.
+ *
+ * Inputs are mean counts of an oversampled burst (fractional, 0..4095).
+ * Host-portable (test/test_calib.cpp builds it).
+ */
+
+#include <stdint.h>
+
+#define ADC_MAX_COUNT     4095.0      // 12-bit full scale
+#define ADC_VREF          3.3         // Volts at full scale
+
+// Battery: equal-resistor divider
+#define BAT_DIVIDER       2.0
+
+// Luminosity: photodiode current into a 10k load, 5 V scale via level shifter
+#define LUX_VREF          5.0
+#define LUX_LOAD_OHMS     10000.0
+#define LUX_PER_UA        2.0         // Sensor-specific calibration factor
+
+// Thermistor: NTC to GND, series resistor to Vs
+#define THERM_R_SERIES    10000.0     // Ohms
+#define THERM_R0          10000.0     // Ohms at THERM_T0
+#define THERM_T0          298.15      // Kelvin
+#define THERM_BETA        3950.0
+#define THERM_ADC_MIN     50.0        // Below: shorted to GND
+#define THERM_ADC_MAX     4000.0      // Above: open / shorted to Vs
+#define THERM_ERROR       -999.0f     // Tc value for a sensor fault
+#define THERM_LUT_STEP    16          // Counts between table entries
+#define THERM_LUT_SIZE    (4096 / THERM_LUT_STEP + 1)
+
+constexpr float BAT_VOLTS_PER_COUNT = (float)(ADC_VREF / ADC_MAX_COUNT * BAT_DIVIDER);
+constexpr float LUX_VOLTS_PER_COUNT = (float)(LUX_VREF / 4096.0);
+constexpr float LUX_PER_COUNT = (float)(LUX_VREF / 4096.0 / LUX_LOAD_OHMS * 1e6 * LUX_PER_UA);
+
+// Battery voltage (V) for a mean count
+inline float calibBatteryVolts(float adc) {
+    return adc * BAT_VOLTS_PER_COUNT;
+}
+
+// Illuminance (lx) for a mean count
+inline float calibLux(float adc) {
+    return adc * LUX_PER_COUNT;
+}
+
+// Temperature (C) for a mean count, THERM_ERROR outside
+// [THERM_ADC_MIN, THERM_ADC_MAX]
+float calibThermistorC(float adc);
+
+// Exact B-parameter curve (double log) - for tests and diagnostics
+double calibThermistorExactC(double adc);
+
+#endif // CALIB_H
@@ -10,13 +10,17 @@
  */
 
 #include "config.h"
+#include "log.h"
 #include "radiation.h"
 #include "accel.h"
+#include "lora.h"
+#include "memor.h"
+#include "power.h"
+#include "imu.h"
+#include "perf.h"
+#include "sensors.h"
 #include "secrets.h"  // HMAC key - this file should NOT be committed to git
 
-// Forward declaration for battery reading (defined in sensors.cpp)
-extern void readBatteryVoltage();
-
 // ==================== RADIO ====================
 // RFM95 module (SX1276 chip) - uses DIO0 for interrupts
 SX1276 radio = new Module(CS_RF, DIO0_RF, RST_RF);
@@ -30,31 +34,42 @@ String MsR = "";
 String sat_id = "";
 
 // ==================== STATE MACHINE ====================
-MissionState currentState = STATE_BOOT;
-AntennaState antennaState = ANT_IDLE;
+// Mission-critical values are registered in the TMR region (tmr.h)
+const MissionState& currentState = tmrNew("state", STATE_BOOT);
+const AntennaState& antennaState = tmrNew("antState", ANT_IDLE);
 unsigned long stateStartTime = 0;
 unsigned long lastWdtFeed = 0;
-unsigned long missionStartTime = 0;
-uint32_t bootCount = 0;
+const unsigned long& missionStartTime = tmrNew("missionStart", 0UL);
+const uint32_t& bootCount = tmrNew("bootCount", (uint32_t)0);
 
 // ==================== ANTENNA DEPLOYMENT ====================
-int deployRetryCount = 0;
-bool antennaDeployed = false;
+const int& deployRetryCount = tmrNew("deployRetries", 0);
+const bool& antennaDeployed = tmrNew("antDeployed", false);
 
 // ==================== BEACON SYSTEM ====================
-bool groundContactEstablished = false;    // True after first successful command received
-unsigned long lastGroundContact = 0;       // Time of last command from ground station
-unsigned long lastBeaconTime = 0;          // Time of last beacon transmission
+const bool& groundContactEstablished = tmrNew("contact", false);   // True after first successful command received
+const unsigned long& lastGroundContact = tmrNew("lastContact", 0UL); // Time of last command from ground station
+uint32_t groundContactsTotal = 0;
+uint32_t lastContactBoot = 0;
+uint32_t lastContactSecs = 0;
+const unsigned long& lastBeaconTime = tmrNew("lastBeacon", 0UL);     // Time of last beacon transmission
+
+// ==================== TELEMETRY ====================
+const TelemetryFormat& telemetryFormat = tmrNew("telemFormat", TELEM_FORMAT_DEFAULT);
 
 // ==================== HARDWARE STATUS FLAGS ====================
-bool IMUOK = true;
-bool RFOK = true;
-bool SDOK = false;  // Start false, set true only after successful init
+const bool& IMUOK = tmrNew("imuOK", true);
+const bool& RFOK = tmrNew("rfOK", true);
+const bool& SDOK = tmrNew("sdOK", false);  // Start false, set true only after successful init
 
 // ==================== LORA RETRY COUNTERS ====================
 int contE = 0;
 int contR = 0;
 
+// ==================== LORA TURNAROUND ====================
+uint32_t radioLastTurnaroundUs = 0;
+uint32_t radioMaxTurnaroundUs = 0;
+
 // ==================== SOAK TEST COUNTERS ====================
 uint32_t soakBeaconsSent = 0;
 uint32_t soakBeaconsSkipped = 0;
@@ -73,12 +88,7 @@ float VE = 0.0f;
 float VT = 0.0f;
 
 // ==================== SENSORS: TEMPERATURE ====================
-double adcMax = 4095.0;
-double Vs = 3.3;
-double R1z = 10000.0;
-double Beta = 3950.0;
-double To = 298.15;
-double Ro = 10000.0;
+// Thermistor constants are compile-time (THERM_* in calib.h)
 double Tc = 0.0;
 
 // ==================== SENSORS: LUMINOSITY ====================
@@ -102,65 +112,134 @@ void feedWatchdog() {
 // which calls loadStateWithCRC() for CRC-verified state restoration.
 
 void saveState() {
-    // Sync critical variables to TMR copies for radiation protection
-    tmrWrite(tmr_missionState, (uint8_t)currentState);
-    tmrWrite(tmr_antennaState, (uint8_t)antennaState);
-    tmrWrite(tmr_antennaDeployed, antennaDeployed);
-    tmrWrite(tmr_groundContact, groundContactEstablished);
-    tmrWrite(tmr_rfOK, RFOK);
-    tmrWrite(tmr_imuOK, IMUOK);
-    tmrWrite(tmr_sdOK, SDOK);
-    tmrWrite(tmr_bootCount, bootCount);
-
     // Use CRC-protected save
     saveStateWithCRC();
 }
 
 // ==================== HMAC AUTHENTICATION ====================
+// HMAC(K, m) = H((K ^ opad) || H((K ^ ipad) || m)). The key never changes,
+// so the SHA-256 states after absorbing the two padded key blocks are
+// computed once in initHMAC() and cloned for every message: per packet that
+// saves two compression rounds plus the md_setup()/free() churn.
+
+#define HMAC_BLOCK_SIZE 64   // SHA-256 block size
+#define HMAC_TAG_LENGTH 8    // Truncated tag: 8 bytes = 16 hex chars on air
+
+// Older mbedtls (arduino-esp32 2.x ships 2.28) only has the *_ret variants
+#if MBEDTLS_VERSION_MAJOR >= 3
+    #define sha256Starts(ctx)        mbedtls_sha256_starts((ctx), 0)
+    #define sha256Update(ctx, d, n)  mbedtls_sha256_update((ctx), (d), (n))
+    #define sha256Finish(ctx, out)   mbedtls_sha256_finish((ctx), (out))
+#else
+    #define sha256Starts(ctx)        mbedtls_sha256_starts_ret((ctx), 0)
+    #define sha256Update(ctx, d, n)  mbedtls_sha256_update_ret((ctx), (d), (n))
+    #define sha256Finish(ctx, out)   mbedtls_sha256_finish_ret((ctx), (out))
+#endif
+
+static mbedtls_sha256_context hmacInner;   // State after (K ^ ipad)
+static mbedtls_sha256_context hmacOuter;   // State after (K ^ opad)
+static bool hmacReady = false;
+
+void initHMAC() {
+    uint8_t pad[HMAC_BLOCK_SIZE];
+
+    mbedtls_sha256_init(&hmacInner);
+    mbedtls_sha256_init(&hmacOuter);
+
+    // Key is 32 bytes (< block size), so it is zero-padded, not hashed
+    memset(pad, 0x36, sizeof(pad));
+    for (int i = 0; i < HMAC_KEY_LENGTH; i++) pad[i] ^= HMAC_KEY[i];
+    sha256Starts(&hmacInner);
+    sha256Update(&hmacInner, pad, sizeof(pad));
+
+    memset(pad, 0x5C, sizeof(pad));
+    for (int i = 0; i < HMAC_KEY_LENGTH; i++) pad[i] ^= HMAC_KEY[i];
+    sha256Starts(&hmacOuter);
+    sha256Update(&hmacOuter, pad, sizeof(pad));
+
+    memset(pad, 0, sizeof(pad));
+    hmacReady = true;
+}
+
+// Truncated HMAC-SHA256 tag from the pre-keyed states
+static void calculateHMACTag(const uint8_t* message, size_t length, uint8_t tag[HMAC_TAG_LENGTH]) {
+    if (!hmacReady) initHMAC();
+    PerfScope perf(PERF_HMAC);
+
+    uint8_t digest[32];
+    mbedtls_sha256_context ctx;
+    mbedtls_sha256_init(&ctx);
+
+    mbedtls_sha256_clone(&ctx, &hmacInner);
+    sha256Update(&ctx, message, length);
+    sha256Finish(&ctx, digest);
+
+    mbedtls_sha256_clone(&ctx, &hmacOuter);
+    sha256Update(&ctx, digest, sizeof(digest));
+    sha256Finish(&ctx, digest);
+
+    mbedtls_sha256_free(&ctx);
+    memcpy(tag, digest, HMAC_TAG_LENGTH);
+}
+
+static int hexNibble(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
 
 String calculateHMAC(const String& message) {
-    uint8_t hmacResult[32];
-
-    mbedtls_md_context_t ctx;
-    mbedtls_md_type_t md_type = MBEDTLS_MD_SHA256;
-
-    mbedtls_md_init(&ctx);
-    mbedtls_md_setup(&ctx, mbedtls_md_info_from_type(md_type), 1);
-    mbedtls_md_hmac_starts(&ctx, HMAC_KEY, HMAC_KEY_LENGTH);
-    mbedtls_md_hmac_update(&ctx, (const unsigned char*)message.c_str(), message.length());
-    mbedtls_md_hmac_finish(&ctx, hmacResult);
-    mbedtls_md_free(&ctx);
-
-    // Convert to hex string (first 8 bytes = 16 hex chars for brevity in LoRa)
-    String hmacHex = "";
-    for (int i = 0; i < 8; i++) {
-        if (hmacResult[i] < 16) hmacHex += "0";
-        hmacHex += String(hmacResult[i], HEX);
+    uint8_t tag[HMAC_TAG_LENGTH];
+    calculateHMACTag((const uint8_t*)message.c_str(), message.length(), tag);
+
+    // Convert to hex string
+    char hmacHex[HMAC_TAG_LENGTH * 2 + 1];
+    for (int i = 0; i < HMAC_TAG_LENGTH; i++) {
+        snprintf(hmacHex + i * 2, 3, "%02x", tag[i]);
     }
 
-    return hmacHex;
+    return String(hmacHex);
 }
 
-bool verifyHMAC(const String& message, const String& receivedHMAC) {
-    String calculatedHMAC = calculateHMAC(message);
-
-    // Case-insensitive comparison
-    String recvLower = receivedHMAC;
-    String calcLower = calculatedHMAC;
-    recvLower.toLowerCase();
-    calcLower.toLowerCase();
-
-    bool valid = recvLower.equals(calcLower);
-
-    if (!valid) {
-        Serial.println("[AUTH] HMAC verification failed!");
-        Serial.print("[AUTH] Expected: ");
-        Serial.println(calcLower);
-        Serial.print("[AUTH] Received: ");
-        Serial.println(recvLower);
+bool verifyHMAC(const uint8_t* message, size_t length, const char* receivedHMAC, size_t hmacLength) {
+    // Decode the received hex first - malformed tags cost no hashing
+    uint8_t received[HMAC_TAG_LENGTH];
+    if (hmacLength != HMAC_TAG_LENGTH * 2) {
+        LOG_W("AUTH", "HMAC has wrong length");
+        return false;
+    }
+    for (int i = 0; i < HMAC_TAG_LENGTH; i++) {
+        int hi = hexNibble(receivedHMAC[i * 2]);
+        int lo = hexNibble(receivedHMAC[i * 2 + 1]);
+        if (hi < 0 || lo < 0) {
+            LOG_W("AUTH", "HMAC is not hex");
+            return false;
+        }
+        received[i] = (uint8_t)((hi << 4) | lo);
+    }
+
+    uint8_t tag[HMAC_TAG_LENGTH];
+    calculateHMACTag(message, length, tag);
+
+    // Constant-time comparison - no early exit on the first mismatch
+    uint8_t diff = 0;
+    for (int i = 0; i < HMAC_TAG_LENGTH; i++) {
+        diff |= (uint8_t)(tag[i] ^ received[i]);
+    }
+
+    if (diff != 0) {
+        LOG_E("AUTH", "HMAC verification failed!");
+        LOG_D("AUTH", "Received: %.*s", (int)hmacLength, receivedHMAC);
+        return false;
     }
 
-    return valid;
+    return true;
+}
+
+bool verifyHMAC(const String& message, const String& receivedHMAC) {
+    return verifyHMAC((const uint8_t*)message.c_str(), message.length(),
+                      receivedHMAC.c_str(), receivedHMAC.length());
 }
 
 // ==================== BEACON SYSTEM ====================
@@ -184,8 +263,6 @@ bool verifyHMAC(const String& message, const String& receivedHMAC) {
  * Configure timing in config.h (BEACON_* defines)
  */
 
-// Forward declaration for sendMessage (defined in lora.cpp)
-extern bool sendMessage(const String& message);
 
 // Get the appropriate beacon interval based on contact status
 unsigned long getBeaconInterval() {
@@ -193,7 +270,7 @@ unsigned long getBeaconInterval() {
 
     if (!groundContactEstablished) {
         // No contact yet - beacon every 4 minutes to help ground find us
-        Serial.println("[BEACON] Interval: NO_CONTACT (every 4 min)");
+        LOG_I("BEACON", "Interval: NO_CONTACT (every 4 min)");
         return BEACON_INTERVAL_NO_CONTACT;
     }
 
@@ -202,13 +279,13 @@ unsigned long getBeaconInterval() {
 
     if (timeSinceContact > BEACON_LOST_THRESHOLD) {
         // Lost contact - beacon every 8 minutes
-        Serial.printf("[BEACON] Interval: LOST (every 8 min, no contact for %lu hours)\n",
-                      timeSinceContact / 3600000UL);
+        LOG_I("BEACON", "Interval: LOST (every 8 min, no contact for %lu hours)",
+              timeSinceContact / 3600000UL);
         return BEACON_INTERVAL_LOST;
     }
 
     // Normal operation - beacon every 1 hour
-    Serial.println("[BEACON] Interval: NORMAL (every 1 hour)");
+    LOG_I("BEACON", "Interval: NORMAL (every 1 hour)");
     return BEACON_INTERVAL_NORMAL;
 }
 
@@ -219,13 +296,23 @@ void registerGroundContact() {
     bool isFirstContact = !groundContactEstablished;
 
     if (isFirstContact) {
-        Serial.println("[BEACON] First ground contact established!");
-        groundContactEstablished = true;
+        LOG_I("BEACON", "First ground contact established!");
+        tmrWrite(groundContactEstablished, true);
     }
 
-    lastGroundContact = now;
-    Serial.printf("[BEACON] Ground contact registered at T+%lu ms\n",
-                  now - missionStartTime);
+    tmrWrite(lastGroundContact, now);
+    LOG_I("BEACON", "Ground contact registered at T+%lu ms",
+          now - missionStartTime);
+
+    groundContactsTotal++;
+    lastContactBoot = bootCount;
+    lastContactSecs = now / 1000;
+
+    // A journal save is one slot program; without the journal each save
+    // is a sector rewrite, so only the first contact is persisted then
+    if (stateJournalActive() || isFirstContact) {
+        saveState();
+    }
 
     // Trigger first accelerometer recording on initial contact
     if (isFirstContact) {
@@ -238,43 +325,44 @@ void sendBeacon() {
     unsigned long now = millis();
 
     // ==================== BATTERY CHECK ====================
-    // Read battery voltage before sending beacon
-    Serial.println("[BEACON] Checking battery voltage...");
-    readBatteryVoltage();
+    // VT is the sampler's moving average - no ADC read here
+    SensorStats bat;
+    sensorWindowTake(SENSOR_WIN_BEACON, SENSOR_BATTERY, bat);
 
     // Skip beacon if battery is too low (power saving mode)
     if (VT < BEACON_MIN_BATTERY_VOLTAGE && VT > 0) {
-        Serial.printf("[BEACON] LOW BATTERY (%.2fV < %.1fV) - Skipping beacon to save power\n",
-                      VT, BEACON_MIN_BATTERY_VOLTAGE);
+        LOG_W("BEACON", "LOW BATTERY (%.2fV < %.1fV) - Skipping beacon to save power",
+              VT, BEACON_MIN_BATTERY_VOLTAGE);
         // Still update lastBeaconTime to maintain interval timing
-        lastBeaconTime = millis();
+        tmrWrite(lastBeaconTime, millis());
         soakBeaconsSkipped++;  // Track for soak test
         return;
     }
 
-    Serial.printf("[BEACON] Battery OK: %.2fV\n", VT);
+    LOG_I("BEACON", "Battery OK: %.2fV (%.2f-%.2fV since last beacon)",
+          VT, bat.min, bat.max);
 
     // Choose beacon message based on contact status
-    String beacon;
+    Reply beacon;
     if (!groundContactEstablished) {
         // Searching for Earth
-        Serial.println("[BEACON] Mode: SEARCHING (every 4 min)");
-        beacon = BEACON_MSG_SEARCHING;
+        LOG_I("BEACON", "Mode: SEARCHING (every 4 min)");
+        beacon.add(BEACON_MSG_SEARCHING);
     } else {
         // Check if lost
         unsigned long timeSinceContact = now - lastGroundContact;
         if (timeSinceContact > BEACON_LOST_THRESHOLD) {
             // Lost contact
-            Serial.println("[BEACON] Mode: LOST (every 8 min)");
-            beacon = BEACON_MSG_LOST;
+            LOG_I("BEACON", "Mode: LOST (every 8 min)");
+            beacon.add(BEACON_MSG_LOST);
         } else {
             // Connected
-            Serial.println("[BEACON] Mode: CONNECTED (every 1 hour)");
-            beacon = BEACON_MSG_CONNECTED;
+            LOG_I("BEACON", "Mode: CONNECTED (every 1 hour)");
+            beacon.add(BEACON_MSG_CONNECTED);
         }
     }
 
-    beacon += "|";
+    beacon.add('|');
 
     // Add mission elapsed time
     unsigned long elapsed = now - missionStartTime;
@@ -282,42 +370,43 @@ void sendBeacon() {
     unsigned long minutes = (elapsed % 3600000UL) / 60000UL;
     unsigned long seconds = (elapsed % 60000UL) / 1000UL;
 
-    char timeStr[20];
-    snprintf(timeStr, sizeof(timeStr), "T+%02lu:%02lu:%02lu", hours, minutes, seconds);
-    beacon += timeStr;
+    beacon.addf("T+%02lu:%02lu:%02lu", hours, minutes, seconds);
 
     // Add boot count
-    beacon += "|B:";
-    beacon += String(bootCount);
+    beacon.add("|B:").addU(bootCount);
 
     // Add contact status
-    beacon += "|C:";
-    beacon += groundContactEstablished ? "YES" : "NO";
+    beacon.add("|C:").add(groundContactEstablished ? "YES" : "NO");
 
     // Add battery voltage
-    beacon += "|V:";
-    beacon += String(VT, 1);
+    beacon.add("|V:").addF(VT, 1);
 
-    Serial.println("[BEACON] Sending: " + beacon);
-    sendMessage(beacon);
+    LOG_I("BEACON", "Sending: %s", beacon.c_str());
+    sendMessage(beacon, TX_PRIO_BEACON);
 
-    lastBeaconTime = millis();
+    tmrWrite(lastBeaconTime, millis());
     soakBeaconsSent++;  // Track for soak test
 }
 
 // ==================== SOAK TEST LOGGING ====================
 // Comprehensive logging for 7-day endurance test debugging
 
-// Forward declarations for functions we need
-extern void logToSD(const char* message);
 
 // Get free heap memory (detect memory leaks)
 uint32_t getFreeHeap() {
     return ESP.getFreeHeap();
 }
 
+uint32_t getLargestFreeBlock() {
+    return ESP.getMaxAllocHeap();
+}
+
+uint32_t getMinFreeHeap() {
+    return ESP.getMinFreeHeap();
+}
+
 // Format uptime as days:hours:minutes:seconds
-String formatUptime(unsigned long ms) {
+static void formatUptime(char* buf, size_t size, unsigned long ms) {
     unsigned long seconds = ms / 1000;
     unsigned long minutes = seconds / 60;
     unsigned long hours = minutes / 60;
@@ -327,65 +416,79 @@ String formatUptime(unsigned long ms) {
     minutes %= 60;
     hours %= 24;
 
-    char buf[32];
-    snprintf(buf, sizeof(buf), "%lud %02lu:%02lu:%02lu", days, hours, minutes, seconds);
-    return String(buf);
-}
-
-// Called every loop iteration - checks if it's time for logging
-void soakTestTick() {
-    unsigned long now = millis();
-    soakLoopIterations++;  // Will overflow, that's OK
-
-    // Hourly log
-    if (now - soakLastHourlyLog >= SOAK_LOG_INTERVAL) {
-        soakLogHourly();
-        soakLastHourlyLog = now;
-    }
-
-    // Daily log
-    if (now - soakLastDailyLog >= SOAK_DAILY_INTERVAL) {
-        soakLogDaily();
-        soakLastDailyLog = now;
-    }
+    snprintf(buf, size, "%lud %02lu:%02lu:%02lu", days, hours, minutes, seconds);
 }
 
 // Hourly status log - written to SD card and serial
 void soakLogHourly() {
     unsigned long now = millis();
-
-    Serial.println();
-    Serial.println("╔═══════════════════════════════════════════════════════════════╗");
-    Serial.println("║              SOAK TEST - HOURLY STATUS                        ║");
-    Serial.println("╠═══════════════════════════════════════════════════════════════╣");
-    Serial.printf("║ Uptime: %-50s  ║\n", formatUptime(now).c_str());
-    Serial.printf("║ Boot Count: %-5lu    Free Heap: %-10lu bytes            ║\n",
-                  (unsigned long)bootCount, (unsigned long)getFreeHeap());
-    Serial.println("╠═══════════════════════════════════════════════════════════════╣");
-    Serial.printf("║ Beacons Sent: %-8lu   Skipped (low bat): %-8lu         ║\n",
-                  (unsigned long)soakBeaconsSent, (unsigned long)soakBeaconsSkipped);
-    Serial.printf("║ Commands OK: %-9lu  Failed: %-8lu                     ║\n",
-                  (unsigned long)soakCommandsReceived, (unsigned long)soakCommandsFailed);
-    Serial.printf("║ TX Errors: %-11lu  RX Errors: %-8lu                   ║\n",
-                  (unsigned long)soakTxErrors, (unsigned long)soakRxErrors);
-    Serial.printf("║ Radio Resets: %-8lu                                        ║\n",
-                  (unsigned long)soakRadioResets);
-    Serial.println("╠═══════════════════════════════════════════════════════════════╣");
-    Serial.printf("║ Battery: %.2fV   Temp: %.1fC   Contact: %-3s               ║\n",
-                  VT, Tc, groundContactEstablished ? "YES" : "NO");
-    Serial.printf("║ IMU: %-4s  SD: %-4s  RF: %-4s                                ║\n",
-                  IMUOK ? "OK" : "FAIL", SDOK ? "OK" : "FAIL", RFOK ? "OK" : "FAIL");
-    Serial.println("╚═══════════════════════════════════════════════════════════════╝");
-    Serial.println();
+    char uptime[32];
+    formatUptime(uptime, sizeof(uptime), now);
+
+    LOG_TEXT_D("");
+    LOG_TEXT_D("╔═══════════════════════════════════════════════════════════════╗");
+    LOG_TEXT_D("║              SOAK TEST - HOURLY STATUS                        ║");
+    LOG_TEXT_D("╠═══════════════════════════════════════════════════════════════╣");
+    LOG_TEXT_D("║ Uptime: %-50s  ║", uptime);
+    LOG_TEXT_D("║ Boot Count: %-5lu    Free Heap: %-10lu bytes            ║",
+               (unsigned long)bootCount, (unsigned long)getFreeHeap());
+    LOG_TEXT_D("║ Largest Block: %-8lu  Min Free: %-8lu bytes          ║",
+               (unsigned long)getLargestFreeBlock(), (unsigned long)getMinFreeHeap());
+    LOG_TEXT_D("╠═══════════════════════════════════════════════════════════════╣");
+    LOG_TEXT_D("║ Beacons Sent: %-8lu   Skipped (low bat): %-8lu         ║",
+               (unsigned long)soakBeaconsSent, (unsigned long)soakBeaconsSkipped);
+    LOG_TEXT_D("║ Commands OK: %-9lu  Failed: %-8lu                     ║",
+               (unsigned long)soakCommandsReceived, (unsigned long)soakCommandsFailed);
+    LOG_TEXT_D("║ TX Errors: %-11lu  RX Errors: %-8lu                   ║",
+               (unsigned long)soakTxErrors, (unsigned long)soakRxErrors);
+    LOG_TEXT_D("║ Radio Resets: %-8lu                                        ║",
+               (unsigned long)soakRadioResets);
+    LOG_TEXT_D("║ TX->RX Turnaround: last %-8lu us  max %-8lu us          ║",
+               (unsigned long)radioLastTurnaroundUs, (unsigned long)radioMaxTurnaroundUs);
+    LOG_TEXT_D("║ TX Queue: depth %-3u  max %-3u  dropped %-8lu               ║",
+               (unsigned)txQueueDepth(), (unsigned)txQueueMaxDepth(), (unsigned long)txQueueDrops());
+    LOG_TEXT_D("║ RX Queue: depth %-3u  max %-3u  dropped %-8lu               ║",
+               (unsigned)rxQueueDepth(), (unsigned)rxQueueMaxDepth(), (unsigned long)rxQueueDrops());
+    LOG_TEXT_D("║ Log Ring: depth %-5u  dropped %-8lu                      ║",
+               (unsigned)logRingDepth(), (unsigned long)logRingDrops());
+    uint16_t slp = sleepPermille();
+    LOG_TEXT_D("║ Sleep: %3u.%u%%  sleeps: %-10lu  radio wakes: %-8lu     ║",
+               (unsigned)(slp / 10), (unsigned)(slp % 10),
+               (unsigned long)sleepCount(), (unsigned long)sleepRadioWakes());
+    LOG_TEXT_D("╠═══════════════════════════════════════════════════════════════╣");
+    LOG_TEXT_D("║ Battery: %.2fV   Temp: %.1fC   Contact: %-3s               ║",
+               VT, Tc, groundContactEstablished ? "YES" : "NO");
+    LOG_TEXT_D("║ IMU: %-4s  SD: %-4s  RF: %-4s                                ║",
+               IMUOK ? "OK" : "FAIL", SDOK ? "OK" : "FAIL", RFOK ? "OK" : "FAIL");
+    LOG_TEXT_D("║ IMU reads: %-10lu  errors: %-6lu  max %-8lu us      ║",
+               (unsigned long)imuReadCount(), (unsigned long)imuErrorCount(),
+               (unsigned long)imuMaxLatencyUs());
+    LOG_TEXT_D("╚═══════════════════════════════════════════════════════════════╝");
+    LOG_TEXT_D("");
+
+    // Latency histograms since boot (us)
+    for (int p = 0; p < PERF_PROBE_COUNT; p++) {
+        PerfStats ps;
+        if (perfStats((PerfProbe)p, ps)) {
+            LOG_D("PERF", "%-5s n=%lu min=%lu mean=%lu p50=%lu p99=%lu max=%lu",
+                  perfProbeName((PerfProbe)p), (unsigned long)ps.count,
+                  (unsigned long)ps.minUs, (unsigned long)ps.meanUs, (unsigned long)ps.p50Us,
+                  (unsigned long)ps.p99Us, (unsigned long)ps.maxUs);
+        }
+    }
+    char perfLine[PERF_SUMMARY_MAX];
+    perfSummary(perfLine, sizeof(perfLine));
 
     // Log to SD card for persistence
     if (SDOK) {
-        char logEntry[256];
+        char logEntry[352];
         snprintf(logEntry, sizeof(logEntry),
-                 "HOURLY|UP:%s|BOOT:%lu|HEAP:%lu|BCN:%lu|SKIP:%lu|CMD:%lu|FAIL:%lu|TX_ERR:%lu|RX_ERR:%lu|RST:%lu|BAT:%.2f|TEMP:%.1f",
-                 formatUptime(now).c_str(),
+                 "HOURLY|UP:%s|BOOT:%lu|HEAP:%lu/%lu/%lu|BCN:%lu|SKIP:%lu|CMD:%lu|FAIL:%lu|TX_ERR:%lu|RX_ERR:%lu|RST:%lu|TRN:%lu/%lu|TXQ:%u|TXDROP:%lu|RXQ:%u|RXDROP:%lu|LOGDROP:%lu|UARTDROP:%lu|SLP:%u.%u%%|WAKE:%lu/%lu|IMU:%lu/%lu/%lu|BAT:%.2f|TEMP:%.1f",
+                 uptime,
                  (unsigned long)bootCount,
                  (unsigned long)getFreeHeap(),
+                 (unsigned long)getLargestFreeBlock(),
+                 (unsigned long)getMinFreeHeap(),
                  (unsigned long)soakBeaconsSent,
                  (unsigned long)soakBeaconsSkipped,
                  (unsigned long)soakCommandsReceived,
@@ -393,8 +496,23 @@ void soakLogHourly() {
                  (unsigned long)soakTxErrors,
                  (unsigned long)soakRxErrors,
                  (unsigned long)soakRadioResets,
+                 (unsigned long)radioLastTurnaroundUs,
+                 (unsigned long)radioMaxTurnaroundUs,
+                 (unsigned)txQueueMaxDepth(),
+                 (unsigned long)txQueueDrops(),
+                 (unsigned)rxQueueMaxDepth(),
+                 (unsigned long)rxQueueDrops(),
+                 (unsigned long)logRingDrops(),
+                 (unsigned long)logUartDrops(),
+                 (unsigned)(slp / 10), (unsigned)(slp % 10),
+                 (unsigned long)sleepRadioWakes(),
+                 (unsigned long)sleepCount(),
+                 (unsigned long)imuReadCount(),
+                 (unsigned long)imuErrorCount(),
+                 (unsigned long)imuMaxLatencyUs(),
                  VT, Tc);
         logToSD(logEntry);
+        logToSD(perfLine);
     }
 }
 
@@ -402,65 +520,75 @@ void soakLogHourly() {
 void soakLogDaily() {
     unsigned long now = millis();
     unsigned long uptimeDays = now / 86400000UL;
-
-    Serial.println();
-    Serial.println("╔═══════════════════════════════════════════════════════════════╗");
-    Serial.println("║         *** SOAK TEST - DAILY SUMMARY ***                     ║");
-    Serial.printf("║                    DAY %lu COMPLETE                             ║\n", uptimeDays);
-    Serial.println("╠═══════════════════════════════════════════════════════════════╣");
-    Serial.printf("║ Total Uptime: %-48s  ║\n", formatUptime(now).c_str());
-    Serial.printf("║ Boot Count: %-5lu (should be 1 for clean test)                ║\n",
-                  (unsigned long)bootCount);
-    Serial.printf("║ Free Heap: %-10lu bytes                                    ║\n",
-                  (unsigned long)getFreeHeap());
-    Serial.println("╠═══════════════════════════════════════════════════════════════╣");
-    Serial.println("║ COMMUNICATION STATS:                                          ║");
-    Serial.printf("║   Beacons Sent: %-10lu                                     ║\n",
-                  (unsigned long)soakBeaconsSent);
-    Serial.printf("║   Beacons Skipped: %-7lu (low battery)                      ║\n",
-                  (unsigned long)soakBeaconsSkipped);
-    Serial.printf("║   Commands Received: %-5lu                                   ║\n",
-                  (unsigned long)soakCommandsReceived);
-    Serial.printf("║   Commands Failed: %-7lu                                    ║\n",
-                  (unsigned long)soakCommandsFailed);
-    Serial.println("╠═══════════════════════════════════════════════════════════════╣");
-    Serial.println("║ ERROR COUNTS:                                                 ║");
-    Serial.printf("║   TX Errors: %-10lu                                        ║\n",
-                  (unsigned long)soakTxErrors);
-    Serial.printf("║   RX Errors: %-10lu                                        ║\n",
-                  (unsigned long)soakRxErrors);
-    Serial.printf("║   Radio Resets: %-7lu                                       ║\n",
-                  (unsigned long)soakRadioResets);
-    Serial.println("╠═══════════════════════════════════════════════════════════════╣");
-    Serial.printf("║ HEALTH: Battery=%.2fV Temp=%.1fC                            ║\n", VT, Tc);
+    char uptime[32];
+    formatUptime(uptime, sizeof(uptime), now);
+
+    LOG_TEXT_D("");
+    LOG_TEXT_D("╔═══════════════════════════════════════════════════════════════╗");
+    LOG_TEXT_D("║         *** SOAK TEST - DAILY SUMMARY ***                     ║");
+    LOG_TEXT_D("║                    DAY %lu COMPLETE                             ║", uptimeDays);
+    LOG_TEXT_D("╠═══════════════════════════════════════════════════════════════╣");
+    LOG_TEXT_D("║ Total Uptime: %-48s  ║", uptime);
+    LOG_TEXT_D("║ Boot Count: %-5lu (should be 1 for clean test)                ║",
+               (unsigned long)bootCount);
+    LOG_TEXT_D("║ Free Heap: %-10lu bytes                                    ║",
+               (unsigned long)getFreeHeap());
+    LOG_TEXT_D("║ Largest Free Block: %-8lu  Min Free Ever: %-8lu        ║",
+               (unsigned long)getLargestFreeBlock(), (unsigned long)getMinFreeHeap());
+    LOG_TEXT_D("╠═══════════════════════════════════════════════════════════════╣");
+    LOG_TEXT_D("║ COMMUNICATION STATS:                                          ║");
+    LOG_TEXT_D("║   Beacons Sent: %-10lu                                     ║",
+               (unsigned long)soakBeaconsSent);
+    LOG_TEXT_D("║   Beacons Skipped: %-7lu (low battery)                      ║",
+               (unsigned long)soakBeaconsSkipped);
+    LOG_TEXT_D("║   Commands Received: %-5lu                                   ║",
+               (unsigned long)soakCommandsReceived);
+    LOG_TEXT_D("║   Commands Failed: %-7lu                                    ║",
+               (unsigned long)soakCommandsFailed);
+    LOG_TEXT_D("╠═══════════════════════════════════════════════════════════════╣");
+    LOG_TEXT_D("║ ERROR COUNTS:                                                 ║");
+    LOG_TEXT_D("║   TX Errors: %-10lu                                        ║",
+               (unsigned long)soakTxErrors);
+    LOG_TEXT_D("║   RX Errors: %-10lu                                        ║",
+               (unsigned long)soakRxErrors);
+    LOG_TEXT_D("║   RX Drops (queue full): %-7lu                              ║",
+               (unsigned long)rxQueueDrops());
+    LOG_TEXT_D("║   Radio Resets: %-7lu                                       ║",
+               (unsigned long)soakRadioResets);
+    LOG_TEXT_D("╠═══════════════════════════════════════════════════════════════╣");
+    LOG_TEXT_D("║ HEALTH: Battery=%.2fV Temp=%.1fC                            ║", VT, Tc);
 
     // Health assessment
     bool healthy = (bootCount == 1) &&
                    (soakCommandsFailed == 0) &&
                    (soakTxErrors < 10) &&
                    (soakRxErrors < 10) &&
-                   (getFreeHeap() > 50000);
+                   (getFreeHeap() > 50000) &&
+                   (getLargestFreeBlock() > HEAP_MIN_LARGEST_BLOCK);
 
-    Serial.printf("║ STATUS: %s                                             ║\n",
-                  healthy ? "HEALTHY ✓" : "CHECK REQUIRED !");
-    Serial.println("╚═══════════════════════════════════════════════════════════════╝");
-    Serial.println();
+    LOG_TEXT_D("║ STATUS: %s                                             ║",
+               healthy ? "HEALTHY ✓" : "CHECK REQUIRED !");
+    LOG_TEXT_D("╚═══════════════════════════════════════════════════════════════╝");
+    LOG_TEXT_D("");
 
     // Log to SD card
     if (SDOK) {
-        char logEntry[300];
+        char logEntry[320];
         snprintf(logEntry, sizeof(logEntry),
-                 "DAILY|DAY:%lu|UP:%s|BOOT:%lu|HEAP:%lu|BCN:%lu|SKIP:%lu|CMD:%lu|FAIL:%lu|TX_ERR:%lu|RX_ERR:%lu|RST:%lu|BAT:%.2f|TEMP:%.1f|STATUS:%s",
+                 "DAILY|DAY:%lu|UP:%s|BOOT:%lu|HEAP:%lu/%lu/%lu|BCN:%lu|SKIP:%lu|CMD:%lu|FAIL:%lu|TX_ERR:%lu|RX_ERR:%lu|RX_DROP:%lu|RST:%lu|BAT:%.2f|TEMP:%.1f|STATUS:%s",
                  uptimeDays,
-                 formatUptime(now).c_str(),
+                 uptime,
                  (unsigned long)bootCount,
                  (unsigned long)getFreeHeap(),
+                 (unsigned long)getLargestFreeBlock(),
+                 (unsigned long)getMinFreeHeap(),
                  (unsigned long)soakBeaconsSent,
                  (unsigned long)soakBeaconsSkipped,
                  (unsigned long)soakCommandsReceived,
                  (unsigned long)soakCommandsFailed,
                  (unsigned long)soakTxErrors,
                  (unsigned long)soakRxErrors,
+                 (unsigned long)rxQueueDrops(),
                  (unsigned long)soakRadioResets,
                  VT, Tc,
                  healthy ? "HEALTHY" : "CHECK");
@@ -12,6 +12,8 @@
  * - Centralized LoRa configuration (sync word consistency)
  * - Added SD card status tracking
  * - Added mission elapsed time tracking
+ * - Mission-critical globals are const references into the TMR region
+ * - State saves append to a flash journal partition instead of an EEPROM commit
  */
 
 #include <Arduino.h>
@@ -42,7 +44,11 @@
 #include <EEPROM.h>
 
 // HMAC for authentication
-#include "mbedtls/md.h"
+#include "mbedtls/version.h"
+#include "mbedtls/sha256.h"
+
+// TMR region (protected globals below are const references into it)
+#include "tmr.h"
 
 // Radiation protection (forward declaration - full include in .cpp files)
 // See radiation.h for TMR and CRC functions
@@ -78,6 +84,18 @@
 #define LORA_SYNC_WORD    0x12      // Sync word - MUST BE SAME FOR RX AND TX
 #define LORA_PREAMBLE     8         // Preamble length
 
+// Outbound packet queue (drained by radioTxTick() in mainLoop())
+#define TX_MAX_PACKET        255    // SX1276 FIFO limit (bytes)
+#define TX_QUEUE_SLOTS       16     // Packets that can wait for the radio
+#define TX_QUEUE_BULK_SLOTS  8      // Slots bulk downlinks may occupy at once
+#define TX_FLUSH_TIMEOUT     5000UL // Max wait to drain the queue before restart (ms)
+
+// Inbound packet queue (filled by the RX task, drained by mainLoop())
+#define RX_QUEUE_SLOTS       4      // Uplinks waiting for processMessage() (power of two)
+#define RX_TASK_STACK        3072
+#define RX_TASK_PRIORITY     3      // Above loop() (1): preempts long handlers
+#define RX_TASK_CORE         1      // Same core as the radio callers in loop()
+
 // ==================== WATCHDOG CONFIGURATION ====================
 
 #define WDT_TIMEOUT_SECONDS  60     // Watchdog timeout in seconds
@@ -126,12 +144,45 @@ extern const uint8_t HMAC_KEY[HMAC_KEY_LENGTH];
 #define DEPLOY_MAX_RETRIES     3          // Maximum deployment attempts
 
 #define STATUS_INTERVAL        60000UL    // Send status every 60 seconds in operational mode
+
+// ==================== TELEMETRY FORMAT ====================
+// Binary frame (little-endian, fixed layout - see buildBinaryTelemetry()):
+//   [0]  TELEM_FRAME_TYPE   [1]  TELEM_VERSION
+//   [2]  mission time (s, u32)          [6]  boot count (u32)
+//   [10] status flags (u8)              [11] SD free % (u8, 0xFF = n/a)
+//   [12] battery (mV, u16)              [14] temperature (0.01 C, i16)
+//   [16] lux (0.1 lx, u32)
+//   [20] gyro x,y,z (0.1 dps, i16)      [26] accel x,y,z (mg, i16)
+//   [32] mag x,y,z (mgauss, i16)        [38] SEU corrections (u32)
+//   [42] time asleep since boot (permille of uptime, u16)
+//   [44] largest free heap block (16-byte units, u16)
+//   [46] minimum free heap since boot (16-byte units, u16)
+//   [48] CRC32 of bytes 0-47 (u32)
+// Version 1 frames were 46 bytes: no sleep field, CRC at [42]
+// Version 2 frames were 48 bytes: no heap fields, CRC at [44]
+typedef enum {
+    TELEM_FORMAT_TEXT,           // Legacy "T+..|IMU:OK,..|BAT:..." string
+    TELEM_FORMAT_BINARY          // Fixed-layout binary frame
+} TelemetryFormat;
+
+#define TELEM_FORMAT_DEFAULT   TELEM_FORMAT_BINARY
+#define TELEM_FRAME_TYPE       0xC7       // First byte >= 0x80: never ASCII text
+#define TELEM_VERSION          3
+#define TELEM_BINARY_SIZE      52
+
+// Status flag bits (byte 10)
+#define TELEM_FLAG_IMU         0x01
+#define TELEM_FLAG_SD          0x02
+#define TELEM_FLAG_RF          0x04
+#define TELEM_FLAG_CONTACT     0x08
+#define TELEM_FLAG_IMU_DATA    0x10       // Gyro/accel/mag fields are valid
 #define WDT_FEED_INTERVAL      10000UL    // Feed watchdog every 10 seconds
 
 // ==================== SOAK TEST LOGGING ====================
 // Comprehensive logging for 7-day endurance test debugging
 #define SOAK_LOG_INTERVAL      3600000UL  // Log to SD every 1 hour (3,600,000 ms)
 #define SOAK_DAILY_INTERVAL    86400000UL // Daily summary every 24 hours
+#define HEAP_MIN_LARGEST_BLOCK 32768      // Daily health check: below this the heap is fragmented
 
 // ==================== BEACON CONFIGURATION ====================
 // Adaptive beacon timing based on ground station contact status
@@ -192,6 +243,16 @@ extern const uint8_t HMAC_KEY[HMAC_KEY_LENGTH];
 // Accelerometer module (address 200)
 #define EEPROM_ADDR_FIRST_ACCEL  200        // 1 byte (0xAA = first recording done)
 
+// ==================== STATE JOURNAL CONFIGURATION ====================
+// saveState() appends a record to this partition (journal.h): one 64-byte
+// program instead of an EEPROM commit, which rewrites a whole sector. The
+// EEPROM block above stays as the fallback when the partition is missing,
+// and the first boot after an upgrade seeds the journal from it.
+
+#define JOURNAL_PARTITION_LABEL   "journal"
+#define JOURNAL_PARTITION_SUBTYPE 0x40      // Custom data subtype (partitions.csv)
+#define JOURNAL_PREPARE_INTERVAL  60000UL   // Idle erase of the next sector (ms)
+
 // ==================== SD CARD CONFIGURATION ====================
 
 #define SD_SCK  18
@@ -210,31 +271,42 @@ extern volatile bool receivedFlag;
 extern String MsR;
 
 // --- State Machine ---
-extern MissionState currentState;
-extern AntennaState antennaState;
+// const& : TMR-protected, write with tmrWrite() (tmr.h)
+extern const MissionState& currentState;
+extern const AntennaState& antennaState;
 extern unsigned long stateStartTime;
 extern unsigned long lastWdtFeed;
-extern unsigned long missionStartTime;
-extern uint32_t bootCount;
+extern const unsigned long& missionStartTime;
+extern const uint32_t& bootCount;
 
 // --- Antenna Deployment ---
-extern int deployRetryCount;
-extern bool antennaDeployed;
+extern const int& deployRetryCount;
+extern const bool& antennaDeployed;
 
 // --- Beacon System ---
-extern bool groundContactEstablished;     // True after first successful command received
-extern unsigned long lastGroundContact;    // Time of last command from ground station
-extern unsigned long lastBeaconTime;       // Time of last beacon transmission
+extern const bool& groundContactEstablished;     // True after first successful command received
+extern const unsigned long& lastGroundContact;    // Time of last command from ground station
+extern const unsigned long& lastBeaconTime;       // Time of last beacon transmission
+extern uint32_t groundContactsTotal;              // Commands received, all boots (persisted)
+extern uint32_t lastContactBoot;                  // Boot of the last contact (persisted)
+extern uint32_t lastContactSecs;                  // Uptime at the last contact, s (persisted)
+
+// --- Telemetry ---
+extern const TelemetryFormat& telemetryFormat;   // Selected with SetTelemetryFormat
 
 // --- Hardware Status Flags ---
-extern bool IMUOK;
-extern bool RFOK;
-extern bool SDOK;
+extern const bool& IMUOK;
+extern const bool& RFOK;
+extern const bool& SDOK;
 
 // --- LoRa retry counters ---
 extern int contE;  // Transmit retry counter
 extern int contR;  // Receive retry counter
 
+// --- LoRa TX->RX turnaround (measured per packet in returnToReceive()) ---
+extern uint32_t radioLastTurnaroundUs;  // Last TX-end to RX-armed time (us)
+extern uint32_t radioMaxTurnaroundUs;   // Worst turnaround since boot (us)
+
 // --- Soak Test Counters (for 7-day test debugging) ---
 extern uint32_t soakBeaconsSent;       // Total beacons sent this session
 extern uint32_t soakBeaconsSkipped;    // Beacons skipped (low battery)
@@ -253,12 +325,6 @@ extern float VE;
 extern float VT;
 
 // --- Sensors: Temperature ---
-extern double adcMax;
-extern double Vs;
-extern double R1z;
-extern double Beta;
-extern double To;
-extern double Ro;
 extern double Tc;
 
 // --- Sensors: Luminosity ---
@@ -281,7 +347,9 @@ void saveState();
 // Note: State loading is handled by initRadiationProtection() in radiation.cpp
 
 // Authentication
+void initHMAC();  // Precompute keyed SHA-256 states (once at boot)
 bool verifyHMAC(const String& message, const String& receivedHMAC);
+bool verifyHMAC(const uint8_t* message, size_t length, const char* receivedHMAC, size_t hmacLength);
 String calculateHMAC(const String& message);
 
 // Beacon system
@@ -289,9 +357,14 @@ void sendBeacon();
 unsigned long getBeaconInterval();
 void registerGroundContact();
 
-// Soak test logging (7-day test)
-void soakTestTick();
+// Soak test logging (7-day test) - run by mainLoop() scheduler jobs
 void soakLogHourly();
 void soakLogDaily();
 
+// Heap health: total free alone hides fragmentation, the largest free
+// block shows it (a reply needing more than that fails to allocate)
+uint32_t getFreeHeap();
+uint32_t getLargestFreeBlock();
+uint32_t getMinFreeHeap();      // Low-water mark since boot
+
 #endif // CONFIG_H
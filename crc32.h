@@ -0,0 +1,60 @@
+#ifndef CRC32_H
+#define CRC32_H
+
+/*
+ * Orbital Temple Satellite - CRC32 Engine
+ * Version: 1.21
+ *
+ * Standard CRC-32 (IEEE 802.3 / zlib, reflected poly 0xEDB88320) with an
+ * incremental interface for data that arrives in chunks (SD files, radio
+ * frames):
+ *
+ *   uint32_t crc = crc32Begin();
+ *   crc = crc32Update(crc, chunk, n);   // repeat per chunk
+ *   uint32_t result = crc32Final(crc);
+ *
+ * BACKENDS:
+ *    - ESP32: the mask ROM crc32_le(), checked against the table at init
+ *    - Host:  slicing-by-8 (eight bytes per step, 8 KB of tables)
+ *    - Both:  byte-at-a-time table, the reference and the fallback
+ *
+ * Host-portable: no Arduino dependencies, so the test suite compiles it
+ * directly (test/test_crc32.cpp).
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#if defined(ARDUINO_ARCH_ESP32)
+#define CRC32_HAVE_ROM 1
+#else
+#define CRC32_HAVE_ROM 0
+#endif
+
+// Select the fastest backend that matches the reference table
+// Call once at boot, before any CRC is computed from another task
+void crc32Init();
+
+// Name of the selected backend ("rom", "slice8" or "table")
+const char* crc32BackendName();
+
+// Incremental API (the running value is the raw, uninverted register)
+static inline uint32_t crc32Begin() { return 0xFFFFFFFFu; }
+uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t length);
+static inline uint32_t crc32Final(uint32_t crc) { return crc ^ 0xFFFFFFFFu; }
+
+// ==================== INDIVIDUAL BACKENDS ====================
+// Same contract as crc32Update(); exposed for the self-test and benchmarks
+
+uint32_t crc32UpdateTable(uint32_t crc, const uint8_t* data, size_t length);
+#if CRC32_HAVE_ROM
+uint32_t crc32UpdateROM(uint32_t crc, const uint8_t* data, size_t length);
+#else
+uint32_t crc32UpdateSlice8(uint32_t crc, const uint8_t* data, size_t length);
+#endif
+
+// V1.21 table with its three wrong entries; only for accepting EEPROM
+// blocks saved by older firmware
+uint32_t crc32UpdateLegacy(uint32_t crc, const uint8_t* data, size_t length);
+
+#endif // CRC32_H
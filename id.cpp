@@ -11,12 +11,12 @@
 
 #include <Arduino.h>
 #include "config.h"
+#include "log.h"
 
 void getId() {
     // Satellite ID - unique identifier for this satellite
     // This is used as part of the message addressing
     sat_id = "ab4ec7121663a28e7226dbaa238da777";
 
-    Serial.print("[ID] Satellite ID: ");
-    Serial.println(sat_id);
+    LOG_I("ID", "Satellite ID: %s", sat_id.c_str());
 }
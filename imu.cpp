@@ -0,0 +1,226 @@
+/*
+ * Orbital Temple Satellite - IMU Service Implementation
+ * Version: 1.21
+ *
+ * The SparkFun driver reads each sensor with its own status poll and
+ * transaction; telemetry used three of those sequences behind a 100 ms
+ * Wire timeout. Here the AG device's gyro and accel output registers are
+ * fetched in one auto-incrementing read (0x18-0x2D, the control and
+ * status registers in between are read and ignored), the magnetometer in
+ * a second one (multi-byte reads need the sub-address MSB set).
+ *
+ * The sample is double-buffered: a read fills the back buffer and then
+ * flips the index, so a reader always copies a complete sample.
+ */
+
+#include <Arduino.h>
+#include "config.h"
+#include "log.h"
+#include "imu.h"
+#include "radiation.h"
+#include "scheduler.h"
+
+// LSM9DS1 registers
+#define AG_OUT_X_L_G      0x18    // Gyro XYZ, ... , accel XYZ at +16
+#define AG_BURST_LEN      22      // 0x18-0x2D
+#define AG_ACCEL_OFFSET   16      // OUT_X_L_XL (0x28) - OUT_X_L_G
+#define AG_OUT_X_L_XL     0x28
+#define AG_FIFO_SRC       0x2F    // [5:0] unread FIFO entries
+#define M_OUT_X_L         0x28
+#define M_AUTO_INC        0x80
+
+static ImuSample imuBuf[2];
+static volatile uint8_t imuFront = 0;
+
+static SchedJob imuJob = SCHED_NONE;
+static bool imuHealthy = false;
+static bool imuCapture = false;
+static uint8_t imuFailures = 0;
+
+static uint32_t imuReads = 0;
+static uint32_t imuErrors = 0;
+static uint32_t imuLastUs = 0;
+static uint32_t imuMaxUs = 0;
+
+static inline int16_t le16(const uint8_t *p) {
+    return (int16_t)((uint16_t)p[0] | ((uint16_t)p[1] << 8));
+}
+
+// Back buffer, seeded with the current sample
+static ImuSample &imuBack() {
+    ImuSample &back = imuBuf[imuFront ^ 1];
+    back = imuBuf[imuFront];
+    return back;
+}
+
+static void imuPublish() {
+    __sync_synchronize();  // Sample complete before readers can see it
+    imuFront ^= 1;
+}
+
+static void imuConfigureBus() {
+    Wire.setClock(IMU_I2C_CLOCK);
+    Wire.setTimeOut(IMU_I2C_TIMEOUT_MS);
+}
+
+static void imuSetHealthy(bool healthy, unsigned long now) {
+    imuHealthy = healthy;
+    imuFailures = 0;
+    tmrWrite(IMUOK, healthy);
+    schedSetPeriod(imuJob, healthy ? IMU_POLL_INTERVAL : IMU_RETRY_INTERVAL);
+    schedAfter(imuJob, healthy ? IMU_POLL_INTERVAL : IMU_RETRY_INTERVAL, now);
+}
+
+// One timed register read; IMU_MAX_FAILURES in a row take the service down
+static bool imuBurstRead(uint8_t addr, uint8_t reg, uint8_t *dest, uint8_t count) {
+    unsigned long start = micros();
+
+    Wire.beginTransmission(addr);
+    Wire.write(reg);
+    bool ok = Wire.endTransmission(false) == 0 &&
+              Wire.requestFrom(addr, count) == count;
+    if (ok) {
+        for (uint8_t i = 0; i < count; i++) {
+            dest[i] = (uint8_t)Wire.read();
+        }
+    }
+
+    imuLastUs = micros() - start;
+    if (imuLastUs > imuMaxUs) imuMaxUs = imuLastUs;
+
+    if (ok) {
+        imuReads++;
+        imuFailures = 0;
+        return true;
+    }
+
+    imuErrors++;
+    if (++imuFailures >= IMU_MAX_FAILURES && imuHealthy) {
+        LOG_E("IMU", "ERROR: %d failed reads in a row (last %lu us), giving up",
+              IMU_MAX_FAILURES, (unsigned long)imuLastUs);
+        imuSetHealthy(false, millis());
+    }
+    return false;
+}
+
+// Restart the bus and the sensor (not during a capture: begin() would
+// drop the FIFO configuration accel.cpp set up)
+static void imuRecover(unsigned long now) {
+    if (imuCapture) return;
+
+    LOG_W("IMU", "Restarting I2C bus...");
+    Wire.end();
+    Wire.begin();
+    imuConfigureBus();
+
+    if (imu.begin()) {
+        LOG_I("IMU", "LSM9DS1 answering again");
+        imuSetHealthy(true, now);
+    } else {
+        LOG_W("IMU", "Still not answering, next try in %lu s", IMU_RETRY_INTERVAL / 1000);
+    }
+}
+
+static void imuJobTick(unsigned long now) {
+    if (!imuHealthy) {
+        imuRecover(now);
+        return;
+    }
+
+    ImuSample &s = imuBack();
+    bool updated = false;
+    uint8_t b[AG_BURST_LEN];
+
+    if (!imuCapture && imuBurstRead(IMU_AG_ADDR, AG_OUT_X_L_G, b, AG_BURST_LEN)) {
+        for (int i = 0; i < 3; i++) {
+            s.gyro[i] = le16(b + 2 * i);
+            s.accel[i] = le16(b + AG_ACCEL_OFFSET + 2 * i);
+        }
+        s.gyroTime = s.accelTime = now;
+        s.valid |= IMU_HAS_GYRO | IMU_HAS_ACCEL;
+        updated = true;
+    }
+
+    if (imuHealthy && imuBurstRead(IMU_M_ADDR, M_OUT_X_L | M_AUTO_INC, b, 6)) {
+        for (int i = 0; i < 3; i++) {
+            s.mag[i] = le16(b + 2 * i);
+        }
+        s.magTime = now;
+        s.valid |= IMU_HAS_MAG;
+        updated = true;
+    }
+
+    if (updated) imuPublish();
+}
+
+void imuServiceStart() {
+    imuConfigureBus();
+
+    if (imuJob == SCHED_NONE) {
+        imuJob = schedRegister("imu", imuJobTick, IMU_POLL_INTERVAL);
+    }
+    imuSetHealthy(IMUOK, millis());
+
+    LOG_I("IMU", "Service %s: %lu kHz, read every %lu ms",
+          imuHealthy ? "running" : "waiting for the sensor",
+          IMU_I2C_CLOCK / 1000, IMU_POLL_INTERVAL);
+}
+
+bool imuLatest(ImuSample &out) {
+    out = imuBuf[imuFront];
+    return out.valid != 0;
+}
+
+void imuSetCaptureMode(bool capture) {
+    imuCapture = capture;
+}
+
+uint8_t imuReadAccelFifo(int16_t (*xyz)[3], uint8_t max, uint8_t *available) {
+    *available = 0;
+    if (!imuHealthy) return 0;
+
+    uint8_t src;
+    if (!imuBurstRead(IMU_AG_ADDR, AG_FIFO_SRC, &src, 1)) return 0;
+    *available = src & 0x3F;
+
+    uint8_t count = *available < max ? *available : max;
+    uint8_t popped = 0;
+    uint8_t b[6];
+    while (popped < count && imuBurstRead(IMU_AG_ADDR, AG_OUT_X_L_XL, b, 6)) {
+        for (int i = 0; i < 3; i++) {
+            xyz[popped][i] = le16(b + 2 * i);
+        }
+        popped++;
+    }
+
+    if (popped > 0) {
+        ImuSample &s = imuBack();
+        for (int i = 0; i < 3; i++) {
+            s.accel[i] = xyz[popped - 1][i];
+        }
+        s.accelTime = millis();
+        s.valid |= IMU_HAS_ACCEL;
+        imuPublish();
+    }
+    return popped;
+}
+
+uint32_t imuReadCount() {
+    return imuReads;
+}
+
+uint32_t imuErrorCount() {
+    return imuErrors;
+}
+
+uint32_t imuLastLatencyUs() {
+    return imuLastUs;
+}
+
+uint32_t imuMaxLatencyUs() {
+    return imuMaxUs;
+}
+
+bool imuServiceHealthy() {
+    return imuHealthy;
+}
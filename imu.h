@@ -0,0 +1,72 @@
+#ifndef IMU_H
+#define IMU_H
+
+/*
+ * Orbital Temple Satellite - IMU Service
+ * Version: 1.21
+ *
+ * Sole reader of the LSM9DS1 output registers. A scheduler job reads all
+ * axes every IMU_POLL_INTERVAL in two burst I2C transactions at 400 kHz
+ * (gyro + accel in one 22-byte read from the AG device, mag in one 6-byte
+ * read) into a double-buffered, timestamped sample. Telemetry and future
+ * consumers copy the latest sample (imuLatest()) without touching the bus.
+ *
+ * During an accelerometer capture the AG output registers belong to the
+ * FIFO: accel.cpp drains it through imuReadAccelFifo(), which also keeps
+ * the accel part of the latest sample current, and the job reads only the
+ * magnetometer.
+ *
+ * Every read is timed. IMU_MAX_FAILURES failed transactions in a row (a
+ * hung bus or a dead sensor) make the service give up: IMUOK goes false,
+ * reads stop, and every IMU_RETRY_INTERVAL the bus is restarted and the
+ * sensor re-initialised until it answers again.
+ */
+
+#include <stdint.h>
+
+#define IMU_AG_ADDR          0x6B     // Accel/gyro (SparkFun default)
+#define IMU_M_ADDR           0x1E     // Magnetometer
+#define IMU_I2C_CLOCK        400000UL // Fast mode
+#define IMU_I2C_TIMEOUT_MS   20       // A 22-byte read takes ~0.6 ms at 400 kHz
+#define IMU_POLL_INTERVAL    1000UL   // ms between full reads
+#define IMU_MAX_FAILURES     3        // Consecutive failed reads before giving up
+#define IMU_RETRY_INTERVAL   60000UL  // ms between recovery attempts
+
+// ImuSample.valid bits
+#define IMU_HAS_GYRO         0x01
+#define IMU_HAS_ACCEL        0x02
+#define IMU_HAS_MAG          0x04
+
+// Raw counts; scale with imu.calcGyro()/calcAccel()/calcMag()
+struct ImuSample {
+    int16_t gyro[3];
+    int16_t accel[3];
+    int16_t mag[3];
+    unsigned long gyroTime;     // millis() of each part's last read
+    unsigned long accelTime;
+    unsigned long magTime;
+    uint8_t valid;              // IMU_HAS_* for parts read at least once
+};
+
+// Configure the bus and register the polling job (after BeginIMU())
+void imuServiceStart();
+
+// Copy the newest sample; false if nothing has been read yet
+bool imuLatest(ImuSample &out);
+
+// Capture mode on/off (accel.cpp, around its FIFO configuration)
+void imuSetCaptureMode(bool capture);
+
+// Pop up to max accelerometer FIFO entries, oldest first (6-byte burst
+// read each). *available = entries the FIFO held (ACCEL_FIFO_DEPTH means
+// it overran). Returns the number popped, 0 on a bus error.
+uint8_t imuReadAccelFifo(int16_t (*xyz)[3], uint8_t max, uint8_t *available);
+
+// Statistics since boot
+uint32_t imuReadCount();         // Successful transactions
+uint32_t imuErrorCount();        // Failed transactions
+uint32_t imuLastLatencyUs();     // Duration of the last transaction
+uint32_t imuMaxLatencyUs();
+bool imuServiceHealthy();        // false after giving up, until recovered
+
+#endif // IMU_H
@@ -0,0 +1,166 @@
+/*
+ * Orbital Temple Satellite - State Journal Implementation
+ * Version: 1.21
+ */
+
+#include <string.h>
+#include "journal.h"
+#include "crc32.h"
+
+#define SLOT_CRC     56
+#define SLOT_COMMIT  60
+
+struct SlotHeader {
+    uint32_t seq;
+    uint16_t length;
+    uint16_t magic;
+};
+
+static_assert(sizeof(SlotHeader) == 8, "journal slot header layout");
+static_assert(8 + JOURNAL_PAYLOAD_MAX == SLOT_CRC, "journal slot layout");
+
+static uint32_t slotOffset(uint32_t sector, uint32_t slot) {
+    return sector * JOURNAL_SECTOR_SIZE + slot * JOURNAL_SLOT_SIZE;
+}
+
+static uint32_t slotCRC(const uint8_t* buf) {
+    return crc32Final(crc32Update(crc32Begin(), buf, SLOT_CRC));
+}
+
+static bool blank(const uint8_t* buf, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        if (buf[i] != 0xFF) return false;
+    }
+    return true;
+}
+
+static bool slotBlank(Journal& j, uint32_t offset) {
+    uint8_t buf[JOURNAL_SLOT_SIZE];
+    return j.flash->read(offset, buf, sizeof(buf)) && blank(buf, sizeof(buf));
+}
+
+static bool sectorBlank(Journal& j, uint32_t sector) {
+    for (uint32_t s = 0; s < JOURNAL_SLOTS; s++) {
+        if (!slotBlank(j, slotOffset(sector, s))) return false;
+    }
+    return true;
+}
+
+// Committed, intact record: header and payload copied out
+static bool slotValid(Journal& j, uint32_t offset, SlotHeader& hdr, uint8_t* buf) {
+    if (!j.flash->read(offset, buf, JOURNAL_SLOT_SIZE)) return false;
+
+    uint32_t crc, commit;
+    memcpy(&hdr, buf, sizeof(hdr));
+    memcpy(&crc, buf + SLOT_CRC, 4);
+    memcpy(&commit, buf + SLOT_COMMIT, 4);
+    return commit == 0 && hdr.magic == JOURNAL_MAGIC &&
+           hdr.length <= JOURNAL_PAYLOAD_MAX && crc == slotCRC(buf);
+}
+
+// ==================== OPEN / RECOVERY ====================
+
+bool journalOpen(Journal& j, const JournalFlash* flash) {
+    memset(&j, 0, sizeof(j));
+    j.flash = flash;
+    j.latest = -1;
+    if (flash == NULL || !flash->read || !flash->write || !flash->erase) return false;
+
+    j.sectors = flash->size / JOURNAL_SECTOR_SIZE;
+    if (j.sectors < 2) return false;
+
+    // Every committed slot is a candidate; the highest sequence number wins
+    uint8_t buf[JOURNAL_SLOT_SIZE];
+    for (uint32_t sector = 0; sector < j.sectors; sector++) {
+        for (uint32_t s = 0; s < JOURNAL_SLOTS; s++) {
+            SlotHeader hdr;
+            uint32_t offset = slotOffset(sector, s);
+            if (!slotValid(j, offset, hdr, buf)) continue;
+            j.records++;
+            if (j.latest < 0 || hdr.seq > j.seq) {
+                j.seq = hdr.seq;
+                j.latest = (int32_t)offset;
+            }
+        }
+    }
+
+    if (j.latest >= 0) {
+        // Append after the latest record, past any slot torn by a reset
+        j.sector = (uint32_t)j.latest / JOURNAL_SECTOR_SIZE;
+        j.slot = ((uint32_t)j.latest % JOURNAL_SECTOR_SIZE) / JOURNAL_SLOT_SIZE + 1;
+        while (j.slot < JOURNAL_SLOTS && !slotBlank(j, slotOffset(j.sector, j.slot))) {
+            j.slot++;
+        }
+    } else {
+        // Empty (or foreign data): the first append starts sector 0
+        j.sector = j.sectors - 1;
+        j.slot = JOURNAL_SLOTS;
+    }
+
+    j.nextBlank = sectorBlank(j, (j.sector + 1) % j.sectors);
+    return true;
+}
+
+size_t journalLatest(Journal& j, void* data, size_t maxLength) {
+    if (j.latest < 0) return 0;
+
+    SlotHeader hdr;
+    uint8_t buf[JOURNAL_SLOT_SIZE];
+    if (!slotValid(j, (uint32_t)j.latest, hdr, buf)) return 0;
+
+    size_t n = hdr.length < maxLength ? hdr.length : maxLength;
+    memcpy(data, buf + sizeof(hdr), n);
+    return n;
+}
+
+// ==================== APPEND ====================
+
+bool journalAppend(Journal& j, const void* data, size_t length) {
+    if (j.flash == NULL || length > JOURNAL_PAYLOAD_MAX) return false;
+
+    if (j.slot >= JOURNAL_SLOTS) {
+        uint32_t next = (j.sector + 1) % j.sectors;
+        if (!j.nextBlank && !sectorBlank(j, next)) {
+            if (!j.flash->erase(next * JOURNAL_SECTOR_SIZE)) return false;
+            j.erases++;
+        }
+        j.sector = next;
+        j.slot = 0;
+        j.nextBlank = false;    // journalPrepare() finds out
+    }
+
+    uint8_t buf[JOURNAL_SLOT_SIZE];
+    SlotHeader hdr;
+    hdr.seq = j.seq + 1;
+    hdr.length = (uint16_t)length;
+    hdr.magic = JOURNAL_MAGIC;
+    memset(buf, 0xFF, sizeof(buf));
+    memcpy(buf, &hdr, sizeof(hdr));
+    memcpy(buf + sizeof(hdr), data, length);
+    uint32_t crc = slotCRC(buf);
+    memcpy(buf + SLOT_CRC, &crc, 4);
+
+    // Body first, commit word last: the slot is invisible until both landed
+    uint32_t offset = slotOffset(j.sector, j.slot);
+    static const uint32_t commit = 0;
+    j.slot++;
+    if (!j.flash->write(offset, buf, SLOT_COMMIT)) return false;
+    if (!j.flash->write(offset + SLOT_COMMIT, &commit, 4)) return false;
+
+    j.seq = hdr.seq;
+    j.latest = (int32_t)offset;
+    return true;
+}
+
+bool journalPrepare(Journal& j) {
+    if (j.flash == NULL || j.nextBlank) return false;
+
+    uint32_t next = (j.sector + 1) % j.sectors;
+    if (sectorBlank(j, next)) {
+        j.nextBlank = true;
+        return false;
+    }
+    j.nextBlank = j.flash->erase(next * JOURNAL_SECTOR_SIZE);
+    j.erases++;
+    return true;
+}
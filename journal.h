@@ -0,0 +1,87 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+/*
+ * Orbital Temple Satellite - State Journal
+ * Version: 1.21
+ *
+ * Append-only log of small records on raw NOR flash (a data partition).
+ * A save programs one 64-byte slot instead of rewriting a sector, so
+ * state can be saved often; a sector is only erased when the log wraps
+ * into it.
+ *
+ * SLOT LAYOUT (64 bytes):
+ *    0  seq       uint32, +1 per record, highest valid one wins
+ *    4  length    uint16, payload bytes
+ *    6  magic     uint16, JOURNAL_MAGIC
+ *    8  payload   up to JOURNAL_PAYLOAD_MAX bytes, rest 0xFF
+ *   56  crc       CRC-32 of bytes 0-55
+ *   60  commit    0x00000000, programmed after the rest
+ *
+ * ATOMICITY:
+ *    A slot only counts once its commit word is programmed, which is a
+ *    separate write after the body. A reset mid-save leaves an
+ *    uncommitted slot that recovery skips; the previous record stays the
+ *    latest. The CRC catches anything else.
+ *
+ * ERASES:
+ *    Sectors are used in turn. journalPrepare() erases the sector after
+ *    the current one ahead of time (it holds only old records), so the
+ *    save that crosses a sector boundary normally finds it blank and
+ *    does not block on the erase.
+ *
+ * Host-portable: the flash is reached through JournalFlash callbacks, so
+ * the test suite runs it on a RAM model (test/test_journal.cpp).
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ==================== CONFIGURATION ====================
+
+#define JOURNAL_SECTOR_SIZE   4096
+#define JOURNAL_SLOT_SIZE     64
+#define JOURNAL_SLOTS         (JOURNAL_SECTOR_SIZE / JOURNAL_SLOT_SIZE)
+#define JOURNAL_PAYLOAD_MAX   48
+#define JOURNAL_MAGIC         0x4A52   // "JR"
+
+// ==================== FLASH ACCESS ====================
+
+// Offsets are from the start of the journal area. write() may only clear
+// bits (NOR flash); erase() sets one sector to 0xFF.
+struct JournalFlash {
+    uint32_t size;      // Bytes, whole sectors, at least 2
+    bool (*read)(uint32_t offset, void* data, size_t length);
+    bool (*write)(uint32_t offset, const void* data, size_t length);
+    bool (*erase)(uint32_t offset);
+};
+
+// ==================== JOURNAL ====================
+
+struct Journal {
+    const JournalFlash* flash;
+    uint32_t sectors;
+    uint32_t sector;        // Sector being appended to
+    uint32_t slot;          // Next slot in it (JOURNAL_SLOTS = full)
+    bool nextBlank;         // Following sector already erased
+    uint32_t seq;           // Sequence number of the latest record
+    int32_t latest;         // Offset of the latest record, -1 if none
+    uint32_t erases;        // Sector erases since open
+    uint32_t records;       // Valid records found by journalOpen()
+};
+
+// Scan the flash and find the latest valid record and the append point
+// Returns false if the flash is unusable (too small, read errors)
+bool journalOpen(Journal& j, const JournalFlash* flash);
+
+// Copy the latest record's payload; returns its length, 0 if there is none
+size_t journalLatest(Journal& j, void* data, size_t maxLength);
+
+// Append a record (length <= JOURNAL_PAYLOAD_MAX)
+bool journalAppend(Journal& j, const void* data, size_t length);
+
+// Erase the next sector if it is not blank yet; call when idle
+// Returns true if an erase was done
+bool journalPrepare(Journal& j);
+
+#endif // JOURNAL_H
@@ -0,0 +1,135 @@
+/*
+ * Orbital Temple Satellite - Link Quality Implementation
+ * Version: 1.21
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "link.h"
+
+// Demodulator floors from the SX1276 datasheet (BW 125 kHz)
+const LinkProfile LINK_PROFILE_TABLE[LINK_PROFILES] = {
+    { LINK_SAFE_SF, LINK_SAFE_CR, -12.5f },
+    { 8, 5, -10.0f },
+    { 7, 5, -7.5f },
+};
+
+static LinkPass pass;
+
+static float profileNeed(uint8_t profile) {
+    return LINK_PROFILE_TABLE[profile].floorSnr + LINK_MARGIN_DB;
+}
+
+static void fallBack() {
+    pass.profile = LINK_PROFILE_SAFE;
+    pass.awaitingAck = false;
+    pass.missedAcks = 0;
+    pass.fallbacks++;
+}
+
+void linkReset() {
+    memset(&pass, 0, sizeof(pass));
+}
+
+// ==================== ESTIMATE ====================
+
+void linkUplink(float rssi, float snr, unsigned long now) {
+    if (!pass.open) {
+        memset(&pass, 0, sizeof(pass));
+        pass.open = true;
+        pass.startMs = now;
+        pass.snrAvg = snr;
+        pass.snrMin = snr;
+        pass.snrMax = snr;
+        pass.rssiMin = rssi;
+    }
+
+    pass.snrAvg += LINK_SNR_ALPHA * (snr - pass.snrAvg);
+    if (snr < pass.snrMin) pass.snrMin = snr;
+    if (snr > pass.snrMax) pass.snrMax = snr;
+    pass.rssiSum += rssi;
+    if (rssi < pass.rssiMin) pass.rssiMin = rssi;
+    pass.uplinks++;
+    pass.lastUplinkMs = now;
+
+    // Ground is still there: whatever went out fast arrived
+    pass.awaitingAck = false;
+    pass.missedAcks = 0;
+
+    if (pass.profile != LINK_PROFILE_SAFE &&
+        pass.snrAvg < profileNeed(pass.profile) - LINK_HYSTERESIS_DB) {
+        fallBack();
+    }
+}
+
+uint8_t linkBestProfile() {
+    if (!pass.open || pass.uplinks < LINK_MIN_UPLINKS) return LINK_PROFILE_SAFE;
+
+    uint8_t best = LINK_PROFILE_SAFE;
+    for (uint8_t p = 1; p < LINK_PROFILES; p++) {
+        if (pass.snrAvg >= profileNeed(p)) best = p;
+    }
+    return best;
+}
+
+int linkRequest(int profile) {
+    int best = linkBestProfile();
+    if (profile == LINK_PROFILE_AUTO) {
+        profile = best;
+    } else if (profile < 0 || profile >= LINK_PROFILES || profile > best) {
+        return -1;
+    }
+
+    pass.profile = (uint8_t)profile;
+    pass.missedAcks = 0;
+    if (pass.profile > pass.maxProfile) pass.maxProfile = pass.profile;
+    return profile;
+}
+
+// ==================== BULK ====================
+
+uint8_t linkBulkProfile() {
+    return pass.profile;
+}
+
+void linkBulkSent(uint8_t profile, unsigned long now) {
+    if (profile == LINK_PROFILE_SAFE) {
+        pass.bulkSafe++;
+        return;
+    }
+    pass.bulkFast++;
+    pass.awaitingAck = true;
+    pass.lastFastBulkMs = now;
+}
+
+LinkEvent linkTick(unsigned long now) {
+    if (!pass.open) return LINK_EVENT_NONE;
+
+    if (now - pass.lastUplinkMs >= LINK_PASS_GAP_MS) {
+        pass.open = false;
+        pass.profile = LINK_PROFILE_SAFE;
+        pass.awaitingAck = false;
+        return LINK_EVENT_PASS_END;
+    }
+
+    if (pass.awaitingAck && now - pass.lastFastBulkMs >= LINK_ACK_TIMEOUT_MS) {
+        pass.awaitingAck = false;
+        if (++pass.missedAcks >= LINK_MAX_MISSED_ACKS) {
+            fallBack();
+            return LINK_EVENT_FALLBACK;
+        }
+    }
+    return LINK_EVENT_NONE;
+}
+
+const LinkPass& linkPass() {
+    return pass;
+}
+
+void linkFormatPass(char* out, size_t size) {
+    float rssiAvg = pass.uplinks > 0 ? pass.rssiSum / pass.uplinks : 0.0f;
+    snprintf(out, size, "LINK|UP:%u|RSSI:%.1f/%.1f|SNR:%.1f/%.1f/%.1f|PROF:%u|BULK:%u/%u|FB:%u|DUR:%lu",
+             pass.uplinks, rssiAvg, pass.rssiMin, pass.snrAvg, pass.snrMin, pass.snrMax,
+             pass.maxProfile, pass.bulkFast, pass.bulkSafe, pass.fallbacks,
+             (pass.lastUplinkMs - pass.startMs) / 1000UL);
+}
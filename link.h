@@ -0,0 +1,120 @@
+#ifndef LINK_H
+#define LINK_H
+
+/*
+ * Orbital Temple Satellite - Link Quality and Downlink Profiles
+ * Version: 1.21
+ *
+ * The radio settings in config.h (SF9, CR 4/7) are sized for a pass near
+ * the horizon. This module keeps a per-pass estimate of the uplink SNR
+ * and RSSI and, when ground asks for it (SetLinkProfile), lets bulk
+ * downlinks - file reads, listings, accel files - go out with a faster
+ * spreading factor and coding rate. Everything else, and all reception,
+ * stays on the safe profile, so commands, replies and beacons always
+ * reach a receiver that only knows the safe settings.
+ *
+ * ESTIMATE:
+ *   Every authenticated uplink feeds an exponential average of its SNR
+ *   (LINK_SNR_ALPHA). A profile is allowed once LINK_MIN_UPLINKS uplinks
+ *   were seen this pass and the average is at least its demodulator floor
+ *   plus LINK_MARGIN_DB. The downlink is assumed to see the same path.
+ *
+ * FALLBACK to the safe profile:
+ *   - the average drops LINK_HYSTERESIS_DB below the active profile's need
+ *   - LINK_MAX_MISSED_ACKS fast bulk transfers in a row were not followed
+ *     by any uplink within LINK_ACK_TIMEOUT_MS (ground "acks" a transfer
+ *     with its next command, e.g. ReadFileRange or Ping)
+ *   - no uplink for LINK_PASS_GAP_MS: the pass is over; its statistics
+ *     are returned by linkTick() for the log
+ *
+ * Host-portable: the caller passes "now" and the packet's RSSI/SNR
+ * (test/test_link.cpp builds it).
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ==================== CONFIGURATION ====================
+
+#define LINK_PROFILE_SAFE     0
+#define LINK_SAFE_SF          9         // Must equal LORA_SF / LORA_CR
+#define LINK_SAFE_CR          7
+#define LINK_PROFILE_AUTO     -1        // linkRequest(): best allowed
+#define LINK_PROFILES         3
+#define LINK_MARGIN_DB        10.0f     // Above the demodulator floor
+#define LINK_HYSTERESIS_DB    2.0f      // Below the need before dropping a profile
+#define LINK_SNR_ALPHA        0.25f     // Weight of the newest uplink
+#define LINK_MIN_UPLINKS      3         // Per pass, before a fast profile
+#define LINK_ACK_TIMEOUT_MS   30000UL   // After the last fast bulk packet
+#define LINK_MAX_MISSED_ACKS  2
+#define LINK_PASS_GAP_MS      600000UL  // Silence that ends a pass (10 min)
+#define LINK_TICK_INTERVAL    5000UL    // linkTick() period (scheduler job)
+#define LINK_PASS_LINE_MAX    112
+
+struct LinkProfile {
+    uint8_t sf;
+    uint8_t cr;             // Denominator: 4/cr
+    float floorSnr;         // dB, SX1276 demodulator limit at this SF
+};
+
+extern const LinkProfile LINK_PROFILE_TABLE[LINK_PROFILES];
+
+// ==================== PASS STATISTICS ====================
+
+struct LinkPass {
+    bool open;
+    unsigned long startMs;
+    unsigned long lastUplinkMs;
+    uint16_t uplinks;
+    float snrAvg;               // Exponential average (the estimate)
+    float snrMin;
+    float snrMax;
+    float rssiSum;
+    float rssiMin;
+    uint8_t profile;            // Active bulk profile
+    uint8_t maxProfile;         // Fastest used this pass
+    uint16_t bulkFast;          // Bulk packets sent on a fast profile
+    uint16_t bulkSafe;
+    uint8_t missedAcks;         // In a row
+    uint8_t fallbacks;
+    bool awaitingAck;
+    unsigned long lastFastBulkMs;
+};
+
+typedef enum {
+    LINK_EVENT_NONE,
+    LINK_EVENT_FALLBACK,        // Back on the safe profile, pass continues
+    LINK_EVENT_PASS_END         // Pass closed; linkPass() has its totals
+} LinkEvent;
+
+// ==================== API ====================
+
+// Authenticated uplink (opens a pass if none is open)
+void linkUplink(float rssi, float snr, unsigned long now);
+
+// Fastest profile the estimate allows now (LINK_PROFILE_SAFE if none)
+uint8_t linkBestProfile();
+
+// Ground asks for a profile (or LINK_PROFILE_AUTO); returns the profile now
+// active for bulk, or -1 if the estimate does not allow it (unchanged)
+int linkRequest(int profile);
+
+// Profile for the next bulk packet
+uint8_t linkBulkProfile();
+
+// A bulk packet went out on this profile
+void linkBulkSent(uint8_t profile, unsigned long now);
+
+// Ack timeout and end-of-pass checks (every LINK_TICK_INTERVAL)
+LinkEvent linkTick(unsigned long now);
+
+const LinkPass& linkPass();
+
+// "LINK|UP:n|RSSI:avg/min|SNR:avg/min/max|PROF:max|BULK:fast/safe|FB:n|DUR:s"
+// DUR runs from the first to the last uplink of the pass
+void linkFormatPass(char* out, size_t size);
+
+// Back to boot state (tests)
+void linkReset();
+
+#endif // LINK_H
@@ -0,0 +1,128 @@
+/*
+ * Orbital Temple Satellite - Debug Log Implementation
+ * Version: 1.21
+ *
+ * Same ring layout as the SD log writer (memor.cpp), but with several
+ * producers - the main loop, the RX task and the SD writer task all log -
+ * so reserving space and copying a line happen under a spinlock. A line
+ * is at most LOG_LINE_MAX bytes, so the lock is held for a short memcpy.
+ * The writer task is the only consumer; it may block in Serial.write()
+ * for as long as the line takes, nobody else waits for it.
+ */
+
+#include <Arduino.h>
+#include <stdarg.h>
+#include "log.h"
+
+static char uartRing[LOG_UART_RING_SIZE];
+static volatile uint32_t uartHead = 0;       // Advanced by producers, under uartMux
+static volatile uint32_t uartTail = 0;       // Advanced by the writer task only
+static volatile uint32_t uartDrops = 0;      // Lines dropped (ring full)
+static volatile bool uartWriterActive = false;
+static TaskHandle_t uartTaskHandle = NULL;
+static portMUX_TYPE uartMux = portMUX_INITIALIZER_UNLOCKED;
+
+static uint32_t uartRingUsed() {
+    return uartHead - uartTail;
+}
+
+static void uartDrainRing() {
+    uint32_t head = uartHead;
+    __sync_synchronize();  // Read the bytes only after seeing the new head
+    uint32_t tail = uartTail;
+
+    while (tail != head) {
+        size_t idx = tail & (LOG_UART_RING_SIZE - 1);
+        size_t n = head - tail;
+        if (n > LOG_UART_RING_SIZE - idx) n = LOG_UART_RING_SIZE - idx;
+
+        Serial.write((const uint8_t*)uartRing + idx, n);
+        tail += n;
+
+        __sync_synchronize();  // Finish writing before releasing the space
+        uartTail = tail;
+    }
+}
+
+static void uartWriterTask(void *param) {
+    (void)param;
+    for (;;) {
+        uartWriterActive = false;
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        uartWriterActive = true;
+        uartDrainRing();
+    }
+}
+
+void logUartStart() {
+    if (uartTaskHandle != NULL) return;
+
+    if (xTaskCreatePinnedToCore(uartWriterTask, "logUart", LOG_UART_TASK_STACK, NULL,
+                                LOG_UART_TASK_PRIORITY, &uartTaskHandle, LOG_UART_TASK_CORE) != pdPASS) {
+        uartTaskHandle = NULL;
+        LOG_E("LOG", "UART writer task failed to start, logging inline");
+    }
+}
+
+void logLine(const char *fmt, ...) {
+    char line[LOG_LINE_MAX];
+    va_list args;
+    va_start(args, fmt);
+    int len = vsnprintf(line, sizeof(line) - 1, fmt, args);
+    va_end(args);
+    if (len < 0) return;
+    if ((size_t)len > sizeof(line) - 2) len = sizeof(line) - 2;  // Truncated
+    line[len++] = '\n';
+
+    if (uartTaskHandle == NULL) {
+        Serial.write((const uint8_t*)line, len);
+        return;
+    }
+
+    // Whole lines only, so a full ring never leaves half a line
+    bool queued = false;
+    portENTER_CRITICAL(&uartMux);
+    uint32_t head = uartHead;
+    if (LOG_UART_RING_SIZE - (head - uartTail) >= (uint32_t)len) {
+        size_t idx = head & (LOG_UART_RING_SIZE - 1);
+        size_t first = LOG_UART_RING_SIZE - idx;
+        if (first > (size_t)len) first = len;
+        memcpy(uartRing + idx, line, first);
+        memcpy(uartRing, line + first, len - first);
+
+        __sync_synchronize();  // Publish the bytes before the new head
+        uartHead = head + len;
+        queued = true;
+    } else {
+        uartDrops++;
+    }
+    portEXIT_CRITICAL(&uartMux);
+
+    if (queued) xTaskNotifyGive(uartTaskHandle);
+}
+
+bool logUartFlush(unsigned long timeoutMs) {
+    if (uartTaskHandle == NULL) return true;  // Inline writes are already out
+
+    unsigned long start = millis();
+    while (logUartBusy()) {
+        if (millis() - start >= timeoutMs) {
+            return false;
+        }
+        delay(1);
+    }
+    Serial.flush();
+    return true;
+}
+
+bool logUartBusy() {
+    return uartWriterActive || uartRingUsed() != 0;
+}
+
+uint32_t logUartDrops() {
+    return uartDrops;
+}
+
+size_t logUartDepth() {
+    return uartRingUsed();
+}
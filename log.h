@@ -0,0 +1,103 @@
+#ifndef LOG_H
+#define LOG_H
+
+/*
+ * Orbital Temple Satellite - Debug Log
+ * Version: 1.21
+ *
+ * Leveled, tagged serial logging. OT_LOG_LEVEL (platformio.ini
+ * build_flags) selects what is compiled in; the macros for the levels
+ * above it become dead code (format still checked, arguments never
+ * evaluated), so a flight build carries neither the strings nor the
+ * formatting cost.
+ *
+ *   LOG_E("LORA", "ERROR: startReceive failed, code: %d", state);
+ *   -> "[LORA] ERROR: startReceive failed, code: 5\n"
+ *
+ * Tags are string literals, pasted into the format at compile time. The
+ * newline is added by the sink. LOG_TEXT_x() prints an untagged line
+ * (status boxes, banners) under the same level switch.
+ *
+ * Lines are formatted on the caller's stack and copied whole into a
+ * ring; a low-priority task on core 0 writes the ring to the UART. A
+ * caller never waits for the 115200 baud line: when the ring is full the
+ * line is dropped and counted. Safe from any task (not from ISRs). Until
+ * logUartStart() has run, lines are written to Serial inline.
+ *
+ * Serial output only - logToSD() (memor.h) is unaffected by the level.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define LOG_LEVEL_NONE     0
+#define LOG_LEVEL_ERROR    1      // Failures
+#define LOG_LEVEL_WARN     2      // Degraded, recovered, retried
+#define LOG_LEVEL_INFO     3      // State changes, one line per event
+#define LOG_LEVEL_DEBUG    4      // Per-chunk / per-packet detail, status boxes
+
+#ifndef OT_LOG_LEVEL
+#define OT_LOG_LEVEL       LOG_LEVEL_DEBUG
+#endif
+
+#define LOG_LINE_MAX           192     // Longest line incl. tag and newline
+#define LOG_UART_RING_SIZE     4096    // Bytes, must be a power of two
+#define LOG_UART_TASK_STACK    2048
+#define LOG_UART_TASK_PRIORITY 1
+#define LOG_UART_TASK_CORE     0       // Arduino loop() runs on core 1
+#define LOG_UART_FLUSH_TIMEOUT 500UL   // logUartFlush() wait before a restart (4 KB ~ 360 ms)
+
+// Format one line and queue it (use the macros)
+void logLine(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+// Disabled levels: still type-checked, never evaluated, no code or strings
+#define LOG_DISCARD(fmt, ...)   do { if (0) logLine(fmt, ##__VA_ARGS__); } while (0)
+
+#if OT_LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_E(tag, fmt, ...)    logLine("[" tag "] " fmt, ##__VA_ARGS__)
+#define LOG_TEXT_E(fmt, ...)    logLine(fmt, ##__VA_ARGS__)
+#else
+#define LOG_E(tag, fmt, ...)    LOG_DISCARD("[" tag "] " fmt, ##__VA_ARGS__)
+#define LOG_TEXT_E(fmt, ...)    LOG_DISCARD(fmt, ##__VA_ARGS__)
+#endif
+
+#if OT_LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_W(tag, fmt, ...)    logLine("[" tag "] " fmt, ##__VA_ARGS__)
+#define LOG_TEXT_W(fmt, ...)    logLine(fmt, ##__VA_ARGS__)
+#else
+#define LOG_W(tag, fmt, ...)    LOG_DISCARD("[" tag "] " fmt, ##__VA_ARGS__)
+#define LOG_TEXT_W(fmt, ...)    LOG_DISCARD(fmt, ##__VA_ARGS__)
+#endif
+
+#if OT_LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_I(tag, fmt, ...)    logLine("[" tag "] " fmt, ##__VA_ARGS__)
+#define LOG_TEXT_I(fmt, ...)    logLine(fmt, ##__VA_ARGS__)
+#else
+#define LOG_I(tag, fmt, ...)    LOG_DISCARD("[" tag "] " fmt, ##__VA_ARGS__)
+#define LOG_TEXT_I(fmt, ...)    LOG_DISCARD(fmt, ##__VA_ARGS__)
+#endif
+
+#if OT_LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_D(tag, fmt, ...)    logLine("[" tag "] " fmt, ##__VA_ARGS__)
+#define LOG_TEXT_D(fmt, ...)    logLine(fmt, ##__VA_ARGS__)
+#else
+#define LOG_D(tag, fmt, ...)    LOG_DISCARD("[" tag "] " fmt, ##__VA_ARGS__)
+#define LOG_TEXT_D(fmt, ...)    LOG_DISCARD(fmt, ##__VA_ARGS__)
+#endif
+
+// Start the UART writer task (call once, right after Serial.begin())
+void logUartStart();
+
+// Wait until everything queued has been handed to the UART
+// (call before ESP.restart()). Returns false on timeout
+bool logUartFlush(unsigned long timeoutMs);
+
+// True while lines are queued or being written,
+// the main loop must not light-sleep then (the UART stops)
+bool logUartBusy();
+
+// Ring statistics
+uint32_t logUartDrops();
+size_t logUartDepth();
+
+#endif // LOG_H
@@ -31,23 +31,33 @@
  *    V1.2 sent sensor data without timestamps.
  *
  *    FIX: All telemetry includes mission elapsed time.
+ *
+ * 5. ZERO-COPY PARSER AND COMMAND TABLE:
+ *    validateMessage() made five substring() copies plus one more for the
+ *    HMAC input, and processMessage() walked an if/else chain of ~25
+ *    command.equals(). The message is now parsed in place in the RX buffer
+ *    and commands are looked up in a sorted table (binary search).
  */
 
 #include <Arduino.h>
 #include "config.h"
+#include "log.h"
 #include "loop.h"
 #include "lora.h"
 #include "sensors.h"
 #include "memor.h"
 #include "radiation.h"
 #include "accel.h"
-
-// ==================== LOCAL VARIABLES ====================
-static unsigned long lastTelemetryTime = 0;
-static String receivedData = "";
+#include "scheduler.h"
+#include "power.h"
+#include "imu.h"
+#include "perf.h"
+#include "upload.h"
+#include "names.h"
+#include "link.h"
 
 // ==================== MISSION TIME ====================
-String getMissionTime() {
+void formatMissionTime(char* buffer, size_t size) {
     unsigned long elapsed = millis() - missionStartTime;
 
     // Convert to hours:minutes:seconds
@@ -58,398 +68,895 @@ String getMissionTime() {
     seconds %= 60;
     minutes %= 60;
 
+    snprintf(buffer, size, "T+%02lu:%02lu:%02lu", hours, minutes, seconds);
+}
+
+void addMissionTime(MsgBuilder& msg) {
     char buffer[20];
-    snprintf(buffer, sizeof(buffer), "T+%02lu:%02lu:%02lu", hours, minutes, seconds);
-    return String(buffer);
+    formatMissionTime(buffer, sizeof(buffer));
+    msg.add(buffer);
 }
 
 // ==================== TELEMETRY ====================
-void sendTelemetry() {
-    Serial.println("[TELEM] >>> Starting telemetry collection...");
-    feedWatchdog();
+// Both encodings are built into static buffers - no heap allocation.
+// Values come from the analog sampler and the IMU service caches.
 
-    // Read all sensors with progress logging
-    Serial.println("[TELEM] Reading battery voltage...");
-    readBatteryVoltage();
-    Serial.println("[TELEM] Battery OK");
+static char telemText[TX_MAX_PACKET + 1];
+static uint8_t telemBinary[TELEM_BINARY_SIZE];
 
-    Serial.println("[TELEM] Reading luminosity...");
-    readLumi();
-    Serial.println("[TELEM] Luminosity OK");
+static void putU16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)(v >> 8);
+}
 
-    Serial.println("[TELEM] Reading temperature...");
-    readTemp();
-    Serial.println("[TELEM] Temperature OK");
+static void putU32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
 
-    // Read IMU if available - with timeout protection
-    if (IMUOK) {
-        Serial.println("[TELEM] Reading IMU (with timeout)...");
+// Scale and clamp a reading into a signed 16-bit field
+static int16_t scaleI16(float value, float scale) {
+    float scaled = value * scale;
+    if (scaled > 32767.0f) return 32767;
+    if (scaled < -32768.0f) return -32768;
+    return (int16_t)lroundf(scaled);
+}
 
-        // Set I2C timeout to prevent hanging on unresponsive sensor
-        Wire.setTimeOut(100);  // 100ms timeout
+static uint32_t scaleU32(float value, float scale) {
+    float scaled = value * scale;
+    if (scaled <= 0.0f) return 0;
+    if (scaled >= 4294967295.0f) return 0xFFFFFFFFUL;
+    return (uint32_t)lroundf(scaled);
+}
 
-        unsigned long imuStart = millis();
-        bool imuReadOK = true;
+// Heap bytes in the frame's 16-byte units (saturates at 1 MB)
+static uint16_t heapUnits(uint32_t bytes) {
+    return bytes / 16 > 0xFFFF ? 0xFFFF : (uint16_t)(bytes / 16);
+}
 
-        // Try to read gyro with timeout check
-        Serial.println("[TELEM]   Checking gyro...");
-        if (imu.gyroAvailable()) {
-            imu.readGyro();
-            if (millis() - imuStart > 500) {
-                Serial.println("[TELEM]   WARNING: Gyro read took too long!");
-                imuReadOK = false;
-            }
-        }
-        feedWatchdog();
+// Legacy text format: TIME|SENSORS|BAT|TEMP|LUX|IMU|SD|SEU
+const char* buildTextTelemetry() {
+    unsigned long seconds = (millis() - missionStartTime) / 1000;
+    int len = snprintf(telemText, sizeof(telemText),
+                       "T+%02lu:%02lu:%02lu|IMU:%s,SD:%s,RF:%s|BAT:%.2fV|TEMP:%.1fC|LUX:%.1f",
+                       seconds / 3600, (seconds / 60) % 60, seconds % 60,
+                       IMUOK ? "OK" : "FAIL", SDOK ? "OK" : "FAIL", RFOK ? "OK" : "FAIL",
+                       VT, Tc, lux);
+
+    ImuSample s;
+    if (IMUOK && imuLatest(s) && len > 0 && len < (int)sizeof(telemText)) {
+        len += snprintf(telemText + len, sizeof(telemText) - len,
+                        "|GYR:%.1f,%.1f,%.1f|ACC:%.2f,%.2f,%.2f|MAG:%.1f,%.1f,%.1f",
+                        imu.calcGyro(s.gyro[0]), imu.calcGyro(s.gyro[1]), imu.calcGyro(s.gyro[2]),
+                        imu.calcAccel(s.accel[0]), imu.calcAccel(s.accel[1]), imu.calcAccel(s.accel[2]),
+                        imu.calcMag(s.mag[0]), imu.calcMag(s.mag[1]), imu.calcMag(s.mag[2]));
+    }
 
-        // Try to read accelerometer with timeout check
-        Serial.println("[TELEM]   Checking accel...");
-        if (imu.accelAvailable()) {
-            imu.readAccel();
-            if (millis() - imuStart > 1000) {
-                Serial.println("[TELEM]   WARNING: Accel read took too long!");
-                imuReadOK = false;
-            }
-        }
-        feedWatchdog();
+    // SD card capacity (Gemini review recommendation)
+    if (SDOK && len > 0 && len < (int)sizeof(telemText)) {
+        len += snprintf(telemText + len, sizeof(telemText) - len, "|SD:%u%%", getSDFreePercent());
+    }
 
-        // Try to read magnetometer with timeout check
-        Serial.println("[TELEM]   Checking mag...");
-        if (imu.magAvailable()) {
-            imu.readMag();
-            if (millis() - imuStart > 1500) {
-                Serial.println("[TELEM]   WARNING: Mag read took too long!");
-                imuReadOK = false;
-            }
-        }
-        feedWatchdog();
+    // Radiation protection status (SEU corrections)
+    if (len > 0 && len < (int)sizeof(telemText)) {
+        len += snprintf(telemText + len, sizeof(telemText) - len, "|SEU:%lu", (unsigned long)seuCorrectionsTotal);
+    }
 
-        unsigned long imuTime = millis() - imuStart;
-        if (imuReadOK) {
-            Serial.printf("[TELEM] IMU OK (took %lu ms)\n", imuTime);
-        } else {
-            Serial.printf("[TELEM] IMU SLOW/TIMEOUT (took %lu ms)\n", imuTime);
+    // Share of uptime spent in idle light sleep
+    if (len > 0 && len < (int)sizeof(telemText)) {
+        len += snprintf(telemText + len, sizeof(telemText) - len, "|SLP:%u%%", (unsigned)(sleepPermille() / 10));
+    }
+
+    // Heap: largest free block / low-water mark (fragmentation shows in the first)
+    if (len > 0 && len < (int)sizeof(telemText)) {
+        snprintf(telemText + len, sizeof(telemText) - len, "|HEAP:%lu/%lu",
+                 (unsigned long)getLargestFreeBlock(), (unsigned long)getMinFreeHeap());
+    }
+
+    return telemText;
+}
+
+// Versioned fixed-layout frame (layout documented in config.h)
+size_t buildBinaryTelemetry() {
+    uint8_t* p = telemBinary;
+    memset(p, 0, TELEM_BINARY_SIZE);
+
+    ImuSample s;
+    bool imuData = IMUOK && imuLatest(s);
+
+    uint8_t flags = 0;
+    if (IMUOK) flags |= TELEM_FLAG_IMU;
+    if (imuData) flags |= TELEM_FLAG_IMU_DATA;
+    if (SDOK) flags |= TELEM_FLAG_SD;
+    if (RFOK) flags |= TELEM_FLAG_RF;
+    if (groundContactEstablished) flags |= TELEM_FLAG_CONTACT;
+
+    p[0] = TELEM_FRAME_TYPE;
+    p[1] = TELEM_VERSION;
+    putU32(p + 2, (uint32_t)((millis() - missionStartTime) / 1000));
+    putU32(p + 6, bootCount);
+    p[10] = flags;
+    p[11] = SDOK ? getSDFreePercent() : 0xFF;
+    putU16(p + 12, (uint16_t)scaleU32(VT, 1000.0f));
+    putU16(p + 14, (uint16_t)scaleI16((float)Tc, 100.0f));
+    putU32(p + 16, scaleU32(lux, 10.0f));
+
+    if (imuData) {
+        for (int i = 0; i < 3; i++) {
+            putU16(p + 20 + 2 * i, (uint16_t)scaleI16(imu.calcGyro(s.gyro[i]), 10.0f));
+            putU16(p + 26 + 2 * i, (uint16_t)scaleI16(imu.calcAccel(s.accel[i]), 1000.0f));
+            putU16(p + 32 + 2 * i, (uint16_t)scaleI16(imu.calcMag(s.mag[i]), 1000.0f));
         }
+    }
+
+    putU32(p + 38, seuCorrectionsTotal);
+    putU16(p + 42, sleepPermille());
+    putU16(p + 44, heapUnits(getLargestFreeBlock()));
+    putU16(p + 46, heapUnits(getMinFreeHeap()));
+    putU32(p + 48, calculateCRC32(p, TELEM_BINARY_SIZE - 4));
+
+    return TELEM_BINARY_SIZE;
+}
+
+void sendTelemetry() {
+    LOG_I("TELEM", ">>> Starting telemetry collection...");
+    feedWatchdog();
+
+    // Analog channels: VT/Tc/lux are kept current by the sampler, the
+    // window gives the spread since the last telemetry
+    SensorStats bat, temp, light;
+    sensorWindowTake(SENSOR_WIN_TELEMETRY, SENSOR_BATTERY, bat);
+    sensorWindowTake(SENSOR_WIN_TELEMETRY, SENSOR_TEMP, temp);
+    sensorWindowTake(SENSOR_WIN_TELEMETRY, SENSOR_LUX, light);
+    char window[128];
+    snprintf(window, sizeof(window),
+             "SENS|N:%u|BAT:%.2f/%.2f/%.2f|TEMP:%.1f/%.1f/%.1f|LUX:%.1f/%.1f/%.1f",
+             (unsigned)bat.count, bat.min, bat.mean, bat.max,
+             temp.min, temp.mean, temp.max, light.min, light.mean, light.max);
+    LOG_D("TELEM", "Window (min/mean/max) %s", window);
+
+    // IMU: latest sample from the service - no bus access here
+    ImuSample imuSample;
+    if (!IMUOK) {
+        LOG_I("TELEM", "IMU not available, skipping");
+    } else if (imuLatest(imuSample)) {
+        unsigned long now = millis();
+        LOG_D("TELEM", "IMU sample age: accel %lu ms, mag %lu ms (last read %lu us, max %lu us)",
+              now - imuSample.accelTime, now - imuSample.magTime,
+              (unsigned long)imuLastLatencyUs(), (unsigned long)imuMaxLatencyUs());
     } else {
-        Serial.println("[TELEM] IMU not available, skipping");
-    }
-
-    // Build telemetry message with timestamp
-    // Format: TIME|SENSORS|BAT|TEMP|LUX|IMU
-    Serial.println("[TELEM] Building telemetry message...");
-
-    String telemetry = getMissionTime();
-    telemetry += "|";
-    telemetry += getSensorStatus();
-    telemetry += "|BAT:";
-    telemetry += String(VT, 2);
-    telemetry += "V|TEMP:";
-    telemetry += String(Tc, 1);
-    telemetry += "C|LUX:";
-    telemetry += String(lux, 1);
-
-    Serial.println("[TELEM] Basic sensors added to message");
-
-    // Add IMU data if available
-    if (IMUOK) {
-        Serial.println("[TELEM] Adding IMU data to message...");
-        telemetry += "|GYR:";
-        telemetry += String(imu.calcGyro(imu.gx), 1) + ",";
-        telemetry += String(imu.calcGyro(imu.gy), 1) + ",";
-        telemetry += String(imu.calcGyro(imu.gz), 1);
-        telemetry += "|ACC:";
-        telemetry += String(imu.calcAccel(imu.ax), 2) + ",";
-        telemetry += String(imu.calcAccel(imu.ay), 2) + ",";
-        telemetry += String(imu.calcAccel(imu.az), 2);
-        telemetry += "|MAG:";
-        telemetry += String(imu.calcMag(imu.mx), 1) + ",";
-        telemetry += String(imu.calcMag(imu.my), 1) + ",";
-        telemetry += String(imu.calcMag(imu.mz), 1);
-        Serial.println("[TELEM] IMU data added");
-    }
-
-    // Add SD card capacity (Gemini review recommendation)
-    if (SDOK) {
-        Serial.println("[TELEM] Adding SD card info...");
-        telemetry += "|SD:";
-        telemetry += String(getSDFreePercent());
-        telemetry += "%";
-    }
-
-    // Add radiation protection status (SEU corrections)
-    telemetry += "|SEU:";
-    telemetry += String(seuCorrectionsTotal);
-
-    Serial.println("[TELEM] Message complete, length: " + String(telemetry.length()));
-    Serial.println("[TELEM] >>> " + telemetry);
-
-    Serial.println("[TELEM] Sending via LoRa...");
-    bool sendOK = sendMessage(telemetry);
+        LOG_I("TELEM", "IMU service has no sample yet");
+    }
+
+    // Text form is always built - it goes to the SD log either way
+    LOG_D("TELEM", "Building telemetry message...");
+    const char* text = buildTextTelemetry();
+    LOG_I("TELEM", ">>> %s", text);
+
+    bool sendOK;
+    if (telemetryFormat == TELEM_FORMAT_BINARY) {
+        size_t length = buildBinaryTelemetry();
+        LOG_I("TELEM", "Queueing binary frame (%u bytes, text was %u)...",
+              (unsigned)length, (unsigned)strlen(text));
+        sendOK = sendPacket(telemBinary, length, TX_PRIO_TELEMETRY);
+    } else {
+        LOG_D("TELEM", "Queueing text telemetry...");
+        sendOK = sendPacket((const uint8_t*)text, strlen(text), TX_PRIO_TELEMETRY);
+    }
+
     if (sendOK) {
-        Serial.println("[TELEM] >>> Send SUCCESS");
+        LOG_D("TELEM", ">>> Queued");
     } else {
-        Serial.println("[TELEM] >>> Send FAILED!");
+        LOG_E("TELEM", ">>> Queue FAILED!");
     }
 
     // Log to SD card
-    Serial.println("[TELEM] Logging to SD...");
-    logToSD(telemetry.c_str());
-    Serial.println("[TELEM] <<< Telemetry complete");
+    LOG_D("TELEM", "Logging to SD...");
+    logToSD(text);
+    logToSD(window);
+    LOG_I("TELEM", "<<< Telemetry complete");
 }
 
 // ==================== INPUT VALIDATION ====================
-bool validateMessage(const String& msg, String& satId, String& command,
-                     String& path, String& data, String& hmac) {
+// The parser works in place on the RX buffer: fields are pointer+length
+// views, nothing is copied. Only after the HMAC has been verified are the
+// delimiters overwritten with NULs so path/data can be used as C strings.
+bool validateMessage(char* buffer, size_t length, ParsedMessage& msg) {
     // Message format: SAT_ID-COMMAND&PATH@DATA#HMAC
     // Minimum valid message: "X-Y&@#Z" = 7 characters
 
-    if (msg.length() < 7) {
-        Serial.println("[PARSE] Message too short");
+    if (length < 7) {
+        LOG_W("PARSE", "Message too short");
+        return false;
+    }
+
+    if (length > RX_MAX_PACKET) {
+        LOG_W("PARSE", "Message too long");
         return false;
     }
 
-    if (msg.length() > 500) {
-        Serial.println("[PARSE] Message too long");
+    // Cheap rejection first: noise and other satellites on 401.5 MHz
+    // must not reach the delimiter scan or the HMAC
+    size_t idLength = sat_id.length();
+    if (length <= idLength || buffer[idLength] != '-' ||
+        memcmp(buffer, sat_id.c_str(), idLength) != 0) {
+        LOG_W("PARSE", "Wrong satellite ID");
         return false;
     }
 
     // Find all delimiters
-    int dashIdx = msg.indexOf('-');
-    int ampIdx = msg.indexOf('&');
-    int atIdx = msg.indexOf('@');
-    int hashIdx = msg.indexOf('#');
+    const char* dash = (const char*)memchr(buffer, '-', length);
+    const char* amp = (const char*)memchr(buffer, '&', length);
+    const char* at = (const char*)memchr(buffer, '@', length);
+    const char* hash = (const char*)memchr(buffer, '#', length);
 
     // Validate all delimiters present and in correct order
-    if (dashIdx == -1 || ampIdx == -1 || atIdx == -1 || hashIdx == -1) {
-        Serial.println("[PARSE] Missing delimiter(s)");
+    if (!dash || !amp || !at || !hash) {
+        LOG_W("PARSE", "Missing delimiter(s)");
         return false;
     }
 
-    if (!(dashIdx < ampIdx && ampIdx < atIdx && atIdx < hashIdx)) {
-        Serial.println("[PARSE] Delimiters in wrong order");
+    if (!(dash < amp && amp < at && at < hash)) {
+        LOG_W("PARSE", "Delimiters in wrong order");
         return false;
     }
 
-    // Extract parts
-    satId = msg.substring(0, dashIdx);
-    command = msg.substring(dashIdx + 1, ampIdx);
-    path = msg.substring(ampIdx + 1, atIdx);
-    data = msg.substring(atIdx + 1, hashIdx);
-    hmac = msg.substring(hashIdx + 1);
-
-    // Validate satellite ID
-    if (!satId.equals(sat_id)) {
-        Serial.println("[PARSE] Wrong satellite ID");
+    // Extract parts (views only)
+    const char* end = buffer + length;
+    msg.satId.ptr = buffer;       msg.satId.len = dash - buffer;
+    msg.command.ptr = dash + 1;   msg.command.len = amp - (dash + 1);
+    msg.path.ptr = amp + 1;       msg.path.len = at - (amp + 1);
+    msg.data.ptr = at + 1;        msg.data.len = hash - (at + 1);
+    msg.hmac.ptr = hash + 1;      msg.hmac.len = end - (hash + 1);
+
+    // Truncated tag is always 16 hex chars
+    if (msg.hmac.len != 16) {
+        LOG_W("PARSE", "Bad HMAC length");
         return false;
     }
 
     // Validate command is alphanumeric
-    for (unsigned int i = 0; i < command.length(); i++) {
-        char c = command.charAt(i);
-        if (!isalnum(c)) {
-            Serial.println("[PARSE] Invalid command characters");
+    for (size_t i = 0; i < msg.command.len; i++) {
+        if (!isalnum((unsigned char)msg.command.ptr[i])) {
+            LOG_W("PARSE", "Invalid command characters");
             return false;
         }
     }
 
     // Validate path (no directory traversal)
-    if (path.indexOf("..") != -1) {
-        Serial.println("[PARSE] Path traversal blocked!");
-        sendMessage("ERR:PATH_TRAVERSAL_BLOCKED");
-        return false;
+    for (size_t i = 0; i + 1 < msg.path.len; i++) {
+        if (msg.path.ptr[i] == '.' && msg.path.ptr[i + 1] == '.') {
+            LOG_W("PARSE", "Path traversal blocked!");
+            sendMessage("ERR:PATH_TRAVERSAL_BLOCKED");
+            return false;
+        }
     }
 
-    // Verify HMAC
-    String messageToVerify = msg.substring(0, hashIdx);
-    if (!verifyHMAC(messageToVerify, hmac)) {
-        Serial.println("[AUTH] HMAC verification failed!");
+    // Verify HMAC over SAT_ID-COMMAND&PATH@DATA
+    if (!verifyHMAC((const uint8_t*)buffer, hash - buffer, msg.hmac.ptr, msg.hmac.len)) {
+        LOG_E("AUTH", "HMAC verification failed!");
         sendMessage("ERR:AUTH_FAILED");
         return false;
     }
 
+    // Authentic - terminate fields in place
+    buffer[dash - buffer] = '\0';
+    buffer[amp - buffer] = '\0';
+    buffer[at - buffer] = '\0';
+    buffer[hash - buffer] = '\0';
+    buffer[length] = '\0';
+
     return true;
 }
 
+// Entries are only split here; the envelope HMAC already covered them
+int splitBatch(char* data, size_t length, ParsedMessage* out, size_t maxCommands) {
+    char* end = data + length;
+    char* entry = data;
+    size_t count = 0;
+
+    while (entry < end) {
+        char* sep = (char*)memchr(entry, BATCH_SEPARATOR, end - entry);
+        char* entryEnd = sep ? sep : end;
+
+        if (entryEnd > entry) {
+            int index = (int)count;
+            if (count >= maxCommands) {
+                return -1 - index;
+            }
+
+            // COMMAND&PATH@DATA, same rules as a single command
+            char* amp = (char*)memchr(entry, '&', entryEnd - entry);
+            char* at = amp ? (char*)memchr(amp, '@', entryEnd - amp) : NULL;
+            if (!amp || !at || amp == entry) {
+                return -1 - index;
+            }
+            for (const char* c = entry; c < amp; c++) {
+                if (!isalnum((unsigned char)*c)) return -1 - index;
+            }
+            for (const char* c = amp + 1; c + 1 < at; c++) {
+                if (c[0] == '.' && c[1] == '.') {
+                    LOG_W("PARSE", "Path traversal blocked!");
+                    return -1 - index;
+                }
+            }
+
+            ParsedMessage& msg = out[count++];
+            msg.command.ptr = entry;    msg.command.len = amp - entry;
+            msg.path.ptr = amp + 1;     msg.path.len = at - (amp + 1);
+            msg.data.ptr = at + 1;      msg.data.len = entryEnd - (at + 1);
+            *amp = '\0';
+            *at = '\0';
+        }
+
+        if (!sep) break;
+        *sep = '\0';
+        entry = sep + 1;
+    }
+
+    return (int)count;
+}
+
+// ==================== COMMAND HANDLERS ====================
+
+static void cmdStatus(const ParsedMessage& msg) {
+    LOG_D("CMD", "====================================");
+    LOG_I("CMD", "STATUS REQUEST RECEIVED");
+    LOG_D("CMD", "====================================");
+    sendTelemetry();
+    LOG_I("CMD", "Status request completed");
+}
+
+static void cmdSetTelemetryFormat(const ParsedMessage& msg) {
+    // "@BIN" = compact binary frame, "@TEXT" = legacy string for older ground software
+    if (msg.data.equals("BIN")) {
+        tmrWrite(telemetryFormat, TELEM_FORMAT_BINARY);
+        sendMessage("OK:TELEM_FORMAT:BIN");
+    } else if (msg.data.equals("TEXT")) {
+        tmrWrite(telemetryFormat, TELEM_FORMAT_TEXT);
+        sendMessage("OK:TELEM_FORMAT:TEXT");
+    } else {
+        sendMessage("ERR:INVALID_TELEM_FORMAT");
+    }
+}
+
+static void cmdPing(const ParsedMessage& msg) {
+    char reply[32];
+    snprintf(reply, sizeof(reply), "PONG|");
+    formatMissionTime(reply + 5, sizeof(reply) - 5);
+    sendMessage(reply);
+}
+
+static void cmdListDir(const ParsedMessage& msg) {
+    // "@offset,count,version" pages through the manifest; "@Z" sends the
+    // whole walk as a compressed stream
+    listDir(SD, msg.path.ptr, msg.data.ptr);
+}
+
+static void cmdCreateDir(const ParsedMessage& msg) {
+    createDir(SD, msg.path.ptr);
+}
+
+static void cmdRemoveDir(const ParsedMessage& msg) {
+    removeDir(SD, msg.path.ptr);
+}
+
+static void cmdWriteFile(const ParsedMessage& msg) {
+    writeFile(SD, msg.path.ptr, msg.data.ptr);
+}
+
+static void cmdAppendFile(const ParsedMessage& msg) {
+    appendFile(SD, msg.path.ptr, msg.data.ptr);
+}
+
+static void cmdUploadBegin(const ParsedMessage& msg) {
+    uploadBegin(msg.path.ptr, msg.data.ptr);
+}
+
+static void cmdUploadChunk(const ParsedMessage& msg) {
+    uploadChunk(msg.path.ptr, msg.data.ptr, msg.data.len);
+}
+
+static void cmdUploadStatus(const ParsedMessage& msg) {
+    uploadStatus(msg.path.ptr);
+}
+
+static void cmdUploadAbort(const ParsedMessage& msg) {
+    uploadAbort(msg.path.ptr);
+}
+
+static void cmdNameQuery(const ParsedMessage& msg) {
+    // NameQuery&@Name, or no name for the ledger statistics
+    nameQuery(msg.data.ptr, msg.data.len);
+}
+
+static void cmdNameBatch(const ParsedMessage& msg) {
+    // NameBatch&@Name1|Name2|...
+    nameBatch(msg.data.ptr, msg.data.len);
+}
+
+static void cmdReadFile(const ParsedMessage& msg) {
+    // "@B" selects the binary burst downlink (numbered frames + CRC32),
+    // "@Z" the compressed stream
+    if (msg.data.equals("B")) {
+        readFileBurst(SD, msg.path.ptr);
+    } else if (msg.data.equals("Z")) {
+        readFileCompressed(SD, msg.path.ptr);
+    } else {
+        readFile(SD, msg.path.ptr);
+    }
+}
+
+static void cmdReadFileRange(const ParsedMessage& msg) {
+    readFileRange(SD, msg.path.ptr, msg.data.ptr);
+}
+
+static void cmdRenameFile(const ParsedMessage& msg) {
+    renameFile(SD, msg.path.ptr, msg.data.ptr);
+}
+
+static void cmdDeleteFile(const ParsedMessage& msg) {
+    deleteFile(SD, msg.path.ptr);
+}
+
+static void cmdTestFileIO(const ParsedMessage& msg) {
+    testFileIO(SD, msg.path.ptr);
+}
+
+static void cmdMCURestart(const ParsedMessage& msg) {
+    sendMessage("OK:RESTARTING");
+    txQueueFlush(TX_FLUSH_TIMEOUT);  // Let the reply (and queued packets) go out
+    saveState();
+    logFlush(LOG_FLUSH_TIMEOUT);
+    logUartFlush(LOG_UART_FLUSH_TIMEOUT);
+    ESP.restart();
+}
+
+static void cmdGetState(const ParsedMessage& msg) {
+    char reply[96];
+    snprintf(reply, sizeof(reply), "STATE:%d|BOOTS:%lu|ANT:%s|CONTACTS:%lu|LAST:B%lu+%lus",
+             (int)currentState, (unsigned long)bootCount,
+             antennaDeployed ? "DEPLOYED" : "PENDING",
+             (unsigned long)groundContactsTotal, (unsigned long)lastContactBoot,
+             (unsigned long)lastContactSecs);
+    sendMessage(reply);
+}
+
+static void cmdGetPerf(const ParsedMessage& msg) {
+    // Latency histograms since boot; "@RESET" clears them after this report
+    char reply[PERF_SUMMARY_MAX];
+    perfSummary(reply, sizeof(reply));
+    sendMessage(reply);
+    if (msg.data.equals("RESET")) {
+        perfReset();
+    }
+}
+
+static void cmdSetLinkProfile(const ParsedMessage& msg) {
+    // "@AUTO" takes the fastest profile the pass estimate allows, "@0".."@2"
+    // a given one, "@" only reports. Applies to bulk downlinks only.
+    int profile = linkBulkProfile();
+    if (msg.data.equals("AUTO")) {
+        profile = linkRequest(LINK_PROFILE_AUTO);
+    } else if (msg.data.len == 1 && msg.data.ptr[0] >= '0' && msg.data.ptr[0] < '0' + LINK_PROFILES) {
+        profile = linkRequest(msg.data.ptr[0] - '0');
+    } else if (msg.data.len > 0) {
+        sendMessage("ERR:LINK_BAD_PROFILE");
+        return;
+    }
+
+    const LinkPass& pass = linkPass();
+    Reply reply;
+    if (profile < 0) {
+        reply.add("ERR:LINK_MARGIN:").add(msg.data.ptr);
+    } else {
+        const LinkProfile& p = LINK_PROFILE_TABLE[profile];
+        reply.add("OK:LINK:").addU(profile).add(",SF").addU(p.sf).add(",CR4/").addU(p.cr);
+        LOG_I("LINK", "Bulk profile %d (SF%u CR4/%u), SNR %.1f dB over %u uplinks",
+              profile, p.sf, p.cr, pass.snrAvg, pass.uplinks);
+    }
+    reply.add(",SNR:").addF(pass.snrAvg, 1).add(",UP:").addU(pass.uplinks);
+    sendMessage(reply);
+}
+
+static void cmdForceOperational(const ParsedMessage& msg) {
+    // Emergency command to skip antenna deployment
+    tmrWrite(antennaDeployed, true);
+    tmrWrite(currentState, STATE_OPERATIONAL);
+    saveState();
+    sendMessage("OK:FORCED_OPERATIONAL");
+}
+
+static void cmdGetRadStatus(const ParsedMessage& msg) {
+    // Variable with the most corrections, to tell a weak cell from random hits
+    uint32_t hot = 0, hotCount = 0;
+    for (uint32_t i = 0; i < tmrBlockCount(); i++) {
+        uint32_t n = tmrBlockCorrections(i);
+        if (n > hotCount) {
+            hot = i;
+            hotCount = n;
+        }
+    }
+
+    char reply[96];
+    int len = snprintf(reply, sizeof(reply), "RAD:SEU_TOTAL:%lu|LAST_SCRUB:%lus_ago|TMR:%luB",
+                       (unsigned long)seuCorrectionsTotal,
+                       (unsigned long)((millis() - lastScrubTime) / 1000),
+                       (unsigned long)tmrUsedWords() * 4);
+    if (hotCount > 0 && len > 0 && len < (int)sizeof(reply)) {
+        snprintf(reply + len, sizeof(reply) - len, "|HOT:%s:%lu",
+                 tmrBlockAt(hot)->name, (unsigned long)hotCount);
+    }
+    sendMessage(reply);
+}
+
+// ==================== ACCELEROMETER RECORDING COMMANDS ====================
+
+static void cmdAccelRecord(const ParsedMessage& msg) {
+    // Start 60-second FIFO capture; data selects the rate (119/238/476 Hz)
+    uint16_t rate = ACCEL_RATE_DEFAULT;
+    if (msg.data.len > 0) {
+        rate = (uint16_t)atoi(msg.data.ptr);
+    }
+    accelStartRecording(rate);
+}
+
+static void cmdAccelStatus(const ParsedMessage& msg) {
+    MsgBuf<96> reply;
+    getAccelStatus(reply);
+    sendMessage(reply);
+}
+
+static void cmdAccelList(const ParsedMessage& msg) {
+    accelListRecordings(msg.data.ptr);
+}
+
+static void cmdAccelCancel(const ParsedMessage& msg) {
+    accelCancelRecording();
+}
+
+static void cmdAccelAnalyze(const ParsedMessage& msg) {
+    // Path selects the recording, empty = the last one
+    accelAnalyze(msg.path.ptr);
+}
+
+// ==================== ARTWORK ASCENSION COMMANDS ====================
+
+static void cmdArtworkAscension(const ParsedMessage& msg) {
+    // Store artwork reference (IPFS CID + metadata) - artwork ascends to orbit
+    // Data format: IPFS_CID|ArtistName|WorkTitle
+    const char* data = msg.data.ptr;
+    const char* pipe1 = strchr(data, '|');
+    const char* pipe2 = strrchr(data, '|');
+
+    if (!pipe1 || pipe1 == pipe2) {
+        LOG_W("ART", "Invalid format, expected: IPFS_CID|ArtistName|WorkTitle");
+        sendMessage("ERR:ART_INVALID_FORMAT");
+        return;
+    }
+
+    int cidLen = pipe1 - data;
+    int artistLen = pipe2 - (pipe1 + 1);
+    const char* workTitle = pipe2 + 1;
+
+    // Validate IPFS CID (should start with Qm or bafy for CIDv0/v1)
+    if (cidLen < 10 || cidLen > ART_CID_MAX) {
+        LOG_W("ART", "Invalid IPFS CID");
+        sendMessage("ERR:ART_INVALID_CID");
+        return;
+    }
+
+    if (artistLen == 0 || workTitle[0] == '\0') {
+        LOG_W("ART", "Missing artist name or work title");
+        sendMessage("ERR:ART_MISSING_METADATA");
+        return;
+    }
+
+    // A resend after a lost reply must not store the same CID twice
+    int32_t existing = artworkFind(data, cidLen);
+    if (existing >= 0) {
+        char reply[RX_MAX_PACKET + 1];
+        snprintf(reply, sizeof(reply), "OK:ART_EXISTS|%.*s|#%ld", cidLen, data, (long)existing + 1);
+        sendMessage(reply);
+        return;
+    }
+
+    // Log artwork to SD card: T+HH:MM:SS|CID|Artist|Title
+    char artEntry[RX_MAX_PACKET + 20];
+    formatMissionTime(artEntry, sizeof(artEntry));
+    size_t prefix = strlen(artEntry);
+    snprintf(artEntry + prefix, sizeof(artEntry) - prefix, "|%s", data);
+
+    char reply[RX_MAX_PACKET + 1];
+    if (logArtwork(artEntry)) {
+        LOG_I("ART", "Artwork stored: %s", artEntry);
+        snprintf(reply, sizeof(reply), "OK:ART_STORED|%.*s", cidLen, data);
+        sendMessage(reply);
+    } else {
+        LOG_E("ART", "Failed to store artwork");
+        sendMessage("ERR:ART_STORE_FAILED");
+    }
+}
+
+static void cmdArtworkList(const ParsedMessage& msg) {
+    // Optional paging: artworkList&offset@count (both default to everything)
+    uint32_t offset = msg.path.len > 0 ? strtoul(msg.path.ptr, NULL, 10) : 0;
+    uint32_t count = msg.data.len > 0 ? strtoul(msg.data.ptr, NULL, 10) : 0;
+    listArtworks(offset, count);
+}
+
+static void cmdArtworkGet(const ParsedMessage& msg) {
+    // artworkGet&CID
+    if (msg.path.len == 0) {
+        sendMessage("ERR:ART_INVALID_CID");
+        return;
+    }
+    getArtwork(msg.path.ptr);
+}
+
+// ==================== BATCHED COMMANDS ====================
+// Replies of the running sub-command arrive through the reply sink and are
+// packed into frames of up to TX_MAX_PACKET bytes.
+
+#define BATCH_BODY_MAX (TX_MAX_PACKET - BATCH_HEADER_MAX)
+
+static char batchBody[BATCH_BODY_MAX];
+static size_t batchBodyLen = 0;
+static uint8_t batchFrame = 0;
+static int batchCurrent = 0;            // Sub-command running
+static bool batchReplied = false;       // It sent at least one reply
+static bool batchFailed = false;        // One of them was "ERR:..."
+
+static void dispatchCommand(const ParsedMessage& msg);
+
+static void batchFlush(bool last, int commands, int failed) {
+    char packet[TX_MAX_PACKET];
+    int len = last
+        ? snprintf(packet, sizeof(packet), "BATCH:%u|N:%d|FAILED:%d\n", batchFrame, commands, failed)
+        : snprintf(packet, sizeof(packet), "BATCH:%u\n", batchFrame);
+    memcpy(packet + len, batchBody, batchBodyLen);
+    sendPacket((const uint8_t*)packet, len + batchBodyLen, TX_PRIO_REPLY);
+    batchFrame++;
+    batchBodyLen = 0;
+}
+
+static void batchAddLine(const char* text, size_t length) {
+    char prefix[8];
+    size_t prefixLen = snprintf(prefix, sizeof(prefix), "%d:", batchCurrent);
+
+    if (prefixLen + length > BATCH_BODY_MAX) {
+        // Too long for any frame: keep the order, send it on its own
+        if (batchBodyLen > 0) batchFlush(false, 0, 0);
+        sendPacket((const uint8_t*)text, length, TX_PRIO_REPLY);
+        text = "SENT";
+        length = 4;
+    }
+
+    size_t needed = prefixLen + length + (batchBodyLen > 0 ? 1 : 0);
+    if (batchBodyLen + needed > BATCH_BODY_MAX) {
+        batchFlush(false, 0, 0);
+    }
+    if (batchBodyLen > 0) {
+        batchBody[batchBodyLen++] = '\n';
+    }
+    memcpy(batchBody + batchBodyLen, prefix, prefixLen);
+    memcpy(batchBody + batchBodyLen + prefixLen, text, length);
+    batchBodyLen += prefixLen + length;
+}
+
+static void batchReplySink(const char* text, size_t length) {
+    batchReplied = true;
+    if (length >= 4 && memcmp(text, "ERR:", 4) == 0) {
+        batchFailed = true;
+    }
+    batchAddLine(text, length);
+}
+
+static void cmdBatch(const ParsedMessage& msg) {
+    // Data lives in the RX buffer, which the parser already writes to
+    ParsedMessage commands[BATCH_MAX_COMMANDS];
+    int count = splitBatch((char*)msg.data.ptr, msg.data.len, commands, BATCH_MAX_COMMANDS);
+    if (count <= 0) {
+        char reply[32];
+        if (count == 0) {
+            snprintf(reply, sizeof(reply), "ERR:BATCH_EMPTY");
+        } else {
+            snprintf(reply, sizeof(reply), "ERR:BATCH_INVALID:%d", -1 - count);
+        }
+        sendMessage(reply);
+        return;
+    }
+
+    LOG_I("BATCH", "%d commands", count);
+    batchBodyLen = 0;
+    batchFrame = 0;
+    int failed = 0;
+
+    setReplySink(batchReplySink);
+    for (int i = 0; i < count; i++) {
+        commands[i].satId = msg.satId;
+        commands[i].hmac = msg.hmac;
+        batchCurrent = i;
+        batchReplied = false;
+        batchFailed = false;
+
+        const CommandEntry* entry = findCommand(commands[i].command);
+        if (entry != NULL && (entry->flags & CMD_NO_BATCH)) {
+            sendMessage("ERR:NOT_BATCHABLE");
+        } else {
+            dispatchCommand(commands[i]);
+        }
+
+        if (!batchReplied) {
+            batchAddLine("OK", 2);
+        }
+        if (batchFailed) {
+            failed++;
+        }
+    }
+    setReplySink(NULL);
+
+    batchFlush(true, count, failed);
+    LOG_I("BATCH", "Done, %d failed, %u frames", failed, batchFrame);
+}
+
+// ==================== COMMAND TABLE ====================
+// Sorted by strcmp() order (uppercase before lowercase) for binary search.
+// Add new commands here - the static_assert below rejects an unsorted table.
+
+static constexpr CommandEntry COMMAND_TABLE[] = {
+    { "AccelAnalyze",       cmdAccelAnalyze,       CMD_REQUIRES_SD },
+    { "AccelCancel",        cmdAccelCancel,        0 },
+    { "AccelList",          cmdAccelList,          CMD_REQUIRES_SD },
+    { "AccelRecord",        cmdAccelRecord,        CMD_REQUIRES_SD | CMD_MUTATING },
+    { "AccelStatus",        cmdAccelStatus,        0 },
+    { "AppendFile",         cmdAppendFile,         CMD_REQUIRES_SD | CMD_MUTATING },
+    { "Batch",              cmdBatch,              CMD_NO_BATCH },
+    { "CreateDir",          cmdCreateDir,          CMD_REQUIRES_SD | CMD_MUTATING },
+    { "DeleteFile",         cmdDeleteFile,         CMD_REQUIRES_SD | CMD_MUTATING },
+    { "ForceOperational",   cmdForceOperational,   CMD_MUTATING },
+    { "GetPerf",            cmdGetPerf,            0 },
+    { "GetRadStatus",       cmdGetRadStatus,       0 },
+    { "GetState",           cmdGetState,           0 },
+    { "ListDir",            cmdListDir,            CMD_REQUIRES_SD },
+    { "MCURestart",         cmdMCURestart,         CMD_NO_BATCH },
+    { "NameBatch",          cmdNameBatch,          CMD_REQUIRES_SD | CMD_MUTATING },
+    { "NameQuery",          cmdNameQuery,          CMD_REQUIRES_SD },
+    { "Ping",               cmdPing,               0 },
+    { "ReadFile",           cmdReadFile,           CMD_REQUIRES_SD },
+    { "ReadFileRange",      cmdReadFileRange,      CMD_REQUIRES_SD },
+    { "RemoveDir",          cmdRemoveDir,          CMD_REQUIRES_SD | CMD_MUTATING },
+    { "RenameFile",         cmdRenameFile,         CMD_REQUIRES_SD | CMD_MUTATING },
+    { "SetLinkProfile",     cmdSetLinkProfile,     0 },
+    { "SetTelemetryFormat", cmdSetTelemetryFormat, 0 },
+    { "Status",             cmdStatus,             0 },
+    { "TestFileIO",         cmdTestFileIO,         CMD_REQUIRES_SD },
+    { "UploadAbort",        cmdUploadAbort,        CMD_REQUIRES_SD | CMD_MUTATING },
+    { "UploadBegin",        cmdUploadBegin,        CMD_REQUIRES_SD | CMD_MUTATING },
+    { "UploadChunk",        cmdUploadChunk,        CMD_REQUIRES_SD },   // Audited once, by UploadBegin
+    { "UploadStatus",       cmdUploadStatus,       CMD_REQUIRES_SD },
+    { "WriteFile",          cmdWriteFile,          CMD_REQUIRES_SD | CMD_MUTATING },
+    { "artworkAscension",   cmdArtworkAscension,   CMD_REQUIRES_SD | CMD_MUTATING },
+    { "artworkGet",         cmdArtworkGet,         CMD_REQUIRES_SD },
+    { "artworkList",        cmdArtworkList,        CMD_REQUIRES_SD },
+};
+
+static constexpr size_t COMMAND_COUNT = sizeof(COMMAND_TABLE) / sizeof(COMMAND_TABLE[0]);
+
+// C++11 constexpr (single-return recursion) so the order is checked at compile time
+static constexpr int constStrCmp(const char* a, const char* b) {
+    return (*a != *b || *a == '\0')
+        ? (int)(unsigned char)*a - (int)(unsigned char)*b
+        : constStrCmp(a + 1, b + 1);
+}
+
+static constexpr bool commandTableSorted(size_t i) {
+    return (i + 1 >= COMMAND_COUNT)
+        ? true
+        : (constStrCmp(COMMAND_TABLE[i].name, COMMAND_TABLE[i + 1].name) < 0 &&
+           commandTableSorted(i + 1));
+}
+
+static_assert(commandTableSorted(0), "COMMAND_TABLE must be sorted by name (strcmp order)");
+
+// Compare a NUL-terminated table name with a command view
+static int compareCommand(const char* name, const StrView& cmd) {
+    int r = strncmp(name, cmd.ptr, cmd.len);
+    if (r != 0) return r;
+    return name[cmd.len] == '\0' ? 0 : 1;   // Longer table name sorts after
+}
+
+const CommandEntry* findCommand(const StrView& name) {
+    size_t lo = 0;
+    size_t hi = COMMAND_COUNT;
+
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        int r = compareCommand(COMMAND_TABLE[mid].name, name);
+        if (r == 0) return &COMMAND_TABLE[mid];
+        if (r < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return NULL;
+}
+
 // ==================== COMMAND PROCESSING ====================
-void processMessage(const String& message) {
+void processMessage(char* buffer, size_t length, float rssi, float snr) {
+    PerfScope perf(PERF_PROCESS);
     feedWatchdog();
 
-    Serial.println("[MSG] Processing: " + message);
+    LOG_D("MSG", "Processing: %.*s", (int)length, buffer);
 
-    String satId, command, path, data, hmac;
+    ParsedMessage msg;
 
     // Validate and parse message
-    if (!validateMessage(message, satId, command, path, data, hmac)) {
-        Serial.println("[MSG] Invalid message, ignoring");
+    if (!validateMessage(buffer, length, msg)) {
+        LOG_W("MSG", "Invalid message, ignoring");
         soakCommandsFailed++;  // Track for soak test
         return;
     }
 
-    Serial.println("[MSG] Valid message received");
+    LOG_I("MSG", "Valid message received");
     soakCommandsReceived++;  // Track for soak test
-    Serial.println("[MSG] Command: " + command);
-    Serial.println("[MSG] Path: " + path);
-    Serial.println("[MSG] Data: " + data);
+    LOG_D("MSG", "Command: %s", msg.command.ptr);
+    LOG_D("MSG", "Path: %s", msg.path.ptr);
+    LOG_D("MSG", "Data: %s", msg.data.ptr);
 
     // Register ground contact (for beacon timing)
     registerGroundContact();
 
-    // Convert path and data to C strings for SD operations
-    const char* pathCStr = path.c_str();
-    const char* dataCStr = data.c_str();
+    // Link estimate from authenticated uplinks only
+    uint8_t profile = linkBulkProfile();
+    linkUplink(rssi, snr, millis());
+    if (linkBulkProfile() != profile) {
+        LOG_W("LINK", "SNR down to %.1f dB, bulk back on the safe profile", linkPass().snrAvg);
+    }
 
-    // Process command
-    if (command.equals("Status")) {
-        Serial.println("[CMD] ====================================");
-        Serial.println("[CMD] STATUS REQUEST RECEIVED");
-        Serial.println("[CMD] ====================================");
-        sendTelemetry();
-        Serial.println("[CMD] Status request completed");
-    }
-    else if (command.equals("Ping")) {
-        Serial.println("[CMD] Ping");
-        sendMessage("PONG|" + getMissionTime());
-    }
-    else if (command.equals("ListDir")) {
-        Serial.println("[CMD] List directory");
-        listDir(SD, pathCStr, 0);
-    }
-    else if (command.equals("CreateDir")) {
-        Serial.println("[CMD] Create directory");
-        createDir(SD, pathCStr);
-    }
-    else if (command.equals("RemoveDir")) {
-        Serial.println("[CMD] Remove directory");
-        removeDir(SD, pathCStr);
-    }
-    else if (command.equals("WriteFile")) {
-        Serial.println("[CMD] Write file");
-        writeFile(SD, pathCStr, dataCStr);
-    }
-    else if (command.equals("AppendFile")) {
-        Serial.println("[CMD] Append to file");
-        appendFile(SD, pathCStr, dataCStr);
-    }
-    else if (command.equals("ReadFile")) {
-        Serial.println("[CMD] Read file");
-        readFile(SD, pathCStr);
-    }
-    else if (command.equals("RenameFile")) {
-        Serial.println("[CMD] Rename file");
-        renameFile(SD, pathCStr, dataCStr);
-    }
-    else if (command.equals("DeleteFile")) {
-        Serial.println("[CMD] Delete file");
-        deleteFile(SD, pathCStr);
-    }
-    else if (command.equals("TestFileIO")) {
-        Serial.println("[CMD] Test file I/O");
-        testFileIO(SD, pathCStr);
-    }
-    else if (command.equals("MCURestart")) {
-        Serial.println("[CMD] MCU restart requested");
-        sendMessage("OK:RESTARTING");
-        delay(500);
-        saveState();
-        ESP.restart();
-    }
-    else if (command.equals("GetState")) {
-        Serial.println("[CMD] Get state");
-        String stateMsg = "STATE:" + String((int)currentState);
-        stateMsg += "|BOOTS:" + String(bootCount);
-        stateMsg += "|ANT:" + String(antennaDeployed ? "DEPLOYED" : "PENDING");
-        sendMessage(stateMsg);
-    }
-    else if (command.equals("ForceOperational")) {
-        // Emergency command to skip antenna deployment
-        Serial.println("[CMD] Force operational mode");
-        antennaDeployed = true;
-        currentState = STATE_OPERATIONAL;
-        saveState();
-        sendMessage("OK:FORCED_OPERATIONAL");
-    }
-    else if (command.equals("GetRadStatus")) {
-        // Get radiation protection status
-        Serial.println("[CMD] Get radiation status");
-        String radMsg = "RAD:SEU_TOTAL:";
-        radMsg += String(seuCorrectionsTotal);
-        radMsg += "|LAST_SCRUB:";
-        radMsg += String((millis() - lastScrubTime) / 1000);
-        radMsg += "s_ago";
-        sendMessage(radMsg);
-    }
-    // ==================== ACCELEROMETER RECORDING COMMANDS ====================
-    else if (command.equals("AccelRecord")) {
-        // Start 60-second accelerometer recording at 30Hz
-        Serial.println("[CMD] Accel record");
-        accelStartRecording();
-    }
-    else if (command.equals("AccelStatus")) {
-        // Get accelerometer recording status
-        Serial.println("[CMD] Accel status");
-        sendMessage(getAccelStatus());
-    }
-    else if (command.equals("AccelList")) {
-        // List available accelerometer recordings
-        Serial.println("[CMD] Accel list");
-        accelListRecordings();
-    }
-    else if (command.equals("AccelCancel")) {
-        // Cancel current accelerometer recording
-        Serial.println("[CMD] Accel cancel");
-        accelCancelRecording();
-    }
-    // ==================== ARTWORK ASCENSION COMMAND ====================
-    else if (command.equals("artworkAscension")) {
-        // Store artwork reference (IPFS CID + metadata) - artwork ascends to orbit
-        // Data format: IPFS_CID|ArtistName|WorkTitle
-        Serial.println("[CMD] artworkAscension");
-
-        // Parse the data: IPFS_CID|ArtistName|WorkTitle
-        int pipe1 = data.indexOf('|');
-        int pipe2 = data.lastIndexOf('|');
-
-        if (pipe1 == -1 || pipe2 == -1 || pipe1 == pipe2) {
-            Serial.println("[ART] Invalid format, expected: IPFS_CID|ArtistName|WorkTitle");
-            sendMessage("ERR:ART_INVALID_FORMAT");
-        } else {
-            String ipfsCID = data.substring(0, pipe1);
-            String artistName = data.substring(pipe1 + 1, pipe2);
-            String workTitle = data.substring(pipe2 + 1);
-
-            // Validate IPFS CID (should start with Qm or bafy for CIDv0/v1)
-            if (ipfsCID.length() < 10) {
-                Serial.println("[ART] Invalid IPFS CID");
-                sendMessage("ERR:ART_INVALID_CID");
-            } else if (artistName.length() == 0 || workTitle.length() == 0) {
-                Serial.println("[ART] Missing artist name or work title");
-                sendMessage("ERR:ART_MISSING_METADATA");
-            } else {
-                // Log artwork to SD card
-                String artEntry = getMissionTime() + "|" + ipfsCID + "|" + artistName + "|" + workTitle;
+    dispatchCommand(msg);
+}
 
-                if (logArtwork(artEntry.c_str())) {
-                    Serial.println("[ART] Artwork stored: " + artEntry);
-                    sendMessage("OK:ART_STORED|" + ipfsCID);
-                } else {
-                    Serial.println("[ART] Failed to store artwork");
-                    sendMessage("ERR:ART_STORE_FAILED");
-                }
-            }
-        }
+// Look up and run one command (a whole message, or one entry of a Batch)
+static void dispatchCommand(const ParsedMessage& msg) {
+    const CommandEntry* entry = findCommand(msg.command);
+    if (entry == NULL) {
+        LOG_W("CMD", "Unknown command: %s", msg.command.ptr);
+        char reply[RX_MAX_PACKET + 1];
+        snprintf(reply, sizeof(reply), "ERR:UNKNOWN_CMD:%s", msg.command.ptr);
+        sendMessage(reply);
+        return;
     }
-    else if (command.equals("artworkList")) {
-        // List all ascended artworks
-        Serial.println("[CMD] artworkList");
-        listArtworks();
+
+    LOG_I("CMD", "%s", entry->name);
+
+    if ((entry->flags & CMD_REQUIRES_SD) && !isSDAvailable()) {
+        return;  // isSDAvailable() already replied ERR:SD_NOT_AVAILABLE
     }
-    else {
-        Serial.println("[CMD] Unknown command: " + command);
-        sendMessage("ERR:UNKNOWN_CMD:" + command);
+
+    // Audit trail for everything that changes stored state
+    if ((entry->flags & CMD_MUTATING) && SDOK) {
+        char audit[96];
+        snprintf(audit, sizeof(audit), "CMD|%s|%.60s", entry->name, msg.path.ptr);
+        logToSD(audit);
     }
+
+    entry->handler(msg);
 }
 
 // ==================== ANTENNA DEPLOYMENT STATE MACHINE ====================
+
+// Deployment report: "<event>|T+hh:mm:ss"
+static void sendAntennaEvent(const char* event) {
+    MsgBuf<48> reply;
+    reply.add(event).add('|');
+    addMissionTime(reply);
+    sendMessage(reply);
+}
+
 void handleAntennaDeployment() {
     unsigned long now = millis();
     unsigned long elapsed = now - stateStartTime;
@@ -459,19 +966,19 @@ void handleAntennaDeployment() {
             // Check switch state
             if (digitalRead(AntSwitch) == HIGH) {
                 // Switch pressed, start heating
-                Serial.println("[ANT] Switch pressed, starting burn wire heating");
+                LOG_I("ANT", "Switch pressed, starting burn wire heating");
                 digitalWrite(R1, HIGH);
-                antennaState = ANT_HEATING;
+                tmrWrite(antennaState, ANT_HEATING);
                 stateStartTime = now;
             } else {
                 // Switch released - antenna deployed!
-                Serial.println("[ANT] Switch released - antenna deployed!");
+                LOG_I("ANT", "Switch released - antenna deployed!");
                 digitalWrite(R1, LOW);
-                antennaDeployed = true;
-                antennaState = ANT_COMPLETE;
-                currentState = STATE_OPERATIONAL;
+                tmrWrite(antennaDeployed, true);
+                tmrWrite(antennaState, ANT_COMPLETE);
+                tmrWrite(currentState, STATE_OPERATIONAL);
                 saveState();
-                sendMessage("OK:ANTENNA_DEPLOYED|" + getMissionTime());
+                sendAntennaEvent("OK:ANTENNA_DEPLOYED");
             }
             break;
 
@@ -480,21 +987,21 @@ void handleAntennaDeployment() {
 
             if (elapsed >= DEPLOY_HEAT_TIME) {
                 // Done heating, start cooling
-                Serial.println("[ANT] Heating complete, cooling down");
+                LOG_I("ANT", "Heating complete, cooling down");
                 digitalWrite(R1, LOW);
-                antennaState = ANT_COOLING;
+                tmrWrite(antennaState, ANT_COOLING);
                 stateStartTime = now;
             }
 
             // Check if switch released during heating
             if (digitalRead(AntSwitch) == LOW) {
-                Serial.println("[ANT] Switch released during heating - success!");
+                LOG_I("ANT", "Switch released during heating - success!");
                 digitalWrite(R1, LOW);
-                antennaDeployed = true;
-                antennaState = ANT_COMPLETE;
-                currentState = STATE_OPERATIONAL;
+                tmrWrite(antennaDeployed, true);
+                tmrWrite(antennaState, ANT_COMPLETE);
+                tmrWrite(currentState, STATE_OPERATIONAL);
                 saveState();
-                sendMessage("OK:ANTENNA_DEPLOYED|" + getMissionTime());
+                sendAntennaEvent("OK:ANTENNA_DEPLOYED");
             }
             break;
 
@@ -504,28 +1011,28 @@ void handleAntennaDeployment() {
             if (elapsed >= DEPLOY_COOL_TIME) {
                 // Check if deployment successful
                 if (digitalRead(AntSwitch) == LOW) {
-                    Serial.println("[ANT] Deployment successful after cooling");
-                    antennaDeployed = true;
-                    antennaState = ANT_COMPLETE;
-                    currentState = STATE_OPERATIONAL;
+                    LOG_I("ANT", "Deployment successful after cooling");
+                    tmrWrite(antennaDeployed, true);
+                    tmrWrite(antennaState, ANT_COMPLETE);
+                    tmrWrite(currentState, STATE_OPERATIONAL);
                     saveState();
-                    sendMessage("OK:ANTENNA_DEPLOYED|" + getMissionTime());
+                    sendAntennaEvent("OK:ANTENNA_DEPLOYED");
                 } else {
                     // Still not deployed, need to retry
-                    deployRetryCount++;
-                    Serial.printf("[ANT] Deployment attempt %d failed\n", deployRetryCount);
+                    tmrWrite(deployRetryCount, deployRetryCount + 1);
+                    LOG_E("ANT", "Deployment attempt %d failed", deployRetryCount);
 
                     if (deployRetryCount >= DEPLOY_MAX_RETRIES) {
-                        Serial.println("[ANT] Max retries reached!");
-                        sendMessage("ERR:ANT_DEPLOY_FAILED|" + getMissionTime());
+                        LOG_E("ANT", "Max retries reached!");
+                        sendAntennaEvent("ERR:ANT_DEPLOY_FAILED");
                         // Continue to operational anyway - we tried our best
-                        currentState = STATE_OPERATIONAL;
+                        tmrWrite(currentState, STATE_OPERATIONAL);
                         saveState();
                     } else {
                         // Wait before retry
-                        antennaState = ANT_RETRY_WAIT;
+                        tmrWrite(antennaState, ANT_RETRY_WAIT);
                         stateStartTime = now;
-                        sendMessage("WARN:ANT_RETRY_WAIT|" + getMissionTime());
+                        sendAntennaEvent("WARN:ANT_RETRY_WAIT");
                     }
                 }
             }
@@ -535,19 +1042,19 @@ void handleAntennaDeployment() {
             feedWatchdog();
 
             if (elapsed >= DEPLOY_RETRY_WAIT) {
-                Serial.println("[ANT] Retry wait complete, attempting again");
-                antennaState = ANT_IDLE;
+                LOG_I("ANT", "Retry wait complete, attempting again");
+                tmrWrite(antennaState, ANT_IDLE);
                 stateStartTime = now;
             }
 
             // Check if switch released during wait
             if (digitalRead(AntSwitch) == LOW) {
-                Serial.println("[ANT] Switch released during wait - success!");
-                antennaDeployed = true;
-                antennaState = ANT_COMPLETE;
-                currentState = STATE_OPERATIONAL;
+                LOG_I("ANT", "Switch released during wait - success!");
+                tmrWrite(antennaDeployed, true);
+                tmrWrite(antennaState, ANT_COMPLETE);
+                tmrWrite(currentState, STATE_OPERATIONAL);
                 saveState();
-                sendMessage("OK:ANTENNA_DEPLOYED|" + getMissionTime());
+                sendAntennaEvent("OK:ANTENNA_DEPLOYED");
             }
             break;
 
@@ -557,211 +1064,317 @@ void handleAntennaDeployment() {
     }
 }
 
+// ==================== SCHEDULED JOBS ====================
+// Everything time-driven in mainLoop() is a scheduler job; the loop itself
+// only services events (radio, bulk downlinks) and state transitions.
+
+#define BEACON_STATE_RECHECK   1000UL     // While not in a beaconing state
+#define COUNTDOWN_PRINT_INTERVAL 300000UL // Beacon countdown box (5 min)
+#define RADIO_CHECK_INTERVAL   1000UL     // radioNeedsRecovery() poll
+#define RECOVERY_INTERVAL      5000UL     // STATE_ERROR recovery attempts
+
+static SchedJob jobBeaconId = SCHED_NONE;
+static SchedJob jobTelemetryId = SCHED_NONE;
+static SchedJob jobDeployWaitId = SCHED_NONE;
+static unsigned long loopIdleMs = 0;
+
+static bool beaconingState() {
+    return currentState == STATE_WAIT_DEPLOY || currentState == STATE_OPERATIONAL;
+}
+
+// Time until the next beacon is due. A connected satellite whose contact
+// ages past BEACON_LOST_THRESHOLD switches to the short interval, so the
+// deadline is the earlier of the two.
+static unsigned long beaconDelay(unsigned long now) {
+    unsigned long interval = getBeaconInterval();
+    unsigned long since = now - lastBeaconTime;
+    unsigned long delay = since < interval ? interval - since : 0;
+
+    if (groundContactEstablished) {
+        unsigned long age = now - lastGroundContact;
+        if (age <= BEACON_LOST_THRESHOLD) {
+            unsigned long toLost = BEACON_LOST_THRESHOLD - age + 1;
+            unsigned long lostDue = since < BEACON_INTERVAL_LOST ? BEACON_INTERVAL_LOST - since : 0;
+            unsigned long lostDelay = toLost > lostDue ? toLost : lostDue;
+            if (lostDelay < delay) delay = lostDelay;
+        }
+    }
+    return delay;
+}
+
+static void jobBeacon(unsigned long now) {
+    if (!beaconingState()) {
+        schedAfter(jobBeaconId, BEACON_STATE_RECHECK, now);
+        return;
+    }
+
+    if (now - lastBeaconTime >= getBeaconInterval()) {
+        LOG_I("BEACON", ">>> INTERVAL REACHED - SENDING BEACON NOW <<<");
+        sendBeacon();
+        // lastBeaconTime is updated inside sendBeacon()
+    }
+    schedAfter(jobBeaconId, beaconDelay(now), now);
+}
+
+static void jobTelemetry(unsigned long now) {
+    // Periodic telemetry (in addition to beacon)
+    if (currentState == STATE_OPERATIONAL) {
+        sendTelemetry();
+    }
+}
+
+static void jobDeployWait(unsigned long now) {
+    // Non-blocking wait before antenna deployment (RX stays live meanwhile)
+    if (currentState == STATE_WAIT_DEPLOY) {
+        LOG_I("STATE", "Wait complete, starting deployment");
+        tmrWrite(currentState, STATE_DEPLOYING);
+        tmrWrite(antennaState, ANT_IDLE);
+        stateStartTime = now;
+    }
+}
+
+static void jobWatchdog(unsigned long now) {
+    feedWatchdog();
+}
+
+static void jobScrub(unsigned long now) {
+    // Radiation protection - complete a TMR pass the loop ticks did not,
+    // and check the name filter (RAM outside TMR)
+    scrubTMRPass();
+    namesScrub();
+}
+
+static void jobJournal(unsigned long now) {
+    // Sector erase for the state journal, while nothing is waiting on a save
+    stateJournalTick();
+}
+
+static void jobUpload(unsigned long now) {
+    // Chunks buffered at the end of a pass go to the card
+    uploadTick(now);
+}
+
+static void jobLink(unsigned long now) {
+    LinkEvent event = linkTick(now);
+    if (event == LINK_EVENT_FALLBACK) {
+        LOG_W("LINK", "Fast bulk transfers not acknowledged, back on the safe profile");
+    } else if (event == LINK_EVENT_PASS_END) {
+        // Per-pass statistics, kept on the card for tuning the thresholds
+        char line[LINK_PASS_LINE_MAX];
+        linkFormatPass(line, sizeof(line));
+        LOG_I("LINK", "Pass over: %s", line);
+        if (SDOK) logToSD(line);
+    }
+}
+
+static void jobSoakHourly(unsigned long now) {
+    soakLogHourly();
+    soakLastHourlyLog = now;
+}
+
+static void jobSoakDaily(unsigned long now) {
+    soakLogDaily();
+    soakLastDailyLog = now;
+}
+
+static void jobRadioCheck(unsigned long now) {
+    if (currentState == STATE_OPERATIONAL && radioNeedsRecovery()) {
+        LOG_W("STATE", "Radio needs recovery");
+        if (!recoverRadio()) {
+            LOG_E("STATE", "Radio recovery failed, restarting...");
+            saveState();
+            logFlush(LOG_FLUSH_TIMEOUT);
+            logUartFlush(LOG_UART_FLUSH_TIMEOUT);
+            ESP.restart();
+        }
+    }
+}
+
+static void jobErrorRecovery(unsigned long now) {
+    // Error state - try to recover (non-blocking)
+    if (currentState == STATE_ERROR) {
+        LOG_E("STATE", "Error state, attempting recovery");
+        feedWatchdog();
+
+        if (recoverRadio()) {
+            tmrWrite(currentState, STATE_OPERATIONAL);
+            stateStartTime = 0;
+        }
+    }
+}
+
+// ==================== BEACON COUNTDOWN (every 5 min) ====================
+static void jobBeaconCountdown(unsigned long now) {
+    if (currentState != STATE_OPERATIONAL) return;
+
+    // Beacon interval depends on ground contact status:
+    // - Before first contact: every 4 minutes (frequent)
+    // - After contact established: every 1 hour (normal)
+    // - After 24h without contact: every 8 minutes (lost mode)
+    unsigned long beaconInterval = getBeaconInterval();
+    unsigned long timeSinceLastBeacon = now - lastBeaconTime;
+    unsigned long timeUntilBeacon = (timeSinceLastBeacon < beaconInterval)
+        ? (beaconInterval - timeSinceLastBeacon) : 0;
+
+    unsigned long minutesUntil = timeUntilBeacon / 60000UL;
+    unsigned long secondsUntil = (timeUntilBeacon % 60000UL) / 1000UL;
+
+    unsigned long minutesSince = timeSinceLastBeacon / 60000UL;
+    unsigned long secondsSince = (timeSinceLastBeacon % 60000UL) / 1000UL;
+
+    // Determine beacon mode
+    const char* beaconMode;
+    const char* beaconMsg;
+    if (!groundContactEstablished) {
+        beaconMode = "SEARCHING";
+        beaconMsg = "Andar com fe...";
+    } else {
+        unsigned long contactAge = now - lastGroundContact;
+        if (contactAge > BEACON_LOST_THRESHOLD) {
+            beaconMode = "LOST";
+            beaconMsg = "Por mais distante...";
+        } else {
+            beaconMode = "CONNECTED";
+            beaconMsg = "Ainda bem...";
+        }
+    }
+
+    LOG_TEXT_D("");
+    LOG_TEXT_D("╔══════════════════════════════════════════════════════════╗");
+    LOG_TEXT_D("║             BEACON COUNTDOWN STATUS                      ║");
+    LOG_TEXT_D("╠══════════════════════════════════════════════════════════╣");
+    LOG_TEXT_D("║ Mode: %-12s  Contact: %-3s                       ║",
+               beaconMode, groundContactEstablished ? "YES" : "NO");
+    LOG_TEXT_D("║ Interval: %lu min                                         ║",
+               beaconInterval / 60000UL);
+    LOG_TEXT_D("║ Time since last beacon: %02lu:%02lu                           ║",
+               minutesSince, secondsSince);
+    LOG_TEXT_D("║ Time until next beacon: %02lu:%02lu                           ║",
+               minutesUntil, secondsUntil);
+    LOG_TEXT_D("║ Next message: %-40s  ║", beaconMsg);
+    LOG_TEXT_D("║ lastBeaconTime: %lu                                   ║", lastBeaconTime);
+    LOG_TEXT_D("╚══════════════════════════════════════════════════════════╝");
+    LOG_TEXT_D("");
+}
+
+static void startJobs(unsigned long now) {
+    schedEvery("watchdog", jobWatchdog, WDT_FEED_INTERVAL, now);
+    schedEvery("scrub", jobScrub, SCRUB_INTERVAL, now);
+    schedEvery("journal", jobJournal, JOURNAL_PREPARE_INTERVAL, now);
+    schedEvery("upload", jobUpload, UPLOAD_FLUSH_MS, now);
+    schedEvery("link", jobLink, LINK_TICK_INTERVAL, now);
+    schedEvery("soakHourly", jobSoakHourly, SOAK_LOG_INTERVAL, now);
+    schedEvery("soakDaily", jobSoakDaily, SOAK_DAILY_INTERVAL, now);
+    schedEvery("countdown", jobBeaconCountdown, COUNTDOWN_PRINT_INTERVAL, now);
+    schedEvery("radioCheck", jobRadioCheck, RADIO_CHECK_INTERVAL, now);
+    schedEvery("recovery", jobErrorRecovery, RECOVERY_INTERVAL, now);
+    jobTelemetryId = schedEvery("telemetry", jobTelemetry, STATUS_INTERVAL, now);
+    jobDeployWaitId = schedRegister("deployWait", jobDeployWait, 0);
+    jobBeaconId = schedRegister("beacon", jobBeacon, 0);
+    schedAfter(jobBeaconId, beaconDelay(now), now);
+
+    // Last registrations of the boot (setup() has done the modules' own):
+    // a refused job would otherwise just never run
+    if (schedRejected() > 0) {
+        LOG_E("SCHED", "%u jobs not registered, raise SCHED_MAX_JOBS (%d, %u in use)",
+              schedRejected(), SCHED_MAX_JOBS, schedJobCount());
+    }
+}
+
+// Incoming packets - the same in every state that listens
+// One per iteration, so the TX queue and due jobs run in between
+static void serviceRadioRx() {
+    if (currentState == STATE_BOOT || currentState == STATE_ERROR) {
+        return;
+    }
+
+    RxPacket* pkt = rxQueuePeek();
+    if (pkt == NULL) return;
+
+    LOG_D("LORA", "====================================");
+    LOG_I("LORA", "PACKET RECEIVED SUCCESSFULLY");
+    LOG_I("LORA", "Length: %u  RSSI: %.1f dBm  SNR: %.2f dB  queued %lu ms",
+          (unsigned)pkt->length, pkt->rssi, pkt->snr, millis() - pkt->receivedAt);
+    LOG_D("LORA", "Data: %s", pkt->data);
+    LOG_D("LORA", "====================================");
+    LOG_D("LORA", "Processing message...");
+    processMessage(pkt->data, pkt->length, pkt->rssi, pkt->snr);
+    rxQueueRelease();
+    LOG_D("LORA", "Message processing complete");
+}
+
+unsigned long mainLoopIdleTime() {
+    return loopIdleMs;
+}
+
 // ==================== MAIN LOOP ====================
 void mainLoop() {
+    PerfScope perf(PERF_LOOP);
     unsigned long now = millis();
+    soakLoopIterations++;  // Will overflow, that's OK
 
-    // Feed watchdog regularly
-    if (now - lastWdtFeed >= WDT_FEED_INTERVAL) {
-        feedWatchdog();
+    static bool jobsStarted = false;
+    if (!jobsStarted) {
+        startJobs(now);
+        jobsStarted = true;
     }
 
-    // Radiation protection - scrub TMR variables periodically
-    radiationProtectionTick();
+    // Timed work: only what is due
+    schedRun(now);
+
+    // A few TMR words per tick; jobScrub completes the pass if the loop slept
+    scrubTMRTick();
 
-    // Soak test logging - hourly and daily status
-    soakTestTick();
+    // Outbound traffic - bulk job fills the TX queue, the tick drains it
+    bulkDownlinkTick();
+    radioTxTick();
 
-    // State machine
+    serviceRadioRx();
+
+    // State machine (transitions only - periodic work is in the jobs)
     switch (currentState) {
         case STATE_BOOT:
             // Initial state after power-on
-            Serial.println("[STATE] Boot complete, waiting before deployment");
-            currentState = STATE_WAIT_DEPLOY;
+            LOG_I("STATE", "Boot complete, waiting before deployment");
+            tmrWrite(currentState, STATE_WAIT_DEPLOY);
             stateStartTime = now;
+            schedAfter(jobDeployWaitId, DEPLOY_WAIT_TIME, now);
             break;
 
         case STATE_WAIT_DEPLOY:
-            // Non-blocking wait before antenna deployment
-            // Still check for incoming messages during this time!
-            if (now - stateStartTime >= DEPLOY_WAIT_TIME) {
-                Serial.println("[STATE] Wait complete, starting deployment");
-                currentState = STATE_DEPLOYING;
-                antennaState = ANT_IDLE;
-                stateStartTime = now;
-            }
-
-            // Send beacon during wait phase (helps ground station find us)
-            {
-                unsigned long beaconInterval = getBeaconInterval();
-                if (now - lastBeaconTime >= beaconInterval) {
-                    sendBeacon();
-                }
-            }
-
-            // Check for incoming messages (allows abort command)
-            if (receivedFlag) {
-                receivedFlag = false;
-                int state = radio.readData(receivedData);
-                if (state == RADIOLIB_ERR_NONE) {
-                    Serial.println("[LORA] Received during wait: " + receivedData);
-                    processMessage(receivedData);
-                }
-            }
             break;
 
         case STATE_DEPLOYING:
             // Handle antenna deployment state machine
             handleAntennaDeployment();
-
-            // Still check for incoming messages
-            if (receivedFlag) {
-                receivedFlag = false;
-                int state = radio.readData(receivedData);
-                if (state == RADIOLIB_ERR_NONE) {
-                    processMessage(receivedData);
-                }
-            }
             break;
 
         case STATE_OPERATIONAL:
             // Normal operation - send first beacon if just entered
             if (stateStartTime == 0) {
-                Serial.println("[STATE] Entering operational mode");
+                LOG_I("STATE", "Entering operational mode");
                 // Send initial beacon
                 sendBeacon();
                 stateStartTime = now;
-                lastTelemetryTime = now;
-                lastBeaconTime = now;
-            }
-
-            // ==================== ADAPTIVE BEACON ====================
-            // Beacon interval depends on ground contact status:
-            // - Before first contact: every 4 minutes (frequent)
-            // - After contact established: every 1 hour (normal)
-            // - After 24h without contact: every 8 minutes (lost mode)
-            {
-                unsigned long beaconInterval = getBeaconInterval();
-                unsigned long timeSinceLastBeacon = now - lastBeaconTime;
-
-                // ==================== BEACON COUNTDOWN (every 5 min) ====================
-                static unsigned long lastCountdownPrint = 0;
-                const unsigned long COUNTDOWN_PRINT_INTERVAL = 300000UL;  // 5 minutes
-
-                if (now - lastCountdownPrint >= COUNTDOWN_PRINT_INTERVAL) {
-                    unsigned long timeUntilBeacon = (timeSinceLastBeacon < beaconInterval)
-                        ? (beaconInterval - timeSinceLastBeacon) : 0;
-
-                    unsigned long minutesUntil = timeUntilBeacon / 60000UL;
-                    unsigned long secondsUntil = (timeUntilBeacon % 60000UL) / 1000UL;
-
-                    unsigned long minutesSince = timeSinceLastBeacon / 60000UL;
-                    unsigned long secondsSince = (timeSinceLastBeacon % 60000UL) / 1000UL;
-
-                    // Determine beacon mode
-                    const char* beaconMode;
-                    const char* beaconMsg;
-                    if (!groundContactEstablished) {
-                        beaconMode = "SEARCHING";
-                        beaconMsg = "Andar com fe...";
-                    } else {
-                        unsigned long contactAge = now - lastGroundContact;
-                        if (contactAge > BEACON_LOST_THRESHOLD) {
-                            beaconMode = "LOST";
-                            beaconMsg = "Por mais distante...";
-                        } else {
-                            beaconMode = "CONNECTED";
-                            beaconMsg = "Ainda bem...";
-                        }
-                    }
-
-                    Serial.println();
-                    Serial.println("╔══════════════════════════════════════════════════════════╗");
-                    Serial.println("║             BEACON COUNTDOWN STATUS                      ║");
-                    Serial.println("╠══════════════════════════════════════════════════════════╣");
-                    Serial.printf("║ Mode: %-12s  Contact: %-3s                       ║\n",
-                                  beaconMode, groundContactEstablished ? "YES" : "NO");
-                    Serial.printf("║ Interval: %lu min                                         ║\n",
-                                  beaconInterval / 60000UL);
-                    Serial.printf("║ Time since last beacon: %02lu:%02lu                           ║\n",
-                                  minutesSince, secondsSince);
-                    Serial.printf("║ Time until next beacon: %02lu:%02lu                           ║\n",
-                                  minutesUntil, secondsUntil);
-                    Serial.printf("║ Next message: %-40s  ║\n", beaconMsg);
-                    Serial.printf("║ lastBeaconTime: %lu                                   ║\n", lastBeaconTime);
-                    Serial.println("╚══════════════════════════════════════════════════════════╝");
-                    Serial.println();
-
-                    lastCountdownPrint = now;
-                }
-
-                // Check if it's time to send beacon
-                if (timeSinceLastBeacon >= beaconInterval) {
-                    Serial.println("[BEACON] >>> INTERVAL REACHED - SENDING BEACON NOW <<<");
-                    sendBeacon();
-                    // lastBeaconTime is updated inside sendBeacon()
-                }
-            }
-
-            // Periodic telemetry (in addition to beacon)
-            if (now - lastTelemetryTime >= STATUS_INTERVAL) {
-                sendTelemetry();
-                lastTelemetryTime = now;
-            }
-
-            // Process accelerometer recording (must be called frequently for 30Hz sampling)
-            accelRecordingTick();
-
-            // Check for radio recovery
-            if (radioNeedsRecovery()) {
-                Serial.println("[STATE] Radio needs recovery");
-                if (!recoverRadio()) {
-                    Serial.println("[STATE] Radio recovery failed, restarting...");
-                    saveState();
-                    ESP.restart();
-                }
-            }
-
-            // Process incoming messages
-            if (receivedFlag) {
-                Serial.println("[LORA] *** PACKET RECEIVED FLAG SET ***");
-                receivedFlag = false;
-                Serial.println("[LORA] Reading packet data...");
-                int state = radio.readData(receivedData);
-                if (state == RADIOLIB_ERR_NONE) {
-                    Serial.println("[LORA] ====================================");
-                    Serial.println("[LORA] PACKET RECEIVED SUCCESSFULLY");
-                    Serial.println("[LORA] Length: " + String(receivedData.length()));
-                    Serial.println("[LORA] Data: " + receivedData);
-                    Serial.println("[LORA] ====================================");
-                    Serial.println("[LORA] Processing message...");
-                    processMessage(receivedData);
-                    Serial.println("[LORA] Message processing complete");
-                } else {
-                    Serial.println("[LORA] *** READ ERROR ***");
-                    Serial.printf("[LORA] Error code: %d\n", state);
-                    soakRxErrors++;  // Track for soak test
-                }
+                tmrWrite(lastBeaconTime, now);
+                schedAfter(jobTelemetryId, STATUS_INTERVAL, now);
+                schedAfter(jobBeaconId, beaconDelay(now), now);
             }
             break;
 
         case STATE_ERROR:
-            // Error state - try to recover (non-blocking)
-            {
-                static unsigned long lastRecoveryAttempt = 0;
-                const unsigned long RECOVERY_INTERVAL = 5000;
-
-                if (now - lastRecoveryAttempt >= RECOVERY_INTERVAL) {
-                    Serial.println("[STATE] Error state, attempting recovery");
-                    feedWatchdog();
-
-                    if (recoverRadio()) {
-                        currentState = STATE_OPERATIONAL;
-                        stateStartTime = 0;
-                    }
-                    lastRecoveryAttempt = now;
-                }
-            }
             break;
     }
+
+    unsigned long after = millis();
+    loopIdleMs = schedNextDelay(after);
+
+    // Work the scheduler doesn't see keeps the loop awake
+    if (currentState == STATE_BOOT || currentState == STATE_DEPLOYING ||
+        bulkDownlinkBusy() || logWriterBusy() || logUartBusy()) {
+        loopIdleMs = 0;
+    } else {
+        unsigned long radioIdle = radioIdleTime();
+        if (radioIdle < loopIdleMs) loopIdleMs = radioIdle;
+    }
 }
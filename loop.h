@@ -12,21 +12,112 @@
  * - ADDED telemetry timestamps (mission elapsed time)
  * - ADDED watchdog feeding throughout all operations
  * - FIXED command parsing to handle missing delimiters safely
+ * - ADDED compact binary telemetry frame (text kept as fallback)
+ * - ADDED in-place message parser and table-driven command dispatch
+ * - ADDED batched commands: several commands under one HMAC
+ * - REPLACED per-iteration millis() polling with scheduler jobs (scheduler.h)
+ * - ADDED idle light sleep between deadlines (power.h), sleep share in telemetry
+ * - REPLACED Serial prints with leveled log macros (log.h); lines are queued
+ *   for a UART writer task instead of waiting for the UART
+ * - ADDED latency histograms on the hot paths (perf.h), GetPerf command
+ * - REPLACED String replies with stack message builders (msgbuf.h); heap
+ *   largest free block and low-water mark in telemetry and soak logs
+ * - ADDED resumable chunked upload commands (upload.h)
+ * - ADDED per-pass link statistics and SetLinkProfile for faster bulk
+ *   downlinks (link.h)
+ * - ADDED name ledger commands NameBatch / NameQuery (names.h)
  */
 
+#include <stddef.h>
+#include <string.h>
+#include "msgbuf.h"
+
+// ==================== MESSAGE PARSING ====================
+// Non-owning pointer+length view into the RX buffer
+struct StrView {
+    const char* ptr;
+    size_t len;
+
+    bool equals(const char* s) const {
+        return strlen(s) == len && memcmp(ptr, s, len) == 0;
+    }
+};
+
+// Fields of SAT_ID-COMMAND&PATH@DATA#HMAC
+// After a successful validateMessage() the delimiters are replaced by NULs,
+// so path.ptr and data.ptr are also valid C strings.
+struct ParsedMessage {
+    StrView satId;
+    StrView command;
+    StrView path;
+    StrView data;
+    StrView hmac;
+};
+
+// Command flags
+#define CMD_REQUIRES_SD  0x01   // Rejected with ERR:SD_NOT_AVAILABLE if !SDOK
+#define CMD_MUTATING     0x02   // Changes stored state - logged to SD
+#define CMD_NO_BATCH     0x04   // Refused inside a Batch (ERR:NOT_BATCHABLE)
+
+typedef void (*CommandHandler)(const ParsedMessage& msg);
+
+struct CommandEntry {
+    const char* name;
+    CommandHandler handler;
+    uint8_t flags;
+};
+
+// Validate and split a message in place (buffer must hold length + 1 bytes)
+// Returns true if the message is well-formed, addressed to us and authentic
+bool validateMessage(char* buffer, size_t length, ParsedMessage& msg);
+
+// Find a command in the dispatch table (binary search), NULL if unknown
+const CommandEntry* findCommand(const StrView& name);
+
+// ==================== BATCHED COMMANDS ====================
+// Uplink:  SAT_ID-Batch&@CMD&PATH@DATA;CMD&PATH@DATA;...#HMAC
+//          One HMAC over the whole envelope; sub-command data can't hold ';'
+// Downlink: replies packed into as few frames as fit, in command order
+//          "BATCH:<frame>\n<i>:<reply>\n<i>:<reply>..."
+//          The last frame's header is "BATCH:<frame>|N:<n>|FAILED:<f>"
+//          A command with no reply of its own reports "<i>:OK"; a reply too
+//          long for a frame goes out on its own and reports "<i>:SENT"
+//          A command failed if one of its replies starts with "ERR:"
+#define BATCH_MAX_COMMANDS  8
+#define BATCH_SEPARATOR     ';'
+#define BATCH_HEADER_MAX    24      // "BATCH:255|N:8|FAILED:8\n"
+
+// Split the data of a Batch envelope in place (delimiters become NULs)
+// Fills command/path/data of out[]; empty entries are skipped
+// Returns the number of commands, or -1 - index of the first bad entry
+// (index maxCommands when there are too many)
+int splitBatch(char* data, size_t length, ParsedMessage* out, size_t maxCommands);
+
 // Main loop function - called repeatedly from Arduino loop()
+// Runs due scheduler jobs, services the radio and the state machine
 void mainLoop();
 
+// ms the CPU may sleep, as of the end of the last mainLoop(): until the
+// next scheduled job or radio timeout, 0 while other work is pending
+unsigned long mainLoopIdleTime();
+
 // Process received message (with authentication)
-void processMessage(const String& message);
+// Parses in place - the buffer is modified; rssi/snr feed the link estimate
+void processMessage(char* buffer, size_t length, float rssi, float snr);
 
-// Send telemetry status
+// Send telemetry status (format selected by telemetryFormat)
 void sendTelemetry();
 
+// Build telemetry from the last sensor readings into static buffers
+// Text: NUL-terminated legacy string; binary: returns frame length
+const char* buildTextTelemetry();
+size_t buildBinaryTelemetry();
+
 // Handle antenna deployment state machine
 void handleAntennaDeployment();
 
-// Utility: Get mission elapsed time string
-String getMissionTime();
+// Utility: Append the mission elapsed time ("T+hh:mm:ss")
+void addMissionTime(MsgBuilder& msg);
+void formatMissionTime(char* buffer, size_t size);
 
 #endif // LOOP_H
@@ -23,31 +23,140 @@
  * 3. IMPROVED ERROR HANDLING:
  *    Added retry limits and recovery mechanism instead of infinite loops
  *    or immediate ESP.restart().
+ *
+ * 4. PERSISTENT RADIO SESSION:
+ *    Every packet used to cost two radio.begin() calls (TX config, then
+ *    RX config in returnToReceive()) plus a delay(100). The radio is now
+ *    initialised once in startRadio() and TX/RX switching only retunes the
+ *    frequency. Full re-initialisation is left to recoverRadio().
+ *
+ * 5. NON-BLOCKING TRANSMIT QUEUE:
+ *    sendMessage() used to block for the whole radio.transmit() plus retry
+ *    delays, so mainLoop() stopped sampling and reading uplinks. Packets are
+ *    now queued by priority and drained by radioTxTick() using
+ *    startTransmit() and the DIO0 TxDone interrupt.
+ *
+ * 6. RX TASK AND QUEUE:
+ *    RxDone only set receivedFlag; the packet stayed in the SX1276 FIFO
+ *    until mainLoop() got round to it, and a second uplink during a long
+ *    handler overwrote the first. The ISR now wakes a task that copies
+ *    the packet (with RSSI/SNR) into a queue straight away. Radio access
+ *    from the task and the main loop is serialised by a mutex.
+ *
+ * 7. LINK PROFILES:
+ *    Bulk packets carry the link profile (link.h) active when they were
+ *    queued; txStart() switches SF/CR per packet and returnToReceive()
+ *    always restores the safe profile.
  */
 
 #include <Arduino.h>
 #include "config.h"
+#include "log.h"
 #include "lora.h"
+#include "perf.h"
+#include "link.h"
 
 // Maximum retry attempts before considering radio failed
 #define MAX_INIT_RETRIES    5
-#define MAX_TX_RETRIES      3
 #define RETRY_DELAY_MS      1000
 
 // ==================== ISR CALLBACK ====================
 // This is the interrupt service routine called when a packet is received
 // NOTE: receivedFlag is defined in config.cpp, declared extern in config.h
+//
+// On the SX1276 DIO0 signals both RxDone and TxDone. Since the radio is no
+// longer re-initialised after every transmission, the same callback stays
+// installed for the whole session, so TxDone edges must be ignored here.
+
+static volatile bool radioTransmitting = false;
+static volatile bool txDoneFlag = false;
+static TaskHandle_t rxTaskHandle = NULL;
 
 #if defined(ESP8266) || defined(ESP32)
     ICACHE_RAM_ATTR
 #endif
 void setFlag(void) {
-    receivedFlag = true;
+    if (radioTransmitting) {
+        txDoneFlag = true;  // TxDone - picked up by radioTxTick()
+        return;
+    }
+    receivedFlag = true;    // RxDone - packet still in the radio FIFO
+
+    if (rxTaskHandle == NULL) return;
+    if (xPortInIsrContext()) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(rxTaskHandle, &woken);
+        if (woken) portYIELD_FROM_ISR();
+    } else {
+        xTaskNotifyGive(rxTaskHandle);  // idleSleep() after a DIO0 wakeup
+    }
+}
+
+// ==================== RADIO LOCK ====================
+// Once the RX task runs, every multi-step radio operation holds this
+// (recursive: returnToReceive() runs inside radioTxTick()). Before that
+// there is only one context and the lock is a no-op.
+static SemaphoreHandle_t radioMutex = NULL;
+
+struct RadioLock {
+    RadioLock() {
+        if (radioMutex != NULL) xSemaphoreTakeRecursive(radioMutex, portMAX_DELAY);
+    }
+    ~RadioLock() {
+        if (radioMutex != NULL) xSemaphoreGiveRecursive(radioMutex);
+    }
+};
+
+// ==================== CHANNEL SWITCHING ====================
+// The radio session is initialised once in startRadio(). Switching between
+// the RX (401.5 MHz) and TX (468.5 MHz) channels only retunes the synthesizer;
+// bandwidth, SF, CR, sync word and the DIO0 callback are kept.
+
+// Time the last transmission finished (for TX->RX turnaround measurement)
+static unsigned long txEndMicros = 0;
+
+// Modem profile the radio is set to (link.h). Bulk packets may go out on a
+// faster one; reception and everything else use LINK_PROFILE_SAFE.
+static_assert(LINK_SAFE_SF == LORA_SF && LINK_SAFE_CR == LORA_CR,
+              "safe link profile is the configured modem");
+static uint8_t radioProfile = LINK_PROFILE_SAFE;
+
+// Radio must be in standby
+static bool setProfile(uint8_t profile) {
+    if (profile == radioProfile) return true;
+
+    const LinkProfile& p = LINK_PROFILE_TABLE[profile];
+    int state = radio.setSpreadingFactor(p.sf);
+    if (state == RADIOLIB_ERR_NONE) {
+        state = radio.setCodingRate(p.cr);
+    }
+    if (state != RADIOLIB_ERR_NONE) {
+        LOG_E("LORA", "ERROR: Switch to SF%u CR4/%u failed, code: %d", p.sf, p.cr, state);
+        return false;
+    }
+    radioProfile = profile;
+    return true;
+}
+
+static bool tuneRadio(float frequency) {
+    // Frequency registers may only be written in standby
+    int state = radio.standby();
+    if (state == RADIOLIB_ERR_NONE) {
+        state = radio.setFrequency(frequency);
+    }
+
+    if (state != RADIOLIB_ERR_NONE) {
+        LOG_E("LORA", "ERROR: Retune to %.1f MHz failed, code: %d", frequency, state);
+        return false;
+    }
+    return true;
 }
 
 // ==================== RADIO INITIALIZATION ====================
+// Full SX1276 initialisation - only at boot and from recoverRadio()
 bool startRadio() {
-    Serial.println("[LORA] Initializing radio...");
+    RadioLock lock;
+    LOG_I("LORA", "Initializing radio...");
 
     int retries = 0;
     int state;
@@ -57,7 +166,7 @@ bool startRadio() {
         // Feed watchdog during potentially long operation
         feedWatchdog();
 
-        Serial.printf("[LORA] Init attempt %d/%d\n", retries + 1, MAX_INIT_RETRIES);
+        LOG_D("LORA", "Init attempt %d/%d", retries + 1, MAX_INIT_RETRIES);
 
         // Initialize radio with parameters from config.h
         // Using CONSISTENT sync word (was inconsistent in V1.2)
@@ -71,37 +180,40 @@ bool startRadio() {
         );
 
         if (state == RADIOLIB_ERR_NONE) {
-            Serial.println("[LORA] Radio initialized successfully");
+            LOG_I("LORA", "Radio initialized successfully");
             break;
         }
 
-        Serial.printf("[LORA] Init failed, code: %d\n", state);
+        LOG_E("LORA", "Init failed, code: %d", state);
         retries++;
         delay(RETRY_DELAY_MS);
     }
 
     if (state != RADIOLIB_ERR_NONE) {
-        Serial.println("[LORA] ERROR: Radio initialization failed after all retries!");
-        RFOK = false;
+        LOG_E("LORA", "ERROR: Radio initialization failed after all retries!");
+        tmrWrite(RFOK, false);
         contR = MAX_INIT_RETRIES;
         return false;
     }
 
-    // Set up receive callback
+    radioProfile = LINK_PROFILE_SAFE;   // begin() set LORA_SF / LORA_CR
+
+    // Set up receive callback (stays installed for the whole session)
+    radioTransmitting = false;
     radio.setPacketReceivedAction(setFlag);
 
     // Start receiving
-    Serial.println("[LORA] Starting receive mode...");
+    LOG_I("LORA", "Starting receive mode...");
     state = radio.startReceive();
 
     if (state == RADIOLIB_ERR_NONE) {
-        Serial.println("[LORA] Receive mode started successfully");
-        RFOK = true;
+        LOG_I("LORA", "Receive mode started successfully");
+        tmrWrite(RFOK, true);
         contR = 0;
         return true;
     } else {
-        Serial.printf("[LORA] ERROR: startReceive failed, code: %d\n", state);
-        RFOK = false;
+        LOG_E("LORA", "ERROR: startReceive failed, code: %d", state);
+        tmrWrite(RFOK, false);
         contR++;
         return false;
     }
@@ -109,145 +221,475 @@ bool startRadio() {
 
 // ==================== RETURN TO RECEIVE MODE ====================
 bool returnToReceive() {
-    Serial.println("[LORA] Returning to receive mode...");
+    RadioLock lock;
 
     // Feed watchdog
     feedWatchdog();
 
-    // Re-initialize radio for RX frequency with CONSISTENT sync word
-    int state = radio.begin(
-        LORA_FREQ_RX,
-        LORA_BW,
-        LORA_SF,
-        LORA_CR,
-        LORA_SYNC_WORD,     // Same sync word as TX!
-        LORA_PREAMBLE
-    );
-
-    if (state != RADIOLIB_ERR_NONE) {
-        Serial.printf("[LORA] ERROR: RX init failed, code: %d\n", state);
-        RFOK = false;
+    // Retune to the RX channel - no full re-initialisation. Ground always
+    // transmits on the safe profile.
+    if (!tuneRadio(LORA_FREQ_RX) || !setProfile(LINK_PROFILE_SAFE)) {
+        tmrWrite(RFOK, false);
         contR++;
         return false;
     }
 
-    // Re-set receive callback
-    radio.setPacketReceivedAction(setFlag);
+    // From here on DIO0 means RxDone again. Anything flagged before this
+    // point was lost to the retune, so a stale flag must not block TX
+    radioTransmitting = false;
+    receivedFlag = false;
 
     // Start receiving
-    state = radio.startReceive();
+    int state = radio.startReceive();
 
     if (state == RADIOLIB_ERR_NONE) {
-        Serial.println("[LORA] Back in receive mode");
-        RFOK = true;
+        // Measure how long the radio was deaf after the transmission ended
+        unsigned long turnaround = micros() - txEndMicros;
+        radioLastTurnaroundUs = turnaround;
+        if (turnaround > radioMaxTurnaroundUs) {
+            radioMaxTurnaroundUs = turnaround;
+        }
+        LOG_D("LORA", "Back in receive mode (TX->RX turnaround: %lu us)", turnaround);
+        tmrWrite(RFOK, true);
         contR = 0;
         return true;
     } else {
-        Serial.printf("[LORA] ERROR: startReceive failed, code: %d\n", state);
-        RFOK = false;
+        LOG_E("LORA", "ERROR: startReceive failed, code: %d", state);
+        tmrWrite(RFOK, false);
         contR++;
         return false;
     }
 }
 
-// ==================== SEND MESSAGE ====================
-bool sendMessage(const String& message) {
-    Serial.print("[LORA] Sending: ");
-    Serial.println(message);
+// ==================== OUTBOUND PACKET QUEUE ====================
+// sendMessage()/sendPacket() only copy the packet into a fixed slot pool and
+// return. radioTxTick() (called every mainLoop() iteration) starts the next
+// transmission with startTransmit(); DIO0 TxDone -> txDoneFlag tells the tick
+// to finish it and either chain the next queued packet (staying on the TX
+// channel) or retune back to RX once the queue is empty.
+//
+// Packets leave in priority order (replies > telemetry > beacons > bulk),
+// FIFO within the same priority. Bulk data may only occupy
+// TX_QUEUE_BULK_SLOTS slots so replies always find room.
+
+struct TxSlot {
+    uint8_t data[TX_MAX_PACKET];
+    uint8_t length;
+    uint8_t priority;
+    uint8_t profile;        // Link profile to transmit with
+    bool used;
+    uint32_t seq;           // Enqueue order (FIFO within a priority)
+};
+
+static TxSlot txSlots[TX_QUEUE_SLOTS];
+static uint32_t txSeqCounter = 0;
+static uint8_t txSlotsPerPriority[TX_PRIO_COUNT] = {0};
+static uint32_t txDropsPerPriority[TX_PRIO_COUNT] = {0};
+static uint8_t txQueueHighWater = 0;
+
+static int txActiveSlot = -1;            // Slot currently on air (-1 = none)
+static unsigned long txStartMillis = 0;
+static unsigned long txTimeoutMs = 0;
+
+// Highest priority, oldest packet
+static int txPickNext() {
+    int best = -1;
+    for (int i = 0; i < TX_QUEUE_SLOTS; i++) {
+        if (!txSlots[i].used || i == txActiveSlot) continue;
+        if (best < 0 ||
+            txSlots[i].priority < txSlots[best].priority ||
+            (txSlots[i].priority == txSlots[best].priority &&
+             (int32_t)(txSlots[i].seq - txSlots[best].seq) < 0)) {
+            best = i;
+        }
+    }
+    return best;
+}
 
-    // Feed watchdog before transmission
-    feedWatchdog();
+static void txReleaseSlot(int slot) {
+    if (slot < 0) return;
+    txSlotsPerPriority[txSlots[slot].priority]--;
+    txSlots[slot].used = false;
+}
 
-    int retries = 0;
-    int state;
+bool sendPacket(const uint8_t* data, size_t length, TxPriority priority) {
+    if (length == 0 || priority >= TX_PRIO_COUNT) {
+        return false;
+    }
 
-    // Configure radio for TX frequency
-    while (retries < MAX_TX_RETRIES) {
-        state = radio.begin(
-            LORA_FREQ_TX,       // TX frequency
-            LORA_BW,
-            LORA_SF,
-            LORA_CR,
-            LORA_SYNC_WORD,     // Same sync word!
-            LORA_PREAMBLE
-        );
+    if (length > TX_MAX_PACKET) {
+        LOG_E("LORA", "ERROR: Message too long! (%u bytes)", (unsigned)length);
+        soakTxErrors++;  // Track for soak test
+        return false;
+    }
 
-        if (state == RADIOLIB_ERR_NONE) {
+    // Bulk data is capped so it can never crowd out command replies
+    if (priority == TX_PRIO_BULK && txSlotsPerPriority[TX_PRIO_BULK] >= TX_QUEUE_BULK_SLOTS) {
+        txDropsPerPriority[priority]++;
+        LOG_W("LORA", "WARNING: TX queue bulk budget full, packet dropped");
+        return false;
+    }
+
+    int slot = -1;
+    for (int i = 0; i < TX_QUEUE_SLOTS; i++) {
+        if (!txSlots[i].used) {
+            slot = i;
             break;
         }
-
-        Serial.printf("[LORA] TX config failed, retry %d/%d\n", retries + 1, MAX_TX_RETRIES);
-        retries++;
-        delay(RETRY_DELAY_MS);
-        feedWatchdog();
     }
 
-    if (state != RADIOLIB_ERR_NONE) {
-        Serial.println("[LORA] ERROR: Could not configure for TX!");
-        RFOK = false;
-        contE = MAX_TX_RETRIES;
-        returnToReceive();  // Try to at least get back to RX
+    if (slot < 0) {
+        txDropsPerPriority[priority]++;
+        LOG_W("LORA", "WARNING: TX queue full, packet dropped (prio %d)", (int)priority);
         return false;
     }
 
-    // Small delay before transmitting
-    delay(100);
+    memcpy(txSlots[slot].data, data, length);
+    txSlots[slot].length = (uint8_t)length;
+    txSlots[slot].priority = (uint8_t)priority;
+    txSlots[slot].profile = priority == TX_PRIO_BULK ? linkBulkProfile() : LINK_PROFILE_SAFE;
+    txSlots[slot].seq = txSeqCounter++;
+    txSlots[slot].used = true;
+    txSlotsPerPriority[priority]++;
+
+    uint8_t depth = (uint8_t)txQueueDepth();
+    if (depth > txQueueHighWater) {
+        txQueueHighWater = depth;
+    }
+    return true;
+}
 
-    // Transmit the message (make a copy since RadioLib takes non-const String&)
-    String txMessage = message;
-    state = radio.transmit(txMessage);
+static_assert(MSG_REPLY_SIZE == TX_MAX_PACKET + 1, "Reply holds one packet of text");
 
-    if (state == RADIOLIB_ERR_NONE) {
-        Serial.println("[LORA] Message sent successfully");
-        Serial.printf("[LORA] Datarate: %.2f bps\n", radio.getDataRate());
-        contE = 0;
+static ReplySink replySink = NULL;
 
-        // Return to receive mode
-        returnToReceive();
+void setReplySink(ReplySink sink) {
+    replySink = sink;
+}
+
+bool sendMessage(const char* text, size_t length, TxPriority priority) {
+    PerfScope perf(PERF_SEND);
+    if (replySink != NULL && priority == TX_PRIO_REPLY) {
+        replySink(text, length);
         return true;
+    }
 
-    } else if (state == RADIOLIB_ERR_PACKET_TOO_LONG) {
-        Serial.println("[LORA] ERROR: Message too long!");
-        soakTxErrors++;  // Track for soak test
-        returnToReceive();
-        return false;
+    LOG_D("LORA", "Queued: %.*s", (int)length, text);
+
+    return sendPacket((const uint8_t*)text, length, priority);
+}
+
+bool sendMessage(const char* text, TxPriority priority) {
+    return sendMessage(text, strlen(text), priority);
+}
 
-    } else if (state == RADIOLIB_ERR_TX_TIMEOUT) {
-        Serial.println("[LORA] ERROR: TX timeout!");
+bool sendMessage(const MsgBuilder& message, TxPriority priority) {
+    if (message.overflowed()) {
+        LOG_W("LORA", "Reply truncated to %u bytes", (unsigned)message.length());
+    }
+    return sendMessage(message.c_str(), message.length(), priority);
+}
+
+// Start transmitting the given slot (radio must already be on the TX channel,
+// in standby)
+static bool txStart(int slot) {
+    txDoneFlag = false;
+    int state = setProfile(txSlots[slot].profile) ? RADIOLIB_ERR_NONE : RADIOLIB_ERR_UNKNOWN;
+    if (state == RADIOLIB_ERR_NONE) {
+        state = radio.startTransmit(txSlots[slot].data, txSlots[slot].length);
+    }
+
+    if (state != RADIOLIB_ERR_NONE) {
+        LOG_E("LORA", "ERROR: TX failed, code: %d", state);
         contE++;
         soakTxErrors++;  // Track for soak test
-        returnToReceive();
+        txReleaseSlot(slot);
+        txActiveSlot = -1;
         return false;
+    }
 
-    } else {
-        Serial.printf("[LORA] ERROR: TX failed, code: %d\n", state);
+    txActiveSlot = slot;
+    txStartMillis = millis();
+    // Twice the time on air plus margin before declaring a TX timeout
+    txTimeoutMs = (radio.getTimeOnAir(txSlots[slot].length) / 1000UL) * 2UL + 500UL;
+    if (txSlots[slot].priority == TX_PRIO_BULK) {
+        linkBulkSent(txSlots[slot].profile, txStartMillis);
+    }
+    return true;
+}
+
+static void txAbortActive() {
+    if (txActiveSlot >= 0) {
+        txReleaseSlot(txActiveSlot);
+        txActiveSlot = -1;
+    }
+    txDoneFlag = false;
+}
+
+void radioTxTick() {
+    RadioLock lock;
+
+    // ---- Transmission in progress ----
+    if (txActiveSlot >= 0) {
+        if (txDoneFlag) {
+            txDoneFlag = false;
+            radio.finishTransmit();
+            txEndMicros = micros();
+            contE = 0;
+            txReleaseSlot(txActiveSlot);
+            txActiveSlot = -1;
+
+            // Chain the next packet while still on the TX channel
+            int next = txPickNext();
+            if (next >= 0 && txStart(next)) {
+                return;
+            }
+            returnToReceive();
+        } else if (millis() - txStartMillis > txTimeoutMs) {
+            LOG_E("LORA", "ERROR: TX timeout!");
+            contE++;
+            soakTxErrors++;  // Track for soak test
+            radio.finishTransmit();
+            txEndMicros = micros();
+            txAbortActive();
+            returnToReceive();
+        }
+        return;
+    }
+
+    // ---- Idle in RX: start draining the queue ----
+    if (!RFOK) return;          // Recovery path in mainLoop() owns the radio
+    if (receivedFlag) return;   // Let the pending uplink be read first
+
+    int next = txPickNext();
+    if (next < 0) return;
+
+    feedWatchdog();
+
+    // DIO0 will signal TxDone from now on - keep it away from receivedFlag.
+    // An RxDone that landed after the check above is still in the FIFO, so
+    // back off and let the RX task read it
+    radioTransmitting = true;
+    __sync_synchronize();
+    if (receivedFlag) {
+        radioTransmitting = false;
+        return;
+    }
+
+    if (!tuneRadio(LORA_FREQ_TX)) {
+        LOG_E("LORA", "ERROR: Could not configure for TX!");
         contE++;
-        soakTxErrors++;  // Track for soak test
+        txEndMicros = micros();
+        returnToReceive();  // Try to at least get back to RX
+        return;
+    }
+
+    if (!txStart(next)) {
+        txEndMicros = micros();
         returnToReceive();
-        return false;
     }
 }
 
+size_t txQueueDepth() {
+    size_t depth = 0;
+    for (int i = 0; i < TX_PRIO_COUNT; i++) {
+        depth += txSlotsPerPriority[i];
+    }
+    return depth;
+}
+
+size_t txQueueFree(TxPriority priority) {
+    size_t freeSlots = TX_QUEUE_SLOTS - txQueueDepth();
+    if (priority == TX_PRIO_BULK) {
+        size_t bulkFree = TX_QUEUE_BULK_SLOTS - txSlotsPerPriority[TX_PRIO_BULK];
+        if (bulkFree < freeSlots) freeSlots = bulkFree;
+    }
+    return freeSlots;
+}
+
+bool txQueueIdle() {
+    return txActiveSlot < 0 && txQueueDepth() == 0;
+}
+
+unsigned long radioIdleTime() {
+    if (txActiveSlot >= 0) {
+        // On air: TxDone arrives on DIO0, the timeout is the latest wakeup
+        if (txDoneFlag) return 0;
+        unsigned long elapsed = millis() - txStartMillis;
+        return elapsed < txTimeoutMs ? txTimeoutMs - elapsed : 0;
+    }
+    if (receivedFlag || rxQueueDepth() > 0) return 0;
+    if (RFOK && txPickNext() >= 0) return 0;
+    return RADIO_IDLE_FOREVER;
+}
+
+size_t txQueueMaxDepth() {
+    return txQueueHighWater;
+}
+
+uint32_t txQueueDrops() {
+    uint32_t total = 0;
+    for (int i = 0; i < TX_PRIO_COUNT; i++) {
+        total += txDropsPerPriority[i];
+    }
+    return total;
+}
+
+bool txQueueFlush(unsigned long timeoutMs) {
+    unsigned long start = millis();
+    while (!txQueueIdle() && RFOK) {
+        if (millis() - start >= timeoutMs) {
+            return false;
+        }
+        radioTxTick();
+        feedWatchdog();
+        delay(1);
+    }
+    return txQueueIdle();
+}
+
 // ==================== RADIO RECOVERY ====================
 bool radioNeedsRecovery() {
     // Radio needs recovery if too many consecutive failures
     return (contR > 5 || contE > 5 || !RFOK);
 }
 
+// Recovery is the only path (besides boot) that does a full re-initialisation
 bool recoverRadio() {
-    Serial.println("[LORA] Attempting radio recovery...");
+    RadioLock lock;
+    LOG_W("LORA", "Attempting radio recovery...");
     soakRadioResets++;  // Track for soak test
 
     // Reset counters
     contR = 0;
     contE = 0;
 
+    // Anything on air is lost with the re-initialisation
+    txAbortActive();
+
     // Try to reinitialize
     if (startRadio()) {
-        Serial.println("[LORA] Radio recovered successfully");
+        LOG_I("LORA", "Radio recovered successfully");
         return true;
     }
 
-    Serial.println("[LORA] Radio recovery failed!");
+    LOG_E("LORA", "Radio recovery failed!");
     return false;
 }
+
+// ==================== RX QUEUE ====================
+// Single producer (the RX task, or rxQueuePeek() itself when the task
+// could not start) and single consumer (the main loop). The producer
+// fills slot rxHead and publishes it by advancing rxHead; the consumer
+// parses slot rxTail in place and frees it by advancing rxTail.
+
+static RxPacket rxSlots[RX_QUEUE_SLOTS];
+static RxPacket rxScratch;                  // Drained into when the queue is full
+static volatile uint32_t rxHead = 0;        // Advanced by producer only
+static volatile uint32_t rxTail = 0;        // Advanced by consumer only
+static volatile uint32_t rxDrops = 0;
+static uint8_t rxHighWater = 0;
+
+// Copy the pending packet out of the FIFO if RxDone was seen
+static void rxReadPacket() {
+    RadioLock lock;
+
+    // Cleared under the lock, so radioTxTick() can't start a TX over it
+    // between the check and the read; once TX has started the FIFO holds
+    // outbound data, so a flag left over from the handover is only counted
+    // and cleared - leaving it set would stall TX and light sleep
+    if (!receivedFlag) return;
+    receivedFlag = false;
+    if (radioTransmitting) {
+        rxDrops++;
+        LOG_W("LORA", "WARNING: RxDone during TX handover, uplink lost");
+        return;
+    }
+
+    uint32_t head = rxHead;
+    bool full = (head - rxTail) >= RX_QUEUE_SLOTS;
+    RxPacket* pkt = full ? &rxScratch : &rxSlots[head & (RX_QUEUE_SLOTS - 1)];
+
+    size_t length = radio.getPacketLength();
+    if (length > RX_MAX_PACKET) length = RX_MAX_PACKET;
+
+    // readData() also clears the IRQ flags - needed even when dropping
+    int state = radio.readData((uint8_t*)pkt->data, length);
+    pkt->data[length] = '\0';
+    pkt->length = length;
+    pkt->rssi = radio.getRSSI();
+    pkt->snr = radio.getSNR();
+    pkt->receivedAt = millis();
+
+    if (state != RADIOLIB_ERR_NONE) {
+        LOG_E("LORA", "*** READ ERROR *** code: %d", state);
+        soakRxErrors++;  // Track for soak test
+        return;
+    }
+
+    if (full) {
+        rxDrops++;
+        LOG_W("LORA", "WARNING: RX queue full, uplink dropped");
+        return;
+    }
+
+    __sync_synchronize();  // Publish the packet before the new head
+    rxHead = head + 1;
+
+    uint8_t depth = (uint8_t)(rxHead - rxTail);
+    if (depth > rxHighWater) rxHighWater = depth;
+}
+
+static void rxTask(void* param) {
+    (void)param;
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        rxReadPacket();
+    }
+}
+
+void startRxTask() {
+    if (rxTaskHandle != NULL) return;
+
+    radioMutex = xSemaphoreCreateRecursiveMutex();
+    if (radioMutex == NULL ||
+        xTaskCreatePinnedToCore(rxTask, "radioRx", RX_TASK_STACK, NULL,
+                                RX_TASK_PRIORITY, &rxTaskHandle, RX_TASK_CORE) != pdPASS) {
+        rxTaskHandle = NULL;
+        LOG_E("LORA", "RX task failed to start, reading uplinks from the main loop");
+        return;
+    }
+    LOG_I("LORA", "RX task started");
+
+    // An uplink that arrived before the task existed
+    if (receivedFlag) xTaskNotifyGive(rxTaskHandle);
+}
+
+RxPacket* rxQueuePeek() {
+    if (rxTaskHandle == NULL) {
+        rxReadPacket();
+    }
+
+    uint32_t tail = rxTail;
+    if (rxHead == tail) return NULL;
+    __sync_synchronize();  // Read the packet only after seeing the new head
+    return &rxSlots[tail & (RX_QUEUE_SLOTS - 1)];
+}
+
+void rxQueueRelease() {
+    if (rxHead == rxTail) return;
+    __sync_synchronize();  // Finish with the packet before freeing the slot
+    rxTail = rxTail + 1;
+}
+
+size_t rxQueueDepth() {
+    return rxHead - rxTail;
+}
+
+size_t rxQueueMaxDepth() {
+    return rxHighWater;
+}
+
+uint32_t rxQueueDrops() {
+    return rxDrops;
+}
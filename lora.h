@@ -11,31 +11,114 @@
  * - Uses centralized radio configuration from config.h
  * - Added retry mechanism with counter limits
  * - Improved error handling
+ * - Persistent radio session: TX/RX switching retunes instead of re-init
+ * - Non-blocking priority TX queue drained by radioTxTick()
+ * - Reply capture hook for batched commands
+ * - radioIdleTime() tells the idle sleep how long the radio can wait
+ * - Uplinks are copied out of the radio by an RX task into a queue
+ * - sendMessage() takes text and a length (or a MsgBuilder), no String
+ * - Bulk packets go out on the negotiated link profile (link.h)
  */
 
+#include <stddef.h>
+#include <stdint.h>
+#include "msgbuf.h"
+
+// Maximum uplink packet (SX1276 FIFO) - RX buffers hold this plus a NUL
+#define RX_MAX_PACKET 255
+
+// Outbound packet priority (lower value leaves first)
+typedef enum {
+    TX_PRIO_REPLY = 0,      // Command replies (ground station is waiting)
+    TX_PRIO_TELEMETRY,      // Status telemetry
+    TX_PRIO_BEACON,         // Periodic beacons
+    TX_PRIO_BULK,           // File/list downlinks (budget-limited)
+    TX_PRIO_COUNT
+} TxPriority;
+
 // ISR callback for packet received
 #if defined(ESP8266) || defined(ESP32)
     ICACHE_RAM_ATTR
 #endif
 void setFlag(void);
 
-// Initialize radio in receive mode
+// Initialize radio in receive mode (full SX1276 initialisation)
 // Returns true on success, false on failure
 bool startRadio();
 
-// Send a message via LoRa
-// Automatically switches to TX frequency, transmits, then returns to RX
-// Returns true on success, false on failure
-bool sendMessage(const String& message);
+// Queue a message for transmission via LoRa (non-blocking)
+// The packet goes out from radioTxTick(); returns false if it was rejected
+// (too long, or dropped because the queue/bulk budget is full)
+// The text is copied straight into a queue slot - no intermediate copy
+bool sendMessage(const char* text, size_t length, TxPriority priority = TX_PRIO_REPLY);
+bool sendMessage(const char* text, TxPriority priority = TX_PRIO_REPLY);
+bool sendMessage(const MsgBuilder& message, TxPriority priority = TX_PRIO_REPLY);
+
+// Queue a raw binary packet (up to TX_MAX_PACKET bytes, may contain NULs)
+bool sendPacket(const uint8_t* data, size_t length, TxPriority priority);
+
+// Reply capture: while a sink is set, sendMessage() at TX_PRIO_REPLY hands
+// the text to it instead of queueing (batched commands collect their
+// replies this way). sendPacket() is never captured. NULL restores queueing.
+typedef void (*ReplySink)(const char* text, size_t length);
+void setReplySink(ReplySink sink);
+
+// Drive the TX queue: start the next packet, handle TxDone/timeouts and
+// return to RX when the queue is empty. Call every mainLoop() iteration.
+void radioTxTick();
+
+// Queue state
+size_t txQueueDepth();                     // Packets waiting (incl. on air)
+size_t txQueueFree(TxPriority priority);   // Slots available to this priority
+bool txQueueIdle();                        // Nothing queued, nothing on air
+size_t txQueueMaxDepth();                  // High-water mark since boot
+uint32_t txQueueDrops();                   // Packets dropped since boot
+
+// ms the radio can be left alone (light sleep, DIO0 wakes it earlier):
+// 0 if radioTxTick() or the RX path has work now, the time left to the TX
+// timeout while a packet is on air, RADIO_IDLE_FOREVER when idle in RX
+#define RADIO_IDLE_FOREVER  0xFFFFFFFFUL
+unsigned long radioIdleTime();
+
+// Block until the queue is drained or timeoutMs passes (before restarts)
+// Returns true if everything was sent
+bool txQueueFlush(unsigned long timeoutMs);
+
+// ==================== RX QUEUE ====================
+// DIO0 RxDone -> setFlag() wakes the RX task, which copies the packet and
+// its RSSI/SNR out of the SX1276 FIFO at once - even while mainLoop() is
+// busy in a long handler - into a queue of RX_QUEUE_SLOTS packets. When
+// the queue is full the packet is still read out of the radio but
+// dropped (rxQueueDrops()). receivedFlag means "RxDone not read yet".
+struct RxPacket {
+    char data[RX_MAX_PACKET + 1];   // NUL-terminated, may be parsed in place
+    size_t length;
+    float rssi;                     // dBm
+    float snr;                      // dB
+    unsigned long receivedAt;       // millis()
+};
+
+// Start the RX task (call once after startRadio())
+// Without it rxQueuePeek() reads the radio itself
+void startRxTask();
+
+// Oldest queued packet, NULL if none; valid until rxQueueRelease()
+RxPacket* rxQueuePeek();
+void rxQueueRelease();
+
+size_t rxQueueDepth();           // Packets waiting for the main loop
+size_t rxQueueMaxDepth();        // High-water mark since boot
+uint32_t rxQueueDrops();         // Uplinks dropped on a full queue since boot
 
 // Return radio to receive mode after transmission
+// Records the TX->RX turnaround in radioLastTurnaroundUs/radioMaxTurnaroundUs
 // Returns true on success, false on failure
 bool returnToReceive();
 
 // Check if radio needs recovery (after multiple failures)
 bool radioNeedsRecovery();
 
-// Attempt to recover radio after failures
+// Attempt to recover radio after failures (full re-initialisation)
 bool recoverRadio();
 
 #endif // LORA_H
@@ -0,0 +1,114 @@
+/*
+ * Orbital Temple Satellite - LZSS Block Compressor Implementation
+ * Version: 1.21
+ *
+ * Hash-chain match finder over 3-byte prefixes. The chain length is capped
+ * (LZSS_MAX_CHAIN) so a 2 KB block of repetitive log text costs a bounded
+ * amount of CPU regardless of content.
+ */
+
+#include <string.h>
+#include "lzss.h"
+
+static inline uint32_t lzssHash(const uint8_t* p) {
+    uint32_t v = ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+    return (v * 2654435761u) >> (32 - LZSS_HASH_BITS);
+}
+
+size_t lzssCompress(const uint8_t* in, size_t len, uint8_t* out, LzssWorkspace& ws) {
+    if (len > LZSS_BLOCK_MAX) len = LZSS_BLOCK_MAX;
+
+    for (size_t h = 0; h < (1u << LZSS_HASH_BITS); h++) {
+        ws.head[h] = -1;
+    }
+
+    size_t op = 0;
+    size_t flagPos = 0;
+    uint8_t flagBit = 8;    // Forces a flag byte before the first token
+    size_t i = 0;
+
+    while (i < len) {
+        if (flagBit == 8) {
+            flagPos = op++;
+            out[flagPos] = 0;
+            flagBit = 0;
+        }
+
+        // Longest match among the most recent candidates
+        size_t bestLen = 0;
+        size_t bestDist = 0;
+        if (i + LZSS_MIN_MATCH <= len) {
+            size_t maxLen = len - i;
+            if (maxLen > LZSS_MAX_MATCH) maxLen = LZSS_MAX_MATCH;
+
+            int32_t cand = ws.head[lzssHash(in + i)];
+            for (int chain = 0; cand >= 0 && chain < LZSS_MAX_CHAIN; chain++) {
+                size_t dist = i - (size_t)cand;
+                if (dist > LZSS_MAX_DIST) break;
+
+                size_t l = 0;
+                while (l < maxLen && in[cand + l] == in[i + l]) l++;
+                if (l > bestLen) {
+                    bestLen = l;
+                    bestDist = dist;
+                    if (l == maxLen) break;
+                }
+                cand = ws.prev[cand];
+            }
+        }
+
+        size_t advance;
+        if (bestLen >= LZSS_MIN_MATCH) {
+            uint16_t d = (uint16_t)(bestDist - 1);
+            out[op++] = (uint8_t)(d >> 4);
+            out[op++] = (uint8_t)(((d & 0x0F) << 4) | (bestLen - LZSS_MIN_MATCH));
+            advance = bestLen;
+        } else {
+            out[flagPos] |= (uint8_t)(1 << flagBit);
+            out[op++] = in[i];
+            advance = 1;
+        }
+        flagBit++;
+
+        // Every covered position becomes a candidate for later matches
+        for (size_t k = 0; k < advance; k++, i++) {
+            if (i + LZSS_MIN_MATCH <= len) {
+                uint32_t h = lzssHash(in + i);
+                ws.prev[i] = ws.head[h];
+                ws.head[h] = (int16_t)i;
+            }
+        }
+    }
+
+    return op;
+}
+
+bool lzssDecompress(const uint8_t* in, size_t len, uint8_t* out, size_t outMax, size_t& outLen) {
+    size_t ip = 0;
+    size_t op = 0;
+
+    while (ip < len) {
+        uint8_t flags = in[ip++];
+        for (int bit = 0; bit < 8 && ip < len; bit++) {
+            if (flags & (1 << bit)) {
+                if (op >= outMax) return false;
+                out[op++] = in[ip++];
+                continue;
+            }
+
+            if (ip + 2 > len) return false;
+            size_t dist = (((size_t)in[ip] << 4) | (in[ip + 1] >> 4)) + 1;
+            size_t l = (in[ip + 1] & 0x0F) + LZSS_MIN_MATCH;
+            ip += 2;
+            if (dist > op || op + l > outMax) return false;
+
+            // Byte by byte: the source may overlap what is being written
+            for (size_t k = 0; k < l; k++, op++) {
+                out[op] = out[op - dist];
+            }
+        }
+    }
+
+    outLen = op;
+    return true;
+}
@@ -0,0 +1,51 @@
+#ifndef LZSS_H
+#define LZSS_H
+
+/*
+ * Orbital Temple Satellite - LZSS Block Compressor
+ * Version: 1.21
+ *
+ * Small-window LZSS for compressed bulk downlinks. Each block is
+ * compressed on its own, so a lost packet only costs the block it was in
+ * and the encoder needs no state between blocks.
+ *
+ * STREAM FORMAT (one block):
+ *    A flag byte, then up to eight tokens, repeated. Flag bit i (LSB
+ *    first) describes token i:
+ *      1 = literal: one raw byte
+ *      0 = match:   two bytes [dddddddd][ddddllll]
+ *                   d = distance - 1 (12 bits), l = length - 3 (4 bits)
+ *    The block ends with the input; unused flag bits are ignored.
+ *    Matches may overlap the bytes they produce (runs).
+ *
+ * Host-portable: no Arduino dependencies (test/test_lzss.cpp builds it).
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define LZSS_BLOCK_MAX   2048   // Largest block lzssCompress() accepts
+#define LZSS_MIN_MATCH   3
+#define LZSS_MAX_MATCH   18     // 4-bit length field
+#define LZSS_MAX_DIST    4096   // 12-bit distance field
+#define LZSS_HASH_BITS   10
+#define LZSS_MAX_CHAIN   32     // Candidates tried per position (speed vs ratio)
+
+// Worst case output size: all literals plus one flag byte per eight
+#define LZSS_BOUND(n)    ((n) + ((n) + 7) / 8)
+
+// Match finder state (hash heads + chains), ~6 KB; reused for every block
+struct LzssWorkspace {
+    int16_t head[1 << LZSS_HASH_BITS];
+    int16_t prev[LZSS_BLOCK_MAX];
+};
+
+// Compress len (<= LZSS_BLOCK_MAX) bytes into out, which must hold
+// LZSS_BOUND(len) bytes. Returns the compressed size.
+size_t lzssCompress(const uint8_t* in, size_t len, uint8_t* out, LzssWorkspace& ws);
+
+// Decompress one block. Returns false on a malformed stream or if the
+// output would exceed outMax.
+bool lzssDecompress(const uint8_t* in, size_t len, uint8_t* out, size_t outMax, size_t& outLen);
+
+#endif // LZSS_H
@@ -93,6 +93,7 @@
 #include "config.h"
 #include "setup.h"
 #include "loop.h"
+#include "power.h"
 
 // ==================== ARDUINO SETUP ====================
 void setup() {
@@ -115,4 +116,7 @@ void setup() {
 void loop() {
     // Main state machine
     mainLoop();
+
+    // Light sleep until the next deadline or a radio interrupt
+    idleSleep(mainLoopIdleTime());
 }
@@ -0,0 +1,269 @@
+/*
+ * Orbital Temple Satellite - Directory Manifests Implementation
+ * Version: 1.21
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "manifest.h"
+#include "crc32.h"
+
+static DirManifest slots[MANIFEST_SLOTS];
+static uint32_t useClock = 0;
+
+// ==================== PATHS ====================
+
+// "/a/b/" and "a/b" -> "/a/b"; "" -> "/". False if it does not fit.
+static bool normalize(const char* path, char* out, size_t size) {
+    size_t len = strlen(path);
+    while (len > 0 && path[len - 1] == '/') len--;
+    size_t lead = (len > 0 && path[0] == '/') ? 0 : 1;
+    if (len + lead + 1 > size) return false;
+    out[0] = '/';
+    memcpy(out + lead, path, len);
+    out[len + lead] = '\0';
+    return true;
+}
+
+// Parent directory of a file or directory path and its last component
+static bool splitPath(const char* path, char* parent, char* name, size_t& nameLen) {
+    char full[MANIFEST_PATH_MAX + MANIFEST_NAME_MAX + 2];
+    if (!normalize(path, full, sizeof(full)) || full[1] == '\0') return false;  // Root has no parent
+
+    const char* slash = strrchr(full, '/');
+    size_t parentLen = slash == full ? 1 : (size_t)(slash - full);
+    nameLen = strlen(slash + 1);
+    if (parentLen >= MANIFEST_PATH_MAX || nameLen > MANIFEST_NAME_MAX) return false;
+
+    memcpy(parent, full, parentLen);
+    parent[parentLen] = '\0';
+    memcpy(name, slash + 1, nameLen + 1);
+    return true;
+}
+
+// ==================== CACHE ====================
+
+DirManifest* manifestFind(const char* dir) {
+    char path[MANIFEST_PATH_MAX];
+    if (!normalize(dir, path, sizeof(path))) return NULL;
+    for (int i = 0; i < MANIFEST_SLOTS; i++) {
+        if (slots[i].used && strcmp(slots[i].path, path) == 0) {
+            slots[i].lastUse = ++useClock;
+            return &slots[i];
+        }
+    }
+    return NULL;
+}
+
+DirManifest* manifestClaim(const char* dir) {
+    char path[MANIFEST_PATH_MAX];
+    if (!normalize(dir, path, sizeof(path))) return NULL;
+
+    DirManifest* m = manifestFind(path);
+    for (int i = 0; i < MANIFEST_SLOTS && m == NULL; i++) {
+        if (!slots[i].used) m = &slots[i];
+    }
+    if (m == NULL) {
+        m = &slots[0];
+        for (int i = 1; i < MANIFEST_SLOTS; i++) {
+            if (slots[i].lastUse < m->lastUse) m = &slots[i];
+        }
+    }
+
+    m->used = true;
+    m->complete = false;
+    m->truncated = false;
+    strcpy(m->path, path);
+    m->lastUse = ++useClock;
+    m->count = 0;
+    m->stale = 0;
+    m->poolUsed = 0;
+    return m;
+}
+
+void manifestDrop(const char* dir) {
+    char path[MANIFEST_PATH_MAX];
+    if (!normalize(dir, path, sizeof(path))) return;
+    size_t len = strlen(path);
+    for (int i = 0; i < MANIFEST_SLOTS; i++) {
+        const char* p = slots[i].path;
+        if (slots[i].used && strncmp(p, path, len) == 0 &&
+            (p[len] == '\0' || p[len] == '/' || len == 1)) {
+            slots[i].used = false;
+        }
+    }
+}
+
+void manifestReset() {
+    memset(slots, 0, sizeof(slots));
+    useClock = 0;
+}
+
+// ==================== ENTRIES ====================
+
+bool manifestAdd(DirManifest& m, const char* name, uint32_t size, uint8_t flags, uint8_t tag) {
+    size_t len = strlen(name);
+    if (len == 0 || len > MANIFEST_NAME_MAX || m.count == MANIFEST_MAX_ENTRIES ||
+        m.poolUsed + len > MANIFEST_POOL_SIZE) {
+        m.truncated = true;
+        return false;
+    }
+
+    ManifestEntry& e = m.entries[m.count++];
+    e.size = size;
+    e.nameOffset = m.poolUsed;
+    e.nameLength = (uint8_t)len;
+    e.flags = flags;
+    e.tag = tag;
+    memcpy(m.pool + m.poolUsed, name, len);
+    m.poolUsed += len;
+    if (flags & MANIFEST_STALE) m.stale++;
+    return true;
+}
+
+void manifestRemoveAt(DirManifest& m, uint16_t index) {
+    if (index >= m.count) return;
+    ManifestEntry removed = m.entries[index];
+    if (removed.flags & MANIFEST_STALE) m.stale--;
+
+    // Close the gap in the pool, then in the entry list
+    size_t tail = m.poolUsed - (removed.nameOffset + removed.nameLength);
+    memmove(m.pool + removed.nameOffset, m.pool + removed.nameOffset + removed.nameLength, tail);
+    m.poolUsed -= removed.nameLength;
+    memmove(&m.entries[index], &m.entries[index + 1], (m.count - index - 1) * sizeof(ManifestEntry));
+    m.count--;
+    for (uint16_t i = 0; i < m.count; i++) {
+        if (m.entries[i].nameOffset > removed.nameOffset) {
+            m.entries[i].nameOffset -= removed.nameLength;
+        }
+    }
+}
+
+int manifestIndexOf(const DirManifest& m, const char* name, size_t length) {
+    for (uint16_t i = 0; i < m.count; i++) {
+        const ManifestEntry& e = m.entries[i];
+        if (e.nameLength == length && memcmp(m.pool + e.nameOffset, name, length) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+const char* manifestName(const DirManifest& m, uint16_t index) {
+    return m.pool + m.entries[index].nameOffset;
+}
+
+bool manifestEntryPath(const DirManifest& m, uint16_t index, char* out, size_t size) {
+    const ManifestEntry& e = m.entries[index];
+    int n = snprintf(out, size, "%s%s%.*s", m.path, m.path[1] ? "/" : "",
+                     (int)e.nameLength, m.pool + e.nameOffset);
+    return n > 0 && (size_t)n < size;
+}
+
+void manifestRefreshed(DirManifest& m, uint16_t index, uint32_t size, bool isDir, uint8_t tag) {
+    ManifestEntry& e = m.entries[index];
+    if (e.flags & MANIFEST_STALE) m.stale--;
+    e.size = isDir ? 0 : size;
+    e.flags = isDir ? MANIFEST_DIR : 0;
+    e.tag = tag;
+}
+
+// ==================== UPKEEP ====================
+
+void manifestNoteChanged(const char* path) {
+    char parent[MANIFEST_PATH_MAX];
+    char name[MANIFEST_NAME_MAX + 1];
+    size_t len;
+    if (!splitPath(path, parent, name, len)) return;
+    DirManifest* m = manifestFind(parent);
+    if (m == NULL) return;
+
+    int i = manifestIndexOf(*m, name, len);
+    if (i < 0) {
+        manifestAdd(*m, name, 0, MANIFEST_STALE, 0);
+    } else if (!(m->entries[i].flags & MANIFEST_STALE)) {
+        m->entries[i].flags |= MANIFEST_STALE;
+        m->stale++;
+    }
+}
+
+void manifestNoteRemoved(const char* path) {
+    manifestDrop(path);
+
+    char parent[MANIFEST_PATH_MAX];
+    char name[MANIFEST_NAME_MAX + 1];
+    size_t len;
+    if (!splitPath(path, parent, name, len)) return;
+    DirManifest* m = manifestFind(parent);
+    if (m == NULL) return;
+
+    int i = manifestIndexOf(*m, name, len);
+    if (i >= 0) manifestRemoveAt(*m, (uint16_t)i);
+}
+
+void manifestNoteRenamed(const char* from, const char* to) {
+    manifestNoteRemoved(from);
+    manifestNoteRemoved(to);        // Replaced, if it existed
+    manifestNoteChanged(to);
+}
+
+// ==================== LISTING ====================
+
+uint32_t manifestVersion(const DirManifest& m) {
+    uint32_t crc = crc32Begin();
+    for (uint16_t i = 0; i < m.count; i++) {
+        const ManifestEntry& e = m.entries[i];
+        uint8_t fields[7] = {
+            (uint8_t)e.size, (uint8_t)(e.size >> 8), (uint8_t)(e.size >> 16), (uint8_t)(e.size >> 24),
+            e.flags, e.tag, e.nameLength
+        };
+        crc = crc32Update(crc, fields, sizeof(fields));
+        crc = crc32Update(crc, (const uint8_t*)m.pool + e.nameOffset, e.nameLength);
+    }
+    uint8_t tail = m.truncated ? 1 : 0;
+    return crc32Final(crc32Update(crc, &tail, 1));
+}
+
+uint16_t manifestPack(const DirManifest& m, const char* prefix, uint16_t first, uint16_t end,
+                      bool filesOnly, char* out, size_t size) {
+    if (end > m.count) end = m.count;
+    if (first > end) first = end;
+
+    size_t len = snprintf(out, size, "%s%08lX,%u,%u", prefix, (unsigned long)manifestVersion(m),
+                          first, m.count);
+    if (len >= size) len = size - 1;
+    size_t budget = size > MANIFEST_FOOTER_MAX + 1 ? size - 1 - MANIFEST_FOOTER_MAX : 0;
+
+    uint16_t i = first;
+    for (; i < end; i++) {
+        const ManifestEntry& e = m.entries[i];
+        if (filesOnly && (e.flags & MANIFEST_DIR)) continue;
+
+        char entry[MANIFEST_NAME_MAX + 32];
+        int n;
+        if (e.flags & MANIFEST_DIR) {
+            n = snprintf(entry, sizeof(entry), "|D:%.*s", (int)e.nameLength, m.pool + e.nameOffset);
+        } else if (e.tag != 0) {
+            n = snprintf(entry, sizeof(entry), "|F:%.*s,%lu,v%u", (int)e.nameLength,
+                         m.pool + e.nameOffset, (unsigned long)e.size, e.tag);
+        } else {
+            n = snprintf(entry, sizeof(entry), "|F:%.*s,%lu", (int)e.nameLength,
+                         m.pool + e.nameOffset, (unsigned long)e.size);
+        }
+        if (len + n > budget) break;
+        memcpy(out + len, entry, n);
+        len += n;
+    }
+
+    // Whatever the budget held back is always enough for the footer
+    if (i == end) {
+        const char* footer = end < m.count ? NULL : (m.truncated ? "|END:TRUNCATED" : "|END");
+        if (footer) {
+            len += snprintf(out + len, size - len, "%s", footer);
+        } else {
+            len += snprintf(out + len, size - len, "|NEXT:%u", end);
+        }
+    }
+    out[len] = '\0';
+    return i;
+}
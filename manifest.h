@@ -0,0 +1,124 @@
+#ifndef MANIFEST_H
+#define MANIFEST_H
+
+/*
+ * Orbital Temple Satellite - Directory Manifests
+ * Version: 1.21
+ *
+ * Walking a directory on the card opens every entry in turn, which is
+ * what made listings slow and one packet per file. A manifest is a RAM
+ * copy of one directory's entries - name, size, file or directory - read
+ * from the card once and then kept current by the firmware's own create,
+ * write, rename and delete paths (manifestNote*()), so a listing is built
+ * from RAM and packed many entries to a frame.
+ *
+ * UPKEEP:
+ *   Writers only say which path changed; the entry is marked STALE (and
+ *   added if new) and memor.cpp re-reads just that entry from the card
+ *   before the next listing of its directory. Removals and renames take
+ *   effect at once. Notes for directories that are not cached cost a few
+ *   string compares and nothing else.
+ *
+ * VERSION:
+ *   manifestVersion() is a CRC32 over the entries in order, so the same
+ *   contents give the same stamp after a reboot and ground can skip or
+ *   resume a listing it already holds.
+ *
+ * FRAMES (manifestPack()):
+ *   "<prefix><version hex>,<first>,<total>|D:name|F:name,size|F:name,size,v<tag>..."
+ *   entries numbered from 0 in manifest order; the last frame of a page
+ *   ends in "|NEXT:<n>" (more entries follow), "|END" or "|END:TRUNCATED"
+ *   (the directory had more entries than a manifest holds).
+ *
+ * Host-portable: no SD access, the caller fills and refreshes the entries
+ * (test/test_manifest.cpp builds it).
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ==================== CONFIGURATION ====================
+
+#define MANIFEST_SLOTS        4         // Directories cached at once (least recently used goes)
+#define MANIFEST_MAX_ENTRIES  100       // Per directory, as the old listing limit
+#define MANIFEST_POOL_SIZE    1600      // Name bytes per directory
+#define MANIFEST_PATH_MAX     64
+#define MANIFEST_NAME_MAX     96        // Longer names are left out (TRUNCATED)
+#define MANIFEST_FOOTER_MAX   16        // "|END:TRUNCATED" / "|NEXT:nnn"
+
+// Entry flags
+#define MANIFEST_DIR          0x01
+#define MANIFEST_STALE        0x02      // Changed on the card since it was read
+
+struct ManifestEntry {
+    uint32_t size;
+    uint16_t nameOffset;        // In the manifest's name pool
+    uint8_t nameLength;
+    uint8_t flags;
+    uint8_t tag;                // Caller-defined (accel format version), 0 = none
+};
+
+struct DirManifest {
+    bool used;
+    bool complete;              // Whole directory read from the card
+    bool truncated;             // It held entries that did not fit
+    char path[MANIFEST_PATH_MAX];
+    uint32_t lastUse;
+    uint16_t count;
+    uint16_t stale;             // Entries flagged MANIFEST_STALE
+    uint16_t poolUsed;
+    ManifestEntry entries[MANIFEST_MAX_ENTRIES];
+    char pool[MANIFEST_POOL_SIZE];
+};
+
+// ==================== CACHE ====================
+
+// Cached manifest of this directory, or NULL
+DirManifest* manifestFind(const char* dir);
+
+// Empty manifest for 'dir', evicting the least recently used; NULL if the
+// path is too long
+DirManifest* manifestClaim(const char* dir);
+
+// Forget one directory (and those below it), or all of them
+void manifestDrop(const char* dir);
+void manifestReset();
+
+// ==================== ENTRIES ====================
+
+// Append an entry; false (and truncated set) if it does not fit
+bool manifestAdd(DirManifest& m, const char* name, uint32_t size, uint8_t flags, uint8_t tag);
+
+void manifestRemoveAt(DirManifest& m, uint16_t index);
+
+// Index of the entry with this name, -1 if none
+int manifestIndexOf(const DirManifest& m, const char* name, size_t length);
+
+// Entry name (not NUL-terminated) and its full path into 'out'
+const char* manifestName(const DirManifest& m, uint16_t index);
+bool manifestEntryPath(const DirManifest& m, uint16_t index, char* out, size_t size);
+
+// Re-read from the card: new size, flags and tag, STALE cleared
+void manifestRefreshed(DirManifest& m, uint16_t index, uint32_t size, bool isDir, uint8_t tag);
+
+// ==================== UPKEEP ====================
+
+// Created, written or resized
+void manifestNoteChanged(const char* path);
+
+// Deleted (a directory also drops its own manifest)
+void manifestNoteRemoved(const char* path);
+
+void manifestNoteRenamed(const char* from, const char* to);
+
+// ==================== LISTING ====================
+
+uint32_t manifestVersion(const DirManifest& m);
+
+// One frame of entries [first, end) into 'out' (NUL-terminated), as many
+// as fit in 'size' - 1 bytes; entries flagged MANIFEST_DIR are skipped if
+// filesOnly. Returns the index after the last entry packed.
+uint16_t manifestPack(const DirManifest& m, const char* prefix, uint16_t first, uint16_t end,
+                      bool filesOnly, char* out, size_t size);
+
+#endif // MANIFEST_H
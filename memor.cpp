@@ -17,105 +17,782 @@
  * 2. Added SD card availability check (SDOK) before operations
  *
  * 3. Added proper file handle closing in all error paths
+ *
+ * 4. NON-BLOCKING BULK DOWNLINKS:
+ *    listDir(), readFile() and listArtworks() used to send every packet
+ *    inline with delay(50) between them. They now start a bulk job that
+ *    bulkDownlinkTick() advances as TX queue space frees up. readFile()
+ *    sends raw bytes, so chunks containing NULs are no longer truncated.
+ *
+ * 5. BURST FILE DOWNLINK:
+ *    readFileBurst() sends numbered full-size binary frames back-to-back
+ *    with a whole-file CRC32; readFileRange() resends only the frames
+ *    ground reports missing instead of the whole file.
+ *
+ * 6. BACKGROUND LOG WRITER:
+ *    logToSD() used to open, append and close /log.txt (plus two capacity
+ *    queries) inline for every line. Records now go through a lock-free
+ *    ring to a writer task on core 0 that keeps the file open and writes
+ *    whole sectors, flushing on a timer or via logFlush() before a restart.
+ *
+ * 7. O(1) FREE SPACE CHECKS:
+ *    hasSDSpace() and getSDFreePercent() called SD.usedBytes() (a FAT
+ *    walk) on every write and every telemetry packet. The free space is
+ *    now tracked from our own writes and reconciled in the log writer task.
+ *
+ * 8. INDEXED ARTWORK STORE:
+ *    listArtworks() re-read the whole log with readStringUntil() and
+ *    nothing stopped the same CID being stored twice. A fixed-record index
+ *    and a sorted CID hash file now give paged listing, a binary-searched
+ *    duplicate check and single-artwork lookup.
+ *
+ * 9. COMPRESSED BULK DOWNLINKS:
+ *    readFileCompressed() and listDir(..., compressed) pass their bytes
+ *    through an LZSS block compressor (lzss.cpp) instead of sending raw
+ *    text; logs and listings typically shrink to a third.
+ *
+ * 10. CACHED, PAGED LISTINGS:
+ *    listDir() and accelListRecordings() walked the card on every request
+ *    and sent a packet per entry. Listings now come from a RAM manifest of
+ *    the directory (manifest.cpp) that the write paths keep current, packed
+ *    many entries to a frame, in pages ground can resume or skip by version.
  */
 
 #include <Arduino.h>
 #include "config.h"
+#include "log.h"
 #include "memor.h"
 #include "lora.h"
+#include "radiation.h"
+#include "crc32.h"
+#include "lzss.h"
+#include "accel.h"
+#include "perf.h"
+#include "manifest.h"
 
 // Maximum chunk size for LoRa transmission
 #define LORA_CHUNK_SIZE 200
 
 // ==================== SD AVAILABILITY CHECK ====================
+// One timed write call (PERF_SD_WRITE)
+static size_t sdWrite(File &file, const uint8_t *data, size_t len) {
+    PerfScope perf(PERF_SD_WRITE);
+    return file.write(data, len);
+}
+
 bool isSDAvailable() {
     if (!SDOK) {
-        Serial.println("[SD] ERROR: SD card not available!");
+        LOG_E("SD", "ERROR: SD card not available!");
         sendMessage("ERR:SD_NOT_AVAILABLE");
         return false;
     }
     return true;
 }
 
-// ==================== LIST DIRECTORY ====================
-void listDir(fs::FS &fs, const char *dirname, uint8_t levels) {
-    if (!isSDAvailable()) return;
+// ==================== BULK DOWNLINK JOB ====================
+// Directory listings, file reads and the artwork list can produce hundreds
+// of packets. Instead of pushing them all at once (and blocking on every
+// transmission) one job at a time is advanced from bulkDownlinkTick(), which
+// only produces packets while the TX queue has bulk room left.
+
+#define BULK_MAX_DEPTH       4    // Directory nesting the lister will follow
+#define BULK_STEPS_PER_TICK  4    // Max SD reads per mainLoop() iteration
+#define MAX_DIR_ENTRIES      100  // Limit to prevent infinite loops
+
+typedef enum {
+    BULK_IDLE,
+    BULK_LIST_DIR,
+    BULK_LIST_PAGE,
+    BULK_READ_FILE,
+    BULK_READ_BURST,
+    BULK_LIST_ARTWORKS,
+    BULK_READ_ZFILE,
+    BULK_Z_TRAILER
+} BulkJobType;
+
+struct BulkJob {
+    BulkJobType type;
+    bool headerPending;
+
+    // Directory listing: stack of open directories (replaces recursion)
+    File dirs[BULK_MAX_DEPTH];
+    int dirCounts[BULK_MAX_DEPTH];
+    uint8_t depth;
+    uint8_t levels;
+
+    // File read / artwork list (aux = artworks.idx)
+    File file;
+    File aux;
+    char path[64];
+    size_t fileSize;
+    size_t totalSent;
+    int count;
+    uint32_t artNext;
+    uint32_t artEnd;
+
+    // Paged listing: dirs[0] stays open while the manifest is being read
+    DirManifest *manifest;
+    const char *pagePrefix;
+    bool pageFilesOnly;
+    ListPage page;
+    uint16_t pageNext;
+
+    // Binary burst: frames come from the range list (whole file = 0..total-1)
+    uint8_t transferId;
+    uint16_t frameTotal;
+    uint16_t frameCount;          // Frames this job will send
+    uint32_t fileCRC;             // Whole burst: running CRC of the frames read
+    char rangeSpec[BURST_RANGE_SPEC_MAX + 1];
+    uint8_t rangeCursor;
+    int32_t rangeLo;
+    int32_t rangeHi;
+};
+
+static BulkJob bulkJob;
+static uint8_t burstTransferCounter = 0;
+
+// CRC of the last whole burst, for its range retries (same path and size)
+struct BurstCRC {
+    bool valid;
+    char path[64];
+    size_t size;
+    uint32_t crc;
+};
+static BurstCRC burstCRC;
+
+// Compressed stream state (one job at a time, so one stream)
+struct BulkZStream {
+    bool enabled;
+    uint8_t in[LZ_BLOCK_SIZE];              // Raw bytes of the block being filled
+    size_t inLen;
+    uint8_t out[LZSS_BOUND(LZ_BLOCK_SIZE)]; // Compressed block being sent
+    size_t outLen;
+    size_t outSent;
+    uint16_t block;
+    uint8_t part;
+    uint32_t rawTotal;
+    uint32_t zTotal;
+};
+
+static BulkZStream bulkZ;
+static LzssWorkspace bulkZWork;
+
+bool bulkDownlinkBusy() {
+    return bulkJob.type != BULK_IDLE;
+}
 
-    // Feed watchdog - directory listing can take time
-    feedWatchdog();
+static bool bulkRejectIfBusy() {
+    if (bulkDownlinkBusy()) {
+        LOG_W("SD", "Downlink already in progress");
+        sendMessage("ERR:DOWNLINK_BUSY");
+        return true;
+    }
+    return false;
+}
 
-    Serial.printf("[SD] Listing directory: %s\n", dirname);
+static void bulkFinish() {
+    while (bulkJob.depth > 0) {
+        bulkJob.depth--;
+        bulkJob.dirs[bulkJob.depth].close();
+    }
+    if (bulkJob.file) bulkJob.file.close();
+    if (bulkJob.aux) bulkJob.aux.close();
+    bulkJob.type = BULK_IDLE;
+    bulkZ.enabled = false;
+}
 
-    File root = fs.open(dirname);
-    if (!root) {
-        Serial.println("[SD] Failed to open directory");
-        sendMessage("ERR:OPEN_DIR_FAILED");
+// ==================== COMPRESSED STREAM ====================
+// Frame: [LZ_FRAME_TYPE][block u16 BE][part | LZ_LAST_PART][payload]
+// Each block of up to LZ_BLOCK_SIZE raw bytes is compressed on its own and
+// split over as many frames as it needs, so a lost frame spoils one block.
+
+static void bulkZStart() {
+    bulkZ.enabled = true;
+    bulkZ.inLen = 0;
+    bulkZ.outLen = 0;
+    bulkZ.outSent = 0;
+    bulkZ.block = 0;
+    bulkZ.part = 0;
+    bulkZ.rawTotal = 0;
+    bulkZ.zTotal = 0;
+}
+
+static bool bulkZPending() {
+    return bulkZ.enabled && bulkZ.outSent < bulkZ.outLen;
+}
+
+static uint8_t bulkZPercent(uint32_t zsize, uint32_t raw) {
+    return raw == 0 ? 100 : (uint8_t)(((uint64_t)zsize * 100 + raw - 1) / raw);
+}
+
+// Compress the filled input (only once the previous block has gone out)
+static void bulkZCompressBlock() {
+    if (bulkZ.inLen == 0) return;
+    bulkZ.outLen = lzssCompress(bulkZ.in, bulkZ.inLen, bulkZ.out, bulkZWork);
+    LOG_D("SD", "Block %u: %u -> %u bytes (%u%%)", bulkZ.block, (unsigned)bulkZ.inLen,
+          (unsigned)bulkZ.outLen, bulkZPercent(bulkZ.outLen, bulkZ.inLen));
+    bulkZ.outSent = 0;
+    bulkZ.part = 0;
+    bulkZ.rawTotal += bulkZ.inLen;
+    bulkZ.zTotal += bulkZ.outLen;
+    bulkZ.inLen = 0;
+}
+
+static void bulkZSendPart() {
+    uint8_t packet[LZ_HEADER_SIZE + LZ_PAYLOAD];
+    size_t n = bulkZ.outLen - bulkZ.outSent;
+    if (n > LZ_PAYLOAD) n = LZ_PAYLOAD;
+    bool last = (bulkZ.outSent + n == bulkZ.outLen);
+
+    packet[0] = LZ_FRAME_TYPE;
+    packet[1] = (uint8_t)(bulkZ.block >> 8);
+    packet[2] = (uint8_t)(bulkZ.block & 0xFF);
+    packet[3] = bulkZ.part | (last ? LZ_LAST_PART : 0);
+    memcpy(packet + LZ_HEADER_SIZE, bulkZ.out + bulkZ.outSent, n);
+
+    sendPacket(packet, LZ_HEADER_SIZE + n, TX_PRIO_BULK);
+    bulkZ.outSent += n;
+    bulkZ.part++;
+    if (last) bulkZ.block++;
+}
+
+// Text line of a listing: its own packet, or newline-terminated into the stream
+static void bulkEmitLine(const MsgBuilder &line) {
+    if (!bulkZ.enabled) {
+        sendMessage(line, TX_PRIO_BULK);
         return;
     }
 
-    if (!root.isDirectory()) {
-        Serial.println("[SD] Not a directory");
-        sendMessage("ERR:NOT_A_DIRECTORY");
+    size_t len = line.length();
+    if (len + 1 > LZ_BLOCK_SIZE) len = LZ_BLOCK_SIZE - 1;
+    if (bulkZ.inLen + len + 1 > LZ_BLOCK_SIZE) {
+        bulkZCompressBlock();
+    }
+    memcpy(bulkZ.in + bulkZ.inLen, line.c_str(), len);
+    bulkZ.inLen += len;
+    bulkZ.in[bulkZ.inLen++] = '\n';
+}
+
+// End of a job's content: plain jobs finish, compressed ones flush the
+// last block and send the ENDZ trailer once it has drained
+static void bulkComplete() {
+    if (!bulkZ.enabled) {
+        bulkFinish();
+        return;
+    }
+    bulkZCompressBlock();
+    bulkJob.type = BULK_Z_TRAILER;
+}
+
+static void bulkZTrailerStep() {
+    char trailer[64];
+    snprintf(trailer, sizeof(trailer), "ENDZ:%u,%lu,%lu,%u%%",
+             bulkZ.block, (unsigned long)bulkZ.rawTotal, (unsigned long)bulkZ.zTotal,
+             bulkZPercent(bulkZ.zTotal, bulkZ.rawTotal));
+    sendMessage(trailer, TX_PRIO_BULK);
+    LOG_I("SD", "Compressed downlink: %lu -> %lu bytes in %u blocks",
+          (unsigned long)bulkZ.rawTotal, (unsigned long)bulkZ.zTotal, bulkZ.block);
+    bulkFinish();
+}
+
+// Directory walk, for the compressed listing
+static bool bulkStartListing(File &root, uint8_t levels, bool compressed) {
+    if (bulkRejectIfBusy()) {
         root.close();
+        return false;
+    }
+
+    if (compressed) {
+        Reply header;
+        header.add("LISTZ:").add(root.path());
+        sendMessage(header, TX_PRIO_BULK);
+        bulkZStart();
+    }
+
+    bulkJob.type = BULK_LIST_DIR;
+    bulkJob.headerPending = true;
+    bulkJob.levels = levels;
+    bulkJob.depth = 1;
+    bulkJob.dirs[0] = root;
+    bulkJob.dirCounts[0] = 0;
+    bulkJob.count = 0;
+    return true;
+}
+
+// One directory-listing step: header, one entry, or end of a directory
+static void bulkListStep() {
+    uint8_t top = bulkJob.depth - 1;
+    File &dir = bulkJob.dirs[top];
+
+    Reply line;
+    if (bulkJob.headerPending) {
+        bulkJob.headerPending = false;
+        bulkEmitLine(line.add("DIR:").add(dir.path()));
+        return;
+    }
+
+    File file;
+    if (bulkJob.dirCounts[top] < MAX_DIR_ENTRIES) {
+        file = dir.openNextFile();
+    }
+
+    if (!file) {
+        // Directory exhausted - send end marker and pop
+        LOG_I("SD", "Listed %d items", bulkJob.dirCounts[top]);
+        dir.close();
+        bulkJob.depth--;
+        bulkEmitLine(line.add("END:DIR"));
+
+        if (bulkJob.depth == 0) {
+            bulkComplete();
+        }
         return;
     }
 
-    // Send header
-    sendMessage("DIR:" + String(dirname));
-    delay(100);
+    // Each entry goes out separately - nothing accumulates
+    bulkJob.dirCounts[top]++;
+    if (file.isDirectory()) {
+        LOG_D("SD", "  DIR: %s", file.name());
+        bulkEmitLine(line.add("D:").add(file.name()));
+
+        // Descend if requested (with limit); header follows on the next step
+        uint8_t level = bulkJob.depth - 1;
+        if (level < bulkJob.levels && bulkJob.depth < BULK_MAX_DEPTH) {
+            bulkJob.dirs[bulkJob.depth] = file;
+            bulkJob.dirCounts[bulkJob.depth] = 0;
+            bulkJob.depth++;
+            bulkJob.headerPending = true;
+            return;
+        }
+    } else {
+        LOG_D("SD", "  FILE: %s  SIZE: %d", file.name(), file.size());
+        bulkEmitLine(line.add("F:").add(file.name()).add(',').addU(file.size()));
+    }
+    file.close();
+}
 
-    File file = root.openNextFile();
-    int fileCount = 0;
-    const int MAX_FILES = 100;  // Limit to prevent infinite loops
+// ==================== PAGED LISTING ====================
+// Three phases, one card access or one frame per step: read the directory
+// into its manifest (first listing only), re-read the entries the write
+// paths marked stale, then pack frames from RAM.
 
-    while (file && fileCount < MAX_FILES) {
-        // Feed watchdog during long operations
-        feedWatchdog();
+// Accel recordings carry their format version (sidecars have none)
+static uint8_t bulkEntryTag(const char *dir, File &file) {
+    if (file.isDirectory() || strcmp(dir, ACCEL_DIR) != 0) return 0;
+    return accelFileVersion(file);
+}
+
+bool parseListPage(const char *spec, ListPage &page) {
+    page.offset = 0;
+    page.count = 0;
+    page.haveVersion = false;
+    page.version = 0;
+
+    const char *p = spec;
+    char *end;
+    for (int field = 0; field < 3 && *p != '\0'; field++) {
+        if (*p != ',') {
+            unsigned long v = strtoul(p, &end, field == 2 ? 16 : 10);
+            if (end == p) return false;
+            if (field == 0) page.offset = v;
+            if (field == 1) page.count = v;
+            if (field == 2) {
+                page.version = v;
+                page.haveVersion = true;
+            }
+            p = end;
+        }
+        if (*p == ',') p++;
+        else if (*p != '\0') return false;
+    }
+    return *p == '\0';
+}
+
+bool bulkStartPage(const char *dirname, const char *prefix, bool filesOnly, const ListPage &page) {
+    if (bulkRejectIfBusy()) return true;
+
+    // The log writer task appends without notes: its file is always re-read
+    manifestNoteChanged(LOG_FILE_PATH);
+
+    DirManifest *m = manifestFind(dirname);
+    if (m == NULL || !m->complete) {
+        File dir = SD.open(dirname);
+        if (!dir || !dir.isDirectory()) {
+            if (dir) dir.close();
+            return false;
+        }
+        m = manifestClaim(dirname);
+        if (m == NULL) {
+            dir.close();
+            return false;
+        }
+        bulkJob.dirs[0] = dir;
+        bulkJob.depth = 1;
+        LOG_I("SD", "Reading manifest of %s", m->path);
+    }
 
-        // FIXED: Send each entry separately instead of accumulating
-        // This prevents unbounded memory growth
-        String entry = "";
+    bulkJob.type = BULK_LIST_PAGE;
+    bulkJob.headerPending = true;
+    bulkJob.manifest = m;
+    bulkJob.pagePrefix = prefix;
+    bulkJob.pageFilesOnly = filesOnly;
+    bulkJob.page = page;
+    bulkJob.count = 0;
+    return true;
+}
 
-        if (file.isDirectory()) {
-            entry = "D:" + String(file.name());
-            Serial.print("[SD]   DIR: ");
-            Serial.println(file.name());
+static void bulkPageStep() {
+    DirManifest &m = *bulkJob.manifest;
+    if (!m.used) {
+        // Directory removed under the listing
+        sendMessage("ERR:OPEN_DIR_FAILED", TX_PRIO_BULK);
+        bulkFinish();
+        return;
+    }
 
-            // Recurse if requested (with limit)
-            if (levels > 0) {
-                listDir(fs, file.path(), levels - 1);
+    if (bulkJob.depth > 0) {
+        File &dir = bulkJob.dirs[0];
+        File file;
+        if (m.count < MANIFEST_MAX_ENTRIES) file = dir.openNextFile();
+        if (!file) {
+            if (m.count == MANIFEST_MAX_ENTRIES && dir.openNextFile()) m.truncated = true;
+            dir.close();
+            bulkJob.depth = 0;
+            m.complete = true;
+            return;
+        }
+        manifestAdd(m, file.name(), file.isDirectory() ? 0 : file.size(),
+                    file.isDirectory() ? MANIFEST_DIR : 0, bulkEntryTag(m.path, file));
+        file.close();
+        return;
+    }
+
+    if (m.stale > 0) {
+        for (uint16_t i = 0; i < m.count; i++) {
+            if (!(m.entries[i].flags & MANIFEST_STALE)) continue;
+            char path[MANIFEST_PATH_MAX + MANIFEST_NAME_MAX + 2];
+            File file;
+            if (manifestEntryPath(m, i, path, sizeof(path))) file = SD.open(path);
+            if (!file) {
+                manifestRemoveAt(m, i);        // Gone (or failed before it was created)
+                return;
             }
+            manifestRefreshed(m, i, file.size(), file.isDirectory(), bulkEntryTag(m.path, file));
+            file.close();
+            return;
+        }
+    }
+
+    char frame[TX_MAX_PACKET + 1];
+    if (bulkJob.headerPending) {
+        bulkJob.headerPending = false;
+        uint32_t version = manifestVersion(m);
+        bulkJob.pageNext = bulkJob.page.offset < m.count ? bulkJob.page.offset : m.count;
+        if (bulkJob.page.haveVersion && bulkJob.page.version == version) {
+            snprintf(frame, sizeof(frame), "%s%08lX,%u,%u|UNCHANGED", bulkJob.pagePrefix,
+                     (unsigned long)version, bulkJob.pageNext, m.count);
+            sendMessage(frame, TX_PRIO_BULK);
+            bulkFinish();
+            return;
+        }
+    }
+
+    // Entries may have gone since the page started; the version shows it
+    uint32_t end = bulkJob.page.count == 0 ? m.count : bulkJob.page.offset + bulkJob.page.count;
+    if (end > m.count) end = m.count;
+    if (bulkJob.pageNext > end) bulkJob.pageNext = end;
+
+    bulkJob.pageNext = manifestPack(m, bulkJob.pagePrefix, bulkJob.pageNext, end,
+                                    bulkJob.pageFilesOnly, frame, sizeof(frame));
+    sendMessage(frame, TX_PRIO_BULK);
+    bulkJob.count++;
+
+    if (bulkJob.pageNext >= end) {
+        LOG_I("SD", "Listed %s in %d frames", m.path, bulkJob.count);
+        bulkFinish();
+    }
+}
+
+// One file-read step: header, one raw chunk, or end marker
+static void bulkReadStep() {
+    if (bulkJob.headerPending) {
+        bulkJob.headerPending = false;
+        Reply header;
+        header.add("FILE:").add(bulkJob.path).add(',').addU(bulkJob.fileSize);
+        sendMessage(header, TX_PRIO_BULK);
+        return;
+    }
+
+    if (bulkJob.file.available() && bulkJob.totalSent < bulkJob.fileSize) {
+        // Raw bytes - binary files and NULs survive (String(buffer) truncated them)
+        uint8_t buffer[LORA_CHUNK_SIZE];
+        size_t bytesRead = bulkJob.file.read(buffer, LORA_CHUNK_SIZE);
+        if (bytesRead > 0) {
+            sendPacket(buffer, bytesRead, TX_PRIO_BULK);
+            bulkJob.totalSent += bytesRead;
+            bulkJob.count++;
+            LOG_D("SD", "Queued chunk %d, %d/%d bytes", bulkJob.count, bulkJob.totalSent, bulkJob.fileSize);
+            return;
+        }
+    }
+
+    sendMessage("END:FILE", TX_PRIO_BULK);
+    LOG_I("SD", "File read complete, %d bytes in %d chunks", bulkJob.totalSent, bulkJob.count);
+    bulkFinish();
+}
+
+// One compressed-read step: header, or read and compress the next block
+// (its frames then go out before the next step runs)
+static void bulkReadZStep() {
+    if (bulkJob.headerPending) {
+        bulkJob.headerPending = false;
+        char header[TX_MAX_PACKET + 1];
+        snprintf(header, sizeof(header), "FILEZ:%s,%lu,%u",
+                 bulkJob.path, (unsigned long)bulkJob.fileSize, bulkJob.frameTotal);
+        sendMessage(header, TX_PRIO_BULK);
+        return;
+    }
+
+    if (bulkJob.file.available()) {
+        bulkZ.inLen = bulkJob.file.read(bulkZ.in, LZ_BLOCK_SIZE);
+        if (bulkZ.inLen > 0) {
+            bulkZCompressBlock();
+            return;
+        }
+    }
+
+    bulkComplete();
+}
+
+// Parse the next "a" or "a-b" token of a frame list such as "3,7,10-12"
+// Returns false at the end of the list or on a malformed token
+static bool burstParseRange(const char* spec, uint8_t& cursor, int32_t& lo, int32_t& hi) {
+    while (spec[cursor] == ',') cursor++;
+    if (!isdigit((unsigned char)spec[cursor])) return false;
+
+    lo = 0;
+    while (isdigit((unsigned char)spec[cursor]) && lo <= 0xFFFF) {
+        lo = lo * 10 + (spec[cursor++] - '0');
+    }
+    hi = lo;
+
+    if (spec[cursor] == '-') {
+        cursor++;
+        if (!isdigit((unsigned char)spec[cursor])) return false;
+        hi = 0;
+        while (isdigit((unsigned char)spec[cursor]) && hi <= 0xFFFF) {
+            hi = hi * 10 + (spec[cursor++] - '0');
+        }
+    }
+
+    if (spec[cursor] != ',' && spec[cursor] != '\0') return false;
+    return lo <= hi;
+}
+
+// Next frame number to send, -1 when the job is done
+static int32_t burstNextFrame() {
+    while (bulkJob.rangeLo > bulkJob.rangeHi) {
+        if (bulkJob.rangeSpec[0] == '\0' ||
+            !burstParseRange(bulkJob.rangeSpec, bulkJob.rangeCursor, bulkJob.rangeLo, bulkJob.rangeHi)) {
+            return -1;
+        }
+    }
+    return bulkJob.rangeLo++;
+}
+
+// One burst step: header, one numbered frame, or trailer
+static void bulkBurstStep() {
+    if (bulkJob.headerPending) {
+        bulkJob.headerPending = false;
+        char header[TX_MAX_PACKET + 1];
+        if (bulkJob.rangeSpec[0] == '\0') {
+            snprintf(header, sizeof(header), "FILEB:%u,%s,%lu,%u",
+                     bulkJob.transferId, bulkJob.path, (unsigned long)bulkJob.fileSize,
+                     bulkJob.frameTotal);
         } else {
-            entry = "F:" + String(file.name()) + "," + String(file.size());
-            Serial.printf("[SD]   FILE: %s  SIZE: %d\n", file.name(), file.size());
+            snprintf(header, sizeof(header), "FILER:%u,%s,%lu,%u,%u",
+                     bulkJob.transferId, bulkJob.path, (unsigned long)bulkJob.fileSize,
+                     bulkJob.frameTotal, bulkJob.frameCount);
+        }
+        sendMessage(header, TX_PRIO_BULK);
+        return;
+    }
+
+    int32_t frame = burstNextFrame();
+    if (frame >= 0) {
+        uint8_t packet[BURST_HEADER_SIZE + BURST_PAYLOAD];
+        size_t offset = (size_t)frame * BURST_PAYLOAD;
+
+        // Sequential bursts never seek; range requests jump between frames
+        if (bulkJob.file.position() != offset) {
+            bulkJob.file.seek(offset);
         }
+        size_t bytesRead = bulkJob.file.read(packet + BURST_HEADER_SIZE, BURST_PAYLOAD);
+        if (bulkJob.rangeSpec[0] == '\0') {
+            bulkJob.fileCRC = crc32Update(bulkJob.fileCRC, packet + BURST_HEADER_SIZE, bytesRead);
+        }
+
+        packet[0] = BURST_FRAME_TYPE;
+        packet[1] = bulkJob.transferId;
+        packet[2] = (uint8_t)(frame >> 8);
+        packet[3] = (uint8_t)(frame & 0xFF);
+        packet[4] = (uint8_t)(bulkJob.frameTotal >> 8);
+        packet[5] = (uint8_t)(bulkJob.frameTotal & 0xFF);
+
+        sendPacket(packet, BURST_HEADER_SIZE + bytesRead, TX_PRIO_BULK);
+        bulkJob.totalSent += bytesRead;
+        bulkJob.count++;
+        return;
+    }
+
+    // A whole burst read every byte in order; its CRC is kept for retries
+    bool haveCRC = false;
+    uint32_t crc = 0;
+    if (bulkJob.rangeSpec[0] == '\0') {
+        crc = crc32Final(bulkJob.fileCRC);
+        haveCRC = bulkJob.totalSent == bulkJob.fileSize;
+        burstCRC.valid = haveCRC;
+        strcpy(burstCRC.path, bulkJob.path);
+        burstCRC.size = bulkJob.fileSize;
+        burstCRC.crc = crc;
+    } else if (burstCRC.valid && burstCRC.size == bulkJob.fileSize &&
+               strcmp(burstCRC.path, bulkJob.path) == 0) {
+        crc = burstCRC.crc;
+        haveCRC = true;
+    }
 
-        // Send this entry
-        sendMessage(entry);
-        delay(50);  // Small delay between transmissions
+    char trailer[32];
+    if (haveCRC) {
+        snprintf(trailer, sizeof(trailer), "ENDB:%u,%08lX", bulkJob.transferId, (unsigned long)crc);
+    } else {
+        snprintf(trailer, sizeof(trailer), "ENDB:%u", bulkJob.transferId);
+    }
+    sendMessage(trailer, TX_PRIO_BULK);
+    LOG_I("SD", "Burst %u complete, %d frames, %d bytes",
+          bulkJob.transferId, bulkJob.count, bulkJob.totalSent);
+    bulkFinish();
+}
 
-        file = root.openNextFile();
-        fileCount++;
+// One artwork-list step: header, one entry, or footer
+static bool artSendRecord(File &idx, File &log, uint32_t n, TxPriority prio);
+
+static void bulkArtworkStep() {
+    if (bulkJob.headerPending) {
+        bulkJob.headerPending = false;
+        char header[64];
+        snprintf(header, sizeof(header), "ART:LIST_START|OFFSET:%lu|TOTAL:%lu",
+                 (unsigned long)bulkJob.artNext, (unsigned long)artworkCount());
+        sendMessage(header, TX_PRIO_BULK);
+        return;
     }
 
-    // Send end marker
-    sendMessage("END:DIR");
+    if (bulkJob.artNext < bulkJob.artEnd) {
+        if (artSendRecord(bulkJob.aux, bulkJob.file, bulkJob.artNext, TX_PRIO_BULK)) {
+            bulkJob.count++;
+        }
+        bulkJob.artNext++;
+        return;
+    }
 
-    root.close();
-    Serial.printf("[SD] Listed %d items\n", fileCount);
+    // NEXT tells ground where the following page starts
+    char footer[64];
+    int len = snprintf(footer, sizeof(footer), "ART:LIST_END|COUNT:%d", bulkJob.count);
+    if (bulkJob.artNext < artworkCount()) {
+        snprintf(footer + len, sizeof(footer) - len, "|NEXT:%lu", (unsigned long)bulkJob.artNext);
+    }
+    sendMessage(footer, TX_PRIO_BULK);
+    LOG_I("ART", "Listed %d artworks", bulkJob.count);
+    bulkFinish();
+}
+
+void bulkDownlinkTick() {
+    for (int step = 0; step < BULK_STEPS_PER_TICK; step++) {
+        if (bulkJob.type == BULK_IDLE) return;
+
+        // Stop if the SD card went away mid-transfer
+        if (!SDOK) {
+            LOG_W("SD", "Downlink aborted - SD not available");
+            bulkFinish();
+            sendMessage("ERR:SD_NOT_AVAILABLE");
+            return;
+        }
+
+        // Only produce what the queue can take - nothing gets dropped
+        if (txQueueFree(TX_PRIO_BULK) == 0) return;
+
+        feedWatchdog();
+
+        // A compressed block's frames go out before anything else is read
+        if (bulkZPending()) {
+            bulkZSendPart();
+            continue;
+        }
+
+        switch (bulkJob.type) {
+            case BULK_LIST_DIR:      bulkListStep();      break;
+            case BULK_LIST_PAGE:     bulkPageStep();      break;
+            case BULK_READ_FILE:     bulkReadStep();      break;
+            case BULK_READ_BURST:    bulkBurstStep();     break;
+            case BULK_LIST_ARTWORKS: bulkArtworkStep();   break;
+            case BULK_READ_ZFILE:    bulkReadZStep();     break;
+            case BULK_Z_TRAILER:     bulkZTrailerStep();  break;
+            default:                 bulkFinish();        break;
+        }
+    }
+}
+
+// ==================== LIST DIRECTORY ====================
+void listDir(fs::FS &fs, const char *dirname, const char *spec) {
+    if (!isSDAvailable()) return;
+    if (bulkRejectIfBusy()) return;
+
+    LOG_I("SD", "Listing directory: %s", dirname);
+
+    if (strcmp(spec, "Z") != 0) {
+        ListPage page;
+        if (!parseListPage(spec, page)) {
+            sendMessage("ERR:LIST_BAD_PAGE");
+            return;
+        }
+        // Frames are sent from bulkDownlinkTick()
+        if (!bulkStartPage(dirname, "LS:", false, page)) {
+            LOG_E("SD", "Failed to open directory");
+            sendMessage("ERR:OPEN_DIR_FAILED");
+        }
+        return;
+    }
+
+    File root = fs.open(dirname);
+    if (!root) {
+        LOG_E("SD", "Failed to open directory");
+        sendMessage("ERR:OPEN_DIR_FAILED");
+        return;
+    }
+
+    if (!root.isDirectory()) {
+        LOG_W("SD", "Not a directory");
+        sendMessage("ERR:NOT_A_DIRECTORY");
+        root.close();
+        return;
+    }
+
+    // Entries are sent from bulkDownlinkTick()
+    bulkStartListing(root, 0, true);
 }
 
 // ==================== CREATE DIRECTORY ====================
 void createDir(fs::FS &fs, const char *path) {
     if (!isSDAvailable()) return;
 
-    Serial.printf("[SD] Creating directory: %s\n", path);
+    LOG_I("SD", "Creating directory: %s", path);
 
     if (fs.mkdir(path)) {
-        Serial.println("[SD] Directory created");
-        sendMessage("OK:DIR_CREATED:" + String(path));
+        manifestNoteChanged(path);
+        LOG_I("SD", "Directory created");
+        Reply reply;
+        sendMessage(reply.add("OK:DIR_CREATED:").add(path));
     } else {
-        Serial.println("[SD] mkdir failed");
+        LOG_E("SD", "mkdir failed");
         sendMessage("ERR:MKDIR_FAILED");
     }
 }
@@ -124,13 +801,14 @@ void createDir(fs::FS &fs, const char *path) {
 void removeDir(fs::FS &fs, const char *path) {
     if (!isSDAvailable()) return;
 
-    Serial.printf("[SD] Removing directory: %s\n", path);
+    LOG_I("SD", "Removing directory: %s", path);
 
     if (fs.rmdir(path)) {
-        Serial.println("[SD] Directory removed");
+        manifestNoteRemoved(path);
+        LOG_I("SD", "Directory removed");
         sendMessage("OK:DIR_REMOVED");
     } else {
-        Serial.println("[SD] rmdir failed");
+        LOG_E("SD", "rmdir failed");
         sendMessage("ERR:RMDIR_FAILED");
     }
 }
@@ -138,48 +816,156 @@ void removeDir(fs::FS &fs, const char *path) {
 // ==================== READ FILE ====================
 void readFile(fs::FS &fs, const char *path) {
     if (!isSDAvailable()) return;
+    if (bulkRejectIfBusy()) return;
 
-    feedWatchdog();
+    LOG_I("SD", "Reading file: %s", path);
 
-    Serial.printf("[SD] Reading file: %s\n", path);
+    File file = fs.open(path, FILE_READ);
+    if (!file || file.isDirectory()) {
+        LOG_E("SD", "Failed to open file for reading");
+        sendMessage("ERR:OPEN_FILE_FAILED");
+        if (file) file.close();
+        return;
+    }
+
+    // Header, chunks and end marker are sent from bulkDownlinkTick()
+    bulkJob.type = BULK_READ_FILE;
+    bulkJob.headerPending = true;
+    bulkJob.file = file;
+    strncpy(bulkJob.path, path, sizeof(bulkJob.path) - 1);
+    bulkJob.path[sizeof(bulkJob.path) - 1] = '\0';
+    bulkJob.fileSize = file.size();
+    bulkJob.totalSent = 0;
+    bulkJob.count = 0;
+}
+
+// ==================== COMPRESSED READ FILE ====================
+void readFileCompressed(fs::FS &fs, const char *path) {
+    if (!isSDAvailable()) return;
+    if (bulkRejectIfBusy()) return;
+
+    LOG_I("SD", "Reading file compressed: %s", path);
 
     File file = fs.open(path, FILE_READ);
     if (!file || file.isDirectory()) {
-        Serial.println("[SD] Failed to open file for reading");
+        LOG_E("SD", "Failed to open file for reading");
         sendMessage("ERR:OPEN_FILE_FAILED");
         if (file) file.close();
         return;
     }
 
-    // Send header with file size
     size_t fileSize = file.size();
-    sendMessage("FILE:" + String(path) + "," + String(fileSize));
-    delay(100);
+    size_t blocks = (fileSize + LZ_BLOCK_SIZE - 1) / LZ_BLOCK_SIZE;
+    if (blocks > 0xFFFF) {
+        sendMessage("ERR:FILE_TOO_LARGE");
+        file.close();
+        return;
+    }
 
-    // Read and send in chunks
-    char buffer[LORA_CHUNK_SIZE + 1];
-    size_t totalSent = 0;
-    int chunkNum = 0;
+    // Each block is compressed as it is sent; the ratio comes in ENDZ
+    bulkJob.type = BULK_READ_ZFILE;
+    bulkJob.headerPending = true;
+    bulkJob.file = file;
+    strncpy(bulkJob.path, path, sizeof(bulkJob.path) - 1);
+    bulkJob.path[sizeof(bulkJob.path) - 1] = '\0';
+    bulkJob.fileSize = fileSize;
+    bulkJob.totalSent = 0;
+    bulkJob.frameTotal = (uint16_t)blocks;
+    bulkJob.count = 0;
+    bulkZStart();
+}
 
-    while (file.available() && totalSent < fileSize) {
-        feedWatchdog();
+// ==================== BURST FILE DOWNLINK ====================
+// Binary frames: [0xB5][transfer id][seq u16 BE][total u16 BE][payload]
+// Every frame except the last carries BURST_PAYLOAD bytes, so ground can
+// place frame n at offset n * BURST_PAYLOAD and NACK only the gaps with
+// ReadFileRange. The CRC32 of the whole file is folded in as the frames
+// are read and goes out in the trailer, so nothing reads the file twice.
 
-        size_t bytesRead = file.readBytes(buffer, LORA_CHUNK_SIZE);
-        buffer[bytesRead] = '\0';
+void burstForget(const char *path) {
+    if (burstCRC.valid && strcmp(burstCRC.path, path) == 0) {
+        burstCRC.valid = false;
+    }
+}
 
-        sendMessage(String(buffer));
-        delay(50);
+static bool startBurst(fs::FS &fs, const char *path, const char *ranges) {
+    if (!isSDAvailable()) return false;
+    if (bulkRejectIfBusy()) return false;
 
-        totalSent += bytesRead;
-        chunkNum++;
+    if (strlen(ranges) > BURST_RANGE_SPEC_MAX) {
+        sendMessage("ERR:RANGE_TOO_LONG");
+        return false;
+    }
 
-        Serial.printf("[SD] Sent chunk %d, %d/%d bytes\n", chunkNum, totalSent, fileSize);
+    File file = fs.open(path, FILE_READ);
+    if (!file || file.isDirectory()) {
+        LOG_E("SD", "Failed to open file for reading");
+        sendMessage("ERR:OPEN_FILE_FAILED");
+        if (file) file.close();
+        return false;
     }
 
-    sendMessage("END:FILE");
-    file.close();
+    size_t fileSize = file.size();
+    size_t frames = (fileSize + BURST_PAYLOAD - 1) / BURST_PAYLOAD;
+    if (frames > 0xFFFF) {
+        sendMessage("ERR:FILE_TOO_LARGE");
+        file.close();
+        return false;
+    }
+
+    // Validate the whole frame list up front so a bad request sends nothing
+    uint32_t count = frames;
+    if (ranges[0] != '\0') {
+        uint8_t cursor = 0;
+        int32_t lo, hi;
+        count = 0;
+        while (ranges[cursor] != '\0') {
+            if (!burstParseRange(ranges, cursor, lo, hi) || hi >= (int32_t)frames) {
+                sendMessage("ERR:INVALID_RANGE");
+                file.close();
+                return false;
+            }
+            count += hi - lo + 1;
+        }
+    }
+
+    bulkJob.type = BULK_READ_BURST;
+    bulkJob.headerPending = true;
+    bulkJob.file = file;
+    strncpy(bulkJob.path, path, sizeof(bulkJob.path) - 1);
+    bulkJob.path[sizeof(bulkJob.path) - 1] = '\0';
+    bulkJob.fileSize = fileSize;
+    bulkJob.totalSent = 0;
+    bulkJob.count = 0;
+    bulkJob.transferId = ++burstTransferCounter;
+    bulkJob.frameTotal = (uint16_t)frames;
+    bulkJob.frameCount = (uint16_t)(count > 0xFFFF ? 0xFFFF : count);
+    bulkJob.fileCRC = crc32Begin();
+    strcpy(bulkJob.rangeSpec, ranges);
+    bulkJob.rangeCursor = 0;
+    if (ranges[0] == '\0') {
+        bulkJob.rangeLo = 0;
+        bulkJob.rangeHi = (int32_t)frames - 1;
+    } else {
+        bulkJob.rangeLo = 1;    // Empty range - first frames come from the spec
+        bulkJob.rangeHi = 0;
+    }
+
+    LOG_I("SD", "Burst %u: %s, %d bytes, %d frames",
+          bulkJob.transferId, path, fileSize, (int)frames);
+    return true;
+}
+
+void readFileBurst(fs::FS &fs, const char *path) {
+    startBurst(fs, path, "");
+}
 
-    Serial.printf("[SD] File read complete, %d bytes in %d chunks\n", totalSent, chunkNum);
+void readFileRange(fs::FS &fs, const char *path, const char *ranges) {
+    if (ranges[0] == '\0') {
+        sendMessage("ERR:INVALID_RANGE");
+        return;
+    }
+    startBurst(fs, path, ranges);
 }
 
 // ==================== WRITE FILE (WITH RETRY) ====================
@@ -195,12 +981,12 @@ void writeFile(fs::FS &fs, const char *path, const char *message) {
     // Check available space
     size_t msgLen = strlen(message);
     if (!hasSDSpace(msgLen)) {
-        Serial.println("[SD] ERROR: Not enough space!");
+        LOG_E("SD", "ERROR: Not enough space!");
         sendMessage("ERR:SD_FULL");
         return;
     }
 
-    Serial.printf("[SD] Writing file: %s\n", path);
+    LOG_I("SD", "Writing file: %s", path);
 
     // Retry loop - names are important, we don't give up easily
     for (int attempt = 1; attempt <= SD_WRITE_RETRIES; attempt++) {
@@ -208,7 +994,7 @@ void writeFile(fs::FS &fs, const char *path, const char *message) {
 
         File file = fs.open(path, FILE_WRITE);
         if (!file) {
-            Serial.printf("[SD] Attempt %d: Failed to open file\n", attempt);
+            LOG_W("SD", "Attempt %d: Failed to open file", attempt);
             if (attempt < SD_WRITE_RETRIES) {
                 delay(SD_RETRY_DELAY);
                 continue;
@@ -217,23 +1003,28 @@ void writeFile(fs::FS &fs, const char *path, const char *message) {
             return;
         }
 
-        size_t bytesWritten = file.print(message);
+        size_t bytesWritten = sdWrite(file, (const uint8_t*)message, strlen(message));
         file.close();
+        manifestNoteChanged(path);
+        burstForget(path);
+        sdSpaceAccount(bytesWritten);
+        sdSpaceInvalidate();  // Truncated the old contents
 
         if (bytesWritten > 0) {
-            Serial.printf("[SD] File written, %d bytes (attempt %d)\n", bytesWritten, attempt);
-            sendMessage("OK:WRITTEN:" + String(bytesWritten) + "B");
+            LOG_I("SD", "File written, %d bytes (attempt %d)", bytesWritten, attempt);
+            MsgBuf<32> reply;
+            sendMessage(reply.add("OK:WRITTEN:").addU(bytesWritten).add('B'));
             return;  // Success!
         }
 
-        Serial.printf("[SD] Attempt %d: Write returned 0 bytes\n", attempt);
+        LOG_W("SD", "Attempt %d: Write returned 0 bytes", attempt);
         if (attempt < SD_WRITE_RETRIES) {
             delay(SD_RETRY_DELAY);
         }
     }
 
     // All retries failed
-    Serial.println("[SD] Write failed after all retries");
+    LOG_E("SD", "Write failed after all retries");
     sendMessage("ERR:WRITE_FAILED");
 }
 
@@ -246,12 +1037,12 @@ void appendFile(fs::FS &fs, const char *path, const char *message) {
     // Check available space
     size_t msgLen = strlen(message);
     if (!hasSDSpace(msgLen)) {
-        Serial.println("[SD] ERROR: Not enough space!");
+        LOG_E("SD", "ERROR: Not enough space!");
         sendMessage("ERR:SD_FULL");
         return;
     }
 
-    Serial.printf("[SD] Appending to file: %s\n", path);
+    LOG_I("SD", "Appending to file: %s", path);
 
     // Retry loop
     for (int attempt = 1; attempt <= SD_WRITE_RETRIES; attempt++) {
@@ -259,7 +1050,7 @@ void appendFile(fs::FS &fs, const char *path, const char *message) {
 
         File file = fs.open(path, FILE_APPEND);
         if (!file) {
-            Serial.printf("[SD] Attempt %d: Failed to open file\n", attempt);
+            LOG_W("SD", "Attempt %d: Failed to open file", attempt);
             if (attempt < SD_WRITE_RETRIES) {
                 delay(SD_RETRY_DELAY);
                 continue;
@@ -268,23 +1059,27 @@ void appendFile(fs::FS &fs, const char *path, const char *message) {
             return;
         }
 
-        size_t bytesWritten = file.print(message);
+        size_t bytesWritten = sdWrite(file, (const uint8_t*)message, strlen(message));
         file.close();
+        manifestNoteChanged(path);
+        burstForget(path);
+        sdSpaceAccount(bytesWritten);
 
         if (bytesWritten > 0) {
-            Serial.printf("[SD] Appended %d bytes (attempt %d)\n", bytesWritten, attempt);
-            sendMessage("OK:APPENDED:" + String(bytesWritten) + "B");
+            LOG_I("SD", "Appended %d bytes (attempt %d)", bytesWritten, attempt);
+            MsgBuf<32> reply;
+            sendMessage(reply.add("OK:APPENDED:").addU(bytesWritten).add('B'));
             return;  // Success!
         }
 
-        Serial.printf("[SD] Attempt %d: Append returned 0 bytes\n", attempt);
+        LOG_W("SD", "Attempt %d: Append returned 0 bytes", attempt);
         if (attempt < SD_WRITE_RETRIES) {
             delay(SD_RETRY_DELAY);
         }
     }
 
     // All retries failed
-    Serial.println("[SD] Append failed after all retries");
+    LOG_E("SD", "Append failed after all retries");
     sendMessage("ERR:APPEND_FAILED");
 }
 
@@ -292,13 +1087,16 @@ void appendFile(fs::FS &fs, const char *path, const char *message) {
 void renameFile(fs::FS &fs, const char *path1, const char *path2) {
     if (!isSDAvailable()) return;
 
-    Serial.printf("[SD] Renaming file %s to %s\n", path1, path2);
+    LOG_I("SD", "Renaming file %s to %s", path1, path2);
 
     if (fs.rename(path1, path2)) {
-        Serial.println("[SD] File renamed");
+        manifestNoteRenamed(path1, path2);
+        burstForget(path1);
+        burstForget(path2);
+        LOG_I("SD", "File renamed");
         sendMessage("OK:RENAMED");
     } else {
-        Serial.println("[SD] Rename failed");
+        LOG_E("SD", "Rename failed");
         sendMessage("ERR:RENAME_FAILED");
     }
 }
@@ -307,13 +1105,16 @@ void renameFile(fs::FS &fs, const char *path1, const char *path2) {
 void deleteFile(fs::FS &fs, const char *path) {
     if (!isSDAvailable()) return;
 
-    Serial.printf("[SD] Deleting file: %s\n", path);
+    LOG_I("SD", "Deleting file: %s", path);
 
     if (fs.remove(path)) {
-        Serial.println("[SD] File deleted");
+        manifestNoteRemoved(path);
+        burstForget(path);
+        sdSpaceInvalidate();
+        LOG_I("SD", "File deleted");
         sendMessage("OK:DELETED");
     } else {
-        Serial.println("[SD] Delete failed");
+        LOG_E("SD", "Delete failed");
         sendMessage("ERR:DELETE_FAILED");
     }
 }
@@ -324,12 +1125,12 @@ void testFileIO(fs::FS &fs, const char *path) {
 
     feedWatchdog();
 
-    Serial.println("[SD] Starting file I/O test...");
+    LOG_I("SD", "Starting file I/O test...");
 
     // Read test
     File file = fs.open(path);
     if (!file) {
-        Serial.println("[SD] Failed to open file for test");
+        LOG_E("SD", "Failed to open file for test");
         sendMessage("ERR:TEST_OPEN_FAILED");
         return;
     }
@@ -349,8 +1150,9 @@ void testFileIO(fs::FS &fs, const char *path) {
     uint32_t readTime = millis() - start;
     file.close();
 
-    String result = "READ:" + String(flen) + "B/" + String(readTime) + "ms";
-    Serial.println(result);
+    MsgBuf<48> result;
+    result.add("READ:").addU(flen).add("B/").addU(readTime).add("ms");
+    LOG_I("SD", "%s", result.c_str());
     sendMessage(result);
 
     // Write test (smaller to avoid SD wear)
@@ -367,76 +1169,345 @@ void testFileIO(fs::FS &fs, const char *path) {
     }
     uint32_t writeTime = millis() - start;
     file.close();
+    manifestNoteChanged(path);
+    sdSpaceAccount(256 * 512);
+    sdSpaceInvalidate();  // Overwrote the test file
 
-    result = "WRITE:" + String(256 * 512) + "B/" + String(writeTime) + "ms";
-    Serial.println(result);
+    result.clear();
+    result.add("WRITE:").addU(256 * 512).add("B/").addU(writeTime).add("ms");
+    LOG_I("SD", "%s", result.c_str());
     sendMessage(result);
 }
 
 // ==================== LOG TO SD ====================
-void logToSD(const char *message) {
-    if (!SDOK) return;
-
+// Direct path used before the writer task starts (or if it failed to)
+static void logToSDDirect(const char *record, size_t len) {
     // Check space before logging
     if (!hasSDSpace(1024)) {
-        Serial.println("[SD] WARNING: Low space, skipping log");
+        LOG_W("SD", "WARNING: Low space, skipping log");
         return;
     }
 
-    File logFile = SD.open("/log.txt", FILE_APPEND);
+    File logFile = SD.open(LOG_FILE_PATH, FILE_APPEND);
     if (logFile) {
-        // Add timestamp (mission elapsed time)
-        unsigned long elapsed = millis() - missionStartTime;
-        logFile.printf("[%lu] %s\n", elapsed, message);
+        sdSpaceAccount(sdWrite(logFile, (const uint8_t*)record, len));
         logFile.close();
+        manifestNoteChanged(LOG_FILE_PATH);
+    }
+}
+
+// ==================== BACKGROUND LOG WRITER ====================
+// logToSD() only copies the formatted record into a single-producer /
+// single-consumer ring; the writer task on core 0 drains it into a
+// sector-sized staging buffer and appends whole sectors to a file it keeps
+// open. FATFS is built reentrant and the SPI HAL lock serialises the bus,
+// so the task can write while the main loop talks to the radio or opens
+// other files.
+//
+// Producer is the main loop only (logToSD is not ISR or multi-task safe).
+
+static char logRing[LOG_RING_SIZE];
+static volatile uint32_t logHead = 0;        // Advanced by producer only
+static volatile uint32_t logTail = 0;        // Advanced by writer task only
+static volatile uint32_t logDrops = 0;       // Records dropped (ring full / no space)
+static volatile uint32_t logFlushRequested = 0;
+static volatile uint32_t logFlushCompleted = 0;
+static volatile bool logWriterActive = false;  // Task is between waits
+static TaskHandle_t logTaskHandle = NULL;
+
+// Writer task state (touched only by the task)
+static File logFile;
+static uint8_t logStage[LOG_SECTOR_SIZE];
+static size_t logStageLen = 0;
+static size_t logStageCap = LOG_SECTOR_SIZE; // Bytes to the next sector boundary
+static uint32_t logFileOffset = 0;
+static bool logSpaceOk = true;
+static unsigned long logLastFlush = 0;
+
+static uint32_t logRingUsed() {
+    return logHead - logTail;
+}
+
+static bool logOpenFile() {
+    logFile = SD.open(LOG_FILE_PATH, FILE_APPEND);
+    if (!logFile) return false;
+    logFileOffset = logFile.size();
+    return true;
+}
+
+static void logWriteStage() {
+    if (logStageLen == 0) return;
+
+    // O(1) with the space tracker; warn once per low-space episode
+    bool spaceOk = hasSDSpace(logStageLen);
+    if (!spaceOk && logSpaceOk) {
+        LOG_W("SD", "WARNING: Low space, dropping log records");
+    }
+    logSpaceOk = spaceOk;
+
+    if (logSpaceOk && (logFile || logOpenFile())) {
+        size_t written = sdWrite(logFile, logStage, logStageLen);
+        sdSpaceAccount(written);
+        if (written == logStageLen) {
+            logFileOffset += written;
+        } else {
+            // Card pulled or FAT error: reopen on the next write
+            logFile.close();
+            logDrops++;
+        }
+    } else {
+        logDrops++;
+    }
+
+    logStageLen = 0;
+    // Realign so the following full-stage writes land on sector boundaries
+    logStageCap = LOG_SECTOR_SIZE - (logFileOffset % LOG_SECTOR_SIZE);
+}
+
+static void logDrainRing() {
+    uint32_t head = logHead;
+    __sync_synchronize();  // Read the bytes only after seeing the new head
+    uint32_t tail = logTail;
+
+    while (tail != head) {
+        size_t n = head - tail;
+        size_t room = logStageCap - logStageLen;
+        size_t idx = tail & (LOG_RING_SIZE - 1);
+        if (n > room) n = room;
+        if (n > LOG_RING_SIZE - idx) n = LOG_RING_SIZE - idx;
+
+        memcpy(logStage + logStageLen, logRing + idx, n);
+        logStageLen += n;
+        tail += n;
+        if (logStageLen == logStageCap) {
+            logWriteStage();
+        }
+    }
+
+    __sync_synchronize();  // Finish copying before releasing the space
+    logTail = tail;
+}
+
+static void logWriterTask(void *param) {
+    (void)param;
+    if (logOpenFile()) {
+        logStageCap = LOG_SECTOR_SIZE - (logFileOffset % LOG_SECTOR_SIZE);
+    }
+
+    for (;;) {
+        logWriterActive = false;
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(LOG_FLUSH_INTERVAL_MS));
+        logWriterActive = true;
+
+        unsigned long now = millis();
+        logDrainRing();
+
+        // Push the partial sector out on the timer or on request
+        uint32_t requested = logFlushRequested;
+        if (requested != logFlushCompleted || now - logLastFlush >= LOG_FLUSH_INTERVAL_MS) {
+            logWriteStage();
+            if (logFile) logFile.flush();
+            logLastFlush = now;
+            logFlushCompleted = requested;
+        }
+
+        // Off the main loop, so the slow FAT scan doesn't stall the radio
+        sdSpaceReconcileIfDue();
+    }
+}
+
+void startLogWriter() {
+    if (!SDOK || logTaskHandle != NULL) return;
+
+    logLastFlush = millis();
+
+    if (xTaskCreatePinnedToCore(logWriterTask, "logWriter", LOG_TASK_STACK, NULL,
+                                LOG_TASK_PRIORITY, &logTaskHandle, LOG_TASK_CORE) != pdPASS) {
+        logTaskHandle = NULL;
+        LOG_E("SD", "Log writer task failed to start, logging inline");
+        return;
+    }
+    LOG_I("SD", "Log writer task started");
+}
+
+bool logFlush(unsigned long timeoutMs) {
+    if (logTaskHandle == NULL) return true;  // Inline writes are already on the card
+
+    uint32_t target = logFlushRequested + 1;
+    logFlushRequested = target;
+    xTaskNotifyGive(logTaskHandle);
+
+    unsigned long start = millis();
+    while (logFlushCompleted != target) {
+        if (millis() - start >= timeoutMs) {
+            return false;
+        }
+        feedWatchdog();
+        delay(1);
+    }
+    return true;
+}
+
+uint32_t logRingDrops() {
+    return logDrops;
+}
+
+size_t logRingDepth() {
+    return logRingUsed();
+}
+
+bool logWriterBusy() {
+    return logWriterActive;
+}
+
+void logToSD(const char *message) {
+    if (!SDOK) return;
+
+    // Add timestamp (mission elapsed time)
+    char record[LOG_RECORD_MAX];
+    unsigned long elapsed = millis() - missionStartTime;
+    int len = snprintf(record, sizeof(record), "[%lu] %s\n", elapsed, message);
+    if (len < 0) return;
+    if ((size_t)len >= sizeof(record)) {
+        // Truncated: keep the line terminator
+        len = sizeof(record) - 1;
+        record[len - 1] = '\n';
+    }
+
+    if (logTaskHandle == NULL) {
+        logToSDDirect(record, len);
+        return;
+    }
+
+    // Whole records only, so a full ring never leaves half a line
+    uint32_t head = logHead;
+    if (LOG_RING_SIZE - (head - logTail) < (uint32_t)len) {
+        logDrops++;
+        return;
+    }
+
+    size_t idx = head & (LOG_RING_SIZE - 1);
+    size_t first = LOG_RING_SIZE - idx;
+    if (first > (size_t)len) first = len;
+    memcpy(logRing + idx, record, first);
+    memcpy(logRing, record + first, len - first);
+
+    __sync_synchronize();  // Publish the bytes before the new head
+    logHead = head + len;
+
+    // Wake the writer once a sector's worth is waiting; the timer catches the rest
+    if (logRingUsed() >= LOG_SECTOR_SIZE) {
+        xTaskNotifyGive(logTaskHandle);
     }
 }
 
 // ==================== SD CARD CAPACITY ====================
+// SD.usedBytes() walks the FAT, which gets slower as the card fills, so it
+// is read once at mount and then only by sdSpaceReconcileIfDue(). In
+// between, our own write paths add what they wrote via sdSpaceAccount().
+// Writes only ever shrink the free estimate; space released by deletes and
+// overwrites shows up at the next reconcile, so the estimate errs on the
+// safe side. Updated from the log writer task too, hence the spinlock.
+
+static portMUX_TYPE sdSpaceMux = portMUX_INITIALIZER_UNLOCKED;
+static uint64_t sdTotalBytes = 0;
+static uint64_t sdUsedBytes = 0;
+static bool sdUsedKnown = false;             // False while usedBytes() looks bogus
+static volatile bool sdReconcileWanted = false;
+static unsigned long sdLastReconcile = 0;
+
+// Fresh usedBytes() reading; false if it hit the ESP32 used == total bug
+static bool sdSpaceRead(uint64_t &used) {
+    used = SD.usedBytes();
+    if (used >= sdTotalBytes) {
+        LOG_W("SD", "WARNING: usedBytes >= totalBytes (known ESP32 bug)");
+        return false;
+    }
+    return true;
+}
+
+void sdSpaceInit() {
+    sdTotalBytes = SD.totalBytes();
+    uint64_t used = 0;
+    bool known = sdTotalBytes > 0 && sdSpaceRead(used);
+
+    portENTER_CRITICAL(&sdSpaceMux);
+    sdUsedBytes = used;
+    sdUsedKnown = known;
+    portEXIT_CRITICAL(&sdSpaceMux);
+
+    sdReconcileWanted = false;
+    sdLastReconcile = millis();
+    LOG_I("SD", "Total space: %lluMB", sdTotalBytes / (1024 * 1024));
+    LOG_I("SD", "Used space: %lluMB", used / (1024 * 1024));
+}
+
+void sdSpaceAccount(size_t bytesWritten) {
+    portENTER_CRITICAL(&sdSpaceMux);
+    sdUsedBytes += bytesWritten;
+    portEXIT_CRITICAL(&sdSpaceMux);
+}
+
+void sdSpaceInvalidate() {
+    sdReconcileWanted = true;
+}
+
+void sdSpaceReconcileIfDue() {
+    if (!SDOK || sdTotalBytes == 0) return;
+    if (!sdReconcileWanted && millis() - sdLastReconcile < SD_SPACE_RECONCILE_MS) return;
+
+    sdReconcileWanted = false;
+    sdLastReconcile = millis();
+
+    uint64_t used;
+    if (!sdSpaceRead(used)) return;  // Keep the running estimate
+
+    portENTER_CRITICAL(&sdSpaceMux);
+    sdUsedBytes = used;
+    sdUsedKnown = true;
+    portEXIT_CRITICAL(&sdSpaceMux);
+}
+
+static uint64_t sdSpaceUsed() {
+    portENTER_CRITICAL(&sdSpaceMux);
+    uint64_t used = sdUsedBytes;
+    portEXIT_CRITICAL(&sdSpaceMux);
+    return used < sdTotalBytes ? used : sdTotalBytes;
+}
+
+// Without the writer task nobody reconciles in the background
+static void sdSpaceReconcileInline() {
+    if (logTaskHandle == NULL) sdSpaceReconcileIfDue();
+}
+
 uint64_t getSDTotalMB() {
     if (!SDOK) return 0;
-    return SD.totalBytes() / (1024 * 1024);
+    return sdTotalBytes / (1024 * 1024);
 }
 
 uint64_t getSDUsedMB() {
     if (!SDOK) return 0;
-    return SD.usedBytes() / (1024 * 1024);
+    return sdSpaceUsed() / (1024 * 1024);
 }
 
 uint64_t getSDFreeMB() {
     if (!SDOK) return 0;
-    return (SD.totalBytes() - SD.usedBytes()) / (1024 * 1024);
+    return (sdTotalBytes - sdSpaceUsed()) / (1024 * 1024);
 }
 
 uint8_t getSDFreePercent() {
-    if (!SDOK) return 0;
-    uint64_t total = SD.totalBytes();
-    uint64_t used = SD.usedBytes();
-
-    // Debug: Log raw values to help diagnose SD issues
-    Serial.printf("[SD] Debug: total=%llu bytes, used=%llu bytes\n", total, used);
-
-    if (total == 0) {
-        Serial.println("[SD] WARNING: totalBytes() returned 0!");
-        return 0;
-    }
-
-    // Check for known ESP32 SD library bug where usedBytes == totalBytes
-    if (used >= total) {
-        Serial.println("[SD] WARNING: usedBytes >= totalBytes (known ESP32 bug)");
+    if (!SDOK || sdTotalBytes == 0) return 0;
+    if (!sdUsedKnown) {
         // Return 99% as fallback (assume card is mostly empty)
         return 99;
     }
-
-    uint64_t free = total - used;
-    uint8_t percent = (uint8_t)((free * 100) / total);
-    Serial.printf("[SD] Free: %llu bytes (%d%%)\n", free, percent);
-    return percent;
+    return (uint8_t)(((sdTotalBytes - sdSpaceUsed()) * 100) / sdTotalBytes);
 }
 
 bool hasSDSpace(size_t bytesNeeded) {
     if (!SDOK) return false;
-    uint64_t freeBytes = SD.totalBytes() - SD.usedBytes();
+    sdSpaceReconcileInline();
+    uint64_t freeBytes = sdTotalBytes - sdSpaceUsed();
     return freeBytes > (bytesNeeded + SD_MIN_FREE_BYTES);
 }
 
@@ -444,18 +1515,292 @@ bool hasSDSpace(size_t bytesNeeded) {
 // Stores artwork references (IPFS CID + metadata) to SD card
 // File: /artworks.log
 // Format per line: T+HH:MM:SS|IPFS_CID|ArtistName|WorkTitle
+//
+// Two binary files sit next to the log so lookups and pages don't parse it:
+//   /artworks.idx  one ArtworkRecord per entry, in log order (entry n+1 is
+//                  record n), so a page starts with a single seek
+//   /artworks.hix  one ArtworkHashEntry per entry sorted by (hash, record),
+//                  binary searched for the CID existence check
+// Appends go log -> idx -> hix, so a reset mid-append leaves at most a
+// missing tail, which artworkIndexInit() re-indexes from the log at boot.
 
 #define ARTWORK_LOG_PATH "/artworks.log"
+#define ARTWORK_IDX_PATH "/artworks.idx"
+#define ARTWORK_HIX_PATH "/artworks.hix"
+
+struct ArtworkRecord {
+    uint32_t cidHash;       // CRC32 of the CID
+    uint32_t logOffset;     // Start of the line in the log
+    uint32_t missionSecs;   // Mission elapsed time when stored
+    uint16_t lineLength;    // Without the line terminator
+    uint8_t cidOffset;      // CID position within the line
+    uint8_t cidLength;
+};
+
+struct ArtworkHashEntry {
+    uint32_t cidHash;
+    uint32_t record;
+};
+
+static_assert(sizeof(ArtworkRecord) == 16, "artworks.idx record layout");
+static_assert(sizeof(ArtworkHashEntry) == 8, "artworks.hix entry layout");
+
+// Index header, TMR-protected: a flipped count would send lookups past the files
+static const bool& artIndexOk = tmrNew("artIndexOk", false);
+static const uint32_t& artCount = tmrNew("artCount", (uint32_t)0);  // Records in the index
+
+static uint32_t artworkHash(const char *cid, size_t cidLen) {
+    return calculateCRC32((const uint8_t*)cid, cidLen);
+}
+
+// CID is the second '|' field of a log line
+static bool artSplitCID(const char *line, size_t len, size_t &cidOff, size_t &cidLen) {
+    const char *p1 = (const char*)memchr(line, '|', len);
+    if (!p1) return false;
+    cidOff = p1 + 1 - line;
+    const char *p2 = (const char*)memchr(p1 + 1, '|', len - cidOff);
+    cidLen = (p2 ? p2 : line + len) - (p1 + 1);
+    return cidLen > 0 && cidLen <= ART_CID_MAX && cidOff <= 255;
+}
+
+static bool artReadAt(File &file, uint32_t pos, void *out, size_t size) {
+    return file.seek(pos) && file.read((uint8_t*)out, size) == size;
+}
+
+static bool artReadRecord(File &idx, uint32_t n, ArtworkRecord &rec) {
+    return artReadAt(idx, n * sizeof(ArtworkRecord), &rec, sizeof(rec));
+}
+
+static bool artReadHash(File &hix, uint32_t pos, ArtworkHashEntry &e) {
+    return artReadAt(hix, pos * sizeof(ArtworkHashEntry), &e, sizeof(e));
+}
+
+// First hash entry with cidHash >= hash (or > hash when upper is set)
+static uint32_t artHashBound(File &hix, uint32_t hash, bool upper) {
+    uint32_t lo = 0, hi = artCount;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        ArtworkHashEntry e;
+        if (!artReadHash(hix, mid, e)) return lo;
+        if (e.cidHash < hash || (upper && e.cidHash == hash)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// Insert keeping the sort order: shift the tail up one entry, back to front.
+// O(n) writes, but inserts only happen on uplinked artworkAscension commands.
+static bool artHashInsert(uint32_t hash, uint32_t record) {
+    File hix = SD.open(ARTWORK_HIX_PATH, SD.exists(ARTWORK_HIX_PATH) ? "r+" : FILE_WRITE);
+    if (!hix) return false;
+
+    uint32_t pos = artHashBound(hix, hash, true);
+    uint8_t chunk[512];
+    uint32_t end = artCount * sizeof(ArtworkHashEntry);
+    uint32_t start = pos * sizeof(ArtworkHashEntry);
+    bool ok = true;
+
+    while (ok && end > start) {
+        uint32_t n = end - start;
+        if (n > sizeof(chunk)) n = sizeof(chunk);
+        ok = artReadAt(hix, end - n, chunk, n) &&
+             hix.seek(end - n + sizeof(ArtworkHashEntry)) &&
+             hix.write(chunk, n) == n;
+        end -= n;
+    }
+
+    ArtworkHashEntry e = { hash, record };
+    ok = ok && hix.seek(start) && hix.write((const uint8_t*)&e, sizeof(e)) == sizeof(e);
+    hix.close();
+    manifestNoteChanged(ARTWORK_HIX_PATH);
+    sdSpaceAccount(sizeof(e));
+    return ok;
+}
+
+static bool artIndexAppend(const ArtworkRecord &rec) {
+    File idx = SD.open(ARTWORK_IDX_PATH, FILE_APPEND);
+    if (!idx) return false;
+    bool ok = idx.write((const uint8_t*)&rec, sizeof(rec)) == sizeof(rec);
+    idx.close();
+    manifestNoteChanged(ARTWORK_IDX_PATH);
+    sdSpaceAccount(sizeof(rec));
+
+    ok = ok && artHashInsert(rec.cidHash, artCount);
+    if (ok) tmrWrite(artCount, artCount + 1);
+    return ok;
+}
+
+static bool artMakeRecord(const char *line, size_t len, uint32_t offset,
+                          uint32_t secs, ArtworkRecord &rec) {
+    size_t cidOff, cidLen;
+    if (!artSplitCID(line, len, cidOff, cidLen)) return false;
+    rec.cidHash = artworkHash(line + cidOff, cidLen);
+    rec.logOffset = offset;
+    rec.missionSecs = secs;
+    rec.lineLength = (uint16_t)len;
+    rec.cidOffset = (uint8_t)cidOff;
+    rec.cidLength = (uint8_t)cidLen;
+    return true;
+}
+
+// "T+HH:MM:SS" prefix back to seconds (for entries indexed from the log)
+static uint32_t artParseMissionSecs(const char *line) {
+    unsigned long h = 0, m = 0, sec = 0;
+    if (sscanf(line, "T+%lu:%lu:%lu", &h, &m, &sec) != 3) return 0;
+    return (uint32_t)(h * 3600 + m * 60 + sec);
+}
+
+// Index log lines from byte offset 'from' onwards
+static bool artIndexLogTail(File &log, uint32_t from) {
+    char line[ART_LINE_MAX + 1];
+    log.seek(from);
+
+    while (log.available()) {
+        feedWatchdog();
+        uint32_t offset = log.position();
+        size_t len = log.readBytesUntil('\n', line, ART_LINE_MAX);
+        while (len > 0 && (line[len - 1] == '\r' || line[len - 1] == ' ')) len--;
+        if (len == 0) continue;
+        line[len] = '\0';
+
+        ArtworkRecord rec;
+        if (!artMakeRecord(line, len, offset, artParseMissionSecs(line), rec)) {
+            LOG_W("ART", "Skipping malformed log line at %lu", (unsigned long)offset);
+            continue;
+        }
+        if (!artIndexAppend(rec)) return false;
+    }
+    return true;
+}
+
+// Strictly increasing (hash, record) with valid record numbers. A reset
+// during artHashInsert() leaves two equal neighbours, so this catches it.
+static bool artHashSorted(File &hix, uint32_t records) {
+    ArtworkHashEntry prev = { 0, 0 };
+    hix.seek(0);
+    for (uint32_t i = 0; i < records; i++) {
+        ArtworkHashEntry e;
+        if (hix.read((uint8_t*)&e, sizeof(e)) != sizeof(e)) return false;
+        if (e.record >= records) return false;
+        if (i > 0 && (e.cidHash < prev.cidHash ||
+                      (e.cidHash == prev.cidHash && e.record <= prev.record))) {
+            return false;
+        }
+        prev = e;
+    }
+    return true;
+}
+
+void artworkIndexInit() {
+    tmrWrite(artIndexOk, false);
+    tmrWrite(artCount, 0);
+    if (!SDOK) return;
+
+    File log = SD.open(ARTWORK_LOG_PATH, FILE_READ);
+    if (!log) {
+        // No artworks yet; drop stale index files so numbering restarts
+        SD.remove(ARTWORK_IDX_PATH);
+        SD.remove(ARTWORK_HIX_PATH);
+        manifestNoteRemoved(ARTWORK_IDX_PATH);
+        manifestNoteRemoved(ARTWORK_HIX_PATH);
+        tmrWrite(artIndexOk, true);
+        return;
+    }
+
+    uint32_t resumeFrom = 0;
+    uint32_t records = 0;
+    File idx = SD.open(ARTWORK_IDX_PATH, FILE_READ);
+    if (idx) {
+        records = idx.size() / sizeof(ArtworkRecord);
+        ArtworkRecord last;
+        if (idx.size() % sizeof(ArtworkRecord) != 0 ||
+            (records > 0 && (!artReadRecord(idx, records - 1, last) ||
+                             last.logOffset + last.lineLength > log.size()))) {
+            records = 0;  // Torn or stale: re-index everything
+        } else if (records > 0) {
+            resumeFrom = last.logOffset + last.lineLength;
+        }
+        idx.close();
+    }
+
+    bool hashesOk = false;
+    File hix = SD.open(ARTWORK_HIX_PATH, FILE_READ);
+    if (hix) {
+        hashesOk = hix.size() == records * sizeof(ArtworkHashEntry) &&
+                   artHashSorted(hix, records);
+        hix.close();
+    }
+
+    if (records == 0 || !hashesOk) {
+        LOG_I("ART", "Rebuilding artwork index from log");
+        SD.remove(ARTWORK_IDX_PATH);
+        SD.remove(ARTWORK_HIX_PATH);
+        manifestNoteRemoved(ARTWORK_IDX_PATH);
+        manifestNoteRemoved(ARTWORK_HIX_PATH);
+        sdSpaceInvalidate();
+        records = 0;
+        resumeFrom = 0;
+    }
+
+    tmrWrite(artCount, records);
+    tmrWrite(artIndexOk, artIndexLogTail(log, resumeFrom));
+    log.close();
+
+    LOG_I("ART", "Index %s, %lu artworks", artIndexOk ? "OK" : "FAILED",
+          (unsigned long)artCount);
+}
+
+int32_t artworkFind(const char *cid, size_t cidLen) {
+    if (!artIndexOk || artCount == 0) return -1;
+
+    File hix = SD.open(ARTWORK_HIX_PATH, FILE_READ);
+    File idx = SD.open(ARTWORK_IDX_PATH, FILE_READ);
+    File log = SD.open(ARTWORK_LOG_PATH, FILE_READ);
+    int32_t found = -1;
+
+    if (hix && idx && log) {
+        uint32_t hash = artworkHash(cid, cidLen);
+        char stored[ART_CID_MAX];
+
+        // Walk the (normally single) entries with this hash
+        for (uint32_t pos = artHashBound(hix, hash, false); pos < artCount && found < 0; pos++) {
+            ArtworkHashEntry e;
+            ArtworkRecord rec;
+            if (!artReadHash(hix, pos, e) || e.cidHash != hash) break;
+            if (!artReadRecord(idx, e.record, rec) || rec.cidLength != cidLen) continue;
+            if (artReadAt(log, rec.logOffset + rec.cidOffset, stored, cidLen) &&
+                memcmp(stored, cid, cidLen) == 0) {
+                found = (int32_t)e.record;
+            }
+        }
+    }
+
+    if (hix) hix.close();
+    if (idx) idx.close();
+    if (log) log.close();
+    return found;
+}
 
 bool logArtwork(const char *entry) {
     if (!SDOK) {
-        Serial.println("[ART] SD card not available");
+        LOG_W("ART", "SD card not available");
+        return false;
+    }
+
+    size_t entryLen = strlen(entry);
+    ArtworkRecord rec;
+    if (entryLen > ART_LINE_MAX || !artMakeRecord(entry, entryLen, 0, 0, rec)) {
+        LOG_W("ART", "Entry has no valid CID field");
         return false;
     }
+    rec.missionSecs = (millis() - missionStartTime) / 1000;
 
     // Check space
-    if (!hasSDSpace(strlen(entry) + 100)) {
-        Serial.println("[ART] Not enough space on SD card");
+    if (!hasSDSpace(entryLen + 100)) {
+        LOG_W("ART", "Not enough space on SD card");
         return false;
     }
 
@@ -465,7 +1810,7 @@ bool logArtwork(const char *entry) {
 
         File file = SD.open(ARTWORK_LOG_PATH, FILE_APPEND);
         if (!file) {
-            Serial.printf("[ART] Attempt %d: Failed to open artwork log\n", attempt);
+            LOG_W("ART", "Attempt %d: Failed to open artwork log", attempt);
             if (attempt < SD_WRITE_RETRIES) {
                 delay(SD_RETRY_DELAY);
                 continue;
@@ -474,15 +1819,23 @@ bool logArtwork(const char *entry) {
         }
 
         // Write entry with newline
+        rec.logOffset = file.size();
         size_t written = file.println(entry);
         file.close();
+        manifestNoteChanged(ARTWORK_LOG_PATH);
+        sdSpaceAccount(written);
 
         if (written > 0) {
-            Serial.printf("[ART] Artwork logged successfully (attempt %d)\n", attempt);
+            if (artIndexOk && !artIndexAppend(rec)) {
+                // The log line is safe; the next boot re-indexes it
+                LOG_W("ART", "WARNING: Index update failed");
+                tmrWrite(artIndexOk, false);
+            }
+            LOG_I("ART", "Artwork logged successfully (attempt %d)", attempt);
             return true;
         }
 
-        Serial.printf("[ART] Attempt %d: Write failed\n", attempt);
+        LOG_W("ART", "Attempt %d: Write failed", attempt);
         if (attempt < SD_WRITE_RETRIES) {
             delay(SD_RETRY_DELAY);
         }
@@ -491,41 +1844,79 @@ bool logArtwork(const char *entry) {
     return false;
 }
 
-void listArtworks() {
-    if (!isSDAvailable()) return;
+// "ART:<n>|<log line>" for record n (numbered from 1, as before)
+static bool artSendRecord(File &idx, File &log, uint32_t n, TxPriority prio) {
+    ArtworkRecord rec;
+    char line[ART_LINE_MAX + 1];
+    size_t len;
 
-    feedWatchdog();
+    if (!artReadRecord(idx, n, rec)) return false;
+    len = rec.lineLength > ART_LINE_MAX ? ART_LINE_MAX : rec.lineLength;
+    if (!artReadAt(log, rec.logOffset, line, len)) return false;
+    line[len] = '\0';
 
-    Serial.println("[ART] Listing artworks");
+    char msg[TX_MAX_PACKET + 1];
+    snprintf(msg, sizeof(msg), "ART:%lu|%s", (unsigned long)(n + 1), line);
+    return sendMessage(msg, prio);
+}
 
-    File file = SD.open(ARTWORK_LOG_PATH, FILE_READ);
-    if (!file) {
-        Serial.println("[ART] No artwork log found");
+static bool artOpenIndex(File &idx, File &log) {
+    if (!artIndexOk) artworkIndexInit();  // Retry after an earlier failure
+    if (!artIndexOk) return false;
+    idx = SD.open(ARTWORK_IDX_PATH, FILE_READ);
+    log = SD.open(ARTWORK_LOG_PATH, FILE_READ);
+    if (idx && log) return true;
+    if (idx) idx.close();
+    if (log) log.close();
+    return false;
+}
+
+void listArtworks(uint32_t offset, uint32_t count) {
+    if (!isSDAvailable()) return;
+    if (bulkRejectIfBusy()) return;
+
+    LOG_I("ART", "Listing artworks %lu+%lu", (unsigned long)offset, (unsigned long)count);
+
+    if (artIndexOk && artCount == 0) {
+        LOG_I("ART", "No artwork log found");
         sendMessage("ART:EMPTY");
         return;
     }
 
-    // Count entries and send
-    int count = 0;
-    sendMessage("ART:LIST_START");
-    delay(100);
+    File idx, log;
+    if (!artOpenIndex(idx, log)) {
+        sendMessage("ERR:ART_INDEX_FAILED");
+        return;
+    }
 
-    while (file.available()) {
-        feedWatchdog();
+    // Entries are sent from bulkDownlinkTick()
+    uint32_t start = offset < artCount ? offset : artCount;
+    bulkJob.type = BULK_LIST_ARTWORKS;
+    bulkJob.headerPending = true;
+    bulkJob.file = log;
+    bulkJob.aux = idx;
+    bulkJob.artNext = start;
+    bulkJob.artEnd = (count == 0 || count > artCount - start) ? artCount : start + count;
+    bulkJob.count = 0;
+}
 
-        String line = file.readStringUntil('\n');
-        line.trim();
+void getArtwork(const char *cid) {
+    if (!isSDAvailable()) return;
 
-        if (line.length() > 0) {
-            count++;
-            // Send each artwork entry
-            sendMessage("ART:" + String(count) + "|" + line);
-            delay(50);
-        }
+    int32_t n = artworkFind(cid, strlen(cid));
+    if (n < 0) {
+        sendMessage("ERR:ART_NOT_FOUND");
+        return;
     }
 
-    file.close();
+    File idx, log;
+    if (!artOpenIndex(idx, log) || !artSendRecord(idx, log, (uint32_t)n, TX_PRIO_REPLY)) {
+        sendMessage("ERR:ART_INDEX_FAILED");
+    }
+    if (idx) idx.close();
+    if (log) log.close();
+}
 
-    sendMessage("ART:LIST_END|COUNT:" + String(count));
-    Serial.printf("[ART] Listed %d artworks\n", count);
+uint32_t artworkCount() {
+    return artCount;
 }
@@ -10,13 +10,54 @@
  * - Added SD card availability check before all operations
  * - Added file size limits for safety
  * - Improved error reporting
+ * - Bulk downlinks (listings, file reads) run as a non-blocking job
+ * - logToSD() hands records to a background writer task
+ * - Free space is tracked incrementally instead of scanning the FAT
+ * - Artworks are indexed: CID dedupe, paged listing, lookup by CID
+ * - Optional LZSS-compressed file reads and listings
+ * - Listings come from cached directory manifests, many entries per
+ *   packet, paged and version-stamped
  */
 
 #include "FS.h"
+#include "lzss.h"
+
+// ==================== BULK DOWNLINK JOB ====================
+// Only one bulk downlink runs at a time; starting another while one is
+// active replies "ERR:DOWNLINK_BUSY".
+
+// Paged listing from a directory manifest (manifest.h): frames of
+// "<prefix><version>,<first>,<total>|D:name|F:name,size|..." for entries
+// [offset, offset + count), count 0 = to the end. A cached manifest goes
+// out straight from RAM; otherwise the directory is read into one first.
+// If ground already holds 'version' and it is still current, the reply is
+// the single frame "<prefix><version>,<offset>,<total>|UNCHANGED".
+struct ListPage {
+    uint32_t offset;
+    uint32_t count;
+    bool haveVersion;
+    uint32_t version;
+};
+
+// "offset,count,version hex", every part optional; false if malformed
+bool parseListPage(const char *spec, ListPage &page);
+
+// Start a paged listing (filesOnly leaves subdirectories out). False, with
+// nothing sent, if dirname is not a directory.
+bool bulkStartPage(const char *dirname, const char *prefix, bool filesOnly, const ListPage &page);
+
+// Advance the active job while the TX queue has bulk room
+// Call every mainLoop() iteration (before radioTxTick())
+void bulkDownlinkTick();
+
+// True while a listing/file read is still being queued
+bool bulkDownlinkBusy();
 
 // List directory contents
-// Sends results via LoRa in chunks to avoid memory exhaustion
-void listDir(fs::FS &fs, const char *dirname, uint8_t levels);
+// "ListDir&path@offset,count,version" sends a paged listing (bulkStartPage(),
+// prefix "LS:"); "ListDir&path@Z" walks the directory into an LZ stream of
+// DIR:/D:/F:/END:DIR lines instead
+void listDir(fs::FS &fs, const char *dirname, const char *spec);
 
 // Create a directory
 void createDir(fs::FS &fs, const char *path);
@@ -25,9 +66,48 @@ void createDir(fs::FS &fs, const char *path);
 void removeDir(fs::FS &fs, const char *path);
 
 // Read file contents
-// Sends contents via LoRa in chunks (max 200 bytes per chunk)
+// Queues raw contents in chunks (max 200 bytes per chunk) via bulkDownlinkTick()
 void readFile(fs::FS &fs, const char *path);
 
+// ==================== COMPRESSED DOWNLINK ====================
+// Frame: [LZ_FRAME_TYPE][block u16 BE][part | LZ_LAST_PART][LZSS bytes]
+// Every block of up to LZ_BLOCK_SIZE raw bytes is compressed independently
+// (format in lzss.h); concatenating a block's parts and decompressing gives
+// its raw bytes. Listings become newline-separated lines of the usual
+// DIR:/D:/F:/END:DIR text.
+// File:    "FILEZ:path,size,blocks", frames, "ENDZ:..."
+// Listing: "LISTZ:path", frames, "ENDZ:..."
+// Trailer: "ENDZ:blocks,raw,zsize,pct%" (pct = compressed size / raw size,
+//          totalled block by block as they are sent)
+#define LZ_FRAME_TYPE     0xD5
+#define LZ_HEADER_SIZE    4
+#define LZ_PAYLOAD        (TX_MAX_PACKET - LZ_HEADER_SIZE)   // 251 bytes
+#define LZ_LAST_PART      0x80
+#define LZ_BLOCK_SIZE     LZSS_BLOCK_MAX                     // 2 KB raw per block
+
+// Send a file compressed ("ReadFile&path@Z")
+void readFileCompressed(fs::FS &fs, const char *path);
+
+// ==================== BURST FILE DOWNLINK ====================
+// Frame: [BURST_FRAME_TYPE][transfer id][seq u16 BE][total u16 BE][payload]
+// Sequence: "FILEB:id,path,size,frames" (or "FILER:...,count" for a
+// range request), the frames, then "ENDB:id,crc32". Frame n holds file bytes
+// [n * BURST_PAYLOAD, (n + 1) * BURST_PAYLOAD). A range request carries the
+// CRC only if the last whole burst was of this path at this size.
+#define BURST_FRAME_TYPE     0xB5
+#define BURST_HEADER_SIZE    6
+#define BURST_PAYLOAD        (TX_MAX_PACKET - BURST_HEADER_SIZE)   // 249 bytes
+#define BURST_RANGE_SPEC_MAX 96     // Max length of a ReadFileRange frame list
+
+// Send the whole file as numbered binary frames ("ReadFile&path@B")
+void readFileBurst(fs::FS &fs, const char *path);
+
+// Resend only the listed frames, e.g. ranges = "3,7,10-12"
+void readFileRange(fs::FS &fs, const char *path, const char *ranges);
+
+// Drop the CRC kept for range retries of 'path' (it was rewritten)
+void burstForget(const char *path);
+
 // Write to file (overwrite)
 void writeFile(fs::FS &fs, const char *path, const char *message);
 
@@ -47,9 +127,37 @@ void testFileIO(fs::FS &fs, const char *path);
 bool isSDAvailable();
 
 // Log message to SD card (for debugging)
+// Queued for the writer task once startLogWriter() has run, written
+// inline before that. Records that don't fit in the ring are dropped.
 void logToSD(const char *message);
 
-// Get SD card capacity info
+// ==================== BACKGROUND LOG WRITER ====================
+#define LOG_FILE_PATH          "/log.txt"
+#define LOG_RING_SIZE          4096    // Bytes, must be a power of two
+#define LOG_SECTOR_SIZE        512     // Append granularity
+#define LOG_RECORD_MAX         320     // Longest single record incl. timestamp
+#define LOG_FLUSH_INTERVAL_MS  2000UL  // Partial sector flush period
+#define LOG_FLUSH_TIMEOUT      1000UL  // logFlush() wait before a restart
+#define LOG_TASK_STACK         4096
+#define LOG_TASK_PRIORITY      1
+#define LOG_TASK_CORE          0       // Arduino loop() runs on core 1
+
+// Start the writer task (call once after SDBegin())
+void startLogWriter();
+
+// Write everything queued so far to the card (call before ESP.restart())
+// Returns false on timeout
+bool logFlush(unsigned long timeoutMs);
+
+// Ring statistics
+uint32_t logRingDrops();
+size_t logRingDepth();
+
+// True while the writer task is draining or writing (not waiting),
+// the main loop must not light-sleep then
+bool logWriterBusy();
+
+// Get SD card capacity info (from the space tracker, no FAT access)
 uint64_t getSDTotalMB();
 uint64_t getSDUsedMB();
 uint64_t getSDFreeMB();
@@ -61,15 +169,50 @@ bool hasSDSpace(size_t bytesNeeded);
 // Minimum free space threshold (bytes) - reject writes below this
 #define SD_MIN_FREE_BYTES  1048576  // 1 MB minimum free space
 
+// ==================== SD SPACE TRACKER ====================
+#define SD_SPACE_RECONCILE_MS  600000UL  // Re-read usedBytes() every 10 min
+
+// Seed from SD.totalBytes()/usedBytes() (called by SDBegin())
+void sdSpaceInit();
+
+// Add bytes written by any of our write paths
+void sdSpaceAccount(size_t bytesWritten);
+
+// Space may have been freed (delete, overwrite): reconcile soon
+void sdSpaceInvalidate();
+
+// Re-read usedBytes() if due or invalidated (log writer task)
+void sdSpaceReconcileIfDue();
+
 // ==================== ARTWORK STORAGE ====================
 // Store artwork references (IPFS CID + artist + title) to SD card
 // Used for Bitforms gallery proposal - curated artwork sent to space
 
-// Log an artwork entry to /artworks.log
+// Index files: /artworks.idx (record per entry, log order) and
+// /artworks.hix (CID hashes, sorted) - see memor.cpp
+#define ART_CID_MAX   100   // Longest CID accepted
+#define ART_LINE_MAX  280   // Longest log line (fits an uplink + timestamp)
+
+// Open, check and repair the index against the log (call after SDBegin())
+// Rebuilds it from /artworks.log when missing or torn
+void artworkIndexInit();
+
+// Log an artwork entry to /artworks.log and index it
 // Entry format: "T+HH:MM:SS|IPFS_CID|ArtistName|WorkTitle"
 bool logArtwork(const char *entry);
 
-// List all stored artworks via LoRa
-void listArtworks();
+// Index (0-based) of the entry with this CID, or -1 - O(log n) SD reads
+int32_t artworkFind(const char *cid, size_t cidLen);
+
+// Number of indexed artworks
+uint32_t artworkCount();
+
+// List 'count' artworks from 'offset' (count 0 = to the end) via LoRa
+// "ART:LIST_START|OFFSET:o|TOTAL:n", "ART:<n>|entry"...,
+// "ART:LIST_END|COUNT:k[|NEXT:o+k]"
+void listArtworks(uint32_t offset = 0, uint32_t count = 0);
+
+// Send the entry for one CID ("ART:<n>|entry" or "ERR:ART_NOT_FOUND")
+void getArtwork(const char *cid);
 
 #endif // MEMOR_H
@@ -0,0 +1,80 @@
+/*
+ * Orbital Temple Satellite - Message Builder Implementation
+ * Version: 1.21
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include "msgbuf.h"
+
+MsgBuilder::MsgBuilder(char* buffer, size_t capacity)
+    : buf(buffer), cap(capacity), len(0), over(false) {
+    buf[0] = '\0';
+}
+
+void MsgBuilder::clear() {
+    len = 0;
+    over = false;
+    buf[0] = '\0';
+}
+
+MsgBuilder& MsgBuilder::add(const char* text, size_t length) {
+    if (length > space()) {
+        length = space();
+        over = true;
+    }
+    memcpy(buf + len, text, length);
+    len += length;
+    buf[len] = '\0';
+    return *this;
+}
+
+MsgBuilder& MsgBuilder::add(const char* text) {
+    return text ? add(text, strlen(text)) : *this;
+}
+
+MsgBuilder& MsgBuilder::add(char c) {
+    return add(&c, 1);
+}
+
+MsgBuilder& MsgBuilder::addU(unsigned long value) {
+    // Digits right to left, no format string to parse
+    char digits[20];
+    size_t n = 0;
+    do {
+        digits[sizeof(digits) - 1 - n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    return add(digits + sizeof(digits) - n, n);
+}
+
+MsgBuilder& MsgBuilder::addI(long value) {
+    if (value < 0) {
+        add('-');
+        return addU(0UL - (unsigned long)value);
+    }
+    return addU((unsigned long)value);
+}
+
+MsgBuilder& MsgBuilder::addF(float value, uint8_t decimals) {
+    return addf("%.*f", (int)decimals, (double)value);
+}
+
+MsgBuilder& MsgBuilder::addf(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(buf + len, cap - len, format, args);
+    va_end(args);
+
+    if (n < 0) {
+        buf[len] = '\0';
+        over = true;
+    } else if ((size_t)n > space()) {
+        len = cap - 1;              // vsnprintf kept what fit and terminated it
+        over = true;
+    } else {
+        len += n;
+    }
+    return *this;
+}
@@ -0,0 +1,75 @@
+#ifndef MSGBUF_H
+#define MSGBUF_H
+
+/*
+ * Orbital Temple Satellite - Message Builder
+ * Version: 1.21
+ *
+ * Fixed-capacity text builder for downlink replies, beacons and log
+ * lines, in place of String concatenation. Each "a" + String(n) + "b"
+ * allocated and freed a few heap blocks per reply; over months of
+ * uptime that fragments the heap: total free stays flat while the
+ * largest free block shrinks. A MsgBuf lives on the stack instead:
+ *
+ *   MsgBuf<64> reply;
+ *   reply.add("OK:WRITTEN:").addU(bytesWritten).add('B');
+ *   sendMessage(reply);
+ *
+ * Appends past the capacity are truncated (always NUL-terminated) and
+ * set overflowed(), so a reply is cut short rather than corrupting the
+ * stack. Functions that contribute to a message take a MsgBuilder& and
+ * append to whatever buffer the caller owns.
+ *
+ * Host-portable: the test suite compiles it directly (test/test_msgbuf.cpp).
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+// One downlink packet of text plus the terminator (TX_MAX_PACKET + 1)
+#define MSG_REPLY_SIZE  256
+
+// ==================== BUILDER ====================
+
+class MsgBuilder {
+public:
+    // capacity includes the terminator
+    MsgBuilder(char* buffer, size_t capacity);
+
+    MsgBuilder& add(const char* text);
+    MsgBuilder& add(const char* text, size_t length);
+    MsgBuilder& add(char c);
+    MsgBuilder& addU(unsigned long value);
+    MsgBuilder& addI(long value);
+    MsgBuilder& addF(float value, uint8_t decimals);     // String(value, decimals)
+    MsgBuilder& addf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+    void clear();
+    const char* c_str() const { return buf; }
+    size_t length() const { return len; }
+    size_t space() const { return cap - 1 - len; }      // Characters that still fit
+    bool overflowed() const { return over; }
+
+private:
+    MsgBuilder(const MsgBuilder&);                      // Would alias the buffer
+    MsgBuilder& operator=(const MsgBuilder&);
+
+    char* buf;
+    size_t cap;
+    size_t len;
+    bool over;
+};
+
+// Builder with its own storage (stack or static)
+template <size_t N>
+class MsgBuf : public MsgBuilder {
+public:
+    MsgBuf() : MsgBuilder(storage, N) {}
+
+private:
+    char storage[N];
+};
+
+typedef MsgBuf<MSG_REPLY_SIZE> Reply;
+
+#endif // MSGBUF_H
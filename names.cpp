@@ -0,0 +1,588 @@
+/*
+ * Orbital Temple Satellite - Name Ledger Implementation
+ * Version: 1.21
+ */
+
+#include <Arduino.h>
+#include "SD.h"
+#include "config.h"
+#include "log.h"
+#include "names.h"
+#include "bloom.h"
+#include "lora.h"
+#include "memor.h"
+#include "radiation.h"
+#include "crc32.h"
+#include "manifest.h"
+
+#define NAME_STAMP_MAX  18                      // "T+HHHHHHH:MM:SS|"
+#define NAME_LINE_MAX   (NAME_STAMP_MAX + NAME_MAX_LENGTH)
+#define LEDGER_READ     32                      // Records per card read (512 bytes)
+#define HIX_READ        64                      // Hash entries per card read (512 bytes)
+
+struct NameRecord {
+    uint32_t h1;            // BloomKey of the name
+    uint32_t h2;
+    uint32_t logOffset;     // Start of its line in the log
+    uint32_t missionSecs;   // Mission elapsed time when stored
+};
+
+struct NameHashEntry {
+    uint32_t h1;
+    uint32_t record;        // Ledger record number
+};
+
+static_assert(sizeof(NameRecord) == 16, "names.ldg record layout");
+static_assert(sizeof(NameHashEntry) == 8, "names.hix entry layout");
+
+// Ledger header, TMR-protected: a flipped count would send scans past the file
+static const bool& ledgerOk = tmrNew("ledgerOk", false);
+static const uint32_t& ledgerCount = tmrNew("ledgerCount", (uint32_t)0);
+
+static uint8_t bloomPool[NAMES_BLOOM_BYTES];
+static Bloom bloom = { NULL, 0, 0 };   // bits NULL: no filter, every query checks the card
+static uint32_t bloomCrc = 0;
+
+static uint32_t queries = 0;
+static uint32_t cardChecks = 0;        // Bloom hits confirmed on the card
+static uint32_t falsePositives = 0;
+
+// ==================== HELPERS ====================
+
+static uint32_t bloomChecksum() {
+    return crc32Final(crc32Update(crc32Begin(), bloom.bits, bloom.mask / 8 + 1));
+}
+
+// Trim spaces; false if nothing valid is left
+static bool nameClean(const char*& name, size_t& len) {
+    while (len > 0 && name[0] == ' ') { name++; len--; }
+    while (len > 0 && name[len - 1] == ' ') len--;
+    if (len == 0 || len > NAME_MAX_LENGTH) return false;
+    for (size_t i = 0; i < len; i++) {
+        if ((uint8_t)name[i] < 0x20 || name[i] == '|' || name[i] == 0x7F) return false;
+    }
+    return true;
+}
+
+static BloomKey nameKey(const char* name, size_t len) {
+    return bloomHash((const uint8_t*)name, len);
+}
+
+// Line at 'offset', without its terminator; returns the length (0 on error)
+static size_t readLine(File& log, uint32_t offset, char* line, size_t size) {
+    if (!log.seek(offset)) return 0;
+    size_t len = log.readBytesUntil('\n', line, size - 1);
+    while (len > 0 && (line[len - 1] == '\r' || line[len - 1] == ' ')) len--;
+    line[len] = '\0';
+    return len;
+}
+
+// Name part of a "T+HH:MM:SS|Name" line
+static const char* lineName(const char* line, size_t len, size_t& nameLen) {
+    const char* bar = (const char*)memchr(line, '|', len);
+    if (!bar) return NULL;
+    nameLen = line + len - (bar + 1);
+    return bar + 1;
+}
+
+// "T+HH:MM:SS" prefix back to seconds (for lines indexed from the log)
+static uint32_t parseMissionSecs(const char* line) {
+    unsigned long h = 0, m = 0, sec = 0;
+    if (sscanf(line, "T+%lu:%lu:%lu", &h, &m, &sec) != 3) return 0;
+    return (uint32_t)(h * 3600 + m * 60 + sec);
+}
+
+static bool recordMatches(File& log, const NameRecord& rec, const char* name, size_t len) {
+    char line[NAME_LINE_MAX + 1];
+    size_t lineLen = readLine(log, rec.logOffset, line, sizeof(line));
+    size_t storedLen;
+    const char* stored = lineName(line, lineLen, storedLen);
+    return stored && storedLen == len && memcmp(stored, name, len) == 0;
+}
+
+// ==================== FILTER ====================
+
+// Add every ledger record (boot and scrub repairs only)
+static void bloomRebuild() {
+    bloomInit(bloom, bloomPool, sizeof(bloomPool));
+
+    File ledger = SD.open(NAMES_LEDGER_PATH, FILE_READ);
+    if (ledgerCount > 0 && !ledger) {
+        bloom.bits = NULL;
+        return;
+    }
+
+    NameRecord recs[LEDGER_READ];
+    for (uint32_t i = 0; i < ledgerCount; ) {
+        feedWatchdog();
+        uint32_t n = ledgerCount - i < LEDGER_READ ? ledgerCount - i : LEDGER_READ;
+        if (ledger.read((uint8_t*)recs, n * sizeof(NameRecord)) != n * sizeof(NameRecord)) {
+            LOG_W("NAMES", "Ledger read failed at %lu, filter disabled", (unsigned long)i);
+            bloom.bits = NULL;
+            break;
+        }
+        for (uint32_t j = 0; j < n; j++) {
+            BloomKey key = { recs[j].h1, recs[j].h2 };
+            bloomAdd(bloom, key);
+        }
+        i += n;
+    }
+    if (ledger) ledger.close();
+
+    if (bloom.bits) bloomCrc = bloomChecksum();
+    LOG_I("NAMES", "Bloom filter %lu bytes for %lu names%s", (unsigned long)sizeof(bloomPool),
+          (unsigned long)ledgerCount, bloomFull(bloom) ? " (past design load)" : "");
+}
+
+void namesScrub() {
+    if (!ledgerOk || bloom.bits == NULL) return;
+    if (bloomChecksum() == bloomCrc) return;
+
+    LOG_W("NAMES", "Bloom filter corrupted, rebuilding from ledger");
+    seuCorrectionsTotal++;
+    bloomRebuild();
+}
+
+// ==================== LEDGER ====================
+
+static bool readAt(File& file, uint32_t pos, void* out, size_t size) {
+    return file.seek(pos) && file.read((uint8_t*)out, size) == size;
+}
+
+// First entry of [0, hi) with h1 >= key (or > key when upper is set)
+static uint32_t hashBound(File& hix, uint32_t h1, uint32_t hi, bool upper) {
+    uint32_t lo = 0;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        NameHashEntry e;
+        if (!readAt(hix, mid * sizeof(NameHashEntry), &e, sizeof(e))) return lo;
+        if (e.h1 < h1 || (upper && e.h1 == h1)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// Merge records [first, first + n) into the sorted index of the 'first'
+// before them in one pass from the back: each new entry (sorted) moves the
+// tail above its place up, as artHashInsert() does for one.
+static bool hashMerge(const NameRecord* recs, uint32_t first, uint32_t n) {
+    NameHashEntry add[NAMES_BATCH_MAX];
+    for (uint32_t i = 0; i < n; i++) {
+        NameHashEntry e = { recs[i].h1, first + i };
+        uint32_t j = i;
+        for (; j > 0 && add[j - 1].h1 > e.h1; j--) add[j] = add[j - 1];
+        add[j] = e;
+    }
+
+    File hix = SD.open(NAMES_HIX_PATH, SD.exists(NAMES_HIX_PATH) ? "r+" : FILE_WRITE);
+    if (!hix) return false;
+
+    // Grow first so every write lands inside the file; a reset from here
+    // on leaves zeroed or repeated entries that namesInit() rejects
+    uint8_t chunk[512];
+    memset(chunk, 0, n * sizeof(NameHashEntry));
+    bool ok = hix.seek(first * sizeof(NameHashEntry)) &&
+              hix.write(chunk, n * sizeof(NameHashEntry)) == n * sizeof(NameHashEntry);
+
+    uint32_t hi = first;
+    for (uint32_t j = n; ok && j-- > 0; ) {
+        feedWatchdog();
+        uint32_t pos = hashBound(hix, add[j].h1, hi, true);
+        uint32_t start = pos * sizeof(NameHashEntry);
+        uint32_t end = hi * sizeof(NameHashEntry);
+        uint32_t shift = (j + 1) * sizeof(NameHashEntry);
+        while (ok && end > start) {
+            uint32_t len = end - start;
+            if (len > sizeof(chunk)) len = sizeof(chunk);
+            ok = readAt(hix, end - len, chunk, len) &&
+                 hix.seek(end - len + shift) && hix.write(chunk, len) == len;
+            end -= len;
+        }
+        ok = ok && hix.seek(start + j * sizeof(NameHashEntry)) &&
+             hix.write((const uint8_t*)&add[j], sizeof(add[j])) == sizeof(add[j]);
+        hi = pos;
+    }
+    hix.close();
+    manifestNoteChanged(NAMES_HIX_PATH);
+    sdSpaceAccount(n * sizeof(NameHashEntry));
+    return ok;
+}
+
+// Entries in the hash index if they are strictly increasing (h1, record)
+// and name only the first of 'records' ledger records, -1 if not. A torn
+// merge leaves zeroed or repeated entries, so this catches it.
+static int32_t hashIndexCovered(uint32_t records) {
+    File hix = SD.open(NAMES_HIX_PATH, FILE_READ);
+    if (!hix) return 0;
+    uint32_t count = hix.size() / sizeof(NameHashEntry);
+    bool ok = hix.size() % sizeof(NameHashEntry) == 0 && count <= records;
+
+    NameHashEntry entries[HIX_READ];
+    NameHashEntry prev = { 0, 0 };
+    for (uint32_t i = 0; ok && i < count; ) {
+        feedWatchdog();
+        uint32_t n = count - i < HIX_READ ? count - i : HIX_READ;
+        ok = hix.read((uint8_t*)entries, n * sizeof(NameHashEntry)) == n * sizeof(NameHashEntry);
+        for (uint32_t j = 0; ok && j < n; j++, i++) {
+            const NameHashEntry& e = entries[j];
+            ok = e.record < count &&
+                 (i == 0 || e.h1 > prev.h1 || (e.h1 == prev.h1 && e.record > prev.record));
+            prev = e;
+        }
+    }
+    hix.close();
+    return ok ? (int32_t)count : -1;
+}
+
+// Merge ledger records [from, to) into the hash index, a batch at a time
+static bool hashIndexExtend(uint32_t from, uint32_t to) {
+    if (from == to) return true;
+    LOG_I("NAMES", "Indexing names %lu-%lu", (unsigned long)from, (unsigned long)to - 1);
+
+    File ledger = SD.open(NAMES_LEDGER_PATH, FILE_READ);
+    if (!ledger || !ledger.seek(from * sizeof(NameRecord))) return false;
+    NameRecord recs[NAMES_BATCH_MAX];
+    bool ok = true;
+    for (uint32_t i = from; ok && i < to; ) {
+        uint32_t n = to - i < NAMES_BATCH_MAX ? to - i : NAMES_BATCH_MAX;
+        ok = ledger.read((uint8_t*)recs, n * sizeof(NameRecord)) == n * sizeof(NameRecord) &&
+             hashMerge(recs, i, n);
+        i += n;
+    }
+    ledger.close();
+    return ok;
+}
+
+// Record with this key whose log text is 'name': binary search of the
+// hash index, then one ledger record and one log line per candidate
+static int32_t ledgerFind(const BloomKey& key, const char* name, size_t len, NameRecord& found) {
+    File hix = SD.open(NAMES_HIX_PATH, FILE_READ);
+    File ledger = SD.open(NAMES_LEDGER_PATH, FILE_READ);
+    File log = SD.open(NAMES_LOG_PATH, FILE_READ);
+    int32_t result = -1;
+
+    if (hix && ledger && log) {
+        for (uint32_t pos = hashBound(hix, key.h1, ledgerCount, false);
+             pos < ledgerCount && result < 0; pos++) {
+            NameHashEntry e;
+            NameRecord rec;
+            if (!readAt(hix, pos * sizeof(NameHashEntry), &e, sizeof(e)) || e.h1 != key.h1) break;
+            if (!readAt(ledger, e.record * sizeof(NameRecord), &rec, sizeof(rec))) break;
+            if (rec.h2 == key.h2 && recordMatches(log, rec, name, len)) {
+                found = rec;
+                result = (int32_t)e.record;
+            }
+        }
+    }
+
+    if (hix) hix.close();
+    if (ledger) ledger.close();
+    if (log) log.close();
+    return result;
+}
+
+// Bloom first; the card only when it says "maybe"
+static int32_t nameFind(const BloomKey& key, const char* name, size_t len, NameRecord& found) {
+    if (ledgerCount == 0 || !bloomMayContain(bloom, key)) return -1;
+    cardChecks++;
+    int32_t n = ledgerFind(key, name, len, found);
+    if (n < 0) falsePositives++;
+    return n;
+}
+
+// Records at the end of the ledger, then into the hash index (n <= NAMES_BATCH_MAX)
+static bool ledgerAppend(const NameRecord* recs, uint32_t n) {
+    File ledger = SD.open(NAMES_LEDGER_PATH, FILE_APPEND);
+    if (!ledger) return false;
+    size_t size = n * sizeof(NameRecord);
+    bool ok = ledger.write((const uint8_t*)recs, size) == size;
+    ledger.close();
+    manifestNoteChanged(NAMES_LEDGER_PATH);
+    sdSpaceAccount(size);
+
+    ok = ok && hashMerge(recs, ledgerCount, n);
+    if (ok) tmrWrite(ledgerCount, ledgerCount + n);
+    return ok;
+}
+
+// Index log lines from byte offset 'from' onwards, a batch at a time
+static bool ledgerIndexLogTail(File& log, uint32_t from) {
+    char line[NAME_LINE_MAX + 1];
+    NameRecord recs[NAMES_BATCH_MAX];
+    uint32_t pending = 0;
+    log.seek(from);
+
+    while (log.available()) {
+        feedWatchdog();
+        uint32_t offset = log.position();
+        size_t len = log.readBytesUntil('\n', line, NAME_LINE_MAX);
+        while (len > 0 && (line[len - 1] == '\r' || line[len - 1] == ' ')) len--;
+        if (len == 0) continue;
+        line[len] = '\0';
+
+        size_t nameLen;
+        const char* name = lineName(line, len, nameLen);
+        if (!name || !nameClean(name, nameLen)) {
+            LOG_W("NAMES", "Skipping malformed log line at %lu", (unsigned long)offset);
+            continue;
+        }
+        BloomKey key = nameKey(name, nameLen);
+        NameRecord rec = { key.h1, key.h2, offset, parseMissionSecs(line) };
+        recs[pending++] = rec;
+        if (pending == NAMES_BATCH_MAX) {
+            if (!ledgerAppend(recs, pending)) return false;
+            pending = 0;
+        }
+    }
+    return pending == 0 || ledgerAppend(recs, pending);
+}
+
+void namesInit() {
+    tmrWrite(ledgerOk, false);
+    tmrWrite(ledgerCount, 0);
+    bloom.bits = NULL;
+    if (!SDOK) return;
+
+    File log = SD.open(NAMES_LOG_PATH, FILE_READ);
+    if (!log) {
+        // No names yet; drop a stale ledger so numbering restarts
+        SD.remove(NAMES_LEDGER_PATH);
+        SD.remove(NAMES_HIX_PATH);
+        manifestNoteRemoved(NAMES_LEDGER_PATH);
+        manifestNoteRemoved(NAMES_HIX_PATH);
+        tmrWrite(ledgerOk, true);
+        bloomRebuild();
+        return;
+    }
+
+    // The last record must point at a line with its name: then everything
+    // before it is indexed and only lines after it are new
+    uint32_t resumeFrom = 0;
+    uint32_t records = 0;
+    File ledger = SD.open(NAMES_LEDGER_PATH, FILE_READ);
+    if (ledger) {
+        records = ledger.size() / sizeof(NameRecord);
+        NameRecord last = { 0, 0, 0, 0 };
+        if (ledger.size() % sizeof(NameRecord) != 0) {
+            records = 0;
+        } else if (records > 0) {
+            char line[NAME_LINE_MAX + 1];
+            size_t len = 0;
+            size_t nameLen = 0;
+            const char* name = NULL;
+            if (ledger.seek((records - 1) * sizeof(NameRecord)) &&
+                ledger.read((uint8_t*)&last, sizeof(last)) == sizeof(last) &&
+                last.logOffset < log.size()) {
+                len = readLine(log, last.logOffset, line, sizeof(line));
+                name = lineName(line, len, nameLen);
+            }
+            BloomKey key = { 0, 0 };
+            if (name && nameClean(name, nameLen)) key = nameKey(name, nameLen);
+            if (name && key.h1 == last.h1 && key.h2 == last.h2) {
+                resumeFrom = log.position();
+            } else {
+                records = 0;    // Torn or stale: re-index everything
+            }
+        }
+        ledger.close();
+    }
+
+    if (records == 0) {
+        if (SD.exists(NAMES_LEDGER_PATH)) LOG_I("NAMES", "Rebuilding name ledger from log");
+        SD.remove(NAMES_LEDGER_PATH);
+        manifestNoteRemoved(NAMES_LEDGER_PATH);
+        sdSpaceInvalidate();
+        resumeFrom = 0;
+    }
+
+    // The hash index covers the records kept: catch up a missing tail,
+    // rebuild it if it is torn
+    int32_t indexed = hashIndexCovered(records);
+    if (indexed < 0) {
+        LOG_I("NAMES", "Rebuilding name hash index");
+        SD.remove(NAMES_HIX_PATH);
+        manifestNoteRemoved(NAMES_HIX_PATH);
+        sdSpaceInvalidate();
+        indexed = 0;
+    }
+    bool indexOk = hashIndexExtend((uint32_t)indexed, records);
+
+    tmrWrite(ledgerCount, records);
+    tmrWrite(ledgerOk, indexOk && ledgerIndexLogTail(log, resumeFrom));
+    log.close();
+
+    bloomRebuild();
+    LOG_I("NAMES", "Ledger %s, %lu names", ledgerOk ? "OK" : "FAILED",
+          (unsigned long)ledgerCount);
+}
+
+uint32_t nameCount() {
+    return ledgerCount;
+}
+
+static bool ledgerReady() {
+    if (!ledgerOk) namesInit();     // Retry after an earlier failure
+    if (ledgerOk) return true;
+    sendMessage("ERR:NAMES_LEDGER_FAILED");
+    return false;
+}
+
+// ==================== COMMANDS ====================
+
+static void sendStats() {
+    Reply r;
+    r.add("NAMES:").addU(ledgerCount).add("|BLOOM:");
+    if (bloom.bits) {
+        r.addU(bloom.mask / 8 + 1).add("B,k").addU(BLOOM_K);
+    } else {
+        r.add("OFF");
+    }
+    r.add("|Q:").addU(queries).add('/').addU(cardChecks).add("|FP:").addU(falsePositives);
+    sendMessage(r);
+}
+
+void nameQuery(const char* data, size_t dataLength) {
+    if (!isSDAvailable()) return;
+    if (!ledgerReady()) return;
+
+    if (dataLength == 0) {
+        sendStats();
+        return;
+    }
+
+    const char* name = data;
+    size_t len = dataLength;
+    if (!nameClean(name, len)) {
+        sendMessage("ERR:NAME_INVALID");
+        return;
+    }
+
+    queries++;
+    NameRecord rec;
+    int32_t n = nameFind(nameKey(name, len), name, len, rec);
+    if (n < 0) {
+        sendMessage("NAME:ABSENT");
+        return;
+    }
+
+    Reply r;
+    r.add("NAME:PRESENT:").addU((uint32_t)n + 1)
+     .addf(",T+%02lu:%02lu:%02lu", (unsigned long)(rec.missionSecs / 3600),
+           (unsigned long)(rec.missionSecs / 60 % 60), (unsigned long)(rec.missionSecs % 60));
+    sendMessage(r);
+}
+
+// Batch being stored (names point into the uplink buffer)
+static const char* batchNames[NAMES_BATCH_MAX];
+static size_t batchLengths[NAMES_BATCH_MAX];
+static BloomKey batchKeys[NAMES_BATCH_MAX];
+static NameRecord batchRecs[NAMES_BATCH_MAX];
+static char batchText[RX_MAX_PACKET + NAMES_BATCH_MAX * NAME_STAMP_MAX];
+
+// Log lines in one write, then their records in one write
+static bool ledgerStore(uint32_t count) {
+    uint32_t secs = (millis() - missionStartTime) / 1000;
+    char stamp[NAME_STAMP_MAX + 1];
+    size_t stampLen = snprintf(stamp, sizeof(stamp), "T+%02lu:%02lu:%02lu|",
+                               (unsigned long)(secs / 3600), (unsigned long)(secs / 60 % 60),
+                               (unsigned long)(secs % 60));
+
+    File log = SD.open(NAMES_LOG_PATH, FILE_APPEND);
+    if (!log) return false;
+
+    uint32_t offset = log.size();
+    size_t textLen = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        NameRecord rec = { batchKeys[i].h1, batchKeys[i].h2, offset + (uint32_t)textLen, secs };
+        batchRecs[i] = rec;
+        memcpy(batchText + textLen, stamp, stampLen);
+        memcpy(batchText + textLen + stampLen, batchNames[i], batchLengths[i]);
+        textLen += stampLen + batchLengths[i];
+        batchText[textLen++] = '\n';
+    }
+    bool ok = log.write((const uint8_t*)batchText, textLen) == textLen;
+    log.close();
+    manifestNoteChanged(NAMES_LOG_PATH);
+    sdSpaceAccount(textLen);
+
+    // A line without its record is indexed from the log at the next boot
+    return ok && ledgerAppend(batchRecs, count);
+}
+
+void nameBatch(const char* data, size_t dataLength) {
+    if (!isSDAvailable()) return;
+    if (!ledgerReady()) return;
+
+    if (dataLength == 0) {
+        sendMessage("ERR:NAME_INVALID");
+        return;
+    }
+
+    // Split on '|', keeping names neither stored nor earlier in the batch
+    uint32_t fresh = 0, dup = 0, bad = 0, deferred = 0;
+    const char* p = data;
+    const char* end = data + dataLength;
+    while (p < end) {
+        const char* bar = (const char*)memchr(p, '|', end - p);
+        const char* name = p;
+        size_t len = (bar ? bar : end) - p;
+        p = bar ? bar + 1 : end;
+
+        if (fresh == NAMES_BATCH_MAX) {
+            // Full - this entry and the rest are left for the next packet
+            deferred = 1;
+            for (const char* q = name; (q = (const char*)memchr(q, '|', end - q)) != NULL; q++) {
+                deferred++;
+            }
+            break;
+        }
+        if (!nameClean(name, len)) {
+            bad++;
+            continue;
+        }
+
+        BloomKey key = nameKey(name, len);
+        NameRecord rec;
+        bool seen = nameFind(key, name, len, rec) >= 0;
+        for (uint32_t i = 0; i < fresh && !seen; i++) {
+            seen = batchKeys[i].h1 == key.h1 && batchKeys[i].h2 == key.h2 &&
+                   batchLengths[i] == len && memcmp(batchNames[i], name, len) == 0;
+        }
+        if (seen) {
+            dup++;
+            continue;
+        }
+        batchNames[fresh] = name;
+        batchLengths[fresh] = len;
+        batchKeys[fresh] = key;
+        fresh++;
+    }
+
+    if (fresh > 0) {
+        if (!hasSDSpace(dataLength + fresh * (NAME_STAMP_MAX + sizeof(NameRecord)) + 100)) {
+            sendMessage("ERR:SD_FULL");
+            return;
+        }
+        if (!ledgerStore(fresh)) {
+            LOG_W("NAMES", "WARNING: Ledger update failed");
+            tmrWrite(ledgerOk, false);
+            sendMessage("ERR:WRITE_FAILED");
+            return;
+        }
+
+        if (bloom.bits) {
+            for (uint32_t i = 0; i < fresh; i++) bloomAdd(bloom, batchKeys[i]);
+            bloomCrc = bloomChecksum();
+        }
+        LOG_I("NAMES", "Stored %lu names (%lu total)", (unsigned long)fresh,
+              (unsigned long)ledgerCount);
+    }
+
+    Reply r;
+    r.add("OK:NAMES:").addU(fresh).add(',').addU(dup).add(',').addU(bad).add(',').addU(ledgerCount)
+     .add(',').addU(deferred);
+    sendMessage(r);
+}
@@ -0,0 +1,74 @@
+#ifndef NAMES_H
+#define NAMES_H
+
+/*
+ * Orbital Temple Satellite - Name Ledger
+ * Version: 1.21
+ *
+ * Names sent from the website are stored once each and can be confirmed
+ * in a single packet, instead of a WriteFile into some path followed by
+ * a ReadFile over several packets to check it arrived.
+ *
+ * FILES:
+ *   NAMES_LOG_PATH     "T+HH:MM:SS|Name" per line, append-only (readable
+ *                      with ReadFile, the record of what ascended)
+ *   NAMES_LEDGER_PATH  one NameRecord per name, in log order: the two
+ *                      Bloom hashes, the line's log offset and the
+ *                      mission time, 16 bytes each
+ *   NAMES_HIX_PATH     one (h1, record number) pair per record, sorted,
+ *                      8 bytes each - binary searched for lookups
+ *   Appends go log -> ledger -> hash index, so a reset mid-batch leaves at
+ *   most a missing ledger tail, re-indexed from the log by namesInit(),
+ *   or a torn hash index, rebuilt from the ledger.
+ *
+ * LOOKUP:
+ *   A Bloom filter (bloom.h) over every ledger record lives in RAM. A
+ *   name it has never seen is answered ABSENT with no card access; a hit
+ *   is confirmed by a binary search of the hash index, then the ledger
+ *   record and log text of each entry with the same h1 (normally one).
+ *   A batch is merged into the index in one pass over it. The filter is one
+ *   fixed NAMES_BLOOM_BYTES array, never resized: past its design count
+ *   the false positive rate climbs slowly and only costs card checks. It
+ *   is checksummed and rebuilt from the ledger on a mismatch by
+ *   namesScrub(): a flipped set bit only costs a card check, a cleared
+ *   one would deny a name.
+ *
+ * COMMANDS:
+ *   NameQuery&@Name          -> "NAME:PRESENT:<n>,T+HH:MM:SS" | "NAME:ABSENT"
+ *   NameQuery                -> "NAMES:<count>|BLOOM:<bytes>B,k<k>|Q:<queries>/<card checks>|FP:<n>"
+ *   NameBatch&@Ana|Bo|Cy     -> "OK:NAMES:<added>,<already stored>,<invalid>,<total>,<deferred>"
+ *   A name is 1..NAME_MAX_LENGTH bytes after trimming spaces, without
+ *   control characters or '|'. Names already stored (or repeated in the
+ *   batch) are skipped, so a resent batch adds nothing twice. At most
+ *   NAMES_BATCH_MAX names are added per packet; the last <deferred>
+ *   entries were not looked at and go in the next batch.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ==================== CONFIGURATION ====================
+
+#define NAME_MAX_LENGTH     64
+#define NAMES_BATCH_MAX     48          // Names per NameBatch packet
+#define NAMES_BLOOM_BYTES   16384       // Filter (power of two): 13k names at ~1%
+#define NAMES_LOG_PATH      "/names.log"
+#define NAMES_LEDGER_PATH   "/names.ldg"
+#define NAMES_HIX_PATH      "/names.hix"
+
+// ==================== API ====================
+
+// Validate the ledger against the log and build the filter (after SDBegin())
+void namesInit();
+
+// Verify the filter's checksum, rebuild it on a mismatch (scrub job)
+void namesScrub();
+
+// Command handlers (data as parsed from the uplink)
+void nameQuery(const char* data, size_t dataLength);
+void nameBatch(const char* data, size_t dataLength);
+
+// Names in the ledger
+uint32_t nameCount();
+
+#endif // NAMES_H
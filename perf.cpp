@@ -0,0 +1,135 @@
+/*
+ * Orbital Temple Satellite - Latency Histograms Implementation
+ * Version: 1.21
+ *
+ * The SD writer task records from core 0 while the main loop records from
+ * core 1, so a histogram update is done under a spinlock on the ESP32.
+ * Statistics are computed only when read.
+ */
+
+#include "perf.h"
+#include <stdio.h>
+#include <string.h>
+
+#if PERF_HAVE_ESP_TIMER
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+static portMUX_TYPE perfMux = portMUX_INITIALIZER_UNLOCKED;
+#define PERF_LOCK()    portENTER_CRITICAL(&perfMux)
+#define PERF_UNLOCK()  portEXIT_CRITICAL(&perfMux)
+#else
+#include <time.h>
+#define PERF_LOCK()    do {} while (0)
+#define PERF_UNLOCK()  do {} while (0)
+#endif
+
+struct PerfHist {
+    uint32_t count;
+    uint32_t minUs;
+    uint32_t maxUs;
+    uint64_t sumUs;
+    uint32_t buckets[PERF_BUCKETS];
+};
+
+static PerfHist hists[PERF_PROBE_COUNT];
+
+static const char* const PROBE_NAMES[PERF_PROBE_COUNT] = {
+    "LOOP", "MSG", "HMAC", "TX", "SD", "SCRUB"
+};
+
+uint32_t perfNowUs() {
+#if PERF_HAVE_ESP_TIMER
+    return (uint32_t)esp_timer_get_time();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000);
+#endif
+}
+
+static inline uint8_t perfBucket(uint32_t us) {
+    if (us == 0) return 0;
+    uint8_t b = 31 - __builtin_clz(us);
+    return b < PERF_BUCKETS ? b : PERF_BUCKETS - 1;
+}
+
+void perfRecord(PerfProbe probe, uint32_t us) {
+    if ((unsigned)probe >= PERF_PROBE_COUNT) return;
+    PerfHist &h = hists[probe];
+    uint8_t b = perfBucket(us);
+
+    PERF_LOCK();
+    if (h.count == 0 || us < h.minUs) h.minUs = us;
+    if (us > h.maxUs) h.maxUs = us;
+    h.count++;
+    h.sumUs += us;
+    h.buckets[b]++;
+    PERF_UNLOCK();
+}
+
+// Upper bound of the bucket holding the rank-th sample (1-based),
+// clamped to the observed range
+static uint32_t perfPercentile(const PerfHist &h, uint32_t rank) {
+    uint32_t seen = 0;
+    for (uint8_t b = 0; b < PERF_BUCKETS; b++) {
+        seen += h.buckets[b];
+        if (seen >= rank) {
+            uint32_t upper = (b == PERF_BUCKETS - 1) ? h.maxUs : (2UL << b) - 1;
+            if (upper > h.maxUs) upper = h.maxUs;
+            if (upper < h.minUs) upper = h.minUs;
+            return upper;
+        }
+    }
+    return h.maxUs;
+}
+
+bool perfStats(PerfProbe probe, PerfStats &out) {
+    memset(&out, 0, sizeof(out));
+    if ((unsigned)probe >= PERF_PROBE_COUNT) return false;
+
+    PerfHist h;
+    PERF_LOCK();
+    h = hists[probe];
+    PERF_UNLOCK();
+
+    if (h.count == 0) return false;
+
+    out.count = h.count;
+    out.minUs = h.minUs;
+    out.maxUs = h.maxUs;
+    out.meanUs = (uint32_t)(h.sumUs / h.count);
+    // Nearest rank: ceil(q * n)
+    out.p50Us = perfPercentile(h, (uint32_t)(((uint64_t)h.count * 50 + 99) / 100));
+    out.p99Us = perfPercentile(h, (uint32_t)(((uint64_t)h.count * 99 + 99) / 100));
+    return true;
+}
+
+const char* perfProbeName(PerfProbe probe) {
+    if ((unsigned)probe >= PERF_PROBE_COUNT) return "?";
+    return PROBE_NAMES[probe];
+}
+
+size_t perfSummary(char *buf, size_t size) {
+    if (size == 0) return 0;
+    int len = snprintf(buf, size, "PERF");
+
+    for (int p = 0; p < PERF_PROBE_COUNT && len > 0 && (size_t)len < size; p++) {
+        PerfStats s;
+        perfStats((PerfProbe)p, s);
+        len += snprintf(buf + len, size - len, "|%s:%lu/%lu/%lu/%lu",
+                        PROBE_NAMES[p], (unsigned long)s.count, (unsigned long)s.minUs,
+                        (unsigned long)s.p99Us, (unsigned long)s.maxUs);
+    }
+
+    if (len < 0) {
+        buf[0] = '\0';
+        return 0;
+    }
+    return (size_t)len < size ? (size_t)len : size - 1;
+}
+
+void perfReset() {
+    PERF_LOCK();
+    memset(hists, 0, sizeof(hists));
+    PERF_UNLOCK();
+}
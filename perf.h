@@ -0,0 +1,89 @@
+#ifndef PERF_H
+#define PERF_H
+
+/*
+ * Orbital Temple Satellite - Latency Histograms
+ * Version: 1.21
+ *
+ * Fixed-bucket log2 histograms of how long the hot paths take. A
+ * PerfScope on the stack times its block (esp_timer, microseconds) and
+ * adds the duration to its probe's histogram when it goes out of scope:
+ *
+ *   void processMessage(...) {
+ *       PerfScope perf(PERF_PROCESS);
+ *       ...
+ *
+ * Bucket b counts durations in [2^b, 2^(b+1)) us (bucket 0 also holds
+ * 0 us); the last bucket is open-ended. Recording is a clz, three
+ * compares and a few adds under a spinlock - a few hundred ns - so the
+ * probes stay in flight builds. Percentiles are read off the buckets and
+ * reported as the bucket's upper bound (clamped to the exact max), i.e.
+ * within a factor of two and never optimistic.
+ *
+ * Everything is cumulative since boot (or the last perfReset()).
+ * Host-portable (test/test_perf.cpp builds it).
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#if defined(ARDUINO_ARCH_ESP32)
+#define PERF_HAVE_ESP_TIMER 1
+#else
+#define PERF_HAVE_ESP_TIMER 0
+#endif
+
+#define PERF_BUCKETS      24      // Last bucket: >= 2^23 us (8.4 s)
+#define PERF_SUMMARY_MAX  240     // perfSummary() output incl. terminator
+
+typedef enum {
+    PERF_LOOP = 0,      // One mainLoop() iteration (sleep excluded)
+    PERF_PROCESS,       // processMessage(): parse, verify, execute
+    PERF_HMAC,          // One HMAC-SHA256 tag
+    PERF_SEND,          // sendMessage(): format and queue (or reply sink)
+    PERF_SD_WRITE,      // One SD write call (log sectors, WriteFile, AppendFile)
+    PERF_SCRUB,         // scrubAllTMR()
+    PERF_PROBE_COUNT
+} PerfProbe;
+
+struct PerfStats {
+    uint32_t count;
+    uint32_t minUs;
+    uint32_t maxUs;
+    uint32_t meanUs;
+    uint32_t p50Us;
+    uint32_t p99Us;
+};
+
+// Microsecond clock the scopes use (wraps after 71 minutes; durations
+// are differences, so only a single span over 71 minutes would be wrong)
+uint32_t perfNowUs();
+
+// Add one duration to a probe (safe from any task, not from ISRs)
+void perfRecord(PerfProbe probe, uint32_t us);
+
+// Snapshot of one probe; false if it has no samples yet
+bool perfStats(PerfProbe probe, PerfStats &out);
+
+// Short probe name ("LOOP", "MSG", ...)
+const char* perfProbeName(PerfProbe probe);
+
+// "PERF|LOOP:n/min/p99/max|MSG:..." for every probe, microseconds
+// Returns the length written (output always terminated)
+size_t perfSummary(char *buf, size_t size);
+
+// Clear every histogram
+void perfReset();
+
+// Times the enclosing block into a probe
+struct PerfScope {
+    explicit PerfScope(PerfProbe probe) : probe(probe), start(perfNowUs()) {}
+    ~PerfScope() {
+        perfRecord(probe, perfNowUs() - start);
+    }
+
+    PerfProbe probe;
+    uint32_t start;
+};
+
+#endif // PERF_H
@@ -0,0 +1,81 @@
+/*
+ * Orbital Temple Satellite - Idle Sleep Implementation
+ * Version: 1.21
+ *
+ * DIO0 is attached to setFlag() as a rising-edge interrupt (RadioLib).
+ * gpio_wakeup_enable() reprograms the same pin's interrupt type to a
+ * level, which would retrigger the ISR for as long as DIO0 stays high,
+ * so the pin interrupt is masked for the duration of the sleep and the
+ * edge type restored afterwards. A DIO0 rise while masked is caught by
+ * reading the pin level after waking.
+ */
+
+#include <Arduino.h>
+#include "esp_sleep.h"
+#include "esp_timer.h"
+#include "driver/gpio.h"
+#include "config.h"
+#include "log.h"
+#include "power.h"
+#include "lora.h"
+
+static uint64_t sleptUs = 0;
+static uint32_t sleeps = 0;
+static uint32_t radioWakes = 0;
+
+void sleepInit() {
+    esp_sleep_enable_gpio_wakeup();
+    LOG_I("SLEEP", "Light sleep between deadlines %s (min %lu ms)",
+          SLEEP_ENABLED ? "enabled" : "disabled", SLEEP_MIN_MS);
+}
+
+void idleSleep(unsigned long idleMs) {
+    if (!SLEEP_ENABLED || idleMs < SLEEP_MIN_MS) return;
+    if (idleMs > SLEEP_MAX_MS) idleMs = SLEEP_MAX_MS;
+
+    const gpio_num_t dio0 = (gpio_num_t)DIO0_RF;
+
+    // The UART stops in light sleep - let the last log line out first
+    // (mainLoop() doesn't ask to sleep while log.cpp still has lines queued)
+    Serial.flush();
+
+    gpio_intr_disable(dio0);
+    gpio_wakeup_enable(dio0, GPIO_INTR_HIGH_LEVEL);
+    esp_sleep_enable_timer_wakeup((uint64_t)idleMs * 1000ULL);
+
+    int64_t start = esp_timer_get_time();
+    esp_light_sleep_start();
+    sleptUs += (uint64_t)(esp_timer_get_time() - start);
+    sleeps++;
+
+    gpio_wakeup_disable(dio0);
+    gpio_set_intr_type(dio0, GPIO_INTR_POSEDGE);
+    gpio_intr_enable(dio0);
+
+    if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_GPIO) {
+        radioWakes++;
+    }
+    // RxDone/TxDone stays high until the IRQ flags are cleared, so this
+    // also covers an edge that came while the interrupt was masked
+    if (gpio_get_level(dio0)) {
+        setFlag();
+    }
+}
+
+uint64_t sleepTimeUs() {
+    return sleptUs;
+}
+
+uint32_t sleepCount() {
+    return sleeps;
+}
+
+uint32_t sleepRadioWakes() {
+    return radioWakes;
+}
+
+uint16_t sleepPermille() {
+    uint64_t uptime = (uint64_t)esp_timer_get_time();
+    if (uptime == 0) return 0;
+    return (uint16_t)(sleptUs * 1000ULL / uptime);
+}
@@ -0,0 +1,41 @@
+#ifndef POWER_H
+#define POWER_H
+
+/*
+ * Orbital Temple Satellite - Idle Sleep Module
+ * Version: 1.21
+ *
+ * Between scheduler deadlines the main loop used to spin, running
+ * millions of empty mainLoop() iterations an hour. idleSleep() puts the
+ * ESP32 into light sleep instead (RAM, peripherals and the radio keep
+ * their state) until the next deadline or until the SX1276 raises DIO0
+ * (RxDone / TxDone), whichever comes first.
+ *
+ * mainLoopIdleTime() decides how long that is: 0 while anything outside
+ * the scheduler needs the CPU (bulk downlinks, antenna deployment, a
+ * pending packet, the SD log writer). The watchdog feed is a scheduler
+ * job, so a sleep never outlasts WDT_FEED_INTERVAL.
+ *
+ * Sleep vs. awake time is reported in the hourly soak log and telemetry.
+ */
+
+#include <stdint.h>
+
+#define SLEEP_ENABLED        1        // 0 = spin as before (bench debugging)
+#define SLEEP_MIN_MS         5UL      // Shorter gaps aren't worth the ~1 ms wake latency
+#define SLEEP_MAX_MS         10000UL  // Cap even if the scheduler had nothing armed
+
+// Arm the DIO0 wakeup source (call once after startRadio())
+void sleepInit();
+
+// Light-sleep for up to idleMs (returns at once below SLEEP_MIN_MS)
+// A DIO0 edge during sleep is handed to setFlag() after waking
+void idleSleep(unsigned long idleMs);
+
+// Statistics since boot
+uint64_t sleepTimeUs();
+uint32_t sleepCount();
+uint32_t sleepRadioWakes();      // Sleeps ended by DIO0
+uint16_t sleepPermille();        // Share of uptime spent asleep (0-1000)
+
+#endif // POWER_H
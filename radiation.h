@@ -11,111 +11,51 @@
  * TECHNIQUES USED:
  *
  * 1. TRIPLE MODULAR REDUNDANCY (TMR)
- *    - Critical variables stored 3 times
- *    - Voting logic: 2-out-of-3 majority wins
- *    - Single bit flip is detected and corrected
+ *    - Critical variables stored 3 times, in one region (tmr.h)
+ *    - Voting logic: bitwise 2-out-of-3 majority per 32-bit word
+ *    - Bit flips are corrected unless the same bit flips in two copies
  *
  * 2. CRC32 CHECKSUM
  *    - EEPROM data protected with CRC
  *    - Corruption detected on boot
+ *    - Engine (ROM / slicing-by-8 / table) lives in crc32.h
  *
  * 3. PERIODIC SCRUBBING
- *    - TMR variables checked every SCRUB_INTERVAL
- *    - Mismatches corrected automatically
+ *    - A few words per loop tick, a full pass at least every SCRUB_INTERVAL
+ *    - Mismatches corrected automatically, counted per word
  *
  * LIMITATIONS:
- *    - Cannot protect against multi-bit upsets (MBUs)
+ *    - Cannot correct a bit flipped in two copies of the same word
  *    - Cannot protect code in flash memory
  *    - ESP32 has no hardware ECC
  */
 
 #include <Arduino.h>
 #include <stdint.h>
+#include "tmr.h"
+#include "msgbuf.h"
 
 // ==================== CONFIGURATION ====================
 
 // How often to scrub TMR variables (milliseconds)
 #define SCRUB_INTERVAL  60000  // Every 60 seconds
 
-// ==================== TMR DATA STRUCTURE ====================
-
-// Triple Modular Redundancy container for any type
-template<typename T>
-struct TMR {
-    T copy1;
-    T copy2;
-    T copy3;
-};
-
-// ==================== TMR CRITICAL VARIABLES ====================
-// These are the most important variables that must survive bit flips
-
-extern TMR<uint8_t> tmr_missionState;      // Mission state machine
-extern TMR<uint8_t> tmr_antennaState;      // Antenna deployment state
-extern TMR<bool>    tmr_antennaDeployed;   // Antenna deployed flag
-extern TMR<bool>    tmr_groundContact;     // Ground contact established
-extern TMR<bool>    tmr_rfOK;              // Radio status
-extern TMR<bool>    tmr_imuOK;             // IMU status
-extern TMR<bool>    tmr_sdOK;              // SD card status
-extern TMR<uint32_t> tmr_bootCount;        // Boot counter
-
-// ==================== TMR FUNCTIONS ====================
-
-// Initialize TMR variable with a value (sets all 3 copies)
-template<typename T>
-void tmrWrite(TMR<T>& tmr, T value) {
-    tmr.copy1 = value;
-    tmr.copy2 = value;
-    tmr.copy3 = value;
-}
-
-// Read TMR variable with voting (returns majority value)
-template<typename T>
-T tmrRead(TMR<T>& tmr) {
-    // 2-out-of-3 voting
-    if (tmr.copy1 == tmr.copy2) return tmr.copy1;
-    if (tmr.copy1 == tmr.copy3) return tmr.copy1;
-    if (tmr.copy2 == tmr.copy3) return tmr.copy2;
-
-    // All three different - CATASTROPHIC FAILURE
-    // Memory is severely corrupted, restart is the only safe option
-    Serial.println("[RAD] CRITICAL: TMR all copies differ! Restarting...");
-    delay(100);  // Allow serial to flush
-    ESP.restart();
-
-    // Never reached, but needed for compiler
-    return tmr.copy1;
-}
-
-// Check and correct TMR variable (returns true if correction was made)
-template<typename T>
-bool tmrScrub(TMR<T>& tmr) {
-    T correct = tmrRead(tmr);
-    bool corrected = false;
-
-    if (tmr.copy1 != correct) {
-        tmr.copy1 = correct;
-        corrected = true;
-        Serial.println("[RAD] Corrected TMR copy1");
-    }
-    if (tmr.copy2 != correct) {
-        tmr.copy2 = correct;
-        corrected = true;
-        Serial.println("[RAD] Corrected TMR copy2");
-    }
-    if (tmr.copy3 != correct) {
-        tmr.copy3 = correct;
-        corrected = true;
-        Serial.println("[RAD] Corrected TMR copy3");
-    }
-
-    return corrected;
-}
+// Words voted per mainLoop() tick; the SCRUB_INTERVAL job finishes any
+// pass the ticks have not completed, so a full pass is never further apart
+#define SCRUB_WORDS_PER_TICK  16
+
+// ==================== TMR VARIABLES ====================
+// The protected variables live in the TMR region (tmr.h), registered where
+// they are defined: mission and antenna state, hardware flags, boot count
+// and beacon timing in config.cpp, the artwork index header in memor.cpp.
+// Write them with tmrWrite(); a plain assignment does not compile.
 
 // ==================== CRC32 FUNCTIONS ====================
 
 // Calculate CRC32 of a data block
-uint32_t calculateCRC32(const uint8_t* data, size_t length);
+// Pass the previous result to continue over data split into chunks
+// (zlib crc32() convention: calculateCRC32(b, nb, calculateCRC32(a, na)))
+uint32_t calculateCRC32(const uint8_t* data, size_t length, uint32_t previous = 0);
 
 // ==================== EEPROM WITH CRC ====================
 // Note: EEPROM addresses are centralized in config.h (see EEPROM_ADDR_CRC)
@@ -124,26 +64,38 @@ uint32_t calculateCRC32(const uint8_t* data, size_t length);
 void saveStateWithCRC();
 
 // Load state with CRC verification (returns false if corrupted)
+// Prefers the latest journal record, falls back to the EEPROM block
 bool loadStateWithCRC();
 
+// True when saves go to the journal partition rather than EEPROM
+bool stateJournalActive();
+
+// Erase the journal's next sector ahead of time (scheduler job)
+void stateJournalTick();
+
 // ==================== SCRUBBING ====================
 
 // Scrub all TMR variables, correct any bit flips
 // Returns number of corrections made
 int scrubAllTMR();
 
+// Scrub the next SCRUB_WORDS_PER_TICK words (every mainLoop() tick)
+int scrubTMRTick();
+
+// Finish the current pass unless one completed since the last call
+// Run every SCRUB_INTERVAL by a mainLoop() scheduler job
+int scrubTMRPass();
+
 // Initialize radiation protection
 void initRadiationProtection();
 
-// Periodic radiation protection check (call from main loop)
-void radiationProtectionTick();
 
-// Get radiation protection status
-String getRadiationStatus();
+// Append the radiation protection status ("SEU:n")
+void getRadiationStatus(MsgBuilder& status);
 
 // ==================== STATISTICS ====================
 
 extern uint32_t seuCorrectionsTotal;   // Total SEU corrections since boot
-extern uint32_t lastScrubTime;         // Last scrub timestamp
+extern uint32_t lastScrubTime;         // Last completed pass timestamp
 
 #endif // RADIATION_H
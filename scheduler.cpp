@@ -0,0 +1,200 @@
+/*
+ * Orbital Temple Satellite - Deadline Scheduler Implementation
+ * Version: 1.21
+ *
+ * heap[] holds armed job ids, earliest deadline at heap[0]; heapPos[]
+ * maps a job back to its slot so re-arming and cancelling are O(log n)
+ * without a search.
+ */
+
+#include "scheduler.h"
+
+struct SchedEntry {
+    const char* name;
+    SchedCallback callback;
+    unsigned long period;
+    unsigned long deadline;
+    uint32_t runs;
+    unsigned long maxLate;
+};
+
+static SchedEntry jobs[SCHED_MAX_JOBS];
+static uint8_t jobCount = 0;
+static uint8_t rejected = 0;
+
+static SchedJob heap[SCHED_MAX_JOBS];
+static int8_t heapPos[SCHED_MAX_JOBS];     // -1 = not armed
+static uint8_t heapSize = 0;
+
+// Wrap-safe "a is before b"
+static inline bool schedBefore(unsigned long a, unsigned long b) {
+    return (long)(a - b) < 0;
+}
+
+static inline bool validJob(SchedJob job) {
+    return job >= 0 && job < (SchedJob)jobCount;
+}
+
+// ==================== HEAP ====================
+
+static void heapSet(uint8_t i, SchedJob job) {
+    heap[i] = job;
+    heapPos[job] = (int8_t)i;
+}
+
+static void heapUp(uint8_t i) {
+    SchedJob job = heap[i];
+    while (i > 0) {
+        uint8_t parent = (i - 1) / 2;
+        if (!schedBefore(jobs[job].deadline, jobs[heap[parent]].deadline)) break;
+        heapSet(i, heap[parent]);
+        i = parent;
+    }
+    heapSet(i, job);
+}
+
+static void heapDown(uint8_t i) {
+    SchedJob job = heap[i];
+    for (;;) {
+        uint8_t child = 2 * i + 1;
+        if (child >= heapSize) break;
+        if (child + 1 < heapSize &&
+            schedBefore(jobs[heap[child + 1]].deadline, jobs[heap[child]].deadline)) {
+            child++;
+        }
+        if (!schedBefore(jobs[heap[child]].deadline, jobs[job].deadline)) break;
+        heapSet(i, heap[child]);
+        i = child;
+    }
+    heapSet(i, job);
+}
+
+static void heapRemove(SchedJob job) {
+    int8_t i = heapPos[job];
+    if (i < 0) return;
+    heapPos[job] = -1;
+    heapSize--;
+    if ((uint8_t)i == heapSize) return;
+
+    // Move the last entry into the hole and restore order either way
+    SchedJob moved = heap[heapSize];
+    heapSet(i, moved);
+    heapUp(i);
+    heapDown(heapPos[moved]);
+}
+
+static void heapArm(SchedJob job, unsigned long deadline) {
+    jobs[job].deadline = deadline;
+    int8_t i = heapPos[job];
+    if (i < 0) {
+        i = (int8_t)heapSize++;
+        heapSet(i, job);
+        heapUp(i);
+    } else {
+        heapUp(i);
+        heapDown(heapPos[job]);
+    }
+}
+
+// ==================== API ====================
+
+SchedJob schedRegister(const char* name, SchedCallback callback, unsigned long period) {
+    if (callback == NULL) {
+        return SCHED_NONE;
+    }
+    if (jobCount >= SCHED_MAX_JOBS) {
+        rejected++;
+        return SCHED_NONE;
+    }
+    SchedJob job = (SchedJob)jobCount++;
+    jobs[job].name = name;
+    jobs[job].callback = callback;
+    jobs[job].period = period;
+    jobs[job].deadline = 0;
+    jobs[job].runs = 0;
+    jobs[job].maxLate = 0;
+    heapPos[job] = -1;
+    return job;
+}
+
+SchedJob schedEvery(const char* name, SchedCallback callback, unsigned long period, unsigned long now) {
+    SchedJob job = schedRegister(name, callback, period);
+    if (job != SCHED_NONE) {
+        schedAfter(job, period, now);
+    }
+    return job;
+}
+
+void schedAfter(SchedJob job, unsigned long delay, unsigned long now) {
+    if (!validJob(job)) return;
+    heapArm(job, now + delay);
+}
+
+void schedCancel(SchedJob job) {
+    if (!validJob(job)) return;
+    heapRemove(job);
+}
+
+bool schedArmed(SchedJob job) {
+    return validJob(job) && heapPos[job] >= 0;
+}
+
+void schedSetPeriod(SchedJob job, unsigned long period) {
+    if (!validJob(job)) return;
+    jobs[job].period = period;
+}
+
+unsigned long schedNextDelay(unsigned long now) {
+    if (heapSize == 0) return SCHED_IDLE_MAX;
+    unsigned long deadline = jobs[heap[0]].deadline;
+    return schedBefore(now, deadline) ? deadline - now : 0;
+}
+
+unsigned long schedRun(unsigned long now) {
+    // Bounded so a job re-arming itself with no delay can't hold the loop
+    for (uint8_t n = 0; n < SCHED_MAX_JOBS && heapSize > 0; n++) {
+        SchedJob job = heap[0];
+        SchedEntry& e = jobs[job];
+        if (schedBefore(now, e.deadline)) break;
+
+        unsigned long late = now - e.deadline;
+        if (late > e.maxLate) e.maxLate = late;
+
+        if (e.period > 0) {
+            unsigned long next = e.deadline + e.period;
+            heapArm(job, schedBefore(now, next) ? next : now + e.period);
+        } else {
+            heapRemove(job);
+        }
+
+        e.runs++;
+        e.callback(now);
+    }
+    return schedNextDelay(now);
+}
+
+uint8_t schedJobCount() {
+    return jobCount;
+}
+
+uint8_t schedRejected() {
+    return rejected;
+}
+
+const char* schedJobName(SchedJob job) {
+    return validJob(job) ? jobs[job].name : "";
+}
+
+uint32_t schedJobRuns(SchedJob job) {
+    return validJob(job) ? jobs[job].runs : 0;
+}
+
+unsigned long schedJobMaxLate(SchedJob job) {
+    return validJob(job) ? jobs[job].maxLate : 0;
+}
+
+void schedReset() {
+    jobCount = 0;
+    rejected = 0;
+    heapSize = 0;
+}
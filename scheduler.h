@@ -0,0 +1,67 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+/*
+ * Orbital Temple Satellite - Deadline Scheduler
+ * Version: 1.21
+ *
+ * Periodic and one-shot jobs kept in a binary min-heap ordered by
+ * deadline. mainLoop() calls schedRun() every iteration; only due jobs
+ * run, and the return value says how long nothing else is due (the
+ * budget for sleeping between events).
+ *
+ * Jobs are registered once (fixed table, no allocation) and armed or
+ * cancelled as needed. A periodic job is re-armed before its callback
+ * runs, keeping a fixed phase (deadline + period); if it fell a whole
+ * period behind it restarts from now instead of running a burst of
+ * catch-ups. A callback may re-arm or cancel its own job.
+ *
+ * Times are millis() values, compared wrap-safe, so deadlines must lie
+ * within 24 days of each other. Host-portable: the caller passes "now"
+ * (test/test_scheduler.cpp builds it).
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define SCHED_MAX_JOBS   24             // 16 registered in V1.21
+#define SCHED_NONE       -1
+#define SCHED_IDLE_MAX   0x7FFFFFFFUL   // schedRun() result with nothing armed
+
+typedef int8_t SchedJob;
+typedef void (*SchedCallback)(unsigned long now);
+
+// Register a job, initially not armed (period 0 = one-shot)
+// Returns SCHED_NONE if the table is full
+SchedJob schedRegister(const char* name, SchedCallback callback, unsigned long period);
+
+// Register and arm a periodic job, first run one period from now
+SchedJob schedEvery(const char* name, SchedCallback callback, unsigned long period, unsigned long now);
+
+// Arm to run at now + delay (moves the deadline if already armed)
+void schedAfter(SchedJob job, unsigned long delay, unsigned long now);
+
+// Disarm (the job stays registered)
+void schedCancel(SchedJob job);
+
+bool schedArmed(SchedJob job);
+void schedSetPeriod(SchedJob job, unsigned long period);
+
+// Run every job whose deadline has passed, earliest first
+// Returns ms until the next deadline (0 = something is already due again)
+unsigned long schedRun(unsigned long now);
+
+// ms until the next deadline without running anything
+unsigned long schedNextDelay(unsigned long now);
+
+// Statistics
+uint8_t schedJobCount();
+uint8_t schedRejected();            // Registrations refused because the table was full
+const char* schedJobName(SchedJob job);
+uint32_t schedJobRuns(SchedJob job);
+unsigned long schedJobMaxLate(SchedJob job);   // Worst deadline miss (ms)
+
+// Drop all jobs (host tests)
+void schedReset();
+
+#endif // SCHEDULER_H
@@ -17,22 +17,37 @@
  * 2. Added proper SD card status tracking with SDOK flag
  *
  * 3. Added division-by-zero protection in temperature reading
+ *
+ * 4. BACKGROUND ANALOG SAMPLING:
+ *    readBatteryVoltage(), readLumi() and readTemp() each waited 10 ms and
+ *    took one analogRead(), and beacons/telemetry called them inline. A
+ *    scheduler job now oversamples all three channels into a moving
+ *    average and converts through calib.h (constexpr thermistor table, no
+ *    log() at run time). The ESP32's DMA ADC mode only covers ADC1, and
+ *    the lux sensor is on an ADC2 pin (GPIO 26), so sampling is
+ *    timer-driven; a burst of a few ms per second also leaves the idle light
+ *    sleep undisturbed.
  */
 
 #include <Arduino.h>
 #include <stdint.h>
 #include "config.h"
+#include "log.h"
+#include "sensors.h"
+#include "memor.h"
+#include "calib.h"
+#include "scheduler.h"
 
 // ==================== IMU INITIALIZATION ====================
 void BeginIMU() {
     Wire.begin();
 
     if (!imu.begin()) {
-        Serial.println("[IMU] FAILED to initialize LSM9DS1!");
-        IMUOK = false;
+        LOG_E("IMU", "FAILED to initialize LSM9DS1!");
+        tmrWrite(IMUOK, false);
     } else {
-        Serial.println("[IMU] LSM9DS1 initialized successfully");
-        IMUOK = true;
+        LOG_I("IMU", "LSM9DS1 initialized successfully");
+        tmrWrite(IMUOK, true);
     }
 }
 
@@ -43,170 +58,183 @@ void SDBegin() {
 
     // Attempt to mount SD card
     if (!SD.begin(SD_CS)) {
-        Serial.println("[SD] Card Mount FAILED!");
-        SDOK = false;
+        LOG_E("SD", "Card Mount FAILED!");
+        tmrWrite(SDOK, false);
         return;
     }
 
     // Check card type
     uint8_t cardType = SD.cardType();
     if (cardType == CARD_NONE) {
-        Serial.println("[SD] No SD card attached!");
-        SDOK = false;
+        LOG_E("SD", "No SD card attached!");
+        tmrWrite(SDOK, false);
         return;
     }
 
     // Success
-    SDOK = true;
+    tmrWrite(SDOK, true);
 
     // Print card info
-    Serial.print("[SD] Card Type: ");
+    const char *cardName;
     switch (cardType) {
-        case CARD_MMC:  Serial.println("MMC");  break;
-        case CARD_SD:   Serial.println("SDSC"); break;
-        case CARD_SDHC: Serial.println("SDHC"); break;
-        default:        Serial.println("UNKNOWN"); break;
+        case CARD_MMC:  cardName = "MMC";  break;
+        case CARD_SD:   cardName = "SDSC"; break;
+        case CARD_SDHC: cardName = "SDHC"; break;
+        default:        cardName = "UNKNOWN"; break;
     }
+    LOG_I("SD", "Card Type: %s", cardName);
 
     uint64_t cardSize = SD.cardSize() / (1024 * 1024);
-    Serial.printf("[SD] Card Size: %lluMB\n", cardSize);
-    Serial.printf("[SD] Total space: %lluMB\n", SD.totalBytes() / (1024 * 1024));
-    Serial.printf("[SD] Used space: %lluMB\n", SD.usedBytes() / (1024 * 1024));
+    LOG_I("SD", "Card Size: %lluMB", cardSize);
+
+    // The only FAT scan on the main loop; writes are tracked from here on
+    sdSpaceInit();
 }
 
-// ==================== BATTERY VOLTAGE ====================
-void readBatteryVoltage() {
-    // Small delay for ADC stability
-    delay(10);
+// ==================== ANALOG SAMPLER ====================
+// Channels are read interleaved so one burst is a single moment for all
+// three. A burst of SENSOR_OVERSAMPLE 12-bit reads sums to at most
+// 64 * 4095, and the ring total to 8 times that - well within 32 bits.
 
-    // Read raw ADC value
-    VM1 = analogRead(VBAT_DR);
+static const uint8_t sensorPins[SENSOR_COUNT] = { VBAT_DR, ThermistorPin, TL };
 
-    // Convert to voltage
-    // ADC is 12-bit (0-4095), reference is 3.3V
-    // Voltage divider factor is 2 (assuming equal resistors)
-    // Calibration factor 3.8/3.3 accounts for actual reference
-    VE = (VM1 * 3.3f) / 4095.0f;
+static uint32_t sensorRing[SENSOR_COUNT][SENSOR_RING_SIZE];
+static uint32_t sensorRingTotal[SENSOR_COUNT];
+static uint8_t sensorRingPos = 0;
 
-    // Total battery voltage (accounting for voltage divider)
-    VT = VE * 2.0f;
+struct SensorAccumulator {
+    float min;
+    float max;
+    float sum;
+    uint16_t count;
+};
 
-    // Sanity check
-    if (VT < 0.0f || VT > 10.0f) {
-        Serial.println("[BAT] WARNING: Voltage reading out of range!");
-        VT = -1.0f;  // Error indicator
+static SensorAccumulator sensorWindows[SENSOR_WIN_COUNT][SENSOR_COUNT];
+static bool thermFault = false;
+
+static void sensorBurst(uint32_t sums[SENSOR_COUNT]) {
+    for (int c = 0; c < SENSOR_COUNT; c++) {
+        sums[c] = 0;
+    }
+    for (int i = 0; i < SENSOR_OVERSAMPLE; i++) {
+        for (int c = 0; c < SENSOR_COUNT; c++) {
+            sums[c] += analogRead(sensorPins[c]);
+        }
     }
 }
 
-// ==================== LUMINOSITY SENSOR ====================
-void readLumi() {
-    // Small delay for ADC stability
-    delay(10);
-
-    // Read raw value (using standard 12-bit resolution)
-    // NOTE: ADC resolution is set once in setup, never changed mid-execution
-    // to prevent race conditions with interrupts
-    int rawValue = analogRead(TL);
-
-    // CRITICAL FIX: Assign to GLOBAL variables, not local ones!
-    // In V1.2 these were declared as "float VM = ..." which created
-    // LOCAL variables that shadowed the globals. The globals never
-    // got updated and StatusMsg() always showed zeros.
-
-    // Voltage from sensor (assuming 5V reference through level shifter)
-    // Using 12-bit ADC (4096 levels)
-    VM = rawValue * 5.0f / 4096.0f;
+static float sensorConvert(int channel, float adc) {
+    switch (channel) {
+        case SENSOR_BATTERY: return calibBatteryVolts(adc);
+        case SENSOR_TEMP:    return calibThermistorC(adc);
+        default:             return calibLux(adc);
+    }
+}
 
-    // Percentage of full scale
-    VP = rawValue / 4096.0f * 100.0f;
+// Refresh the globals from the ring mean
+static void sensorUpdateCache() {
+    const float perRead = 1.0f / (SENSOR_RING_SIZE * SENSOR_OVERSAMPLE);
 
-    // Current through sensor (10k load resistor)
-    amps = VM / 10000.0f;
+    float bat = sensorRingTotal[SENSOR_BATTERY] * perRead;
+    VM1 = (int)(bat + 0.5f);
+    VE = bat * (float)(ADC_VREF / ADC_MAX_COUNT);
+    VT = calibBatteryVolts(bat);
 
-    // Convert to microamps
+    float light = sensorRingTotal[SENSOR_LUX] * perRead;
+    VM = light * LUX_VOLTS_PER_COUNT;
+    VP = light / 4096.0f * 100.0f;
+    amps = VM / (float)LUX_LOAD_OHMS;
     microamps = amps * 1000000.0f;
-
-    // Convert to lux (sensor-specific calibration factor)
-    lux = microamps * 2.0f;
-
-    // Debug output
-    Serial.printf("[LUX] Raw: %d, Voltage: %.3fV, Lux: %.1f\n", rawValue, VM, lux);
+    lux = calibLux(light);
+
+    float therm = sensorRingTotal[SENSOR_TEMP] * perRead;
+    Tc = calibThermistorC(therm);
+
+    // Report a thermistor fault once, not every burst
+    bool fault = (Tc == THERM_ERROR);
+    if (fault != thermFault) {
+        if (fault) {
+            LOG_W("TEMP", "WARNING: Sensor error, ADC %.0f outside %.0f-%.0f!",
+                  therm, THERM_ADC_MIN, THERM_ADC_MAX);
+        } else {
+            LOG_I("TEMP", "Sensor reading valid again: %.1f C", Tc);
+        }
+        thermFault = fault;
+    }
 }
 
-// ==================== TEMPERATURE SENSOR ====================
-void readTemp() {
-    // Small delay for ADC stability
-    delay(10);
+static void sensorWindowAdd(const uint32_t sums[SENSOR_COUNT]) {
+    for (int c = 0; c < SENSOR_COUNT; c++) {
+        float value = sensorConvert(c, (float)sums[c] / SENSOR_OVERSAMPLE);
+        if (c == SENSOR_TEMP && value == THERM_ERROR) continue;
+
+        for (int w = 0; w < SENSOR_WIN_COUNT; w++) {
+            SensorAccumulator &acc = sensorWindows[w][c];
+            if (acc.count == 0 || value < acc.min) acc.min = value;
+            if (acc.count == 0 || value > acc.max) acc.max = value;
+            acc.sum += value;
+            if (acc.count < UINT16_MAX) acc.count++;
+        }
+    }
+}
 
-    // Read raw ADC value
-    float adc = analogRead(ThermistorPin);
+static void sensorJobTick(unsigned long now) {
+    (void)now;
+    uint32_t sums[SENSOR_COUNT];
+    sensorBurst(sums);
 
-    // Sanity check on ADC reading
-    if (adc >= 4000.0f) {
-        // Sensor likely disconnected or shorted to VCC
-        Serial.println("[TEMP] WARNING: ADC reading too high, sensor error!");
-        Tc = -999.0;  // Error indicator
-        return;
+    for (int c = 0; c < SENSOR_COUNT; c++) {
+        sensorRingTotal[c] += sums[c] - sensorRing[c][sensorRingPos];
+        sensorRing[c][sensorRingPos] = sums[c];
     }
+    sensorRingPos = (sensorRingPos + 1) % SENSOR_RING_SIZE;
 
-    if (adc <= 50.0f) {
-        // Sensor likely shorted to GND
-        Serial.println("[TEMP] WARNING: ADC reading too low, sensor error!");
-        Tc = -999.0;  // Error indicator
-        return;
-    }
+    sensorUpdateCache();
+    sensorWindowAdd(sums);
+}
 
-    // Calculate voltage
-    double Vout = adc * Vs / adcMax;
+void sensorsStart() {
+    uint32_t sums[SENSOR_COUNT];
+    sensorBurst(sums);
 
-    // CRITICAL FIX: Division by zero protection
-    // If Vout equals Vs, the denominator becomes zero
-    double denominator = Vs - Vout;
-    if (fabs(denominator) < 0.01) {
-        Serial.println("[TEMP] WARNING: Division by zero prevented!");
-        Tc = -999.0;  // Error indicator
-        return;
+    // Prime the whole ring so the moving average is valid at once
+    for (int c = 0; c < SENSOR_COUNT; c++) {
+        for (int i = 0; i < SENSOR_RING_SIZE; i++) {
+            sensorRing[c][i] = sums[c];
+        }
+        sensorRingTotal[c] = sums[c] * SENSOR_RING_SIZE;
     }
 
-    // Calculate thermistor resistance
-    double Rt = R1z * Vout / denominator;
+    sensorUpdateCache();
+    sensorWindowAdd(sums);
 
-    // Additional sanity check on resistance
-    if (Rt <= 0.0 || Rt > 1000000.0) {
-        Serial.println("[TEMP] WARNING: Calculated resistance out of range!");
-        Tc = -999.0;  // Error indicator
-        return;
-    }
-
-    // Steinhart-Hart equation (simplified B-parameter equation)
-    // T = 1 / (1/To + (1/Beta) * ln(Rt/Ro))
-    double lnRatio = log(Rt / Ro);
-    double T = 1.0 / (1.0 / To + lnRatio / Beta);
+    schedEvery("sensors", sensorJobTick, SENSOR_SAMPLE_INTERVAL, millis());
+    LOG_I("SENS", "Sampling every %lu ms, %d reads per channel",
+          SENSOR_SAMPLE_INTERVAL, SENSOR_OVERSAMPLE);
+}
 
-    // Convert Kelvin to Celsius
-    // CRITICAL FIX: Assign to GLOBAL Tc, not a local variable!
-    // In V1.2, "double Tc" was declared locally, shadowing the global.
-    Tc = T - 273.15;
+bool sensorWindowTake(SensorWindow window, SensorChannel channel, SensorStats &stats) {
+    SensorAccumulator &acc = sensorWindows[window][channel];
+    stats.count = acc.count;
 
-    // Sanity check on final temperature
-    if (Tc < -50.0 || Tc > 150.0) {
-        Serial.printf("[TEMP] WARNING: Temperature %.1f C seems unreasonable!\n", Tc);
-        // Don't reset to error value, but log the warning
+    if (acc.count == 0) {
+        float cached = channel == SENSOR_BATTERY ? VT : channel == SENSOR_TEMP ? (float)Tc : lux;
+        stats.min = stats.mean = stats.max = cached;
+        return false;
     }
 
-    Serial.printf("[TEMP] ADC: %.0f, Rt: %.0f ohms, Temp: %.1f C\n", adc, Rt, Tc);
+    stats.min = acc.min;
+    stats.max = acc.max;
+    stats.mean = acc.sum / acc.count;
+
+    acc.count = 0;
+    acc.sum = 0.0f;
+    return true;
 }
 
 // ==================== SENSOR STATUS ====================
-String getSensorStatus() {
-    String status = "";
-
-    status += "IMU:";
-    status += IMUOK ? "OK" : "FAIL";
-    status += ",SD:";
-    status += SDOK ? "OK" : "FAIL";
-    status += ",RF:";
-    status += RFOK ? "OK" : "FAIL";
-
-    return status;
+void getSensorStatus(MsgBuilder& status) {
+    status.add("IMU:").add(IMUOK ? "OK" : "FAIL");
+    status.add(",SD:").add(SDOK ? "OK" : "FAIL");
+    status.add(",RF:").add(RFOK ? "OK" : "FAIL");
 }
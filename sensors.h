@@ -10,8 +10,15 @@
  * - Added proper SD card status tracking (SDOK flag)
  * - Added division-by-zero protection in temperature reading
  * - Added sensor health status reporting
+ * - Battery, thermistor and lux sampled in the background (oversampled,
+ *   averaged, converted through calib.h) instead of read inline
+ * - IMU read by a service (imu.h) in burst I2C transactions; telemetry
+ *   uses its cached sample instead of reading the sensor inline
  */
 
+#include <stdint.h>
+#include "msgbuf.h"
+
 // Initialize IMU sensor
 // Sets IMUOK = false if initialization fails (no longer hangs)
 void BeginIMU();
@@ -20,20 +27,49 @@ void BeginIMU();
 // Sets SDOK = true on success, false on failure
 void SDBegin();
 
-// Read battery voltage
-// Updates global: VT (total voltage)
-void readBatteryVoltage();
+// ==================== ANALOG SAMPLER ====================
+// A scheduler job reads every analog channel SENSOR_OVERSAMPLE times in a
+// burst each SENSOR_SAMPLE_INTERVAL. Burst sums go into a ring; the cached
+// globals are the mean over the ring, converted through calib.h:
+//   VT (battery V), Tc (C, THERM_ERROR on a thermistor fault), lux
+//   (plus the intermediates VM1, VE, VM, VP, amps, microamps)
+// Readers use the globals directly - nothing blocks on the ADC.
+// Every burst also feeds a min/mean/max window per consumer, restarted
+// when that consumer takes it.
+#define SENSOR_SAMPLE_INTERVAL  1000UL   // ms between bursts
+#define SENSOR_OVERSAMPLE       64       // Reads per channel per burst
+#define SENSOR_RING_SIZE        8        // Bursts in the moving average
+
+typedef enum {
+    SENSOR_BATTERY,     // V
+    SENSOR_TEMP,        // C (faulty bursts are left out)
+    SENSOR_LUX,         // lx
+    SENSOR_COUNT
+} SensorChannel;
+
+typedef enum {
+    SENSOR_WIN_TELEMETRY,
+    SENSOR_WIN_BEACON,
+    SENSOR_WIN_COUNT
+} SensorWindow;
+
+struct SensorStats {
+    float min;
+    float mean;
+    float max;
+    uint16_t count;     // Bursts in the window
+};
 
-// Read luminosity sensor
-// Updates globals: VM, VP, amps, microamps, lux
-void readLumi();
+// Fill the ring with a first burst (cached values valid on return) and
+// register the sampling job. Call once after analogReadResolution().
+void sensorsStart();
 
-// Read temperature from thermistor
-// Updates global: Tc (temperature in Celsius)
-// Returns -999.0 on sensor error
-void readTemp();
+// Statistics of the bursts since this window was last taken, then
+// restart it. With no bursts yet, returns false and min = mean = max =
+// the cached value.
+bool sensorWindowTake(SensorWindow window, SensorChannel channel, SensorStats &stats);
 
-// Get sensor health status string
-String getSensorStatus();
+// Append the sensor health status ("IMU:OK,SD:OK,RF:OK")
+void getSensorStatus(MsgBuilder& status);
 
 #endif // SENSORS_H
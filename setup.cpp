@@ -25,6 +25,7 @@
 #include <stdint.h>
 #include <esp_idf_version.h>
 #include "config.h"
+#include "log.h"
 #include "setup.h"
 #include "lora.h"
 #include "id.h"
@@ -32,6 +33,10 @@
 #include "radiation.h"
 #include "accel.h"
 #include "memor.h"
+#include "power.h"
+#include "imu.h"
+#include "upload.h"
+#include "names.h"
 
 void setupGeneral() {
     // Initialize serial first for debugging
@@ -40,16 +45,19 @@ void setupGeneral() {
     // Wait a moment for serial to stabilize (but don't block on it!)
     delay(1000);
 
-    Serial.println();
-    Serial.println("=============================================");
-    Serial.println("  ORBITAL TEMPLE SATELLITE");
-    Serial.println("  Firmware Version: 1.21");
-    Serial.println("  A memorial in outer space");
-    Serial.println("=============================================");
-    Serial.println();
+    // From here on log lines are queued, never waited for
+    logUartStart();
+
+    LOG_TEXT_I("");
+    LOG_TEXT_I("=============================================");
+    LOG_TEXT_I("  ORBITAL TEMPLE SATELLITE");
+    LOG_TEXT_I("  Firmware Version: 1.21");
+    LOG_TEXT_I("  A memorial in outer space");
+    LOG_TEXT_I("=============================================");
+    LOG_TEXT_I("");
 
     // ==================== WATCHDOG INITIALIZATION ====================
-    Serial.println("[SETUP] Initializing watchdog timer...");
+    LOG_I("SETUP", "Initializing watchdog timer...");
     #if ESP_IDF_VERSION_MAJOR >= 5
         // ESP-IDF 5.x uses new struct-based API
         esp_task_wdt_config_t wdt_config = {
@@ -63,13 +71,13 @@ void setupGeneral() {
         esp_task_wdt_init(WDT_TIMEOUT_SECONDS, WDT_PANIC_ON_TIMEOUT);
     #endif
     esp_task_wdt_add(NULL);  // Add current task to watchdog
-    Serial.printf("[SETUP] Watchdog configured: %d second timeout\n", WDT_TIMEOUT_SECONDS);
+    LOG_I("SETUP", "Watchdog configured: %d second timeout", WDT_TIMEOUT_SECONDS);
 
     // Feed watchdog
     feedWatchdog();
 
     // ==================== EEPROM INITIALIZATION ====================
-    Serial.println("[SETUP] Initializing EEPROM...");
+    LOG_I("SETUP", "Initializing EEPROM...");
     EEPROM.begin(EEPROM_SIZE);
 
     // Initialize radiation protection and load previous state with CRC verification
@@ -79,12 +87,15 @@ void setupGeneral() {
     // Feed watchdog
     feedWatchdog();
 
+    // Pre-key the HMAC so the first uplink doesn't pay for it
+    initHMAC();
+
     // ==================== SATELLITE ID ====================
-    Serial.println("[SETUP] Loading satellite ID...");
+    LOG_I("SETUP", "Loading satellite ID...");
     getId();
 
     // ==================== PIN CONFIGURATION ====================
-    Serial.println("[SETUP] Configuring pins...");
+    LOG_I("SETUP", "Configuring pins...");
 
     // Antenna deployment
     pinMode(AntSwitch, INPUT);
@@ -100,56 +111,65 @@ void setupGeneral() {
     // IMPORTANT: Never change this during operation to prevent race conditions
     analogReadResolution(12);
 
-    Serial.println("[SETUP] Pins configured");
+    LOG_I("SETUP", "Pins configured");
 
     // Feed watchdog
     feedWatchdog();
 
     // ==================== POWER SAVING ====================
-    Serial.println("[SETUP] Disabling WiFi and Bluetooth for power saving...");
+    LOG_I("SETUP", "Disabling WiFi and Bluetooth for power saving...");
     WiFi.mode(WIFI_OFF);
     btStop();
 
     // ==================== IMU INITIALIZATION ====================
-    Serial.println("[SETUP] Initializing IMU...");
+    LOG_I("SETUP", "Initializing IMU...");
     BeginIMU();
     // Note: BeginIMU() sets IMUOK flag, doesn't hang on failure
+    imuServiceStart();  // Polls the IMU from now on (retries if it failed)
 
     // Feed watchdog
     feedWatchdog();
 
     // ==================== SD CARD INITIALIZATION ====================
-    Serial.println("[SETUP] Initializing SD card...");
+    LOG_I("SETUP", "Initializing SD card...");
     SDBegin();
     // Note: SDBegin() sets SDOK flag, doesn't hang on failure
+    startLogWriter();  // No-op without a card; logToSD() then stays inline
+    artworkIndexInit();
+    uploadInit();       // Reopens an upload interrupted by a reset
+    namesInit();        // Name ledger and its Bloom filter
 
     // Feed watchdog
     feedWatchdog();
 
     // ==================== ACCELEROMETER RECORDING INITIALIZATION ====================
-    Serial.println("[SETUP] Initializing accelerometer recording system...");
+    LOG_I("SETUP", "Initializing accelerometer recording system...");
     initAccelRecording();
 
     // ==================== INITIAL SENSOR READING ====================
-    Serial.println("[SETUP] Reading initial sensor values...");
-    readBatteryVoltage();
+    LOG_I("SETUP", "Starting analog sampler...");
+    sensorsStart();
 
-    Serial.print("[SETUP] Battery voltage: ");
-    Serial.print(VT);
-    Serial.println("V");
+    LOG_I("SETUP", "Battery voltage: %.2fV", VT);
 
     // Feed watchdog
     feedWatchdog();
 
     // ==================== RADIO INITIALIZATION ====================
-    Serial.println("[SETUP] Initializing LoRa radio...");
+    LOG_I("SETUP", "Initializing LoRa radio...");
     if (startRadio()) {
-        Serial.println("[SETUP] Radio initialized successfully");
+        LOG_I("SETUP", "Radio initialized successfully");
     } else {
-        Serial.println("[SETUP] WARNING: Radio initialization failed!");
-        Serial.println("[SETUP] Will retry in main loop");
+        LOG_E("SETUP", "WARNING: Radio initialization failed!");
+        LOG_I("SETUP", "Will retry in main loop");
     }
 
+    // Uplinks are read out of the radio as soon as they arrive
+    startRxTask();
+
+    // DIO0 wakes the CPU from idle light sleep
+    sleepInit();
+
     // ==================== FINAL SETUP ====================
 
     // Small delay for stability
@@ -159,24 +179,18 @@ void setupGeneral() {
     feedWatchdog();
 
     // Print status summary
-    Serial.println();
-    Serial.println("=============================================");
-    Serial.println("  SETUP COMPLETE - STATUS SUMMARY");
-    Serial.println("=============================================");
-    Serial.print("  IMU:      ");
-    Serial.println(IMUOK ? "OK" : "FAILED");
-    Serial.print("  SD Card:  ");
-    Serial.println(SDOK ? "OK" : "FAILED");
-    Serial.print("  Radio:    ");
-    Serial.println(RFOK ? "OK" : "FAILED");
-    Serial.print("  Antenna:  ");
-    Serial.println(antennaDeployed ? "DEPLOYED" : "PENDING");
-    Serial.print("  Boot #:   ");
-    Serial.println(bootCount);
-    Serial.print("  State:    ");
-    Serial.println((int)currentState);
-    Serial.println("=============================================");
-    Serial.println();
+    LOG_TEXT_I("");
+    LOG_TEXT_I("=============================================");
+    LOG_TEXT_I("  SETUP COMPLETE - STATUS SUMMARY");
+    LOG_TEXT_I("=============================================");
+    LOG_TEXT_I("  IMU:      %s", IMUOK ? "OK" : "FAILED");
+    LOG_TEXT_I("  SD Card:  %s", SDOK ? "OK" : "FAILED");
+    LOG_TEXT_I("  Radio:    %s", RFOK ? "OK" : "FAILED");
+    LOG_TEXT_I("  Antenna:  %s", antennaDeployed ? "DEPLOYED" : "PENDING");
+    LOG_TEXT_I("  Boot #:   %lu", (unsigned long)bootCount);
+    LOG_TEXT_I("  State:    %d", (int)currentState);
+    LOG_TEXT_I("=============================================");
+    LOG_TEXT_I("");
 
     // Log startup to SD card
     if (SDOK) {
@@ -191,6 +205,6 @@ void setupGeneral() {
         logToSD(logMsg);
     }
 
-    Serial.println("[SETUP] Entering main loop...");
-    Serial.println();
+    LOG_I("SETUP", "Entering main loop...");
+    LOG_TEXT_I("");
 }
@@ -0,0 +1,298 @@
+/*
+ * Orbital Temple Satellite - Accelerometer Spectrum Kernel Implementation
+ * Version: 1.21
+ *
+ * Each vibration segment is detrended (segment mean removed) before the
+ * window so the static 1 g and slow tumble don't leak into the low bins.
+ * Statistics are accumulated per full segment with a dot product; the
+ * partial segment left at the end only contributes to the statistics.
+ */
+
+#include <math.h>
+#include <string.h>
+#include "spectrum.h"
+
+#if SPEC_HAVE_ESP_DSP
+#include "esp_dsp.h"
+#endif
+
+static float specWindow[SPEC_FFT_SIZE];
+static float specWindowSum = 0;
+static float specWork[2 * SPEC_FFT_SIZE];      // Interleaved re, im
+#if !SPEC_HAVE_ESP_DSP
+static float specTwiddle[SPEC_FFT_SIZE];       // cos, sin pairs for k < N/2
+#endif
+static bool specReady = false;
+
+static void specInit() {
+    if (specReady) return;
+
+#if SPEC_HAVE_ESP_DSP
+    dsps_fft2r_init_fc32(NULL, SPEC_FFT_SIZE);
+    dsps_wind_hann_f32(specWindow, SPEC_FFT_SIZE);
+#else
+    for (int i = 0; i < SPEC_FFT_SIZE; i++) {
+        specWindow[i] = 0.5f * (1.0f - cosf(2.0f * (float)M_PI * i / (SPEC_FFT_SIZE - 1)));
+    }
+    for (int k = 0; k < SPEC_FFT_SIZE / 2; k++) {
+        float a = -2.0f * (float)M_PI * k / SPEC_FFT_SIZE;
+        specTwiddle[2 * k] = cosf(a);
+        specTwiddle[2 * k + 1] = sinf(a);
+    }
+#endif
+
+    specWindowSum = 0;
+    for (int i = 0; i < SPEC_FFT_SIZE; i++) {
+        specWindowSum += specWindow[i];
+    }
+    specReady = true;
+}
+
+// ==================== VECTOR PRIMITIVES ====================
+
+static float specDot(const float* a, const float* b, int n) {
+#if SPEC_HAVE_ESP_DSP
+    float r = 0;
+    dsps_dotprod_f32(a, b, &r, n);
+    return r;
+#else
+    float r = 0;
+    for (int i = 0; i < n; i++) r += a[i] * b[i];
+    return r;
+#endif
+}
+
+// dst[2i + part] = (src[i] - offset) * window[i] for i < n, zero above n
+static void specLoad(const float* src, int n, float offset, bool windowed, int part) {
+#if SPEC_HAVE_ESP_DSP
+    dsps_addc_f32(src, specWork + part, n, -offset, 1, 2);
+    if (windowed) {
+        dsps_mul_f32(specWork + part, specWindow, specWork + part, n, 2, 1, 2);
+    }
+#else
+    for (int i = 0; i < n; i++) {
+        float v = src[i] - offset;
+        specWork[2 * i + part] = windowed ? v * specWindow[i] : v;
+    }
+#endif
+    for (int i = n; i < SPEC_FFT_SIZE; i++) {
+        specWork[2 * i + part] = 0;
+    }
+}
+
+// In-place complex FFT of specWork, natural order output
+static void specFFT() {
+#if SPEC_HAVE_ESP_DSP
+    dsps_fft2r_fc32(specWork, SPEC_FFT_SIZE);
+    dsps_bit_rev_fc32(specWork, SPEC_FFT_SIZE);
+#else
+    const int n = SPEC_FFT_SIZE;
+    for (int i = 1, j = 0; i < n; i++) {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) {
+            float tr = specWork[2 * i], ti = specWork[2 * i + 1];
+            specWork[2 * i] = specWork[2 * j];
+            specWork[2 * i + 1] = specWork[2 * j + 1];
+            specWork[2 * j] = tr;
+            specWork[2 * j + 1] = ti;
+        }
+    }
+    for (int len = 2; len <= n; len <<= 1) {
+        int half = len >> 1;
+        int step = n / len;
+        for (int i = 0; i < n; i += len) {
+            for (int k = 0; k < half; k++) {
+                float wr = specTwiddle[2 * k * step];
+                float wi = specTwiddle[2 * k * step + 1];
+                float* u = specWork + 2 * (i + k);
+                float* v = specWork + 2 * (i + k + half);
+                float vr = v[0] * wr - v[1] * wi;
+                float vi = v[0] * wi + v[1] * wr;
+                v[0] = u[0] - vr;
+                v[1] = u[1] - vi;
+                u[0] += vr;
+                u[1] += vi;
+            }
+        }
+    }
+#endif
+}
+
+// Power of the two real signals packed as re/im: |A[k]|^2 and |B[k]|^2,
+// using A[k] = (F[k] + conj F[N-k]) / 2 and B[k] = (F[k] - conj F[N-k]) / 2i
+static void specSplitPower(float* powA, float* powB, bool accumulate) {
+    for (int k = 0; k < SPEC_BINS; k++) {
+        int m = (SPEC_FFT_SIZE - k) & (SPEC_FFT_SIZE - 1);
+        float fr = specWork[2 * k], fi = specWork[2 * k + 1];
+        float gr = specWork[2 * m], gi = -specWork[2 * m + 1];
+        float ar = fr + gr, ai = fi + gi;
+        float br = fr - gr, bi = fi - gi;
+        float pa = 0.25f * (ar * ar + ai * ai);
+        float pb = 0.25f * (br * br + bi * bi);
+        powA[k] = accumulate ? powA[k] + pa : pa;
+        if (powB) powB[k] = accumulate ? powB[k] + pb : pb;
+    }
+}
+
+static float specMean(const float* v, int n) {
+    float s = 0;
+    for (int i = 0; i < n; i++) s += v[i];
+    return n > 0 ? s / n : 0;
+}
+
+// ==================== STREAMING ====================
+
+static void specAccumulateStats(SpectrumAnalyzer& sa, int n) {
+    for (int a = 0; a < SPEC_AXES; a++) {
+        const float* v = sa.segment[a];
+        float s = 0, lo = sa.min[a], hi = sa.max[a];
+        for (int i = 0; i < n; i++) {
+            s += v[i];
+            if (v[i] < lo) lo = v[i];
+            if (v[i] > hi) hi = v[i];
+        }
+        sa.sum[a] += s;
+        sa.sumSq[a] += specDot(v, v, n);
+        sa.min[a] = lo;
+        sa.max[a] = hi;
+    }
+}
+
+static void specProcessSegment(SpectrumAnalyzer& sa) {
+    specAccumulateStats(sa, SPEC_FFT_SIZE);
+
+    // X + iY in one transform, Z on its own
+    specLoad(sa.segment[0], SPEC_FFT_SIZE, specMean(sa.segment[0], SPEC_FFT_SIZE), true, 0);
+    specLoad(sa.segment[1], SPEC_FFT_SIZE, specMean(sa.segment[1], SPEC_FFT_SIZE), true, 1);
+    specFFT();
+    specSplitPower(sa.power[0], sa.power[1], true);
+
+    specLoad(sa.segment[2], SPEC_FFT_SIZE, specMean(sa.segment[2], SPEC_FFT_SIZE), true, 0);
+    specLoad(sa.segment[2], 0, 0, false, 1);
+    specFFT();
+    specSplitPower(sa.power[2], NULL, true);
+
+    sa.segments++;
+    sa.segmentFill = 0;
+}
+
+void spectrumBegin(SpectrumAnalyzer& sa, float sampleRate, uint32_t expectedSamples) {
+    specInit();
+    memset(&sa, 0, sizeof(sa));
+    sa.sampleRate = sampleRate;
+    for (int a = 0; a < SPEC_AXES; a++) {
+        sa.min[a] = INFINITY;
+        sa.max[a] = -INFINITY;
+    }
+    // Whole recording must fit the decimated buffer
+    uint32_t factor = (expectedSamples + SPEC_FFT_SIZE - 1) / SPEC_FFT_SIZE;
+    sa.lfFactor = factor > 0 ? (uint16_t)factor : 1;
+}
+
+void spectrumAdd(SpectrumAnalyzer& sa, const float* xyz, size_t n) {
+    for (size_t i = 0; i < n; i++, xyz += SPEC_AXES) {
+        for (int a = 0; a < SPEC_AXES; a++) {
+            sa.segment[a][sa.segmentFill] = xyz[a];
+            sa.lfAcc[a] += xyz[a];
+        }
+        sa.count++;
+
+        if (++sa.lfFill == sa.lfFactor) {
+            if (sa.lfCount < SPEC_FFT_SIZE) {
+                for (int a = 0; a < SPEC_AXES; a++) {
+                    sa.lf[a][sa.lfCount] = sa.lfAcc[a] / sa.lfFactor;
+                }
+                sa.lfCount++;
+            }
+            memset(sa.lfAcc, 0, sizeof(sa.lfAcc));
+            sa.lfFill = 0;
+        }
+
+        if (++sa.segmentFill == SPEC_FFT_SIZE) {
+            specProcessSegment(sa);
+        }
+    }
+}
+
+// ==================== RESULTS ====================
+
+// Sub-bin peak position from the neighbouring bins (parabola through
+// log power - near exact for the Hann main lobe)
+static float specInterpolate(const float* p, int k) {
+    if (p[k - 1] <= 0 || p[k] <= 0 || p[k + 1] <= 0) return (float)k;
+    float a = logf(p[k - 1]), b = logf(p[k]), c = logf(p[k + 1]);
+    float d = a - 2 * b + c;
+    return d < 0 ? k + 0.5f * (a - c) / d : (float)k;
+}
+
+static void specVibrationPeaks(const SpectrumAnalyzer& sa, int axis, AxisResult& r) {
+    for (int i = 0; i < SPEC_PEAKS; i++) {
+        r.peakHz[i] = 0;
+        r.peakAmp[i] = 0;
+    }
+    if (sa.segments == 0) return;
+
+    const float* p = sa.power[axis];
+    int best[SPEC_PEAKS] = { -1, -1, -1 };
+
+    // Local maxima, strongest first
+    for (int k = 1; k < SPEC_BINS - 1; k++) {
+        if (!(p[k] > p[k - 1] && p[k] >= p[k + 1])) continue;
+        for (int i = 0; i < SPEC_PEAKS; i++) {
+            if (best[i] < 0 || p[k] > p[best[i]]) {
+                for (int j = SPEC_PEAKS - 1; j > i; j--) best[j] = best[j - 1];
+                best[i] = k;
+                break;
+            }
+        }
+    }
+
+    for (int i = 0; i < SPEC_PEAKS && best[i] > 0; i++) {
+        int k = best[i];
+        r.peakHz[i] = specInterpolate(p, k) * sa.sampleRate / SPEC_FFT_SIZE;
+        r.peakAmp[i] = 2.0f * sqrtf(p[k] / sa.segments) / specWindowSum;
+    }
+}
+
+void spectrumFinish(SpectrumAnalyzer& sa, AxisResult out[SPEC_AXES]) {
+    specAccumulateStats(sa, sa.segmentFill);
+
+    // Tumble stage: the whole decimated record, mean removed, zero padded
+    float lfPower[SPEC_AXES][SPEC_BINS];
+    int lfn = sa.lfCount;
+    specLoad(sa.lf[0], lfn, specMean(sa.lf[0], lfn), false, 0);
+    specLoad(sa.lf[1], lfn, specMean(sa.lf[1], lfn), false, 1);
+    specFFT();
+    specSplitPower(lfPower[0], lfPower[1], false);
+    specLoad(sa.lf[2], lfn, specMean(sa.lf[2], lfn), false, 0);
+    specLoad(sa.lf[2], 0, 0, false, 1);
+    specFFT();
+    specSplitPower(lfPower[2], NULL, false);
+    float lfRate = sa.sampleRate / sa.lfFactor;
+
+    for (int a = 0; a < SPEC_AXES; a++) {
+        AxisResult& r = out[a];
+        if (sa.count == 0) {
+            memset(&r, 0, sizeof(r));
+            continue;
+        }
+        r.mean = sa.sum[a] / sa.count;
+        r.rms = sqrtf(sa.sumSq[a] / sa.count);
+        r.min = sa.min[a];
+        r.max = sa.max[a];
+        specVibrationPeaks(sa, a, r);
+
+        int best = 0;
+        for (int k = 1; k < SPEC_BINS - 1; k++) {
+            if (best == 0 || lfPower[a][k] > lfPower[a][best]) best = k;
+        }
+        r.tumbleHz = 0;
+        r.tumbleAmp = 0;
+        if (lfn > 2 && best > 0 && lfPower[a][best] > 0) {
+            r.tumbleHz = specInterpolate(lfPower[a], best) * lfRate / SPEC_FFT_SIZE;
+            r.tumbleAmp = 2.0f * sqrtf(lfPower[a][best]) / lfn;
+        }
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef SPECTRUM_H
+#define SPECTRUM_H
+
+/*
+ * Orbital Temple Satellite - Accelerometer Spectrum Kernel
+ * Version: 1.21
+ *
+ * Streaming per-axis statistics and spectral peaks for a recording, fed
+ * a few hundred samples at a time so the whole file never sits in RAM.
+ *
+ * TWO FFT STAGES (same 256-point kernel):
+ *    - Vibration: Welch average of Hann-windowed 256-sample segments at
+ *      the recording rate (bin = rate / 256, e.g. 0.46 Hz at 119 Hz)
+ *    - Tumble: samples averaged down to ~SPEC_LF_RATE Hz over the whole
+ *      recording, one FFT at the end (bin = 1 / duration, 0..2 Hz)
+ *    X and Y share one complex FFT (X real, Y imaginary) and are split
+ *    afterwards, so three axes cost two transforms.
+ *
+ * On the ESP32 the transforms, windowing and dot products use ESP-DSP
+ * (assembly-optimised, SIMD on chips that have it) when the library is
+ * available; otherwise a portable radix-2 FFT is used. Host-portable
+ * (test/test_spectrum.cpp builds it).
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define SPEC_FFT_SIZE   256
+#define SPEC_BINS       (SPEC_FFT_SIZE / 2)
+#define SPEC_PEAKS      3       // Vibration peaks reported per axis
+#define SPEC_LF_RATE    4       // Hz after decimation for the tumble stage
+#define SPEC_AXES       3
+
+#if defined(__has_include)
+#if __has_include("esp_dsp.h")
+#define SPEC_HAVE_ESP_DSP 1
+#endif
+#endif
+#ifndef SPEC_HAVE_ESP_DSP
+#define SPEC_HAVE_ESP_DSP 0
+#endif
+
+struct AxisResult {
+    float mean;
+    float rms;                      // Including the mean (static 1 g shows up)
+    float min;
+    float max;
+    float peakHz[SPEC_PEAKS];       // Strongest vibration lines, 0 = none
+    float peakAmp[SPEC_PEAKS];      // Amplitude in input units (g)
+    float tumbleHz;                 // Strongest line below SPEC_LF_RATE / 2
+    float tumbleAmp;
+};
+
+struct SpectrumAnalyzer {
+    float sampleRate;
+    uint32_t count;
+
+    // Running statistics
+    float sum[SPEC_AXES];
+    float sumSq[SPEC_AXES];
+    float min[SPEC_AXES];
+    float max[SPEC_AXES];
+
+    // Vibration stage: current segment and accumulated power
+    float segment[SPEC_AXES][SPEC_FFT_SIZE];
+    uint16_t segmentFill;
+    uint16_t segments;
+    float power[SPEC_AXES][SPEC_BINS];
+
+    // Tumble stage: decimated record (block means)
+    float lf[SPEC_AXES][SPEC_FFT_SIZE];
+    uint16_t lfCount;
+    uint16_t lfFactor;              // Input samples per decimated sample
+    uint16_t lfFill;
+    float lfAcc[SPEC_AXES];
+};
+
+// Reset for a recording of about expectedSamples at sampleRate Hz
+void spectrumBegin(SpectrumAnalyzer& sa, float sampleRate, uint32_t expectedSamples);
+
+// Feed n samples, interleaved x,y,z
+void spectrumAdd(SpectrumAnalyzer& sa, const float* xyz, size_t n);
+
+// Final results for the three axes
+void spectrumFinish(SpectrumAnalyzer& sa, AxisResult out[SPEC_AXES]);
+
+#endif // SPECTRUM_H
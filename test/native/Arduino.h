@@ -0,0 +1,194 @@
+#ifndef SIM_ARDUINO_H
+#define SIM_ARDUINO_H
+
+/*
+ * Orbital Temple - Host Simulation: Arduino core
+ *
+ * Just enough of the ESP32 Arduino core for the firmware sources to build
+ * and run on a PC ([env:native] in platformio.ini). Time is virtual
+ * (sim.h): millis(), micros() and delay() read and advance the simulated
+ * clock, never the host's. Pins and the ADC are fed by the simulation.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <ctype.h>
+#include <string>
+#include <algorithm>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#define IRAM_ATTR
+#define ICACHE_RAM_ATTR
+
+#define HEX 16
+#define DEC 10
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define RISING 0x01
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+void pinMode(int pin, int mode);
+int digitalRead(int pin);
+void digitalWrite(int pin, int value);
+int analogRead(int pin);
+void analogReadResolution(int bits);
+void btStop();
+
+// ==================== STRING ====================
+
+class String {
+public:
+    String() {}
+    String(const char* c) : s(c ? c : "") {}
+    String(const std::string& x) : s(x) {}
+    explicit String(char c) : s(1, c) {}
+    String(int v, unsigned char base = 10) { fmt(base == 16 ? "%x" : "%d", v); }
+    String(unsigned int v, unsigned char base = 10) { fmt(base == 16 ? "%x" : "%u", v); }
+    String(long v, unsigned char base = 10) { fmt(base == 16 ? "%lx" : "%ld", v); }
+    String(unsigned long v, unsigned char base = 10) { fmt(base == 16 ? "%lx" : "%lu", v); }
+    explicit String(unsigned char v, unsigned char base = 10) : String((unsigned int)v, base) {}
+    String(float v, unsigned char decimals = 2) { fmt("%.*f", (int)decimals, (double)v); }
+    String(double v, unsigned char decimals = 2) { fmt("%.*f", (int)decimals, v); }
+
+    const char* c_str() const { return s.c_str(); }
+    unsigned int length() const { return s.size(); }
+    bool reserve(unsigned int n) { s.reserve(n); return true; }
+
+    char charAt(unsigned int i) const { return i < s.size() ? s[i] : 0; }
+    char operator[](unsigned int i) const { return charAt(i); }
+
+    int indexOf(char c, unsigned int from = 0) const { return pos(s.find(c, from)); }
+    int indexOf(const char* c, unsigned int from = 0) const { return pos(s.find(c, from)); }
+    int indexOf(const String& c, unsigned int from = 0) const { return pos(s.find(c.s, from)); }
+    int lastIndexOf(char c) const { return pos(s.rfind(c)); }
+
+    String substring(unsigned int a) const { return a >= s.size() ? String() : String(s.substr(a)); }
+    String substring(unsigned int a, unsigned int b) const {
+        if (b > s.size()) b = s.size();
+        return a >= b ? String() : String(s.substr(a, b - a));
+    }
+
+    bool equals(const String& o) const { return s == o.s; }
+    bool equals(const char* o) const { return s == o; }
+    bool startsWith(const char* p) const { return s.compare(0, strlen(p), p) == 0; }
+    bool startsWith(const String& p) const { return startsWith(p.c_str()); }
+    bool endsWith(const char* p) const {
+        size_t n = strlen(p);
+        return s.size() >= n && s.compare(s.size() - n, n, p) == 0;
+    }
+    bool operator==(const String& o) const { return s == o.s; }
+    bool operator==(const char* o) const { return s == o; }
+    bool operator!=(const String& o) const { return s != o.s; }
+    bool operator!=(const char* o) const { return s != o; }
+
+    void toLowerCase() { for (size_t i = 0; i < s.size(); i++) s[i] = tolower((unsigned char)s[i]); }
+    void toUpperCase() { for (size_t i = 0; i < s.size(); i++) s[i] = toupper((unsigned char)s[i]); }
+    void trim() {
+        size_t a = s.find_first_not_of(" \t\r\n");
+        if (a == std::string::npos) { s.clear(); return; }
+        s = s.substr(a, s.find_last_not_of(" \t\r\n") - a + 1);
+    }
+    long toInt() const { return atol(s.c_str()); }
+    float toFloat() const { return (float)atof(s.c_str()); }
+
+    String& operator+=(const String& o) { s += o.s; return *this; }
+    String& operator+=(const char* o) { s += o; return *this; }
+    String& operator+=(char c) { s += c; return *this; }
+    String& operator+=(int v) { s += String(v).s; return *this; }
+    String& operator+=(unsigned int v) { s += String(v).s; return *this; }
+    String& operator+=(long v) { s += String(v).s; return *this; }
+    String& operator+=(unsigned long v) { s += String(v).s; return *this; }
+    bool concat(const char* p, unsigned int n) { s.append(p, n); return true; }
+
+    friend String operator+(const String& a, const String& b) { return String(a.s + b.s); }
+    friend String operator+(const String& a, const char* b) { return String(a.s + b); }
+    friend String operator+(const char* a, const String& b) { return String(a + b.s); }
+    friend String operator+(const String& a, char b) { return String(a.s + b); }
+
+private:
+    static int pos(size_t p) { return p == std::string::npos ? -1 : (int)p; }
+    void fmt(const char* f, ...) {
+        char b[48];
+        va_list a;
+        va_start(a, f);
+        vsnprintf(b, sizeof(b), f, a);
+        va_end(a);
+        s = b;
+    }
+
+    std::string s;
+};
+
+// ==================== PRINT / SERIAL ====================
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* b, size_t n) {
+        size_t k = 0;
+        while (n--) k += write(*b++);
+        return k;
+    }
+    size_t write(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+    size_t write(const char* s, size_t n) { return write((const uint8_t*)s, n); }
+
+    size_t print(const char* s) { return write(s); }
+    size_t print(const String& s) { return write(s.c_str()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int v) { return print(String(v)); }
+    size_t print(unsigned int v) { return print(String(v)); }
+    size_t print(long v) { return print(String(v)); }
+    size_t print(unsigned long v) { return print(String(v)); }
+    size_t print(double v, int d = 2) { return print(String(v, (unsigned char)d)); }
+    size_t println() { return write("\r\n"); }
+    template <typename T> size_t println(const T& v) { size_t n = print(v); return n + println(); }
+    size_t println(double v, int d) { size_t n = print(v, d); return n + println(); }
+    size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+
+    virtual void flush() {}
+};
+
+class HardwareSerial : public Print {
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* b, size_t n) override;
+    using Print::write;
+    int availableForWrite() { return 128; }
+    int available() { return 0; }
+    int read() { return -1; }
+    void flush() override;
+    operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+// ==================== ESP ====================
+
+class EspClass {
+public:
+    void restart();
+    uint32_t getFreeHeap();
+    uint32_t getMinFreeHeap();
+    uint32_t getMaxAllocHeap();
+};
+
+extern EspClass ESP;
+
+#endif // SIM_ARDUINO_H
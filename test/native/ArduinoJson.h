@@ -0,0 +1,6 @@
+#ifndef SIM_ARDUINOJSON_H
+#define SIM_ARDUINOJSON_H
+
+// Included by config.h, not used by the firmware
+
+#endif // SIM_ARDUINOJSON_H
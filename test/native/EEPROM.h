@@ -0,0 +1,53 @@
+#ifndef SIM_EEPROM_H
+#define SIM_EEPROM_H
+
+/*
+ * Orbital Temple - Host Simulation: EEPROM
+ *
+ * RAM-backed, erased to 0xFF like fresh flash. Contents are loaded from
+ * and committed to a file when the simulation gives one (sim_main.cpp
+ * --eeprom), so state persistence across "reboots" can be exercised.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define SIM_EEPROM_MAX 4096
+
+class EEPROMClass {
+public:
+    EEPROMClass() { memset(mem, 0xFF, sizeof(mem)); }
+
+    bool begin(size_t size) { used = size < SIM_EEPROM_MAX ? size : SIM_EEPROM_MAX; return true; }
+    uint8_t read(int addr) { return inRange(addr, 1) ? mem[addr] : 0; }
+    void write(int addr, uint8_t value) { if (inRange(addr, 1)) mem[addr] = value; }
+
+    template <typename T> T& get(int addr, T& t) {
+        if (inRange(addr, sizeof(T))) memcpy(&t, mem + addr, sizeof(T));
+        return t;
+    }
+    template <typename T> const T& put(int addr, const T& t) {
+        if (inRange(addr, sizeof(T))) memcpy(mem + addr, &t, sizeof(T));
+        return t;
+    }
+
+    bool commit();
+    size_t length() const { return used; }
+    uint8_t* getDataPtr() { return mem; }
+
+    // Simulation: backing file, NULL for RAM only
+    void simAttach(const char* path);
+
+    uint8_t mem[SIM_EEPROM_MAX];
+
+private:
+    bool inRange(int addr, size_t n) const { return addr >= 0 && (size_t)addr + n <= used; }
+
+    size_t used = 0;
+    const char* file = NULL;
+};
+
+extern EEPROMClass EEPROM;
+
+#endif // SIM_EEPROM_H
@@ -0,0 +1,86 @@
+#ifndef SIM_FS_H
+#define SIM_FS_H
+
+/*
+ * Orbital Temple - Host Simulation: file system
+ *
+ * fs::File and fs::FS as arduino-esp32 has them, backed by a directory on
+ * the host (simSdAttach()). File objects share one open handle between
+ * copies and close it with the last copy, like the real FileImpl.
+ * name() is the last path component, path() the full SD path.
+ */
+
+#include <Arduino.h>
+#include <time.h>
+#include <memory>
+
+#define FILE_READ   "r"
+#define FILE_WRITE  "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+struct FileImpl;
+
+class File : public Print {
+public:
+    File() {}
+    explicit File(std::shared_ptr<FileImpl> impl) : impl(impl) {}
+
+    operator bool() const;
+    bool isDirectory() const;
+    File openNextFile(const char* mode = FILE_READ);
+    void rewindDirectory();
+    const char* name() const;
+    const char* path() const;
+    size_t size() const;
+    time_t getLastWrite();
+
+    int available();
+    int peek();
+    int read();
+    size_t read(uint8_t* buf, size_t size);
+    size_t readBytes(char* buf, size_t size) { return read((uint8_t*)buf, size); }
+    size_t readBytesUntil(char terminator, char* buf, size_t size);
+    String readStringUntil(char terminator);
+    String readString();
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buf, size_t size) override;
+    using Print::write;
+    void flush() override;
+
+    bool seek(uint32_t pos, SeekMode mode = SeekSet);
+    size_t position() const;
+    void close();
+
+private:
+    std::shared_ptr<FileImpl> impl;
+};
+
+class FS {
+public:
+    File open(const char* path, const char* mode = FILE_READ, bool create = false);
+    File open(const String& path, const char* mode = FILE_READ, bool create = false) {
+        return open(path.c_str(), mode, create);
+    }
+    bool exists(const char* path);
+    bool exists(const String& path) { return exists(path.c_str()); }
+    bool mkdir(const char* path);
+    bool mkdir(const String& path) { return mkdir(path.c_str()); }
+    bool rmdir(const char* path);
+    bool rmdir(const String& path) { return rmdir(path.c_str()); }
+    bool remove(const char* path);
+    bool remove(const String& path) { return remove(path.c_str()); }
+    bool rename(const char* from, const char* to);
+    bool rename(const String& from, const String& to) { return rename(from.c_str(), to.c_str()); }
+};
+
+} // namespace fs
+
+using fs::FS;
+using fs::File;
+
+#endif // SIM_FS_H
@@ -0,0 +1,53 @@
+#ifndef SIM_RADIOLIB_H
+#define SIM_RADIOLIB_H
+
+/*
+ * Orbital Temple - Host Simulation: RadioLib SX1276
+ *
+ * The calls lora.cpp makes, on top of the radio model in radio_sim.cpp
+ * (see sim.h). Return codes follow RadioLib 7.
+ */
+
+#include <Arduino.h>
+
+#define RADIOLIB_ERR_NONE               0
+#define RADIOLIB_ERR_UNKNOWN            (-1)
+#define RADIOLIB_ERR_CHIP_NOT_FOUND     (-2)
+#define RADIOLIB_ERR_PACKET_TOO_LONG    (-4)
+#define RADIOLIB_ERR_TX_TIMEOUT         (-5)
+#define RADIOLIB_ERR_RX_TIMEOUT         (-6)
+#define RADIOLIB_ERR_CRC_MISMATCH       (-7)
+#define RADIOLIB_SX127X_MAX_PACKET_LENGTH 255
+
+typedef unsigned long RadioLibTime_t;
+
+class Module {
+public:
+    Module(int cs, int irq, int rst, int gpio = -1) { (void)cs; (void)irq; (void)rst; (void)gpio; }
+};
+
+class SX1276 {
+public:
+    SX1276(Module* mod) { (void)mod; }
+
+    int16_t begin(float freq = 434.0, float bw = 125.0, uint8_t sf = 9, uint8_t cr = 7,
+                  uint8_t syncWord = 0x12, int8_t power = 10, uint16_t preambleLength = 8,
+                  uint8_t gain = 0);
+    int16_t setFrequency(float freq);
+    int16_t setSpreadingFactor(uint8_t sf);
+    int16_t setCodingRate(uint8_t cr);
+    int16_t standby();
+    int16_t sleep();
+    int16_t startReceive();
+    int16_t startTransmit(const uint8_t* data, size_t len, uint8_t addr = 0);
+    int16_t finishTransmit();
+    int16_t readData(uint8_t* data, size_t len);
+    size_t getPacketLength(bool update = true);
+    float getRSSI();
+    float getSNR();
+    RadioLibTime_t getTimeOnAir(size_t len);     // Microseconds
+    void setPacketReceivedAction(void (*func)(void));
+    void clearPacketReceivedAction();
+};
+
+#endif // SIM_RADIOLIB_H
@@ -0,0 +1,23 @@
+#ifndef SIM_SD_H
+#define SIM_SD_H
+
+#include "FS.h"
+#include "SPI.h"
+
+typedef enum { CARD_NONE, CARD_MMC, CARD_SD, CARD_SDHC, CARD_UNKNOWN } sdcard_type_t;
+
+#define SIM_SD_CARD_BYTES  (4ULL * 1024 * 1024 * 1024)   // Reported card size
+
+class SDFS : public fs::FS {
+public:
+    bool begin(uint8_t ssPin = 5);
+    void end() {}
+    sdcard_type_t cardType();
+    uint64_t cardSize() { return SIM_SD_CARD_BYTES; }
+    uint64_t totalBytes() { return SIM_SD_CARD_BYTES; }
+    uint64_t usedBytes();   // Walks the backing directory
+};
+
+extern SDFS SD;
+
+#endif // SIM_SD_H
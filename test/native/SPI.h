@@ -0,0 +1,13 @@
+#ifndef SIM_SPI_H
+#define SIM_SPI_H
+
+class SPIClass {
+public:
+    void begin(int sck = -1, int miso = -1, int mosi = -1, int ss = -1) {
+        (void)sck; (void)miso; (void)mosi; (void)ss;
+    }
+};
+
+extern SPIClass SPI;
+
+#endif // SIM_SPI_H
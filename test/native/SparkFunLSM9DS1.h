@@ -0,0 +1,56 @@
+#ifndef SIM_SPARKFUN_LSM9DS1_H
+#define SIM_SPARKFUN_LSM9DS1_H
+
+/*
+ * Orbital Temple - Host Simulation: SparkFun LSM9DS1
+ *
+ * The library object only configures the sensor; the firmware reads the
+ * output registers itself over Wire (imu.cpp), answered by imu_sim.cpp.
+ * Scale factors are the library defaults (245 dps, 2 g, 4 gauss).
+ */
+
+#include <stdint.h>
+
+enum fifoMode_type {
+    FIFO_OFF = 0,
+    FIFO_THS = 1,
+    FIFO_CONT_TRIGGER = 3,
+    FIFO_OFF_TRIGGER = 4,
+    FIFO_CONT = 6
+};
+
+struct gyroSettings {
+    uint8_t enabled;
+    uint16_t scale;
+    uint8_t sampleRate;
+};
+
+struct accelSettings {
+    uint8_t enabled;
+    uint8_t scale;
+    uint8_t sampleRate;
+};
+
+struct IMUSettings {
+    gyroSettings gyro;
+    accelSettings accel;
+};
+
+class LSM9DS1 {
+public:
+    LSM9DS1();
+
+    uint16_t begin(uint8_t agAddress = 0x6B, uint8_t mAddress = 0x1E);
+    float calcGyro(int16_t gyro) { return 0.00875f * gyro; }
+    float calcAccel(int16_t accel) { return 0.000061f * accel; }
+    float calcMag(int16_t mag) { return 0.00014f * mag; }
+    void enableFIFO(bool enable = true);
+    void setFIFO(fifoMode_type fifoMode, uint8_t fifoThs);
+
+    IMUSettings settings;
+    int16_t gx = 0, gy = 0, gz = 0;
+    int16_t ax = 0, ay = 0, az = 0;
+    int16_t mx = 0, my = 0, mz = 0;
+};
+
+#endif // SIM_SPARKFUN_LSM9DS1_H
@@ -0,0 +1,13 @@
+#ifndef SIM_WIFI_H
+#define SIM_WIFI_H
+
+#define WIFI_OFF 0
+
+class WiFiClass {
+public:
+    void mode(int m) { (void)m; }
+};
+
+extern WiFiClass WiFi;
+
+#endif // SIM_WIFI_H
@@ -0,0 +1,41 @@
+#ifndef SIM_WIRE_H
+#define SIM_WIRE_H
+
+/*
+ * Orbital Temple - Host Simulation: I2C
+ *
+ * Register reads are answered by the LSM9DS1 model (imu_sim.cpp): the
+ * register address written before a repeated start selects what the
+ * following requestFrom() returns.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+class TwoWire {
+public:
+    bool begin() { return true; }
+    bool end() { return true; }
+    void setClock(uint32_t hz) { (void)hz; }
+    void setTimeOut(uint16_t ms) { (void)ms; }
+    uint16_t getTimeOut() { return 50; }
+
+    void beginTransmission(uint8_t addr);
+    size_t write(uint8_t value);
+    uint8_t endTransmission(bool stop = true);
+    uint8_t requestFrom(uint8_t addr, uint8_t count, bool stop = true);
+    int available();
+    int read();
+
+private:
+    uint8_t address = 0;
+    uint8_t reg = 0;
+    bool regSet = false;
+    uint8_t rx[32];
+    uint8_t rxLen = 0;
+    uint8_t rxPos = 0;
+};
+
+extern TwoWire Wire;
+
+#endif // SIM_WIRE_H
@@ -0,0 +1,393 @@
+/*
+ * Orbital Temple - Host Simulation: clock, pins, serial, FreeRTOS, sleep
+ */
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <SPI.h>
+#include <WiFi.h>
+#include "esp_timer.h"
+#include "esp_sleep.h"
+#include "esp_partition.h"
+#include "esp_task_wdt.h"
+#include "driver/gpio.h"
+#include "config.h"
+#include "sim.h"
+
+HardwareSerial Serial;
+EspClass ESP;
+SPIClass SPI;
+WiFiClass WiFi;
+EEPROMClass EEPROM;
+
+// ==================== CLOCK ====================
+
+static uint64_t nowUs = 0;
+static bool advancing = false;
+
+uint64_t simMicros() {
+    return nowUs;
+}
+
+void simAdvance(uint64_t us) {
+    uint64_t target = nowUs + us;
+
+    // Radio events fire at their own time, in order; an event handler
+    // reading the clock never re-enters here
+    if (!advancing) {
+        advancing = true;
+        uint64_t ev;
+        while ((ev = simRadioNextEventUs()) <= target) {
+            if (ev > nowUs) nowUs = ev;
+            simRadioRun(nowUs);
+        }
+        advancing = false;
+    }
+    if (target > nowUs) nowUs = target;
+}
+
+unsigned long millis() {
+    simAdvance(SIM_CALL_COST_US);
+    return (unsigned long)(nowUs / 1000ULL);
+}
+
+unsigned long micros() {
+    simAdvance(SIM_CALL_COST_US);
+    return (unsigned long)nowUs;
+}
+
+int64_t esp_timer_get_time() {
+    simAdvance(SIM_CALL_COST_US);
+    return (int64_t)nowUs;
+}
+
+void delay(unsigned long ms) {
+    simAdvance((uint64_t)ms * 1000ULL);
+}
+
+void delayMicroseconds(unsigned int us) {
+    simAdvance(us);
+}
+
+void yield() {
+}
+
+// ==================== WATCHDOG ====================
+
+static uint64_t lastFeedUs = 0;
+static uint64_t maxFeedGapUs = 0;
+static uint32_t feeds = 0;
+
+int esp_task_wdt_reset() {
+    uint64_t gap = nowUs - lastFeedUs;
+    if (gap > maxFeedGapUs) maxFeedGapUs = gap;
+    lastFeedUs = nowUs;
+    feeds++;
+    return 0;
+}
+
+uint64_t simWatchdogMaxGapUs() {
+    uint64_t gap = nowUs - lastFeedUs;
+    return gap > maxFeedGapUs ? gap : maxFeedGapUs;
+}
+
+uint32_t simWatchdogFeeds() {
+    return feeds;
+}
+
+// ==================== PINS ====================
+
+static uint64_t burnStartUs = 0;
+static uint64_t burnUs = 0;          // Accumulated burn-wire on-time
+static bool burning = false;
+
+void simBurnWire(bool on) {
+    if (on && !burning) {
+        burnStartUs = nowUs;
+    } else if (!on && burning) {
+        burnUs += nowUs - burnStartUs;
+    }
+    burning = on;
+}
+
+bool simAntennaSwitchClosed() {
+    uint64_t total = burnUs + (burning ? nowUs - burnStartUs : 0);
+    return total < (uint64_t)SIM_DEPLOY_BURN_MS * 1000ULL;
+}
+
+void pinMode(int pin, int mode) {
+    (void)pin;
+    (void)mode;
+}
+
+int digitalRead(int pin) {
+    if (pin == AntSwitch) return simAntennaSwitchClosed() ? HIGH : LOW;
+    return LOW;
+}
+
+void digitalWrite(int pin, int value) {
+    if (pin == R1) simBurnWire(value == HIGH);
+}
+
+int analogRead(int pin) {
+    return simAdcRead(pin);
+}
+
+void analogReadResolution(int bits) {
+    (void)bits;
+}
+
+void btStop() {
+}
+
+// ==================== SENSORS ====================
+
+// 0 in sunlight ... 1 deepest in the shadow (cosine edges)
+static float orbitShadow() {
+    const uint64_t periodUs = (uint64_t)SIM_ORBIT_MIN * 60000000ULL;
+    const uint64_t eclipseUs = (uint64_t)SIM_ECLIPSE_MIN * 60000000ULL;
+    uint64_t phase = nowUs % periodUs;
+    if (phase >= eclipseUs) return 0.0f;
+    return (float)sin(M_PI * (double)phase / (double)eclipseUs);
+}
+
+uint16_t simAdcRead(int pin) {
+    static uint32_t noise = 12345;
+    noise = noise * 1103515245u + 12345u;
+    int jitter = (int)((noise >> 16) % 5) - 2;     // +-2 counts
+    float shadow = orbitShadow();
+    int counts;
+
+    switch (pin) {
+        case VBAT_DR:       counts = 2480 - (int)(110.0f * shadow); break;   // 4.0 V .. 3.82 V
+        case ThermistorPin: counts = 1900 + (int)(500.0f * shadow); break;   // Warmer .. colder
+        case TL:            counts = shadow > 0.0f ? 20 : 2600; break;
+        default:            counts = 0; break;
+    }
+    counts += jitter;
+    if (counts < 0) counts = 0;
+    if (counts > 4095) counts = 4095;
+    return (uint16_t)counts;
+}
+
+// ==================== SERIAL ====================
+// Each line is prefixed with the virtual time it was written at
+
+static bool lineStart = true;
+
+static void serialPut(const uint8_t* b, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        if (lineStart) {
+            uint64_t ms = nowUs / 1000ULL;
+            fprintf(stdout, "%3lud%02lu:%02lu:%02lu.%03lu ",
+                    (unsigned long)(ms / 86400000ULL),
+                    (unsigned long)(ms / 3600000ULL % 24),
+                    (unsigned long)(ms / 60000ULL % 60),
+                    (unsigned long)(ms / 1000ULL % 60),
+                    (unsigned long)(ms % 1000ULL));
+            lineStart = false;
+        }
+        fputc(b[i], stdout);
+        if (b[i] == '\n') lineStart = true;
+    }
+}
+
+size_t Print::printf(const char* fmt, ...) {
+    char buf[1024];
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    if (n < 0) return 0;
+    return write((const uint8_t*)buf, (size_t)n < sizeof(buf) ? (size_t)n : sizeof(buf) - 1);
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+    serialPut(&c, 1);
+    return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* b, size_t n) {
+    serialPut(b, n);
+    return n;
+}
+
+void HardwareSerial::flush() {
+    fflush(stdout);
+}
+
+// ==================== ESP ====================
+
+void EspClass::restart() {
+    Serial.println("[SIM] ESP.restart() - simulation ends");
+    fflush(stdout);
+    exit(3);
+}
+
+uint32_t EspClass::getFreeHeap() { return 200000; }
+uint32_t EspClass::getMinFreeHeap() { return 180000; }
+uint32_t EspClass::getMaxAllocHeap() { return 110000; }
+
+// ==================== EEPROM ====================
+
+void EEPROMClass::simAttach(const char* path) {
+    file = path;
+    FILE* f = path ? fopen(path, "rb") : NULL;
+    if (f) {
+        size_t n = fread(mem, 1, sizeof(mem), f);
+        (void)n;
+        fclose(f);
+    }
+}
+
+bool EEPROMClass::commit() {
+    if (file == NULL) return true;
+    FILE* f = fopen(file, "wb");
+    if (f == NULL) return false;
+    bool ok = fwrite(mem, 1, sizeof(mem), f) == sizeof(mem);
+    fclose(f);
+    return ok;
+}
+
+// ==================== JOURNAL PARTITION ====================
+
+#define SIM_PARTITION_SECTOR 4096
+
+static const esp_partition_t journalPart = {
+    ESP_PARTITION_TYPE_DATA, JOURNAL_PARTITION_SUBTYPE, 0x3E0000, 0x10000, JOURNAL_PARTITION_LABEL
+};
+static uint8_t journalMem[0x10000];
+static FILE* journalFile = NULL;
+static bool journalMemReady = false;
+
+static void partitionInit() {
+    if (journalMemReady) return;
+    memset(journalMem, 0xFF, sizeof(journalMem));
+    journalMemReady = true;
+}
+
+// Write-through: the file always matches the flash, as after a power cut
+static void partitionSync(size_t offset, size_t size) {
+    if (journalFile == NULL) return;
+    fseek(journalFile, (long)offset, SEEK_SET);
+    size_t n = fwrite(journalMem + offset, 1, size, journalFile);
+    (void)n;
+    fflush(journalFile);
+}
+
+void simPartitionAttach(const char* path) {
+    partitionInit();
+    if (path == NULL) return;
+    journalFile = fopen(path, "r+b");
+    if (journalFile) {
+        size_t n = fread(journalMem, 1, sizeof(journalMem), journalFile);
+        (void)n;
+    } else {
+        journalFile = fopen(path, "w+b");
+        partitionSync(0, sizeof(journalMem));
+    }
+}
+
+static bool partitionRange(const esp_partition_t* part, size_t offset, size_t size) {
+    return part == &journalPart && offset + size <= sizeof(journalMem) && offset + size >= offset;
+}
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type,
+                                                esp_partition_subtype_t subtype,
+                                                const char* label) {
+    partitionInit();
+    if (type != journalPart.type || subtype != journalPart.subtype) return NULL;
+    if (label != NULL && strcmp(label, journalPart.label) != 0) return NULL;
+    return &journalPart;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t* part, size_t offset, void* dst, size_t size) {
+    if (!partitionRange(part, offset, size)) return ESP_ERR_INVALID_SIZE;
+    memcpy(dst, journalMem + offset, size);
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t* part, size_t offset, const void* src, size_t size) {
+    if (!partitionRange(part, offset, size)) return ESP_ERR_INVALID_SIZE;
+    const uint8_t* p = (const uint8_t*)src;
+    for (size_t i = 0; i < size; i++) {
+        journalMem[offset + i] &= p[i];     // NOR: program only clears bits
+    }
+    partitionSync(offset, size);
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t* part, size_t offset, size_t size) {
+    if (!partitionRange(part, offset, size)) return ESP_ERR_INVALID_SIZE;
+    if (offset % SIM_PARTITION_SECTOR != 0 || size % SIM_PARTITION_SECTOR != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(journalMem + offset, 0xFF, size);
+    partitionSync(offset, size);
+    simAdvance((uint64_t)(size / SIM_PARTITION_SECTOR) * SIM_FLASH_ERASE_MS * 1000);
+    return ESP_OK;
+}
+
+// ==================== FREERTOS ====================
+
+bool simInIsr = false;
+
+BaseType_t xPortInIsrContext() { return simInIsr ? pdTRUE : pdFALSE; }
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t, const char*, uint32_t, void*, UBaseType_t,
+                                   TaskHandle_t* handle, BaseType_t) {
+    if (handle) *handle = NULL;
+    return pdFAIL;
+}
+
+void vTaskDelay(TickType_t ticks) { delay(ticks); }
+void vTaskDelete(TaskHandle_t) {}
+void xTaskNotifyGive(TaskHandle_t) {}
+void vTaskNotifyGiveFromISR(TaskHandle_t, BaseType_t* woken) { if (woken) *woken = pdFALSE; }
+uint32_t ulTaskNotifyTake(BaseType_t, TickType_t) { return 0; }
+TaskHandle_t xTaskGetCurrentTaskHandle() { return NULL; }
+void portYIELD_FROM_ISR(BaseType_t) {}
+
+// Non-NULL, so the modules take their "have a lock" path
+static int simMutex;
+SemaphoreHandle_t xSemaphoreCreateMutex() { return &simMutex; }
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() { return &simMutex; }
+BaseType_t xSemaphoreTake(SemaphoreHandle_t, TickType_t) { return pdTRUE; }
+BaseType_t xSemaphoreGive(SemaphoreHandle_t) { return pdTRUE; }
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t, TickType_t) { return pdTRUE; }
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t) { return pdTRUE; }
+
+// ==================== LIGHT SLEEP ====================
+
+static uint64_t sleepTimerUs = 0;
+static bool gpioWakeup = false;
+static esp_sleep_wakeup_cause_t wakeCause = ESP_SLEEP_WAKEUP_UNDEFINED;
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t us) { sleepTimerUs = us; return 0; }
+esp_err_t esp_sleep_enable_gpio_wakeup() { gpioWakeup = true; return 0; }
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause() { return wakeCause; }
+
+esp_err_t esp_light_sleep_start() {
+    uint64_t deadline = nowUs + sleepTimerUs;
+
+    // DIO0 already high: the level wakeup fires at once
+    if (gpioWakeup && gpio_get_level(DIO0_RF)) {
+        wakeCause = ESP_SLEEP_WAKEUP_GPIO;
+        return 0;
+    }
+
+    // Jump from radio event to radio event until one raises DIO0
+    for (;;) {
+        uint64_t ev = simRadioNextEventUs();
+        if (ev > deadline) break;
+        simAdvance(ev > nowUs ? ev - nowUs : 0);
+        if (gpioWakeup && gpio_get_level(DIO0_RF)) {
+            wakeCause = ESP_SLEEP_WAKEUP_GPIO;
+            return 0;
+        }
+    }
+
+    simAdvance(deadline - nowUs);
+    wakeCause = ESP_SLEEP_WAKEUP_TIMER;
+    return 0;
+}
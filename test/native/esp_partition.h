@@ -0,0 +1,45 @@
+#ifndef SIM_ESP_PARTITION_H
+#define SIM_ESP_PARTITION_H
+
+/*
+ * One data partition, the state journal's (partitions.csv), in RAM with
+ * NOR semantics: a write can only clear bits, an erase sets whole 4 KB
+ * sectors to 0xFF and costs SIM_FLASH_ERASE_MS of virtual time. Kept in
+ * a file between runs when the simulation gives one (sim_main.cpp
+ * --journal).
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <esp_sleep.h>      // esp_err_t
+
+#define ESP_OK                  0
+#define ESP_FAIL                -1
+#define ESP_ERR_INVALID_ARG     0x102
+#define ESP_ERR_INVALID_SIZE    0x104
+
+#define SIM_FLASH_ERASE_MS      45          // Per 4 KB sector (datasheet typ.)
+
+typedef enum {
+    ESP_PARTITION_TYPE_APP = 0x00,
+    ESP_PARTITION_TYPE_DATA = 0x01
+} esp_partition_type_t;
+
+typedef int esp_partition_subtype_t;
+
+typedef struct {
+    esp_partition_type_t type;
+    esp_partition_subtype_t subtype;
+    uint32_t address;
+    uint32_t size;
+    char label[17];
+} esp_partition_t;
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type,
+                                                esp_partition_subtype_t subtype,
+                                                const char* label);
+esp_err_t esp_partition_read(const esp_partition_t* part, size_t offset, void* dst, size_t size);
+esp_err_t esp_partition_write(const esp_partition_t* part, size_t offset, const void* src, size_t size);
+esp_err_t esp_partition_erase_range(const esp_partition_t* part, size_t offset, size_t size);
+
+#endif // SIM_ESP_PARTITION_H
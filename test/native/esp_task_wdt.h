@@ -0,0 +1,17 @@
+#ifndef SIM_ESP_TASK_WDT_H
+#define SIM_ESP_TASK_WDT_H
+
+#include <stdint.h>
+
+typedef struct {
+    uint32_t timeout_ms;
+    uint32_t idle_core_mask;
+    bool trigger_panic;
+} esp_task_wdt_config_t;
+
+// Feeds are counted, never enforced
+static inline int esp_task_wdt_init(const esp_task_wdt_config_t*) { return 0; }
+static inline int esp_task_wdt_add(void*) { return 0; }
+int esp_task_wdt_reset();
+
+#endif // SIM_ESP_TASK_WDT_H
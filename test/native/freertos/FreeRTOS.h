@@ -0,0 +1,37 @@
+#ifndef SIM_FREERTOS_H
+#define SIM_FREERTOS_H
+
+/*
+ * Orbital Temple - Host Simulation: FreeRTOS
+ *
+ * The simulation is single-threaded. Task creation fails, so every module
+ * takes its documented no-task path (log lines, SD writes and uplink reads
+ * happen inline on the main loop). Locks and notifications are no-ops;
+ * "ISR context" is true while the radio model runs the DIO0 callback.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdTRUE  1
+#define pdFALSE 0
+#define pdPASS  1
+#define pdFAIL  0
+#define portMAX_DELAY       0xFFFFFFFFu
+#define portTICK_PERIOD_MS  1
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(ms))
+
+typedef struct { int unused; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED    { 0 }
+#define portENTER_CRITICAL(m)           ((void)(m))
+#define portEXIT_CRITICAL(m)            ((void)(m))
+#define portENTER_CRITICAL_ISR(m)       ((void)(m))
+#define portEXIT_CRITICAL_ISR(m)        ((void)(m))
+
+BaseType_t xPortInIsrContext();
+
+#endif // SIM_FREERTOS_H
@@ -0,0 +1,146 @@
+/*
+ * Orbital Temple - Host Simulation: LSM9DS1 on I2C
+ *
+ * Answers the register reads imu.cpp makes: the 0x18-0x2D accel/gyro
+ * burst, the magnetometer burst, FIFO_SRC and FIFO pops. The satellite
+ * tumbles slowly about Z; accel shows 1 mg of noise around zero g, the
+ * field turns with the tumble. While the FIFO is on it fills at the
+ * configured accel ODR, up to 32 entries.
+ */
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <SparkFunLSM9DS1.h>
+#include "imu.h"
+#include "sim.h"
+
+TwoWire Wire;
+
+static bool fifoOn = false;
+static uint64_t fifoSinceUs = 0;
+static uint8_t accelOdrCode = 6;
+
+// Accel ODR codes 1..6 (LSM9DS1 CTRL_REG6_XL), Hz
+static const float ODR_HZ[7] = { 0.0f, 10.0f, 50.0f, 119.0f, 238.0f, 476.0f, 952.0f };
+
+static uint32_t noiseState = 0xACE1u;
+
+static int16_t noise(int amplitude) {
+    noiseState = noiseState * 1103515245u + 12345u;
+    return (int16_t)((int)((noiseState >> 16) % (2 * amplitude + 1)) - amplitude);
+}
+
+static void putLe16(uint8_t* p, int16_t v) {
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)((uint16_t)v >> 8);
+}
+
+// Tumble angle, 1 rpm about Z
+static double tumbleRad() {
+    return 2.0 * M_PI * (double)(simMicros() % 60000000ULL) / 60000000.0;
+}
+
+static uint8_t fifoCount() {
+    if (!fifoOn) return 0;
+    uint64_t periodUs = (uint64_t)(1e6 / ODR_HZ[accelOdrCode]);
+    uint64_t n = (simMicros() - fifoSinceUs) / periodUs;
+    if (n > 32) {
+        fifoSinceUs = simMicros() - 32 * periodUs;      // Oldest overwritten
+        n = 32;
+    }
+    return (uint8_t)n;
+}
+
+static void fillAccel(uint8_t* p) {
+    putLe16(p + 0, noise(16));
+    putLe16(p + 2, noise(16));
+    putLe16(p + 4, noise(16));
+}
+
+// ==================== I2C ====================
+
+void TwoWire::beginTransmission(uint8_t addr) {
+    address = addr;
+    regSet = false;
+}
+
+size_t TwoWire::write(uint8_t value) {
+    if (!regSet) {
+        reg = value;
+        regSet = true;
+    }
+    return 1;
+}
+
+uint8_t TwoWire::endTransmission(bool stop) {
+    (void)stop;
+    return (address == IMU_AG_ADDR || address == IMU_M_ADDR) ? 0 : 2;   // 2 = NACK on address
+}
+
+uint8_t TwoWire::requestFrom(uint8_t addr, uint8_t count, bool stop) {
+    (void)stop;
+    if (count > sizeof(rx)) count = sizeof(rx);
+    memset(rx, 0, sizeof(rx));
+    rxLen = count;
+    rxPos = 0;
+
+    uint8_t r = reg & 0x7F;
+    if (addr == IMU_AG_ADDR && r == 0x18) {
+        // Gyro at 0x18, accel at 0x28: rate of the tumble about Z
+        putLe16(rx + 0, noise(20));
+        putLe16(rx + 2, noise(20));
+        putLe16(rx + 4, (int16_t)(6.0 / 0.00875) + noise(20));     // 6 dps
+        if (count >= 22) fillAccel(rx + 16);
+    } else if (addr == IMU_AG_ADDR && r == 0x28) {
+        fillAccel(rx);
+        if (fifoCount() > 0) fifoSinceUs += (uint64_t)(1e6 / ODR_HZ[accelOdrCode]);   // Popped
+    } else if (addr == IMU_AG_ADDR && r == 0x2F) {
+        uint8_t n = fifoCount();
+        rx[0] = n & 0x3F;
+        if (n >= 32) rx[0] |= 0x40;                                 // Overrun
+    } else if (addr == IMU_M_ADDR && r == 0x28) {
+        double a = tumbleRad();
+        putLe16(rx + 0, (int16_t)(2000.0 * cos(a)) + noise(10));    // ~0.28 gauss
+        putLe16(rx + 2, (int16_t)(2000.0 * sin(a)) + noise(10));
+        putLe16(rx + 4, (int16_t)-1500 + noise(10));
+    }
+    return count;
+}
+
+int TwoWire::available() {
+    return rxLen - rxPos;
+}
+
+int TwoWire::read() {
+    return rxPos < rxLen ? rx[rxPos++] : -1;
+}
+
+// ==================== LSM9DS1 ====================
+
+LSM9DS1::LSM9DS1() {
+    settings.gyro.enabled = true;
+    settings.gyro.scale = 245;
+    settings.gyro.sampleRate = 6;
+    settings.accel.enabled = true;
+    settings.accel.scale = 2;
+    settings.accel.sampleRate = 6;
+}
+
+uint16_t LSM9DS1::begin(uint8_t agAddress, uint8_t mAddress) {
+    (void)agAddress;
+    (void)mAddress;
+    accelOdrCode = settings.accel.sampleRate >= 1 && settings.accel.sampleRate <= 6
+                   ? settings.accel.sampleRate : 6;
+    fifoOn = false;
+    return 0x683D;      // WHO_AM_I of both dies, what the library returns on success
+}
+
+void LSM9DS1::enableFIFO(bool enable) {
+    fifoOn = enable;
+    fifoSinceUs = simMicros();
+}
+
+void LSM9DS1::setFIFO(fifoMode_type fifoMode, uint8_t fifoThs) {
+    (void)fifoThs;
+    if (fifoMode == FIFO_OFF) fifoOn = false;
+}
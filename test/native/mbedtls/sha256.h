@@ -0,0 +1,29 @@
+#ifndef SIM_MBEDTLS_SHA256_H
+#define SIM_MBEDTLS_SHA256_H
+
+/*
+ * Orbital Temple - Host Simulation: SHA-256
+ *
+ * FIPS 180-4 SHA-256 behind the mbedtls 3.x calls config.cpp makes, so
+ * the HMAC runs the real code path and tags match the ground station.
+ * SHA-224 (is224 != 0) is not supported.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include "mbedtls/version.h"
+
+typedef struct {
+    uint32_t state[8];
+    uint64_t total;             // Bytes absorbed
+    uint8_t buffer[64];         // Partial block
+} mbedtls_sha256_context;
+
+void mbedtls_sha256_init(mbedtls_sha256_context* ctx);
+void mbedtls_sha256_free(mbedtls_sha256_context* ctx);
+void mbedtls_sha256_clone(mbedtls_sha256_context* dst, const mbedtls_sha256_context* src);
+int mbedtls_sha256_starts(mbedtls_sha256_context* ctx, int is224);
+int mbedtls_sha256_update(mbedtls_sha256_context* ctx, const unsigned char* input, size_t length);
+int mbedtls_sha256_finish(mbedtls_sha256_context* ctx, unsigned char output[32]);
+
+#endif // SIM_MBEDTLS_SHA256_H
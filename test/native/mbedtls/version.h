@@ -0,0 +1,8 @@
+#ifndef SIM_MBEDTLS_VERSION_H
+#define SIM_MBEDTLS_VERSION_H
+
+// The simulation's SHA-256 (sha256.cpp) implements the 3.x API
+#define MBEDTLS_VERSION_MAJOR 3
+#define MBEDTLS_VERSION_MINOR 0
+
+#endif // SIM_MBEDTLS_VERSION_H
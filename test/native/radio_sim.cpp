@@ -0,0 +1,249 @@
+/*
+ * Orbital Temple - Host Simulation: SX1276 radio model
+ *
+ * Models what lora.cpp relies on: standby / RX / TX modes, one FIFO
+ * packet, and DIO0 rising on RxDone and TxDone and staying high until
+ * the IRQ flags are cleared (readData(), startReceive(), standby(),
+ * finishTransmit()). The DIO0 callback runs in "ISR context" when the pin
+ * interrupt is enabled; while it is masked (light sleep) only the level
+ * changes, as on the hardware.
+ */
+
+#include <Arduino.h>
+#include <RadioLib.h>
+#include <deque>
+#include <vector>
+#include "driver/gpio.h"
+#include "config.h"
+#include "sim.h"
+
+extern bool simInIsr;
+
+enum RadioMode { MODE_STANDBY, MODE_RX, MODE_TX };
+
+struct Uplink {
+    uint64_t atUs;
+    float freqMHz;
+    std::vector<uint8_t> data;
+};
+
+static RadioMode mode = MODE_STANDBY;
+static float freqMHz = 0.0f;
+static float bwKHz = 125.0f;
+static uint8_t sf = 9;
+static uint8_t cr = 7;
+static uint16_t preamble = 8;
+static bool begun = false;
+
+static std::deque<Uplink> uplinks;
+static std::vector<uint8_t> fifo;
+static uint64_t txDoneAtUs = UINT64_MAX;
+
+static bool dio0 = false;
+static bool dio0IntrEnabled = true;
+static void (*dio0Action)(void) = NULL;
+
+static SimRadioStats stats;
+static SimDownlinkHook downlinkHook = NULL;
+
+// ==================== DIO0 ====================
+
+static void raiseDio0() {
+    if (dio0) return;               // Already high: no new edge
+    dio0 = true;
+    if (dio0IntrEnabled && dio0Action != NULL) {
+        simInIsr = true;
+        dio0Action();
+        simInIsr = false;
+    }
+}
+
+static void clearIrq() {
+    dio0 = false;
+}
+
+esp_err_t gpio_wakeup_enable(gpio_num_t, gpio_int_type_t) { return 0; }
+esp_err_t gpio_wakeup_disable(gpio_num_t) { return 0; }
+esp_err_t gpio_set_intr_type(gpio_num_t, gpio_int_type_t) { return 0; }
+
+esp_err_t gpio_intr_enable(gpio_num_t pin) {
+    if (pin == DIO0_RF) dio0IntrEnabled = true;
+    return 0;
+}
+
+esp_err_t gpio_intr_disable(gpio_num_t pin) {
+    if (pin == DIO0_RF) dio0IntrEnabled = false;
+    return 0;
+}
+
+int gpio_get_level(gpio_num_t pin) {
+    return pin == DIO0_RF && dio0 ? 1 : 0;
+}
+
+// ==================== EVENTS ====================
+
+uint64_t simRadioNextEventUs() {
+    uint64_t next = txDoneAtUs;
+    if (!uplinks.empty() && uplinks.front().atUs < next) next = uplinks.front().atUs;
+    return next;
+}
+
+void simRadioRun(uint64_t nowUs) {
+    if (txDoneAtUs <= nowUs) {
+        txDoneAtUs = UINT64_MAX;
+        stats.downlinks++;
+        raiseDio0();
+    }
+
+    while (!uplinks.empty() && uplinks.front().atUs <= nowUs) {
+        Uplink &up = uplinks.front();
+        // Receiving, on the right channel with ground's modem settings, FIFO free
+        if (mode == MODE_RX && fabsf(freqMHz - up.freqMHz) < 0.01f && !dio0 &&
+            sf == LORA_SF && cr == LORA_CR) {
+            fifo = up.data;
+            stats.uplinksDelivered++;
+            raiseDio0();
+        } else {
+            stats.uplinksMissed++;
+        }
+        uplinks.pop_front();
+    }
+}
+
+void simRadioUplink(uint64_t atUs, float freq, const uint8_t* data, size_t length) {
+    Uplink up;
+    up.atUs = atUs;
+    up.freqMHz = freq;
+    up.data.assign(data, data + length);
+
+    // Ground may answer a downlink with an uplink ahead of ones already queued
+    std::deque<Uplink>::iterator it = uplinks.end();
+    while (it != uplinks.begin() && (it - 1)->atUs > atUs) --it;
+    uplinks.insert(it, up);
+}
+
+void simRadioOnDownlink(SimDownlinkHook hook) {
+    downlinkHook = hook;
+}
+
+const SimRadioStats& simRadioStats() {
+    return stats;
+}
+
+uint8_t simRadioSF() {
+    return sf;
+}
+
+// Semtech AN1200.13: explicit header, CRC on
+uint64_t simRadioTimeOnAirUs(size_t length) {
+    double symbolUs = (double)(1UL << sf) * 1000.0 / bwKHz;
+    int lowRate = symbolUs > 16000.0 ? 1 : 0;
+    int num = 8 * (int)length - 4 * sf + 28 + 16;
+    int den = 4 * (sf - 2 * lowRate);
+    int payloadSymbols = 8 + (num > 0 ? ((num + den - 1) / den) * cr : 0);
+    return (uint64_t)(((double)preamble + 4.25 + payloadSymbols) * symbolUs);
+}
+
+// ==================== SX1276 ====================
+
+int16_t SX1276::begin(float freq, float bw, uint8_t sfIn, uint8_t crIn, uint8_t syncWord,
+                      int8_t power, uint16_t preambleLength, uint8_t gain) {
+    (void)syncWord; (void)power; (void)gain;
+    freqMHz = freq;
+    bwKHz = bw;
+    sf = sfIn;
+    cr = crIn;
+    preamble = preambleLength;
+    mode = MODE_STANDBY;
+    txDoneAtUs = UINT64_MAX;
+    clearIrq();
+    begun = true;
+    return RADIOLIB_ERR_NONE;
+}
+
+int16_t SX1276::setFrequency(float freq) {
+    if (mode != MODE_STANDBY) return RADIOLIB_ERR_UNKNOWN;
+    freqMHz = freq;
+    return RADIOLIB_ERR_NONE;
+}
+
+int16_t SX1276::setSpreadingFactor(uint8_t sfIn) {
+    if (mode != MODE_STANDBY || sfIn < 6 || sfIn > 12) return RADIOLIB_ERR_UNKNOWN;
+    sf = sfIn;
+    return RADIOLIB_ERR_NONE;
+}
+
+int16_t SX1276::setCodingRate(uint8_t crIn) {
+    if (mode != MODE_STANDBY || crIn < 5 || crIn > 8) return RADIOLIB_ERR_UNKNOWN;
+    cr = crIn;
+    return RADIOLIB_ERR_NONE;
+}
+
+int16_t SX1276::standby() {
+    mode = MODE_STANDBY;
+    txDoneAtUs = UINT64_MAX;
+    clearIrq();
+    return RADIOLIB_ERR_NONE;
+}
+
+int16_t SX1276::sleep() {
+    return standby();
+}
+
+int16_t SX1276::startReceive() {
+    if (!begun) return RADIOLIB_ERR_CHIP_NOT_FOUND;
+    mode = MODE_RX;
+    clearIrq();
+    return RADIOLIB_ERR_NONE;
+}
+
+int16_t SX1276::startTransmit(const uint8_t* data, size_t len, uint8_t addr) {
+    (void)addr;
+    if (len > RADIOLIB_SX127X_MAX_PACKET_LENGTH) return RADIOLIB_ERR_PACKET_TOO_LONG;
+
+    uint64_t now = simMicros();
+    uint64_t toa = simRadioTimeOnAirUs(len);
+    mode = MODE_TX;
+    clearIrq();
+    txDoneAtUs = now + toa;
+    stats.downlinkBytes += len;
+    stats.airtimeUs += toa;
+    if (downlinkHook != NULL) downlinkHook(data, len, now);
+    return RADIOLIB_ERR_NONE;
+}
+
+int16_t SX1276::finishTransmit() {
+    return standby();
+}
+
+int16_t SX1276::readData(uint8_t* data, size_t len) {
+    size_t n = len < fifo.size() ? len : fifo.size();
+    if (n > 0) memcpy(data, fifo.data(), n);
+    clearIrq();
+    return RADIOLIB_ERR_NONE;
+}
+
+size_t SX1276::getPacketLength(bool update) {
+    (void)update;
+    return fifo.size();
+}
+
+float SX1276::getRSSI() {
+    return SIM_RSSI_DBM;
+}
+
+float SX1276::getSNR() {
+    return SIM_SNR_DB;
+}
+
+RadioLibTime_t SX1276::getTimeOnAir(size_t len) {
+    return (RadioLibTime_t)simRadioTimeOnAirUs(len);
+}
+
+void SX1276::setPacketReceivedAction(void (*func)(void)) {
+    dio0Action = func;
+}
+
+void SX1276::clearPacketReceivedAction() {
+    dio0Action = NULL;
+}
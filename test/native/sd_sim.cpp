@@ -0,0 +1,254 @@
+/*
+ * Orbital Temple - Host Simulation: SD card on a host directory
+ */
+
+#include <Arduino.h>
+#include <SD.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include "sim.h"
+
+SDFS SD;
+
+static std::string sdRoot = "sim_sd";
+
+static std::string hostPath(const char* path) {
+    std::string p = path ? path : "";
+    if (p.empty() || p[0] != '/') p = "/" + p;
+    return sdRoot + p;
+}
+
+struct fs::FileImpl {
+    std::string path;                   // SD path ("/accel/0001.bin")
+    std::string name;                   // Last component
+    FILE* fp = NULL;
+    bool dir = false;
+    std::vector<std::string> entries;   // Directory listing
+    size_t next = 0;
+
+    ~FileImpl() {
+        if (fp) fclose(fp);
+    }
+};
+
+void simSdAttach(const char* dir) {
+    sdRoot = dir;
+    ::mkdir(sdRoot.c_str(), 0755);
+}
+
+// ==================== FS ====================
+
+namespace fs {
+
+File FS::open(const char* path, const char* mode, bool create) {
+    (void)create;
+    std::string host = hostPath(path);
+    std::shared_ptr<FileImpl> f = std::make_shared<FileImpl>();
+    f->path = path;
+    size_t slash = f->path.find_last_of('/');
+    f->name = slash == std::string::npos ? f->path : f->path.substr(slash + 1);
+
+    struct stat st;
+    if (stat(host.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+        if (strcmp(mode, FILE_READ) != 0) return File();
+        DIR* d = opendir(host.c_str());
+        if (d == NULL) return File();
+        struct dirent* e;
+        while ((e = readdir(d)) != NULL) {
+            if (strcmp(e->d_name, ".") != 0 && strcmp(e->d_name, "..") != 0) {
+                f->entries.push_back(e->d_name);
+            }
+        }
+        closedir(d);
+        f->dir = true;
+        return File(f);
+    }
+
+    // "a" on the ESP32 VFS can also read back (used after a seek)
+    const char* hostMode = strcmp(mode, FILE_WRITE) == 0 ? "w+b"
+                         : strcmp(mode, FILE_APPEND) == 0 ? "a+b"
+                         : strcmp(mode, "r+") == 0 ? "r+b" : "rb";
+    f->fp = fopen(host.c_str(), hostMode);
+    if (f->fp == NULL) return File();
+    return File(f);
+}
+
+bool FS::exists(const char* path) {
+    struct stat st;
+    return stat(hostPath(path).c_str(), &st) == 0;
+}
+
+bool FS::mkdir(const char* path) {
+    return ::mkdir(hostPath(path).c_str(), 0755) == 0;
+}
+
+bool FS::rmdir(const char* path) {
+    return ::rmdir(hostPath(path).c_str()) == 0;
+}
+
+bool FS::remove(const char* path) {
+    return ::unlink(hostPath(path).c_str()) == 0;
+}
+
+bool FS::rename(const char* from, const char* to) {
+    return ::rename(hostPath(from).c_str(), hostPath(to).c_str()) == 0;
+}
+
+// ==================== FILE ====================
+
+File::operator bool() const {
+    return impl && (impl->fp != NULL || impl->dir);
+}
+
+bool File::isDirectory() const {
+    return impl && impl->dir;
+}
+
+File File::openNextFile(const char* mode) {
+    if (!isDirectory() || impl->next >= impl->entries.size()) return File();
+    std::string child = impl->path;
+    if (child.empty() || child[child.size() - 1] != '/') child += "/";
+    child += impl->entries[impl->next++];
+    return SD.open(child.c_str(), mode);
+}
+
+void File::rewindDirectory() {
+    if (isDirectory()) impl->next = 0;
+}
+
+const char* File::name() const {
+    return impl ? impl->name.c_str() : "";
+}
+
+const char* File::path() const {
+    return impl ? impl->path.c_str() : "";
+}
+
+size_t File::size() const {
+    if (!impl || !impl->fp) return 0;
+    fflush(impl->fp);
+    struct stat st;
+    return fstat(fileno(impl->fp), &st) == 0 ? (size_t)st.st_size : 0;
+}
+
+time_t File::getLastWrite() {
+    if (!impl || !impl->fp) return 0;
+    struct stat st;
+    return fstat(fileno(impl->fp), &st) == 0 ? st.st_mtime : 0;
+}
+
+int File::available() {
+    if (!impl || !impl->fp) return 0;
+    size_t pos = position();
+    size_t len = size();
+    return pos < len ? (int)(len - pos) : 0;
+}
+
+int File::peek() {
+    if (!impl || !impl->fp) return -1;
+    int c = fgetc(impl->fp);
+    if (c != EOF) ungetc(c, impl->fp);
+    return c == EOF ? -1 : c;
+}
+
+int File::read() {
+    if (!impl || !impl->fp) return -1;
+    int c = fgetc(impl->fp);
+    return c == EOF ? -1 : c;
+}
+
+size_t File::read(uint8_t* buf, size_t size) {
+    if (!impl || !impl->fp) return 0;
+    return fread(buf, 1, size, impl->fp);
+}
+
+size_t File::readBytesUntil(char terminator, char* buf, size_t size) {
+    size_t n = 0;
+    while (n < size) {
+        int c = read();
+        if (c < 0 || c == terminator) break;
+        buf[n++] = (char)c;
+    }
+    return n;
+}
+
+String File::readStringUntil(char terminator) {
+    std::string s;
+    int c;
+    while ((c = read()) >= 0 && c != terminator) s += (char)c;
+    return String(s);
+}
+
+String File::readString() {
+    std::string s;
+    int c;
+    while ((c = read()) >= 0) s += (char)c;
+    return String(s);
+}
+
+size_t File::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t File::write(const uint8_t* buf, size_t size) {
+    if (!impl || !impl->fp) return 0;
+    return fwrite(buf, 1, size, impl->fp);
+}
+
+void File::flush() {
+    if (impl && impl->fp) fflush(impl->fp);
+}
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+    if (!impl || !impl->fp) return false;
+    int whence = mode == SeekCur ? SEEK_CUR : mode == SeekEnd ? SEEK_END : SEEK_SET;
+    return fseek(impl->fp, (long)pos, whence) == 0;
+}
+
+size_t File::position() const {
+    if (!impl || !impl->fp) return 0;
+    long pos = ftell(impl->fp);
+    return pos < 0 ? 0 : (size_t)pos;
+}
+
+void File::close() {
+    impl.reset();
+}
+
+} // namespace fs
+
+// ==================== SD ====================
+
+bool SDFS::begin(uint8_t ssPin) {
+    (void)ssPin;
+    struct stat st;
+    return stat(sdRoot.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+sdcard_type_t SDFS::cardType() {
+    return begin() ? CARD_SDHC : CARD_NONE;
+}
+
+static uint64_t walk(const std::string& dir) {
+    uint64_t total = 0;
+    DIR* d = opendir(dir.c_str());
+    if (d == NULL) return 0;
+    struct dirent* e;
+    while ((e = readdir(d)) != NULL) {
+        if (strcmp(e->d_name, ".") == 0 || strcmp(e->d_name, "..") == 0) continue;
+        std::string p = dir + "/" + e->d_name;
+        struct stat st;
+        if (stat(p.c_str(), &st) != 0) continue;
+        // Whole 32 KB clusters, like FAT
+        total += S_ISDIR(st.st_mode) ? walk(p) + 32768 : ((uint64_t)st.st_size + 32767) / 32768 * 32768;
+    }
+    closedir(d);
+    return total;
+}
+
+uint64_t SDFS::usedBytes() {
+    return walk(sdRoot);
+}
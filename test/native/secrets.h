@@ -0,0 +1,20 @@
+#ifndef SECRETS_H
+#define SECRETS_H
+
+/*
+ * Orbital Temple - Host Simulation key
+ *
+ * Used only when no real secrets.h is in the source root (the root is
+ * searched first). NOT a flight key.
+ */
+
+#include <stdint.h>
+
+const uint8_t HMAC_KEY[32] = {
+    0x53, 0x49, 0x4d, 0x2d, 0x4f, 0x4e, 0x4c, 0x59,
+    0x53, 0x49, 0x4d, 0x2d, 0x4f, 0x4e, 0x4c, 0x59,
+    0x53, 0x49, 0x4d, 0x2d, 0x4f, 0x4e, 0x4c, 0x59,
+    0x53, 0x49, 0x4d, 0x2d, 0x4f, 0x4e, 0x4c, 0x59
+};
+
+#endif // SECRETS_H
@@ -0,0 +1,100 @@
+#ifndef SIM_H
+#define SIM_H
+
+/*
+ * Orbital Temple - Host Simulation
+ *
+ * The firmware sources built unmodified for a PC against the shims in
+ * this directory ([env:native] in platformio.ini, see README.md here).
+ *
+ * VIRTUAL CLOCK:
+ *   millis(), micros() and esp_timer_get_time() read a simulated clock
+ *   that starts at 0 at power-on. Every read costs SIM_CALL_COST_US, so a
+ *   loop polling the clock still makes progress; delay() and light sleep
+ *   advance it directly. Light sleep jumps to the earlier of its timer
+ *   wakeup and the next radio event, which is what turns a week of
+ *   beacons into a few seconds of host time.
+ *
+ *   unsigned long is 64 bits on the host, so millis() does not wrap at
+ *   49.7 days as it does on the ESP32.
+ *
+ * RADIO:
+ *   A model of the SX1276 as lora.cpp drives it. Uplinks are queued with
+ *   simRadioUplink() and raise DIO0 at their arrival time - but only if
+ *   the radio is then receiving on that frequency with LORA_SF/LORA_CR
+ *   (half duplex, like the real thing; otherwise the uplink is counted as
+ *   missed). A transmission raises DIO0 after its LoRa time on air, which
+ *   follows the spreading factor and coding rate it was sent with.
+ *
+ * SENSORS:
+ *   Battery and light follow a SIM_ORBIT_MIN orbit with an eclipse; the
+ *   IMU reads a slow tumble plus a fixed field. The antenna switch opens
+ *   SIM_DEPLOY_BURN_MS after the burn wire is switched on.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define SIM_CALL_COST_US      1ULL        // Virtual time per clock read
+#define SIM_ORBIT_MIN         95          // Orbit period (minutes)
+#define SIM_ECLIPSE_MIN       35          // Of which in Earth's shadow
+#define SIM_DEPLOY_BURN_MS    5000UL      // Burn wire on-time until the switch opens
+#define SIM_RSSI_DBM          -112.0f     // Reported for every uplink
+#define SIM_SNR_DB            6.5f
+
+// ==================== CLOCK ====================
+
+// Virtual microseconds since power-on
+uint64_t simMicros();
+
+// Move the clock forward, running every radio event that falls due
+void simAdvance(uint64_t us);
+
+// Maximum virtual gap between two watchdog feeds so far
+uint64_t simWatchdogMaxGapUs();
+uint32_t simWatchdogFeeds();
+
+// ==================== RADIO ====================
+
+struct SimRadioStats {
+    uint32_t uplinksDelivered;      // Raised DIO0 while receiving
+    uint32_t uplinksMissed;         // Arrived while transmitting / detuned
+    uint32_t downlinks;             // Completed transmissions
+    uint64_t downlinkBytes;
+    uint64_t airtimeUs;             // Sum of time on air
+};
+
+// Called when a transmission starts (data is the raw packet)
+typedef void (*SimDownlinkHook)(const uint8_t* data, size_t length, uint64_t atUs);
+
+// Queue an uplink arriving at atUs on freqMHz (kept in time order, so a
+// downlink hook can queue replies)
+void simRadioUplink(uint64_t atUs, float freqMHz, const uint8_t* data, size_t length);
+void simRadioOnDownlink(SimDownlinkHook hook);
+const SimRadioStats& simRadioStats();
+
+// Spreading factor the radio is set to (in a downlink hook: of that packet)
+uint8_t simRadioSF();
+
+// LoRa time on air of a packet with the current modem settings
+uint64_t simRadioTimeOnAirUs(size_t length);
+
+// Used by the clock: next pending radio event, UINT64_MAX if none
+uint64_t simRadioNextEventUs();
+void simRadioRun(uint64_t nowUs);
+
+// ==================== SENSORS ====================
+
+uint16_t simAdcRead(int pin);
+bool simAntennaSwitchClosed();
+void simBurnWire(bool on);
+
+// ==================== STORAGE ====================
+
+// Host directory standing in for the SD card (created if missing)
+void simSdAttach(const char* dir);
+
+// File holding the journal partition between runs, NULL for RAM only
+void simPartitionAttach(const char* path);
+
+#endif // SIM_H
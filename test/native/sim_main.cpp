@@ -0,0 +1,668 @@
+/*
+ * Orbital Temple - Host Simulation driver
+ *
+ * Boots the real firmware (setupGeneral()) and runs the same loop as
+ * main.ino against the virtual clock.
+ *
+ *   sim soak [days]            Fly for <days> (default 7): beacons, telemetry,
+ *                              and a ground pass every SIM_PASS_EVERY_MIN with
+ *                              signed Ping/Status uplinks; prints a summary
+ *   sim bench                  Time the hot paths on the host CPU
+ *   sim bench --save FILE      ... and write the results as a baseline
+ *   sim bench --baseline FILE  ... and fail if anything got slower than
+ *                              SIM_BENCH_TOLERANCE x the baseline
+ *
+ * Options (before the mode): --sd DIR (SD card directory, default sim_sd),
+ * --eeprom FILE (persist EEPROM between runs), --journal FILE (persist the
+ * state journal partition between runs).
+ *
+ * Exit status: 0 ok, 1 soak/bench check failed, 2 usage, 3 firmware restarted.
+ */
+
+#include <Arduino.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "config.h"
+#include "setup.h"
+#include "loop.h"
+#include "lora.h"
+#include "power.h"
+#include "perf.h"
+#include "crc32.h"
+#include "radiation.h"
+#include "upload.h"
+#include "names.h"
+#include "SD.h"
+#include "sim.h"
+
+#define SIM_PASS_FIRST_MIN    120     // First pass after power-on
+#define SIM_PASS_EVERY_MIN    (4 * SIM_ORBIT_MIN)
+#define SIM_PASS_LENGTH_S     480
+#define SIM_UPLOAD_AT_S       200     // Upload traffic starts this far into a pass
+#define SIM_UPLOAD_GAP_S      3       // Between chunk uplinks
+#define SIM_UPLOAD_PATH       "/sim_upload.txt"
+#define SIM_UPLOAD_NAMES      300     // ~3 KB, 24 chunks
+#define SIM_LINK_AT_S         420     // SetLinkProfile@AUTO, a listing, then an ack
+#define SIM_NAMES_AT_S        340     // NameBatch, then a query for a stored and an unknown name
+#define SIM_NAMES_PER_PASS    8
+#define SIM_BENCH_MIN_MS      200     // Host time per benchmark
+#define SIM_BENCH_TOLERANCE   1.5     // --baseline: slower than this x fails
+
+// ==================== GROUND STATION ====================
+// Signs uplinks with its own HMAC (straight from the definition, not
+// config.cpp's pre-keyed states), so a firmware HMAC bug shows up as
+// unanswered commands.
+
+static void groundHmac(const std::string& msg, char hex[17]) {
+    uint8_t pad[64];
+    uint8_t inner[32];
+    uint8_t outer[32];
+    mbedtls_sha256_context ctx;
+
+    memset(pad, 0x36, sizeof(pad));
+    for (int i = 0; i < HMAC_KEY_LENGTH; i++) pad[i] ^= HMAC_KEY[i];
+    mbedtls_sha256_init(&ctx);
+    mbedtls_sha256_starts(&ctx, 0);
+    mbedtls_sha256_update(&ctx, pad, sizeof(pad));
+    mbedtls_sha256_update(&ctx, (const uint8_t*)msg.data(), msg.size());
+    mbedtls_sha256_finish(&ctx, inner);
+
+    memset(pad, 0x5c, sizeof(pad));
+    for (int i = 0; i < HMAC_KEY_LENGTH; i++) pad[i] ^= HMAC_KEY[i];
+    mbedtls_sha256_starts(&ctx, 0);
+    mbedtls_sha256_update(&ctx, pad, sizeof(pad));
+    mbedtls_sha256_update(&ctx, inner, sizeof(inner));
+    mbedtls_sha256_finish(&ctx, outer);
+    mbedtls_sha256_free(&ctx);
+
+    for (int i = 0; i < 8; i++) snprintf(hex + 2 * i, 3, "%02x", outer[i]);
+}
+
+static std::string groundCommand(const char* cmd, const char* path, const char* data) {
+    std::string msg = std::string(sat_id.c_str()) + "-" + cmd + "&" + path + "@" + data;
+    char hex[17];
+    groundHmac(msg, hex);
+    return msg + "#" + hex;
+}
+
+struct GroundStats {
+    uint32_t passes;
+    uint32_t commandsSent;
+    uint32_t beacons;
+    uint32_t beaconsHeard;          // Sent while a pass was up
+    uint32_t telemetry;
+    uint32_t pongs;
+    uint32_t statusReplies;
+    uint32_t errors;                // "ERR:" replies
+    uint32_t linkGrants;            // "OK:LINK:" with a fast profile
+    uint32_t fastBulk;              // Listing frames received on a fast profile
+    uint32_t listFrames;            // "LS:" frames
+    uint32_t listings;              // Listings that reached "|END"
+    uint32_t listShort;             // ... with fewer entries than their total
+    uint32_t wrongProfile;          // Anything else not on LORA_SF
+    uint32_t namesStored;           // "OK:NAMES:" added counts
+    uint32_t nameBatches;
+    uint32_t nameAnswers;           // NameQuery replies as expected
+    uint32_t nameWrong;             // ... and not
+    uint32_t other;
+};
+
+static GroundStats ground;
+static std::vector<std::pair<uint64_t, uint64_t> > passWindows;
+
+static bool inPass(uint64_t us) {
+    for (size_t i = 0; i < passWindows.size(); i++) {
+        if (us >= passWindows[i].first && us < passWindows[i].second) return true;
+    }
+    return false;
+}
+
+static bool startsWith(const uint8_t* data, size_t length, const char* prefix) {
+    size_t n = strlen(prefix);
+    return length >= n && memcmp(data, prefix, n) == 0;
+}
+
+static uint64_t passEnd(uint64_t us) {
+    for (size_t i = 0; i < passWindows.size(); i++) {
+        if (us >= passWindows[i].first && us < passWindows[i].second) return passWindows[i].second;
+    }
+    return 0;
+}
+
+static void groundSend(uint64_t atUs, const char* cmd, const char* path, const char* data) {
+    std::string up = groundCommand(cmd, path, data);
+    simRadioUplink(atUs, LORA_FREQ_RX, (const uint8_t*)up.data(), up.size());
+    ground.commandsSent++;
+}
+
+// ==================== GROUND UPLOAD ====================
+// A names file sent as an upload session: the first upload pass sends
+// only half the chunks, the next one resumes from the UPACK bitmap.
+// Chunks the radio missed (it was transmitting) are resent the same way.
+
+struct GroundUpload {
+    std::string file;
+    unsigned id;
+    unsigned chunks;
+    bool begun;                 // Session opened at least once
+    bool done;
+    uint64_t statusAtUs;        // UPACK after this answers our UploadStatus
+    uint32_t chunksSent;
+    uint32_t passes;            // Passes that carried upload traffic
+};
+
+static GroundUpload upload;
+
+static std::string base64(const uint8_t* data, size_t length) {
+    static const char alphabet[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    for (size_t i = 0; i < length; i += 3) {
+        uint32_t v = (uint32_t)data[i] << 16;
+        if (i + 1 < length) v |= (uint32_t)data[i + 1] << 8;
+        if (i + 2 < length) v |= data[i + 2];
+        out += alphabet[(v >> 18) & 63];
+        out += alphabet[(v >> 12) & 63];
+        out += i + 1 < length ? alphabet[(v >> 6) & 63] : '=';
+        out += i + 2 < length ? alphabet[v & 63] : '=';
+    }
+    return out;
+}
+
+static void uploadPrepare() {
+    char line[32];
+    for (int i = 0; i < SIM_UPLOAD_NAMES; i++) {
+        snprintf(line, sizeof(line), "Ascended name %04d\n", i * 37 % 10000);
+        upload.file += line;
+    }
+    upload.chunks = (unsigned)((upload.file.size() + UPLOAD_CHUNK_SIZE - 1) / UPLOAD_CHUNK_SIZE);
+}
+
+static void uploadBeginAt(uint64_t atUs) {
+    char data[32];
+    uint32_t crc = crc32Final(crc32Update(crc32Begin(), (const uint8_t*)upload.file.data(),
+                                          upload.file.size()));
+    snprintf(data, sizeof(data), "%u,%08X", (unsigned)upload.file.size(), (unsigned)crc);
+    groundSend(atUs, "UploadBegin", SIM_UPLOAD_PATH, data);
+    upload.statusAtUs = atUs;
+}
+
+// Send the chunks whose bit is clear (all if have is NULL) that fit in the
+// pass, at most limit, then ask for an UPACK if askStatus
+static void uploadSendMissing(uint64_t fromUs, const std::vector<bool>* have, unsigned limit,
+                              bool askStatus) {
+    uint64_t endUs = passEnd(fromUs);
+    uint64_t at = fromUs + SIM_UPLOAD_GAP_S * 1000000ULL;
+    unsigned sent = 0;
+    char path[24];
+    for (unsigned seq = 0; seq < upload.chunks && sent < limit; seq++) {
+        if (have != NULL && (*have)[seq]) continue;
+        if (at + 2 * SIM_UPLOAD_GAP_S * 1000000ULL >= endUs) break;
+        size_t start = (size_t)seq * UPLOAD_CHUNK_SIZE;
+        size_t n = std::min((size_t)UPLOAD_CHUNK_SIZE, upload.file.size() - start);
+        std::string chunk = base64((const uint8_t*)upload.file.data() + start, n);
+        snprintf(path, sizeof(path), "%u,%u", upload.id, seq);
+        groundSend(at, "UploadChunk", path, chunk.c_str());
+        upload.chunksSent++;
+        sent++;
+        at += SIM_UPLOAD_GAP_S * 1000000ULL;
+    }
+    if (askStatus && at < endUs) {
+        char id[8];
+        snprintf(id, sizeof(id), "%u", upload.id);
+        groundSend(at, "UploadStatus", id, "");
+        upload.statusAtUs = at;
+    }
+}
+
+static void uploadDownlink(const uint8_t* data, size_t length, uint64_t atUs) {
+    std::string reply((const char*)data, length);
+    unsigned id, chunk, chunks, received;
+
+    if (sscanf(reply.c_str(), "OK:UPLOAD:%u,%u,%u,%u", &id, &chunk, &chunks, &received) == 4) {
+        upload.id = id;
+        if (received == 0) {
+            upload.statusAtUs = UINT64_MAX;     // No UPACK follows a fresh session
+            // Fresh session: the first time only half goes up this pass
+            if (upload.begun) {
+                uploadSendMissing(atUs, NULL, upload.chunks, true);
+            } else {
+                uploadSendMissing(atUs, NULL, upload.chunks / 2, false);
+            }
+        }
+        upload.begun = true;
+    } else if (sscanf(reply.c_str(), "UPACK:%u,%u/%u,", &id, &received, &chunks) == 3) {
+        // Progress UPACKs every UPLOAD_ACK_EVERY chunks are not answered
+        if (atUs <= upload.statusAtUs || id != upload.id) return;
+        upload.statusAtUs = UINT64_MAX;
+        const char* hex = strchr(strchr(reply.c_str(), ',') + 1, ',') + 1;
+        std::vector<bool> have(upload.chunks, false);
+        for (unsigned seq = 0; seq < upload.chunks; seq++) {
+            unsigned byte = 0;
+            sscanf(hex + 2 * (seq / 8), "%2x", &byte);
+            have[seq] = (byte >> (seq % 8)) & 1;
+        }
+        uploadSendMissing(atUs, &have, upload.chunks, true);
+    } else if (startsWith(data, length, "OK:UPLOAD_DONE:")) {
+        upload.done = true;
+    }
+}
+
+// True if the card holds exactly what ground uploaded
+static bool uploadVerify() {
+    File f = SD.open(SIM_UPLOAD_PATH, FILE_READ);
+    if (!f) return false;
+    std::string content;
+    uint8_t buf[256];
+    size_t n;
+    while ((n = f.read(buf, sizeof(buf))) > 0) content.append((const char*)buf, n);
+    f.close();
+    return content == upload.file;
+}
+
+static bool bulkLine(const uint8_t* data, size_t length) {
+    return startsWith(data, length, "LS:") || startsWith(data, length, "DIR:") ||
+           startsWith(data, length, "D:") || startsWith(data, length, "F:") ||
+           startsWith(data, length, "END:DIR");
+}
+
+// ==================== GROUND LISTING ====================
+// Every pass lists "/" in one page: the frames together must hold as many
+// entries as the first one says the directory has.
+
+static void listDownlink(const uint8_t* data, size_t length) {
+    static uint32_t entries = 0;
+    std::string frame((const char*)data, length);
+    unsigned long version, first, total;
+    if (sscanf(frame.c_str(), "LS:%lx,%lu,%lu", &version, &first, &total) != 3) {
+        ground.other++;
+        return;
+    }
+
+    ground.listFrames++;
+    if (first == 0) entries = 0;
+    for (size_t at = frame.find('|'); at != std::string::npos; at = frame.find('|', at + 1)) {
+        if (frame.compare(at, 3, "|D:") == 0 || frame.compare(at, 3, "|F:") == 0) entries++;
+    }
+    if (frame.find("|END") != std::string::npos) {
+        ground.listings++;
+        if (entries != total) {
+            ground.listShort++;
+            printf("[SIM] Listing of %lu entries ended after %lu\n", total, (unsigned long)entries);
+        }
+    }
+}
+
+// ==================== GROUND NAMES ====================
+// Every pass sends a batch of new names plus one from the previous pass
+// (must come back as a duplicate), then asks for a stored name from the
+// previous batch and for one never sent.
+
+static std::vector<bool> nameExpect;        // Outstanding queries: PRESENT?
+static size_t nameExpectNext = 0;
+
+static std::string simName(size_t pass, int i) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "Pass %u Name %d", (unsigned)pass, i);
+    return buf;
+}
+
+static void namesDownlink(const uint8_t* data, size_t length) {
+    if (startsWith(data, length, "OK:NAMES:")) {
+        ground.nameBatches++;
+        ground.namesStored += strtoul((const char*)data + 9, NULL, 10);
+        return;
+    }
+    bool present = startsWith(data, length, "NAME:PRESENT:");
+    if (nameExpectNext < nameExpect.size() && nameExpect[nameExpectNext++] == present) {
+        ground.nameAnswers++;
+    } else {
+        ground.nameWrong++;
+        printf("[SIM] Unexpected name reply: %.*s\n", (int)length, (const char*)data);
+    }
+}
+
+// Queued once the pass has started, so the query only asks for the
+// previous batch if it was acknowledged
+static void namesPassTick() {
+    static size_t nextPass = 0;
+    static uint32_t lastBatches = 0;
+    if (nextPass >= passWindows.size() || simMicros() < passWindows[nextPass].first) return;
+
+    uint64_t at = passWindows[nextPass].first + SIM_NAMES_AT_S * 1000000ULL;
+    std::string batch;
+    for (int i = 0; i < SIM_NAMES_PER_PASS; i++) {
+        batch += simName(nextPass, i) + "|";
+    }
+    bool previous = nextPass > 0 && ground.nameBatches > lastBatches;
+    if (nextPass > 0) batch += simName(nextPass - 1, 0);
+    groundSend(at, "NameBatch", "", batch.c_str());
+
+    if (previous) {
+        groundSend(at + 10000000ULL, "NameQuery", "", simName(nextPass - 1, 3).c_str());
+        nameExpect.push_back(true);
+    }
+    groundSend(at + 20000000ULL, "NameQuery", "", ("Never " + simName(nextPass, 0)).c_str());
+    nameExpect.push_back(false);
+
+    lastBatches = ground.nameBatches;
+    nextPass++;
+}
+
+static void onDownlink(const uint8_t* data, size_t length, uint64_t atUs) {
+    // Only bulk data may leave the safe modem settings
+    if (simRadioSF() != LORA_SF) {
+        if (bulkLine(data, length)) {
+            ground.fastBulk++;
+        } else {
+            ground.wrongProfile++;
+            printf("[SIM] Downlink on SF%u: %.*s\n", simRadioSF(), (int)length, (const char*)data);
+        }
+    }
+
+    if (length > 0 && data[0] == TELEM_FRAME_TYPE) {
+        ground.telemetry++;
+        if (inPass(atUs)) ground.statusReplies++;
+    } else if (startsWith(data, length, "Andar") || startsWith(data, length, "Ainda") ||
+               startsWith(data, length, "Por mais")) {
+        ground.beacons++;
+        if (inPass(atUs)) ground.beaconsHeard++;
+    } else if (startsWith(data, length, "PONG")) {
+        ground.pongs++;
+    } else if (startsWith(data, length, "LS:")) {
+        listDownlink(data, length);
+    } else if (startsWith(data, length, "OK:UPLOAD") || startsWith(data, length, "UPACK:")) {
+        uploadDownlink(data, length, atUs);
+    } else if (startsWith(data, length, "OK:NAMES:") || startsWith(data, length, "NAME:")) {
+        namesDownlink(data, length);
+    } else if (startsWith(data, length, "OK:LINK:") && !startsWith(data, length, "OK:LINK:0")) {
+        ground.linkGrants++;
+    } else if (startsWith(data, length, "ERR:")) {
+        ground.errors++;
+        printf("[SIM] Downlink error reply: %.*s\n", (int)length, (const char*)data);
+    } else {
+        ground.other++;
+    }
+}
+
+static void schedulePasses(uint64_t endUs) {
+    const char* const cmds[] = { "Ping", "Status", "Ping" };
+    const uint64_t offsetsS[] = { 30, 90, 150 };
+
+    for (uint64_t start = (uint64_t)SIM_PASS_FIRST_MIN * 60000000ULL; start < endUs;
+         start += (uint64_t)SIM_PASS_EVERY_MIN * 60000000ULL) {
+        passWindows.push_back(std::make_pair(start, start + SIM_PASS_LENGTH_S * 1000000ULL));
+        for (int i = 0; i < 3; i++) {
+            groundSend(start + offsetsS[i] * 1000000ULL, cmds[i], "", "");
+        }
+
+        // Faster bulk with the pass's link margin; the Ping acks the listing
+        uint64_t link = start + SIM_LINK_AT_S * 1000000ULL;
+        groundSend(link, "SetLinkProfile", "", "AUTO");
+        groundSend(link + 10000000ULL, "ListDir", "/", "");
+        groundSend(link + 40000000ULL, "Ping", "", "");
+        ground.passes++;
+    }
+}
+
+// Each pass from the second on opens (or resumes) the upload until it is
+// done; queued once the pass has started, so it sees the last pass's result
+static void uploadPassTick() {
+    static size_t nextPass = 1;
+    if (upload.done || nextPass >= passWindows.size()) return;
+
+    uint64_t at = passWindows[nextPass].first + SIM_UPLOAD_AT_S * 1000000ULL;
+    if (simMicros() < passWindows[nextPass].first) return;
+    if (simMicros() < at) {
+        uploadBeginAt(at);
+        upload.passes++;
+    }
+    nextPass++;
+}
+
+// ==================== SOAK ====================
+
+static int runSoak(double days) {
+    uint64_t endUs = (uint64_t)(days * 86400e6);
+    schedulePasses(endUs);
+    uploadPrepare();
+    simRadioOnDownlink(onDownlink);
+
+    auto hostStart = std::chrono::steady_clock::now();
+    uint64_t loops = 0;
+    while (simMicros() < endUs) {
+        uploadPassTick();
+        namesPassTick();
+        mainLoop();
+        idleSleep(mainLoopIdleTime());
+        loops++;
+    }
+    double hostS = std::chrono::duration<double>(std::chrono::steady_clock::now() - hostStart).count();
+
+    const SimRadioStats& radio = simRadioStats();
+    double simS = simMicros() / 1e6;
+    char perfLine[PERF_SUMMARY_MAX];
+    perfSummary(perfLine, sizeof(perfLine));
+
+    printf("\n========== SIMULATION SUMMARY ==========\n");
+    printf("Simulated:    %.2f days in %.2f s host (%.0fx), %llu loop iterations\n",
+           simS / 86400.0, hostS, simS / (hostS > 0 ? hostS : 1e-9), (unsigned long long)loops);
+    printf("State:        %d (antenna %s), boot #%lu\n", (int)currentState,
+           antennaDeployed ? "deployed" : "NOT deployed", (unsigned long)bootCount);
+    printf("Passes:       %lu, %lu commands sent\n",
+           (unsigned long)ground.passes, (unsigned long)ground.commandsSent);
+    printf("Uplinks:      %lu delivered, %lu missed (radio busy / detuned)\n",
+           (unsigned long)radio.uplinksDelivered, (unsigned long)radio.uplinksMissed);
+    printf("Replies:      %lu PONG, %lu telemetry in pass, %lu errors, %lu other\n",
+           (unsigned long)ground.pongs, (unsigned long)ground.statusReplies,
+           (unsigned long)ground.errors, (unsigned long)ground.other);
+    printf("Downlinks:    %lu (%llu bytes, %.1f s on air, duty %.3f%%)\n",
+           (unsigned long)radio.downlinks, (unsigned long long)radio.downlinkBytes,
+           radio.airtimeUs / 1e6, 100.0 * radio.airtimeUs / (simS * 1e6));
+    printf("  beacons     %lu (%lu heard during passes)\n",
+           (unsigned long)ground.beacons, (unsigned long)ground.beaconsHeard);
+    printf("  telemetry   %lu\n", (unsigned long)ground.telemetry);
+    printf("Link:         %lu fast profile grants, %lu listing frames on them, %lu other packets off SF%d\n",
+           (unsigned long)ground.linkGrants, (unsigned long)ground.fastBulk,
+           (unsigned long)ground.wrongProfile, LORA_SF);
+    printf("Listings:     %lu complete in %lu frames, %lu short\n",
+           (unsigned long)ground.listings, (unsigned long)ground.listFrames,
+           (unsigned long)ground.listShort);
+    printf("Upload:       %s, %u chunks in %lu uplinks over %lu passes%s\n",
+           upload.done ? "done" : (upload.begun ? "incomplete" : "not started"), upload.chunks,
+           (unsigned long)upload.chunksSent, (unsigned long)upload.passes,
+           upload.done ? (uploadVerify() ? ", file matches" : ", FILE DIFFERS") : "");
+    printf("Names:        %lu stored in %lu batches (ledger %lu), %lu queries answered, %lu wrong\n",
+           (unsigned long)ground.namesStored, (unsigned long)ground.nameBatches,
+           (unsigned long)nameCount(), (unsigned long)ground.nameAnswers,
+           (unsigned long)ground.nameWrong);
+    printf("TX queue:     max depth %u, %lu drops\n",
+           (unsigned)txQueueMaxDepth(), (unsigned long)txQueueDrops());
+    printf("Sleep:        %.1f%% of uptime, %lu sleeps, %lu radio wakes\n",
+           sleepPermille() / 10.0, (unsigned long)sleepCount(), (unsigned long)sleepRadioWakes());
+    printf("Watchdog:     %lu feeds, longest gap %.1f s (timeout %d s)\n",
+           (unsigned long)simWatchdogFeeds(), simWatchdogMaxGapUs() / 1e6, WDT_TIMEOUT_SECONDS);
+    printf("Host timing:  %s\n", perfLine);
+    printf("========================================\n");
+
+    // The firmware must have answered every Ping it received, three passes
+    // are enough for the upload, only bulk left the safe profile and the
+    // ledger holds each name once; listings hold every entry they count
+    bool uploadOk = ground.passes < 3 || (upload.done && uploadVerify());
+    bool linkOk = ground.wrongProfile == 0 && (ground.passes < 2 || ground.fastBulk > 0);
+    bool namesOk = ground.nameWrong == 0 && ground.nameAnswers > 0 &&
+                   ground.namesStored == nameCount() &&
+                   ground.namesStored == ground.nameBatches * SIM_NAMES_PER_PASS;
+    bool listOk = ground.listShort == 0 && (ground.passes < 2 || ground.listings > 0);
+    bool ok = antennaDeployed && simWatchdogMaxGapUs() < WDT_TIMEOUT_SECONDS * 1000000ULL &&
+              ground.errors == 0 && ground.pongs > 0 && uploadOk && linkOk &&
+              namesOk && listOk;
+    printf(ok ? "SOAK CHECK PASSED\n" : "SOAK CHECK FAILED\n");
+    return ok ? 0 : 1;
+}
+
+// ==================== BENCH ====================
+
+struct BenchResult {
+    std::string name;
+    double nsPerOp;
+};
+
+static std::vector<BenchResult> results;
+static volatile uint32_t benchSink;
+
+template <typename F>
+static void bench(const char* name, F fn) {
+    using clock = std::chrono::steady_clock;
+    uint64_t iterations = 0;
+    uint64_t batch = 16;
+    auto start = clock::now();
+    double elapsedNs = 0;
+
+    while (elapsedNs < SIM_BENCH_MIN_MS * 1e6 || iterations < 1000) {
+        for (uint64_t i = 0; i < batch; i++) fn();
+        iterations += batch;
+        elapsedNs = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+        if (batch < 65536) batch *= 2;
+    }
+
+    BenchResult r = { name, elapsedNs / iterations };
+    results.push_back(r);
+    printf("BENCH %-26s %12.1f ns/op  (%llu iterations)\n",
+           name, r.nsPerOp, (unsigned long long)iterations);
+}
+
+static int runBench(const char* saveFile, const char* baselineFile) {
+    // ---- Parser + HMAC on a real uplink ----
+    std::string ping = groundCommand("Ping", "", "");
+    std::vector<char> buf(ping.size() + 1);
+    bench("validateMessage(Ping)", [&]() {
+        memcpy(buf.data(), ping.data(), ping.size());
+        ParsedMessage msg;
+        benchSink += validateMessage(buf.data(), ping.size(), msg);
+    });
+
+    std::string signedPart = ping.substr(0, ping.find('#'));
+    std::string tag = ping.substr(ping.find('#') + 1);
+    bench("verifyHMAC(64 B)", [&]() {
+        benchSink += verifyHMAC((const uint8_t*)signedPart.data(), signedPart.size(),
+                                tag.data(), tag.size());
+    });
+
+    String msg(signedPart.c_str());
+    bench("calculateHMAC(String)", [&]() {
+        benchSink += calculateHMAC(msg).length();
+    });
+
+    // ---- CRC32 over a 4 KB buffer (one SD log sector batch) ----
+    static uint8_t block[4096];
+    for (size_t i = 0; i < sizeof(block); i++) block[i] = (uint8_t)(i * 31 + 7);
+    bench("crc32Update(4 KB)", [&]() {
+        benchSink += crc32Update(crc32Begin(), block, sizeof(block));
+    });
+    bench("crc32UpdateSlice8(4 KB)", [&]() {
+        benchSink += crc32UpdateSlice8(crc32Begin(), block, sizeof(block));
+    });
+    bench("crc32UpdateTable(4 KB)", [&]() {
+        benchSink += crc32UpdateTable(crc32Begin(), block, sizeof(block));
+    });
+    bench("crc32UpdateLegacy(4 KB)", [&]() {
+        benchSink += crc32UpdateLegacy(crc32Begin(), block, sizeof(block));
+    });
+
+    // ---- Periodic jobs ----
+    bench("scrubAllTMR()", [&]() {
+        benchSink += scrubAllTMR();
+    });
+    bench("buildTextTelemetry()", [&]() {
+        benchSink += strlen(buildTextTelemetry());
+    });
+    bench("buildBinaryTelemetry()", [&]() {
+        benchSink += buildBinaryTelemetry();
+    });
+
+    if (saveFile != NULL) {
+        FILE* f = fopen(saveFile, "w");
+        if (f == NULL) {
+            printf("Cannot write %s\n", saveFile);
+            return 1;
+        }
+        for (size_t i = 0; i < results.size(); i++) {
+            fprintf(f, "%s %.1f\n", results[i].name.c_str(), results[i].nsPerOp);
+        }
+        fclose(f);
+        printf("Baseline written to %s\n", saveFile);
+    }
+
+    int regressions = 0;
+    if (baselineFile != NULL) {
+        FILE* f = fopen(baselineFile, "r");
+        if (f == NULL) {
+            printf("Cannot read %s\n", baselineFile);
+            return 1;
+        }
+        char name[64];
+        double ns;
+        while (fscanf(f, "%63s %lf", name, &ns) == 2) {
+            for (size_t i = 0; i < results.size(); i++) {
+                if (results[i].name != name) continue;
+                double ratio = results[i].nsPerOp / ns;
+                bool slow = ratio > SIM_BENCH_TOLERANCE;
+                printf("%-6s %-26s %10.1f -> %10.1f ns/op (x%.2f)\n",
+                       slow ? "SLOWER" : "ok", name, ns, results[i].nsPerOp, ratio);
+                if (slow) regressions++;
+            }
+        }
+        fclose(f);
+        if (regressions > 0) printf("%d benchmark(s) regressed\n", regressions);
+    }
+    return regressions > 0 ? 1 : 0;
+}
+
+// ==================== MAIN ====================
+
+static int usage() {
+    printf("usage: sim [--sd DIR] [--eeprom FILE] [--journal FILE] soak [days]\n"
+           "       sim [--sd DIR] [--eeprom FILE] [--journal FILE] bench [--save FILE | --baseline FILE]\n");
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    const char* sdDir = "sim_sd";
+    const char* eepromFile = NULL;
+    const char* journalFile = NULL;
+    int i = 1;
+    for (; i + 1 < argc && argv[i][0] == '-'; i += 2) {
+        if (strcmp(argv[i], "--sd") == 0) sdDir = argv[i + 1];
+        else if (strcmp(argv[i], "--eeprom") == 0) eepromFile = argv[i + 1];
+        else if (strcmp(argv[i], "--journal") == 0) journalFile = argv[i + 1];
+        else return usage();
+    }
+    if (i >= argc) return usage();
+    const char* mode = argv[i++];
+
+    simSdAttach(sdDir);
+    EEPROM.simAttach(eepromFile);
+    simPartitionAttach(journalFile);
+
+    // As main.ino's setup()
+    Serial.begin(115200);
+    setupGeneral();
+
+    if (strcmp(mode, "soak") == 0) {
+        double days = i < argc ? atof(argv[i]) : 7.0;
+        if (days <= 0) return usage();
+        return runSoak(days);
+    }
+    if (strcmp(mode, "bench") == 0) {
+        const char* save = NULL;
+        const char* baseline = NULL;
+        if (i + 1 < argc && strcmp(argv[i], "--save") == 0) save = argv[i + 1];
+        else if (i + 1 < argc && strcmp(argv[i], "--baseline") == 0) baseline = argv[i + 1];
+        else if (i < argc) return usage();
+        return runBench(save, baseline);
+    }
+    return usage();
+}
@@ -0,0 +1,206 @@
+/*
+ * Orbital Temple - Bloom Filter Unit Tests
+ *
+ * Checks that bloom.cpp never denies a name it was given, that its false
+ * positive rate stays near the design figure at the sized capacity, and
+ * how it degrades past that in the name ledger's fixed array (names.cpp).
+ *
+ * Compile: g++ -std=c++11 -O2 -o test_bloom test_bloom.cpp
+ * Run: ./test_bloom
+ */
+
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <string>
+#include <stdexcept>
+
+// Module under test (and the CRC32 engine it hashes with)
+#include "../crc32.cpp"
+#include "../bloom.cpp"
+#include "../names.h"
+
+// ==================== TEST FRAMEWORK ====================
+
+int tests_passed = 0;
+int tests_failed = 0;
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Test: " << #name << "... "; \
+    try { \
+        test_##name(); \
+        std::cout << "PASS" << std::endl; \
+        tests_passed++; \
+    } catch (const std::exception& e) { \
+        std::cout << "FAIL: " << e.what() << std::endl; \
+        tests_failed++; \
+    } \
+} while(0)
+
+#define ASSERT(condition) do { \
+    if (!(condition)) { \
+        throw std::runtime_error("Assertion failed: " #condition); \
+    } \
+} while(0)
+
+#define ASSERT_EQ(a, b) do { \
+    if ((a) != (b)) { \
+        throw std::runtime_error("Assertion failed: " #a " != " #b); \
+    } \
+} while(0)
+
+#define SMALL_BYTES 512
+
+static uint8_t storage[NAMES_BLOOM_BYTES];
+
+static BloomKey key(const std::string& s) {
+    return bloomHash((const uint8_t*)s.data(), s.size());
+}
+
+static std::string name(const char* prefix, int i) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%s %d", prefix, i);
+    return buf;
+}
+
+// Fraction of never-added names reported as maybe present
+static double falsePositiveRate(const Bloom& b, int probes) {
+    int hits = 0;
+    for (int i = 0; i < probes; i++) {
+        if (bloomMayContain(b, key(name("Absent", i)))) hits++;
+    }
+    return (double)hits / probes;
+}
+
+// ==================== TESTS ====================
+
+TEST(empty_contains_nothing) {
+    Bloom b;
+    bloomInit(b, storage, SMALL_BYTES);
+    ASSERT(!bloomMayContain(b, key("Maria")));
+    ASSERT(!bloomMayContain(b, key("")));
+    ASSERT_EQ(b.count, 0u);
+}
+
+TEST(no_filter_is_always_maybe) {
+    Bloom b = { NULL, 0, 0 };
+    ASSERT(bloomMayContain(b, key("Maria")));
+}
+
+TEST(added_names_always_found) {
+    Bloom b;
+    bloomInit(b, storage, 4096);
+    for (int i = 0; i < 2000; i++) bloomAdd(b, key(name("Name", i)));
+    for (int i = 0; i < 2000; i++) ASSERT(bloomMayContain(b, key(name("Name", i))));
+    ASSERT_EQ(b.count, 2000u);
+}
+
+TEST(hashes_differ_and_h2_odd) {
+    BloomKey a = key("Ana");
+    BloomKey b = key("Anb");
+    ASSERT(a.h1 != b.h1);
+    ASSERT(a.h2 != b.h2);
+    ASSERT((a.h2 & 1) == 1);
+    ASSERT((b.h2 & 1) == 1);
+
+    // h1 is the repo's CRC32
+    ASSERT_EQ(key("123456789").h1, 0xCBF43926u);
+}
+
+TEST(false_positive_rate_at_capacity) {
+    // Filled to exactly its sized capacity: about 1% at 10 bits, k = 7
+    Bloom b;
+    size_t bytes = 4096;
+    bloomInit(b, storage, bytes);
+    int entries = (int)(bytes * 8 / BLOOM_BITS_PER_ENTRY);
+    for (int i = 0; i < entries; i++) bloomAdd(b, key(name("Name", i)));
+    ASSERT(!bloomFull(b));
+
+    double rate = falsePositiveRate(b, 20000);
+    std::cout << "(" << rate * 100 << "% at " << entries << " names) ";
+    ASSERT(rate < 0.02);
+}
+
+TEST(false_positive_rate_with_headroom) {
+    // The ledger's array with well under its design count
+    Bloom b;
+    bloomInit(b, storage, NAMES_BLOOM_BYTES);
+    for (int i = 0; i < 3000; i++) bloomAdd(b, key(name("Name", i)));
+    double rate = falsePositiveRate(b, 20000);
+    ASSERT(rate < 0.002);
+}
+
+TEST(similar_names_separate) {
+    // Case, spacing and one-letter changes are different names
+    Bloom b;
+    bloomInit(b, storage, SMALL_BYTES);
+    bloomAdd(b, key("Maria Silva"));
+    ASSERT(bloomMayContain(b, key("Maria Silva")));
+    ASSERT(!bloomMayContain(b, key("maria silva")));
+    ASSERT(!bloomMayContain(b, key("Maria  Silva")));
+    ASSERT(!bloomMayContain(b, key("Maria Silvb")));
+}
+
+TEST(past_design_load_degrades_slowly) {
+    // The ledger never resizes: a quarter past capacity stays a few percent
+    Bloom b;
+    bloomInit(b, storage, NAMES_BLOOM_BYTES);
+    int entries = NAMES_BLOOM_BYTES * 8 / BLOOM_BITS_PER_ENTRY * 5 / 4;
+    for (int i = 0; i < entries; i++) bloomAdd(b, key(name("Name", i)));
+    ASSERT(bloomFull(b));
+
+    double rate = falsePositiveRate(b, 20000);
+    std::cout << "(" << rate * 100 << "% at " << entries << " names) ";
+    ASSERT(rate < 0.04);
+}
+
+TEST(full_after_capacity) {
+    Bloom b;
+    bloomInit(b, storage, SMALL_BYTES);
+    int capacity = SMALL_BYTES * 8 / BLOOM_BITS_PER_ENTRY;
+    for (int i = 0; i < capacity; i++) bloomAdd(b, key(name("Name", i)));
+    ASSERT(!bloomFull(b));
+    bloomAdd(b, key("One more"));
+    ASSERT(bloomFull(b));
+}
+
+TEST(init_clears_storage) {
+    memset(storage, 0xFF, sizeof(storage));
+    Bloom b;
+    bloomInit(b, storage, 1024);
+    ASSERT(!bloomMayContain(b, key("Maria")));
+    ASSERT_EQ(storage[1023], 0);
+    ASSERT_EQ(storage[1024], 0xFF);     // Only its own bytes
+}
+
+// ==================== MAIN ====================
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "  ORBITAL TEMPLE BLOOM UNIT TESTS" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << std::endl;
+
+    crc32Init();
+
+    RUN_TEST(empty_contains_nothing);
+    RUN_TEST(no_filter_is_always_maybe);
+    RUN_TEST(added_names_always_found);
+    RUN_TEST(hashes_differ_and_h2_odd);
+    RUN_TEST(false_positive_rate_at_capacity);
+    RUN_TEST(false_positive_rate_with_headroom);
+    RUN_TEST(similar_names_separate);
+    RUN_TEST(past_design_load_degrades_slowly);
+    RUN_TEST(full_after_capacity);
+    RUN_TEST(init_clears_storage);
+
+    std::cout << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "  RESULTS: " << tests_passed << " passed, "
+              << tests_failed << " failed" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,140 @@
+/*
+ * Orbital Temple - Analog Calibration Unit Tests
+ *
+ * Checks the compile-time thermistor table against the exact
+ * B-parameter equation, the fault bounds, and the linear battery and
+ * luminosity factors against the V1.21 formulas (calib.cpp).
+ *
+ * Compile: g++ -std=c++11 -O2 -o test_calib test_calib.cpp
+ * Run: ./test_calib
+ */
+
+#include <iostream>
+#include <cstdint>
+#include <cmath>
+#include <string>
+#include <stdexcept>
+
+// Conversions under test
+#include "../calib.cpp"
+
+// ==================== TEST FRAMEWORK ====================
+
+int tests_passed = 0;
+int tests_failed = 0;
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Test: " << #name << "... "; \
+    try { \
+        test_##name(); \
+        std::cout << "PASS" << std::endl; \
+        tests_passed++; \
+    } catch (const std::exception& e) { \
+        std::cout << "FAIL: " << e.what() << std::endl; \
+        tests_failed++; \
+    } \
+} while(0)
+
+#define ASSERT_NEAR(expected, actual, tol) do { \
+    if (std::fabs((double)(expected) - (double)(actual)) > (tol)) { \
+        throw std::runtime_error("Expected " + std::to_string(expected) + " but got " + std::to_string(actual)); \
+    } \
+} while(0)
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        throw std::runtime_error("Assertion failed: " #cond); \
+    } \
+} while(0)
+
+// The table must be a constant expression (built by the compiler)
+static_assert(thermTable.c[1] > thermTable.c[THERM_LUT_SIZE - 2],
+              "Thermistor table must be available at compile time");
+
+// ==================== TESTS ====================
+
+TEST(mid_scale_is_reference_temperature) {
+    // Equal resistances: Rt = R0 at 25 C
+    ASSERT_NEAR(25.0, calibThermistorC(2047.5f), 0.01);
+    ASSERT_NEAR(25.0, calibThermistorExactC(2047.5), 1e-9);
+}
+
+TEST(table_matches_exact_curve) {
+    double worst = 0.0;
+    for (double adc = THERM_ADC_MIN; adc <= THERM_ADC_MAX; adc += 0.25) {
+        double exact = calibThermistorExactC(adc);
+        if (exact < -20.0 || exact > 100.0) continue;
+        double err = std::fabs(calibThermistorC((float)adc) - exact);
+        if (err > worst) worst = err;
+    }
+    ASSERT_TRUE(worst < 0.02);
+}
+
+TEST(table_within_quarter_degree_to_150C) {
+    // Steepest curvature at the hot end, where counts are few
+    for (double adc = THERM_ADC_MIN; adc <= THERM_ADC_MAX; adc += 1.0) {
+        double exact = calibThermistorExactC(adc);
+        if (exact > 150.0) continue;
+        ASSERT_NEAR(exact, calibThermistorC((float)adc), 0.25);
+    }
+}
+
+TEST(colder_is_higher_count) {
+    float last = calibThermistorC((float)THERM_ADC_MIN);
+    for (double adc = THERM_ADC_MIN + 1.0; adc <= THERM_ADC_MAX; adc += 1.0) {
+        float t = calibThermistorC((float)adc);
+        ASSERT_TRUE(t < last);
+        last = t;
+    }
+}
+
+TEST(fault_bounds) {
+    ASSERT_TRUE(calibThermistorC(0.0f) == THERM_ERROR);
+    ASSERT_TRUE(calibThermistorC((float)THERM_ADC_MIN - 0.5f) == THERM_ERROR);
+    ASSERT_TRUE(calibThermistorC((float)THERM_ADC_MAX + 0.5f) == THERM_ERROR);
+    ASSERT_TRUE(calibThermistorC(4095.0f) == THERM_ERROR);
+    ASSERT_TRUE(calibThermistorC(NAN) == THERM_ERROR);
+    ASSERT_TRUE(calibThermistorC((float)THERM_ADC_MIN) != THERM_ERROR);
+    ASSERT_TRUE(calibThermistorC((float)THERM_ADC_MAX) != THERM_ERROR);
+}
+
+TEST(battery_matches_v121_formula) {
+    for (int raw = 0; raw <= 4095; raw += 45) {
+        float expected = (raw * 3.3f) / 4095.0f * 2.0f;
+        ASSERT_NEAR(expected, calibBatteryVolts((float)raw), 1e-4);
+    }
+    ASSERT_NEAR(6.6, calibBatteryVolts(4095.0f), 1e-4);
+}
+
+TEST(lux_matches_v121_formula) {
+    for (int raw = 0; raw <= 4095; raw += 45) {
+        float vm = raw * 5.0f / 4096.0f;
+        float expected = vm / 10000.0f * 1000000.0f * 2.0f;
+        ASSERT_NEAR(expected, calibLux((float)raw), expected * 1e-5 + 1e-4);
+    }
+}
+
+// ==================== MAIN ====================
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "  ORBITAL TEMPLE CALIBRATION UNIT TESTS" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << std::endl;
+
+    RUN_TEST(mid_scale_is_reference_temperature);
+    RUN_TEST(table_matches_exact_curve);
+    RUN_TEST(table_within_quarter_degree_to_150C);
+    RUN_TEST(colder_is_higher_count);
+    RUN_TEST(fault_bounds);
+    RUN_TEST(battery_matches_v121_formula);
+    RUN_TEST(lux_matches_v121_formula);
+
+    std::cout << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "  RESULTS: " << tests_passed << " passed, " << tests_failed << " failed" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    return tests_failed > 0 ? 1 : 0;
+}
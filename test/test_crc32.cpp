@@ -1,9 +1,10 @@
 /*
  * Orbital Temple - CRC32 Unit Tests
  *
- * Tests the CRC32 implementation used for EEPROM data integrity.
+ * Tests the CRC32 implementation used for EEPROM data integrity, checks
+ * every crc32.cpp backend against the original table and benchmarks them.
  *
- * Compile: g++ -std=c++11 -o test_crc32 test_crc32.cpp
+ * Compile: g++ -std=c++11 -O2 -o test_crc32 test_crc32.cpp
  * Run: ./test_crc32
  */
 
@@ -11,8 +12,14 @@
 #include <cstdint>
 #include <cstring>
 #include <cassert>
+#include <cstdio>
+#include <chrono>
+#include <vector>
 
-// ==================== CRC32 IMPLEMENTATION (from radiation.cpp) ====================
+// Engine under test (host build: table + slicing-by-8)
+#include "../crc32.cpp"
+
+// ==================== REFERENCE CRC32 (original radiation.cpp loop, fixed table) ====================
 
 static const uint32_t crc32_table[256] = {
     0x00000000, 0x77073096, 0xEE0E612C, 0x990951BA,
@@ -25,7 +32,7 @@ static const uint32_t crc32_table[256] = {
     0x14015C4F, 0x63066CD9, 0xFA0F3D63, 0x8D080DF5,
     0x3B6E20C8, 0x4C69105E, 0xD56041E4, 0xA2677172,
     0x3C03E4D1, 0x4B04D447, 0xD20D85FD, 0xA50AB56B,
-    0x35B5A8FA, 0x42B2986C, 0xDBBBBBD6, 0xACBCCB40,
+    0x35B5A8FA, 0x42B2986C, 0xDBBBC9D6, 0xACBCF940,
     0x32D86CE3, 0x45DF5C75, 0xDCD60DCF, 0xABD13D59,
     0x26D930AC, 0x51DE003A, 0xC8D75180, 0xBFD06116,
     0x21B4F4B5, 0x56B3C423, 0xCFBA9599, 0xB8BDA50F,
@@ -38,7 +45,7 @@ static const uint32_t crc32_table[256] = {
     0x6B6B51F4, 0x1C6C6162, 0x856530D8, 0xF262004E,
     0x6C0695ED, 0x1B01A57B, 0x8208F4C1, 0xF50FC457,
     0x65B0D9C6, 0x12B7E950, 0x8BBEB8EA, 0xFCB9887C,
-    0x62DD1DDF, 0x15DA2D49, 0x8CD37CF3, 0xFAD44C65,
+    0x62DD1DDF, 0x15DA2D49, 0x8CD37CF3, 0xFBD44C65,
     0x4DB26158, 0x3AB551CE, 0xA3BC0074, 0xD4BB30E2,
     0x4ADFA541, 0x3DD895D7, 0xA4D1C46D, 0xD3D6F4FB,
     0x4369E96A, 0x346ED9FC, 0xAD678846, 0xDA60B8D0,
@@ -288,6 +295,148 @@ TEST(partial_vs_full_block) {
     ASSERT_NEQ(crc_50, crc_100);
 }
 
+// ==================== BACKEND EQUIVALENCE ====================
+
+typedef uint32_t (*Backend)(uint32_t, const uint8_t*, size_t);
+
+struct NamedBackend {
+    const char* name;
+    Backend fn;
+};
+
+static const NamedBackend BACKENDS[] = {
+    {"table", crc32UpdateTable},
+    {"slice8", crc32UpdateSlice8},
+    {"active", crc32Update},
+};
+static const size_t BACKEND_COUNT = sizeof(BACKENDS) / sizeof(BACKENDS[0]);
+
+// Deterministic pseudo-random fill (xorshift32)
+static void fillPattern(uint8_t* buf, size_t len, uint32_t seed) {
+    uint32_t x = seed ? seed : 1;
+    for (size_t i = 0; i < len; i++) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        buf[i] = (uint8_t)x;
+    }
+}
+
+static uint32_t backendOneShot(Backend fn, const uint8_t* data, size_t len) {
+    return crc32Final(fn(crc32Begin(), data, len));
+}
+
+// Test: Every backend reproduces the standard check value
+TEST(backends_standard_vector) {
+    const char* str = "123456789";
+    for (size_t b = 0; b < BACKEND_COUNT; b++) {
+        ASSERT_EQ(0xCBF43926u, backendOneShot(BACKENDS[b].fn, (const uint8_t*)str, 9));
+    }
+}
+
+// Test: Every backend matches the reference for all lengths and alignments
+TEST(backends_match_reference) {
+    uint8_t buf[1024 + 8];
+    fillPattern(buf, sizeof(buf), 0x1234567);
+
+    for (size_t offset = 0; offset < 8; offset++) {
+        for (size_t len = 0; len <= 1024; len += (len < 80 ? 1 : 37)) {
+            uint32_t expect = calculateCRC32(buf + offset, len);
+            for (size_t b = 0; b < BACKEND_COUNT; b++) {
+                ASSERT_EQ(expect, backendOneShot(BACKENDS[b].fn, buf + offset, len));
+            }
+        }
+    }
+}
+
+// Test: Chunked updates equal a single pass, whatever the split points
+TEST(incremental_matches_one_shot) {
+    uint8_t buf[3000];
+    fillPattern(buf, sizeof(buf), 0xC0FFEE);
+    uint32_t expect = calculateCRC32(buf, sizeof(buf));
+
+    const size_t chunkSizes[] = {1, 3, 7, 8, 249, 512, 1000};
+    for (size_t b = 0; b < BACKEND_COUNT; b++) {
+        for (size_t c = 0; c < sizeof(chunkSizes) / sizeof(chunkSizes[0]); c++) {
+            uint32_t crc = crc32Begin();
+            for (size_t pos = 0; pos < sizeof(buf); pos += chunkSizes[c]) {
+                size_t n = sizeof(buf) - pos;
+                if (n > chunkSizes[c]) n = chunkSizes[c];
+                crc = BACKENDS[b].fn(crc, buf + pos, n);
+            }
+            ASSERT_EQ(expect, crc32Final(crc));
+        }
+    }
+}
+
+// Test: Slice tables start from the same polynomial table
+TEST(slice_table_matches_reference) {
+    crc32UpdateSlice8(crc32Begin(), NULL, 0);  // Builds the tables
+    for (int i = 0; i < 256; i++) {
+        ASSERT_EQ(crc32_table[i], crc32Slice[0][i]);
+    }
+}
+
+// Test: Reference table is the reflected 0xEDB88320 polynomial table
+TEST(table_matches_polynomial) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) {
+            c = (c & 1) ? (c >> 1) ^ 0xEDB88320u : (c >> 1);
+        }
+        ASSERT_EQ(c, crc32_table[i]);
+    }
+}
+
+// Test: Legacy backend only differs where the old table was wrong
+TEST(legacy_table_differs_at_bad_entries) {
+    uint8_t clean[] = {1, 2, 3};                 // Never indexes 42/43/95 from ~0
+    uint8_t hit[] = {(uint8_t)(0xFF ^ 42)};      // First lookup hits entry 42
+    ASSERT_EQ(crc32UpdateTable(crc32Begin(), clean, 3), crc32UpdateLegacy(crc32Begin(), clean, 3));
+    ASSERT_NEQ(crc32UpdateTable(crc32Begin(), hit, 1), crc32UpdateLegacy(crc32Begin(), hit, 1));
+}
+
+// Test: crc32Init() selects the fast host backend
+TEST(init_selects_slice8) {
+    crc32Init();
+    ASSERT_EQ(0, strcmp(crc32BackendName(), "slice8"));
+}
+
+// ==================== BENCHMARK ====================
+
+static void benchmark() {
+    const size_t sizes[] = {16, 100, 512, 4096, 65536};
+    const size_t totalBytes = 64u * 1024 * 1024;  // Per backend and size
+    std::vector<uint8_t> buf(65536);
+    fillPattern(buf.data(), buf.size(), 42);
+
+    std::cout << "Benchmark (MB/s, " << (totalBytes >> 20) << " MB per cell):" << std::endl;
+    std::printf("  %-8s", "size");
+    for (size_t b = 0; b < BACKEND_COUNT; b++) {
+        std::printf(" %10s", BACKENDS[b].name);
+    }
+    std::printf("\n");
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        size_t len = sizes[s];
+        size_t iterations = totalBytes / len;
+        std::printf("  %-8zu", len);
+
+        for (size_t b = 0; b < BACKEND_COUNT; b++) {
+            volatile uint32_t sink = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < iterations; i++) {
+                sink = sink + BACKENDS[b].fn(crc32Begin(), buf.data(), len);
+            }
+            auto end = std::chrono::steady_clock::now();
+            double seconds = std::chrono::duration<double>(end - start).count();
+            double mbps = (double)(iterations * len) / (1024.0 * 1024.0) / seconds;
+            std::printf(" %10.1f", mbps);
+        }
+        std::printf("\n");
+    }
+}
+
 // ==================== MAIN ====================
 
 int main() {
@@ -310,11 +459,23 @@ int main() {
     RUN_TEST(bootcount_corruption_detected);
     RUN_TEST(large_block);
     RUN_TEST(partial_vs_full_block);
+    RUN_TEST(backends_standard_vector);
+    RUN_TEST(backends_match_reference);
+    RUN_TEST(incremental_matches_one_shot);
+    RUN_TEST(slice_table_matches_reference);
+    RUN_TEST(table_matches_polynomial);
+    RUN_TEST(legacy_table_differs_at_bad_entries);
+    RUN_TEST(init_selects_slice8);
 
     std::cout << std::endl;
     std::cout << "========================================" << std::endl;
     std::cout << "  RESULTS: " << tests_passed << " passed, " << tests_failed << " failed" << std::endl;
     std::cout << "========================================" << std::endl;
 
+    if (tests_failed == 0) {
+        std::cout << std::endl;
+        benchmark();
+    }
+
     return tests_failed > 0 ? 1 : 0;
 }
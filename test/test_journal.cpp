@@ -0,0 +1,344 @@
+/*
+ * Orbital Temple - State Journal Unit Tests
+ *
+ * Runs journal.cpp on a RAM model of NOR flash (writes can only clear
+ * bits, erase sets a sector to 0xFF) with resets injected mid-write.
+ *
+ * Compile: g++ -std=c++11 -O2 -o test_journal test_journal.cpp
+ * Run: ./test_journal
+ */
+
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+
+// Module under test (and the CRC engine it uses)
+#include "../crc32.cpp"
+#include "../journal.cpp"
+
+// ==================== FLASH MODEL ====================
+
+#define FLASH_SECTORS 4
+#define FLASH_SIZE (FLASH_SECTORS * JOURNAL_SECTOR_SIZE)
+
+static uint8_t flash[FLASH_SIZE];
+static uint32_t sectorErases[FLASH_SECTORS];
+static uint32_t bitSetAttempts = 0;     // Writes that tried to turn a 0 into a 1
+static long writeBudget = -1;           // Bytes until the simulated reset, -1 = none
+
+static bool flashRead(uint32_t offset, void* data, size_t length) {
+    if (offset + length > FLASH_SIZE) return false;
+    memcpy(data, flash + offset, length);
+    return true;
+}
+
+static bool flashWrite(uint32_t offset, const void* data, size_t length) {
+    if (offset + length > FLASH_SIZE) return false;
+    const uint8_t* src = (const uint8_t*)data;
+    for (size_t i = 0; i < length; i++) {
+        if (writeBudget == 0) return false;     // Reset hit mid-write
+        if (writeBudget > 0) writeBudget--;
+        if (src[i] & ~flash[offset + i]) bitSetAttempts++;
+        flash[offset + i] &= src[i];
+    }
+    return true;
+}
+
+static bool flashErase(uint32_t offset) {
+    if (offset % JOURNAL_SECTOR_SIZE != 0 || offset >= FLASH_SIZE) return false;
+    memset(flash + offset, 0xFF, JOURNAL_SECTOR_SIZE);
+    sectorErases[offset / JOURNAL_SECTOR_SIZE]++;
+    return true;
+}
+
+static const JournalFlash ramFlash = { FLASH_SIZE, flashRead, flashWrite, flashErase };
+
+static void flashReset() {
+    memset(flash, 0xFF, sizeof(flash));
+    memset(sectorErases, 0, sizeof(sectorErases));
+    bitSetAttempts = 0;
+    writeBudget = -1;
+}
+
+static uint32_t totalErases() {
+    uint32_t n = 0;
+    for (int i = 0; i < FLASH_SECTORS; i++) n += sectorErases[i];
+    return n;
+}
+
+struct State {
+    uint32_t value;
+    uint8_t pad[20];
+};
+
+static State makeState(uint32_t v) {
+    State s;
+    s.value = v;
+    memset(s.pad, (int)(v & 0xFF), sizeof(s.pad));
+    return s;
+}
+
+static uint32_t latestValue(Journal& j) {
+    State s;
+    if (journalLatest(j, &s, sizeof(s)) != sizeof(s)) return 0xFFFFFFFF;
+    return s.value;
+}
+
+// ==================== TEST FRAMEWORK ====================
+
+int tests_passed = 0;
+int tests_failed = 0;
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Test: " << #name << "... "; \
+    try { \
+        flashReset(); \
+        test_##name(); \
+        std::cout << "PASS" << std::endl; \
+        tests_passed++; \
+    } catch (const std::exception& e) { \
+        std::cout << "FAIL: " << e.what() << std::endl; \
+        tests_failed++; \
+    } \
+} while(0)
+
+#define ASSERT(condition) do { \
+    if (!(condition)) { \
+        throw std::runtime_error("Assertion failed: " #condition); \
+    } \
+} while(0)
+
+#define ASSERT_EQ(a, b) do { \
+    if ((a) != (b)) { \
+        throw std::runtime_error("Assertion failed: " #a " != " #b); \
+    } \
+} while(0)
+
+// ==================== TESTS ====================
+
+TEST(open_blank_flash) {
+    Journal j;
+    ASSERT(journalOpen(j, &ramFlash));
+    ASSERT_EQ(j.latest, -1);
+    ASSERT_EQ(j.records, 0u);
+
+    State s;
+    ASSERT_EQ(journalLatest(j, &s, sizeof(s)), 0u);
+}
+
+TEST(rejects_bad_flash) {
+    Journal j;
+    JournalFlash tiny = ramFlash;
+    tiny.size = JOURNAL_SECTOR_SIZE;
+    ASSERT(!journalOpen(j, &tiny));
+    ASSERT(!journalOpen(j, NULL));
+}
+
+TEST(append_then_recover) {
+    Journal j;
+    journalOpen(j, &ramFlash);
+    State s = makeState(1234);
+    ASSERT(journalAppend(j, &s, sizeof(s)));
+    ASSERT_EQ(latestValue(j), 1234u);
+
+    Journal k;
+    ASSERT(journalOpen(k, &ramFlash));
+    ASSERT_EQ(k.records, 1u);
+    ASSERT_EQ(latestValue(k), 1234u);
+    ASSERT_EQ(totalErases(), 0u);       // Blank flash: nothing to erase
+}
+
+TEST(append_programs_one_slot) {
+    Journal j;
+    journalOpen(j, &ramFlash);
+    State s = makeState(7);
+    journalAppend(j, &s, sizeof(s));
+
+    // Everything past the first slot still erased
+    for (size_t i = JOURNAL_SLOT_SIZE; i < sizeof(flash); i++) {
+        ASSERT_EQ(flash[i], 0xFF);
+    }
+    ASSERT_EQ(bitSetAttempts, 0u);
+}
+
+TEST(latest_wins_across_sectors) {
+    Journal j;
+    journalOpen(j, &ramFlash);
+    for (uint32_t i = 1; i <= 3 * JOURNAL_SLOTS + 5; i++) {
+        State s = makeState(i);
+        ASSERT(journalAppend(j, &s, sizeof(s)));
+    }
+
+    Journal k;
+    journalOpen(k, &ramFlash);
+    ASSERT_EQ(latestValue(k), 3u * JOURNAL_SLOTS + 5);
+    ASSERT_EQ(k.sector, 3u);
+    ASSERT_EQ(k.slot, 5u);
+}
+
+TEST(wraparound_keeps_latest) {
+    Journal j;
+    journalOpen(j, &ramFlash);
+    const uint32_t n = 10 * FLASH_SECTORS * JOURNAL_SLOTS + 17;
+    for (uint32_t i = 1; i <= n; i++) {
+        State s = makeState(i);
+        ASSERT(journalAppend(j, &s, sizeof(s)));
+    }
+
+    Journal k;
+    journalOpen(k, &ramFlash);
+    ASSERT_EQ(latestValue(k), n);
+    ASSERT_EQ(k.seq, n);
+    ASSERT_EQ(bitSetAttempts, 0u);
+
+    // One erase per JOURNAL_SLOTS saves, spread evenly over the sectors
+    ASSERT(totalErases() <= n / JOURNAL_SLOTS);
+    for (int i = 1; i < FLASH_SECTORS; i++) {
+        ASSERT(sectorErases[i] + 1 >= sectorErases[0] && sectorErases[i] <= sectorErases[0] + 1);
+    }
+}
+
+TEST(reset_during_body_keeps_previous) {
+    Journal j;
+    journalOpen(j, &ramFlash);
+    State a = makeState(100), b = makeState(200);
+    journalAppend(j, &a, sizeof(a));
+
+    writeBudget = 20;                   // Reset 20 bytes into the next record
+    ASSERT(!journalAppend(j, &b, sizeof(b)));
+    writeBudget = -1;
+
+    Journal k;
+    journalOpen(k, &ramFlash);
+    ASSERT_EQ(latestValue(k), 100u);
+
+    // The torn slot is skipped, not overwritten
+    State c = makeState(300);
+    ASSERT(journalAppend(k, &c, sizeof(c)));
+    ASSERT_EQ(k.latest, 2 * JOURNAL_SLOT_SIZE);
+    ASSERT_EQ(bitSetAttempts, 0u);
+
+    Journal m;
+    journalOpen(m, &ramFlash);
+    ASSERT_EQ(latestValue(m), 300u);
+}
+
+TEST(reset_before_commit_keeps_previous) {
+    Journal j;
+    journalOpen(j, &ramFlash);
+    State a = makeState(1), b = makeState(2);
+    journalAppend(j, &a, sizeof(a));
+
+    writeBudget = 60;                   // Whole body, no commit word
+    ASSERT(!journalAppend(j, &b, sizeof(b)));
+    writeBudget = -1;
+
+    Journal k;
+    journalOpen(k, &ramFlash);
+    ASSERT_EQ(latestValue(k), 1u);
+}
+
+TEST(corrupt_record_falls_back) {
+    Journal j;
+    journalOpen(j, &ramFlash);
+    State a = makeState(10), b = makeState(20);
+    journalAppend(j, &a, sizeof(a));
+    journalAppend(j, &b, sizeof(b));
+
+    flash[JOURNAL_SLOT_SIZE + 12] ^= 0x04;  // Bit flip in the latest payload
+
+    Journal k;
+    journalOpen(k, &ramFlash);
+    ASSERT_EQ(latestValue(k), 10u);
+}
+
+TEST(prepare_keeps_erase_off_append) {
+    Journal j;
+    journalOpen(j, &ramFlash);
+
+    // First pass over all sectors: everything blank, no erase at all
+    for (uint32_t i = 1; i <= FLASH_SECTORS * JOURNAL_SLOTS; i++) {
+        State s = makeState(i);
+        journalAppend(j, &s, sizeof(s));
+    }
+    ASSERT_EQ(totalErases(), 0u);
+
+    // Wrapping into sector 0 needs an erase; prepared while idle, not on the save
+    ASSERT(journalPrepare(j));
+    ASSERT_EQ(totalErases(), 1u);
+    ASSERT(!journalPrepare(j));         // Already blank
+
+    State s = makeState(9999);
+    ASSERT(journalAppend(j, &s, sizeof(s)));
+    ASSERT_EQ(totalErases(), 1u);
+    ASSERT_EQ(j.sector, 0u);
+    ASSERT_EQ(latestValue(j), 9999u);
+}
+
+TEST(foreign_data_ignored) {
+    // A partition that used to hold something else
+    srand(42);
+    for (size_t i = 0; i < sizeof(flash); i++) flash[i] = (uint8_t)rand();
+
+    Journal j;
+    ASSERT(journalOpen(j, &ramFlash));
+    ASSERT_EQ(j.latest, -1);
+
+    State s = makeState(55);
+    ASSERT(journalAppend(j, &s, sizeof(s)));
+    ASSERT_EQ(sectorErases[0], 1u);
+
+    Journal k;
+    journalOpen(k, &ramFlash);
+    ASSERT_EQ(latestValue(k), 55u);
+}
+
+TEST(payload_limits) {
+    Journal j;
+    journalOpen(j, &ramFlash);
+    uint8_t big[JOURNAL_PAYLOAD_MAX + 1];
+    memset(big, 0xA5, sizeof(big));
+
+    ASSERT(!journalAppend(j, big, sizeof(big)));
+    ASSERT(journalAppend(j, big, JOURNAL_PAYLOAD_MAX));
+
+    uint8_t out[JOURNAL_PAYLOAD_MAX];
+    ASSERT_EQ(journalLatest(j, out, sizeof(out)), (size_t)JOURNAL_PAYLOAD_MAX);
+    ASSERT(memcmp(out, big, sizeof(out)) == 0);
+}
+
+// ==================== MAIN ====================
+
+int main() {
+    crc32Init();
+
+    std::cout << "========================================" << std::endl;
+    std::cout << "  ORBITAL TEMPLE JOURNAL UNIT TESTS" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << std::endl;
+
+    RUN_TEST(open_blank_flash);
+    RUN_TEST(rejects_bad_flash);
+    RUN_TEST(append_then_recover);
+    RUN_TEST(append_programs_one_slot);
+    RUN_TEST(latest_wins_across_sectors);
+    RUN_TEST(wraparound_keeps_latest);
+    RUN_TEST(reset_during_body_keeps_previous);
+    RUN_TEST(reset_before_commit_keeps_previous);
+    RUN_TEST(corrupt_record_falls_back);
+    RUN_TEST(prepare_keeps_erase_off_append);
+    RUN_TEST(foreign_data_ignored);
+    RUN_TEST(payload_limits);
+
+    std::cout << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "  RESULTS: " << tests_passed << " passed, "
+              << tests_failed << " failed" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,233 @@
+/*
+ * Orbital Temple - Link Quality Unit Tests
+ *
+ * Feeds link.cpp uplinks with chosen SNRs and checks which downlink
+ * profiles it grants, the fallbacks (SNR drop, missed acks, end of pass)
+ * and the per-pass log line.
+ *
+ * Compile: g++ -std=c++11 -O2 -o test_link test_link.cpp
+ * Run: ./test_link
+ */
+
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <stdexcept>
+
+// Module under test
+#include "../link.cpp"
+
+// ==================== TEST FRAMEWORK ====================
+
+int tests_passed = 0;
+int tests_failed = 0;
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Test: " << #name << "... "; \
+    try { \
+        linkReset(); \
+        test_##name(); \
+        std::cout << "PASS" << std::endl; \
+        tests_passed++; \
+    } catch (const std::exception& e) { \
+        std::cout << "FAIL: " << e.what() << std::endl; \
+        tests_failed++; \
+    } \
+} while(0)
+
+#define ASSERT(condition) do { \
+    if (!(condition)) { \
+        throw std::runtime_error("Assertion failed: " #condition); \
+    } \
+} while(0)
+
+#define ASSERT_EQ(a, b) do { \
+    if ((a) != (b)) { \
+        throw std::runtime_error("Assertion failed: " #a " != " #b); \
+    } \
+} while(0)
+
+// n uplinks at the given SNR, 10 s apart, from t; returns the time after
+static unsigned long uplinks(int n, float snr, unsigned long t) {
+    for (int i = 0; i < n; i++) {
+        linkUplink(-110.0f, snr, t);
+        t += 10000;
+    }
+    return t;
+}
+
+// ==================== TESTS ====================
+
+TEST(safe_before_any_uplink) {
+    ASSERT_EQ(linkBestProfile(), LINK_PROFILE_SAFE);
+    ASSERT_EQ(linkBulkProfile(), LINK_PROFILE_SAFE);
+    ASSERT_EQ(linkRequest(LINK_PROFILE_AUTO), LINK_PROFILE_SAFE);
+    ASSERT_EQ(linkRequest(1), -1);
+}
+
+TEST(needs_min_uplinks) {
+    uplinks(LINK_MIN_UPLINKS - 1, 10.0f, 0);
+    ASSERT_EQ(linkBestProfile(), LINK_PROFILE_SAFE);
+    linkUplink(-100.0f, 10.0f, 100000);
+    ASSERT_EQ(linkBestProfile(), 2);
+}
+
+TEST(profile_follows_snr) {
+    // SF8 needs -10 + 10 dB margin, SF7 -7.5 + 10
+    uplinks(5, 1.0f, 0);
+    ASSERT_EQ(linkBestProfile(), 1);
+    linkReset();
+    uplinks(5, -1.0f, 0);
+    ASSERT_EQ(linkBestProfile(), LINK_PROFILE_SAFE);
+    linkReset();
+    uplinks(5, 3.0f, 0);
+    ASSERT_EQ(linkBestProfile(), 2);
+}
+
+TEST(request_beyond_margin_refused) {
+    uplinks(5, 1.0f, 0);
+    ASSERT_EQ(linkRequest(2), -1);
+    ASSERT_EQ(linkBulkProfile(), LINK_PROFILE_SAFE);
+    ASSERT_EQ(linkRequest(1), 1);
+    ASSERT_EQ(linkBulkProfile(), 1);
+    ASSERT_EQ(linkRequest(LINK_PROFILES), -1);
+    ASSERT_EQ(linkRequest(0), 0);       // Ground may always go back
+}
+
+TEST(snr_drop_falls_back) {
+    unsigned long t = uplinks(5, 6.0f, 0);
+    ASSERT_EQ(linkRequest(LINK_PROFILE_AUTO), 2);
+
+    // Average slides towards -6 dB; drops once 2 dB under SF7's 2.5 dB
+    int steps = 0;
+    while (linkBulkProfile() != LINK_PROFILE_SAFE && steps < 20) {
+        t = uplinks(1, -6.0f, t);
+        steps++;
+    }
+    ASSERT_EQ(linkBulkProfile(), LINK_PROFILE_SAFE);
+    ASSERT(steps > 1);                  // One bad packet is not enough
+    ASSERT_EQ(linkPass().fallbacks, 1u);
+}
+
+TEST(acked_bulk_keeps_profile) {
+    unsigned long t = uplinks(5, 6.0f, 0);
+    linkRequest(2);
+    for (int i = 0; i < 5; i++) {
+        linkBulkSent(2, t);
+        ASSERT_EQ(linkTick(t + LINK_ACK_TIMEOUT_MS - 1), LINK_EVENT_NONE);
+        t = uplinks(1, 6.0f, t + 5000);   // Ground's next command
+    }
+    ASSERT_EQ(linkBulkProfile(), 2);
+    ASSERT_EQ(linkPass().bulkFast, 5u);
+}
+
+TEST(missed_acks_fall_back) {
+    unsigned long t = uplinks(5, 6.0f, 0);
+    linkRequest(2);
+
+    linkBulkSent(2, t);
+    t += LINK_ACK_TIMEOUT_MS;
+    ASSERT_EQ(linkTick(t), LINK_EVENT_NONE);    // First miss tolerated
+    ASSERT_EQ(linkBulkProfile(), 2);
+
+    linkBulkSent(2, t);
+    t += LINK_ACK_TIMEOUT_MS;
+    ASSERT_EQ(linkTick(t), LINK_EVENT_FALLBACK);
+    ASSERT_EQ(linkBulkProfile(), LINK_PROFILE_SAFE);
+
+    // Safe bulk is never waited on
+    linkBulkSent(LINK_PROFILE_SAFE, t);
+    ASSERT_EQ(linkTick(t + 10 * LINK_ACK_TIMEOUT_MS), LINK_EVENT_NONE);
+}
+
+TEST(uplink_clears_missed_acks) {
+    unsigned long t = uplinks(5, 6.0f, 0);
+    linkRequest(2);
+    for (int i = 0; i < 4; i++) {
+        linkBulkSent(2, t);
+        t += LINK_ACK_TIMEOUT_MS;
+        ASSERT_EQ(linkTick(t), LINK_EVENT_NONE);
+        t = uplinks(1, 6.0f, t);        // Late, but there
+    }
+    ASSERT_EQ(linkBulkProfile(), 2);
+}
+
+TEST(pass_end_resets) {
+    unsigned long t = uplinks(5, 6.0f, 1000);
+    linkRequest(2);
+    ASSERT_EQ(linkTick(t + LINK_PASS_GAP_MS - 20000), LINK_EVENT_NONE);
+    ASSERT_EQ(linkTick(t + LINK_PASS_GAP_MS), LINK_EVENT_PASS_END);
+    ASSERT_EQ(linkBulkProfile(), LINK_PROFILE_SAFE);
+    ASSERT(!linkPass().open);
+    ASSERT_EQ(linkTick(t + 2 * LINK_PASS_GAP_MS), LINK_EVENT_NONE);
+
+    // Next pass starts from scratch: no grant until enough uplinks
+    t += 3 * LINK_PASS_GAP_MS;
+    linkUplink(-100.0f, 8.0f, t);
+    ASSERT_EQ(linkPass().uplinks, 1u);
+    ASSERT_EQ(linkRequest(2), -1);
+}
+
+TEST(pass_statistics) {
+    linkUplink(-100.0f, 4.0f, 10000);
+    linkUplink(-120.0f, -2.0f, 20000);
+    linkUplink(-110.0f, 7.0f, 70000);
+    linkRequest(1);
+    linkBulkSent(1, 71000);
+    linkBulkSent(1, 72000);
+    linkBulkSent(LINK_PROFILE_SAFE, 73000);
+
+    const LinkPass& p = linkPass();
+    ASSERT_EQ(p.uplinks, 3u);
+    ASSERT_EQ(p.snrMin, -2.0f);
+    ASSERT_EQ(p.snrMax, 7.0f);
+    ASSERT_EQ(p.rssiMin, -120.0f);
+    ASSERT_EQ(p.maxProfile, 1u);
+
+    char line[LINK_PASS_LINE_MAX];
+    linkFormatPass(line, sizeof(line));
+    ASSERT(strstr(line, "LINK|UP:3|RSSI:-110.0/-120.0|SNR:") == line);
+    ASSERT(strstr(line, "/-2.0/7.0|PROF:1|BULK:2/1|FB:0|DUR:60") != NULL);
+}
+
+TEST(pass_line_fits) {
+    uplinks(200, -20.0f, 0);
+    linkUplink(-139.9f, -19.9f, 4000000000UL);
+    for (int i = 0; i < 60000; i++) linkBulkSent(LINK_PROFILE_SAFE, 0);
+
+    char line[LINK_PASS_LINE_MAX];
+    linkFormatPass(line, sizeof(line));
+    ASSERT(strlen(line) < sizeof(line) - 1);
+    ASSERT(strstr(line, "|DUR:") != NULL);
+}
+
+// ==================== MAIN ====================
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "  ORBITAL TEMPLE LINK UNIT TESTS" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << std::endl;
+
+    RUN_TEST(safe_before_any_uplink);
+    RUN_TEST(needs_min_uplinks);
+    RUN_TEST(profile_follows_snr);
+    RUN_TEST(request_beyond_margin_refused);
+    RUN_TEST(snr_drop_falls_back);
+    RUN_TEST(acked_bulk_keeps_profile);
+    RUN_TEST(missed_acks_fall_back);
+    RUN_TEST(uplink_clears_missed_acks);
+    RUN_TEST(pass_end_resets);
+    RUN_TEST(pass_statistics);
+    RUN_TEST(pass_line_fits);
+
+    std::cout << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "  RESULTS: " << tests_passed << " passed, "
+              << tests_failed << " failed" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,213 @@
+/*
+ * Orbital Temple - LZSS Unit Tests
+ *
+ * Round-trips the bulk downlink compressor (lzss.cpp) over the kinds of
+ * data we actually send and reports the ratio on log-like text.
+ *
+ * Compile: g++ -std=c++11 -O2 -o test_lzss test_lzss.cpp
+ * Run: ./test_lzss
+ */
+
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Compressor under test
+#include "../lzss.cpp"
+
+// ==================== TEST FRAMEWORK ====================
+
+int tests_passed = 0;
+int tests_failed = 0;
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Test: " << #name << "... "; \
+    try { \
+        test_##name(); \
+        std::cout << "PASS" << std::endl; \
+        tests_passed++; \
+    } catch (const std::exception& e) { \
+        std::cout << "FAIL: " << e.what() << std::endl; \
+        tests_failed++; \
+    } \
+} while(0)
+
+#define ASSERT_EQ(expected, actual) do { \
+    if ((expected) != (actual)) { \
+        throw std::runtime_error("Expected " + std::to_string(expected) + " but got " + std::to_string(actual)); \
+    } \
+} while(0)
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        throw std::runtime_error("Assertion failed: " #cond); \
+    } \
+} while(0)
+
+// ==================== HELPERS ====================
+
+static LzssWorkspace workspace;
+
+// Compress, check the bound, decompress and compare; returns compressed size
+static size_t roundTrip(const uint8_t* data, size_t len) {
+    std::vector<uint8_t> packed(LZSS_BOUND(len) + 1, 0xEE);
+    size_t zlen = lzssCompress(data, len, packed.data(), workspace);
+    ASSERT_TRUE(zlen <= LZSS_BOUND(len));
+    ASSERT_EQ(0xEE, packed[LZSS_BOUND(len)]);   // Nothing written past the bound
+
+    std::vector<uint8_t> unpacked(len + 1);
+    size_t outLen = 0;
+    ASSERT_TRUE(lzssDecompress(packed.data(), zlen, unpacked.data(), len, outLen));
+    ASSERT_EQ(len, outLen);
+    ASSERT_TRUE(memcmp(data, unpacked.data(), len) == 0);
+    return zlen;
+}
+
+static std::string logSample(size_t len) {
+    // Shaped like /log.txt: timestamps and soak HOURLY lines
+    std::string s;
+    char line[200];
+    for (unsigned long t = 0; s.size() < len; t += 3600123) {
+        snprintf(line, sizeof(line),
+                 "[%lu] HOURLY|UP:%lu:00:00|BOOT:3|HEAP:%lu|BCN:%lu|SKIP:0|CMD:12|FAIL:0|TXQ:2|TXDROP:0|BAT:3.9%lu|TEMP:2%lu.5\n",
+                 t, t / 3600000, 210000 - (t % 977), t / 60000, t % 10, t % 7);
+        s += line;
+    }
+    s.resize(len);
+    return s;
+}
+
+// ==================== TESTS ====================
+
+TEST(empty_block) {
+    uint8_t dummy[1] = {0};
+    ASSERT_EQ(0u, roundTrip(dummy, 0));
+}
+
+TEST(single_byte) {
+    uint8_t data[1] = {'A'};
+    ASSERT_EQ(2u, roundTrip(data, 1));   // Flag byte + literal
+}
+
+TEST(short_below_min_match) {
+    const char* s = "ab";
+    roundTrip((const uint8_t*)s, 2);
+}
+
+TEST(run_of_zeros_overlapping_match) {
+    std::vector<uint8_t> data(LZSS_BLOCK_MAX, 0);
+    size_t zlen = roundTrip(data.data(), data.size());
+    // One literal, then max-length matches of distance 1
+    ASSERT_TRUE(zlen < data.size() / 7);
+}
+
+TEST(random_data_stays_within_bound) {
+    std::vector<uint8_t> data(LZSS_BLOCK_MAX);
+    uint32_t x = 0x9E3779B9;
+    for (size_t i = 0; i < data.size(); i++) {
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        data[i] = (uint8_t)x;
+    }
+    roundTrip(data.data(), data.size());
+}
+
+TEST(every_length_up_to_300) {
+    std::string text = logSample(300);
+    for (size_t len = 0; len <= text.size(); len++) {
+        roundTrip((const uint8_t*)text.data(), len);
+    }
+}
+
+TEST(log_text_compresses) {
+    std::string text = logSample(LZSS_BLOCK_MAX);
+    size_t zlen = roundTrip((const uint8_t*)text.data(), text.size());
+    ASSERT_TRUE(zlen < text.size() / 2);
+}
+
+TEST(directory_listing_compresses) {
+    std::string text = "DIR:/accel\n";
+    char line[64];
+    for (int i = 0; i < 60; i++) {
+        snprintf(line, sizeof(line), "F:accel_%05d.bin,%d\n", i, 28800 + i * 16);
+        text += line;
+    }
+    text += "END:DIR\n";
+    size_t zlen = roundTrip((const uint8_t*)text.data(), text.size());
+    ASSERT_TRUE(zlen < text.size() / 2);
+}
+
+TEST(block_limit_clamped) {
+    std::string text = logSample(LZSS_BLOCK_MAX + 100);
+    std::vector<uint8_t> packed(LZSS_BOUND(text.size()));
+    size_t zlen = lzssCompress((const uint8_t*)text.data(), text.size(), packed.data(), workspace);
+
+    std::vector<uint8_t> out(LZSS_BLOCK_MAX);
+    size_t outLen = 0;
+    ASSERT_TRUE(lzssDecompress(packed.data(), zlen, out.data(), out.size(), outLen));
+    ASSERT_EQ((size_t)LZSS_BLOCK_MAX, outLen);
+}
+
+TEST(rejects_distance_before_start) {
+    // Flag 0 = match as the first token: nothing to copy from
+    uint8_t bad[3] = {0x00, 0x00, 0x00};
+    uint8_t out[32];
+    size_t outLen = 0;
+    ASSERT_TRUE(!lzssDecompress(bad, sizeof(bad), out, sizeof(out), outLen));
+}
+
+TEST(rejects_truncated_match) {
+    uint8_t bad[3] = {0x01, 'A', 0x00};   // Literal, then half a match token
+    uint8_t out[32];
+    size_t outLen = 0;
+    ASSERT_TRUE(!lzssDecompress(bad, sizeof(bad), out, sizeof(out), outLen));
+}
+
+TEST(rejects_output_overflow) {
+    std::vector<uint8_t> data(100, 'x');
+    std::vector<uint8_t> packed(LZSS_BOUND(data.size()));
+    size_t zlen = lzssCompress(data.data(), data.size(), packed.data(), workspace);
+    uint8_t out[50];
+    size_t outLen = 0;
+    ASSERT_TRUE(!lzssDecompress(packed.data(), zlen, out, sizeof(out), outLen));
+}
+
+// ==================== MAIN ====================
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "  ORBITAL TEMPLE LZSS UNIT TESTS" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << std::endl;
+
+    RUN_TEST(empty_block);
+    RUN_TEST(single_byte);
+    RUN_TEST(short_below_min_match);
+    RUN_TEST(run_of_zeros_overlapping_match);
+    RUN_TEST(random_data_stays_within_bound);
+    RUN_TEST(every_length_up_to_300);
+    RUN_TEST(log_text_compresses);
+    RUN_TEST(directory_listing_compresses);
+    RUN_TEST(block_limit_clamped);
+    RUN_TEST(rejects_distance_before_start);
+    RUN_TEST(rejects_truncated_match);
+    RUN_TEST(rejects_output_overflow);
+
+    std::cout << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "  RESULTS: " << tests_passed << " passed, " << tests_failed << " failed" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    if (tests_failed == 0) {
+        std::string text = logSample(LZSS_BLOCK_MAX);
+        std::vector<uint8_t> packed(LZSS_BOUND(text.size()));
+        size_t zlen = lzssCompress((const uint8_t*)text.data(), text.size(), packed.data(), workspace);
+        std::printf("\nLog sample: %zu -> %zu bytes (%zu%%)\n",
+                    text.size(), zlen, zlen * 100 / text.size());
+    }
+
+    return tests_failed > 0 ? 1 : 0;
+}
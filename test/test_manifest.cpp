@@ -0,0 +1,302 @@
+/*
+ * Orbital Temple - Directory Manifest Unit Tests
+ *
+ * Fills manifest.cpp the way memor.cpp does after a directory walk, then
+ * checks the upkeep notes, the version stamp and the packed, paginated
+ * ListDir frames.
+ *
+ * Compile: g++ -std=c++11 -O2 -o test_manifest test_manifest.cpp
+ * Run: ./test_manifest
+ */
+
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <string>
+#include <stdexcept>
+
+// Module under test (and the CRC32 engine of its version stamp)
+#include "../crc32.cpp"
+#include "../manifest.cpp"
+
+// ==================== TEST FRAMEWORK ====================
+
+int tests_passed = 0;
+int tests_failed = 0;
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Test: " << #name << "... "; \
+    try { \
+        manifestReset(); \
+        test_##name(); \
+        std::cout << "PASS" << std::endl; \
+        tests_passed++; \
+    } catch (const std::exception& e) { \
+        std::cout << "FAIL: " << e.what() << std::endl; \
+        tests_failed++; \
+    } \
+} while(0)
+
+#define ASSERT(condition) do { \
+    if (!(condition)) { \
+        throw std::runtime_error("Assertion failed: " #condition); \
+    } \
+} while(0)
+
+#define ASSERT_EQ(a, b) do { \
+    if ((a) != (b)) { \
+        throw std::runtime_error("Assertion failed: " #a " != " #b); \
+    } \
+} while(0)
+
+#define FRAME_SIZE 256      // TX_MAX_PACKET + 1
+
+// /accel as the card would list it
+static DirManifest* accelDir() {
+    DirManifest* m = manifestClaim("/accel");
+    manifestAdd(*m, "rec_1.bin", 61440, 0, 2);
+    manifestAdd(*m, "rec_1.idx", 480, 0, 0);
+    manifestAdd(*m, "old", 0, MANIFEST_DIR, 0);
+    m->complete = true;
+    return m;
+}
+
+static std::string entryName(const DirManifest& m, uint16_t i) {
+    return std::string(manifestName(m, i), m.entries[i].nameLength);
+}
+
+// Body of a frame after its "<prefix><version>,<first>,<total>" header
+static std::string body(const char* frame) {
+    const char* bar = strchr(frame, '|');
+    return bar ? bar : "";
+}
+
+// ==================== TESTS ====================
+
+TEST(claim_and_find_normalize_paths) {
+    DirManifest* m = manifestClaim("/accel/");
+    ASSERT(m != NULL);
+    ASSERT_EQ(std::string(m->path), std::string("/accel"));
+    ASSERT(manifestFind("/accel") == m);
+    ASSERT(manifestFind("accel") == m);
+    ASSERT(manifestFind("/acc") == NULL);
+    ASSERT_EQ(std::string(manifestClaim("")->path), std::string("/"));
+}
+
+TEST(least_recently_used_evicted) {
+    char path[16];
+    for (int i = 0; i < MANIFEST_SLOTS; i++) {
+        snprintf(path, sizeof(path), "/d%d", i);
+        manifestClaim(path);
+    }
+    manifestFind("/d0");                    // Used again: /d1 is now the oldest
+    manifestClaim("/new");
+    ASSERT(manifestFind("/d0") != NULL);
+    ASSERT(manifestFind("/d1") == NULL);
+    ASSERT(manifestFind("/new") != NULL);
+}
+
+TEST(remove_compacts_names) {
+    DirManifest* m = accelDir();
+    manifestRemoveAt(*m, 0);
+    ASSERT_EQ(m->count, 2);
+    ASSERT_EQ(entryName(*m, 0), std::string("rec_1.idx"));
+    ASSERT_EQ(entryName(*m, 1), std::string("old"));
+    ASSERT_EQ(m->poolUsed, 12);
+    ASSERT(manifestAdd(*m, "rec_2.bin", 100, 0, 2));
+    ASSERT_EQ(manifestIndexOf(*m, "rec_2.bin", 9), 2);
+}
+
+TEST(notes_mark_and_add_stale) {
+    DirManifest* m = accelDir();
+    manifestNoteChanged("/accel/rec_1.idx");
+    ASSERT(m->entries[1].flags & MANIFEST_STALE);
+    ASSERT_EQ(m->stale, 1);
+    manifestNoteChanged("/accel/rec_1.idx");   // Counted once
+    ASSERT_EQ(m->stale, 1);
+
+    manifestNoteChanged("/accel/rec_2.bin");
+    ASSERT_EQ(m->count, 4);
+    ASSERT_EQ(m->stale, 2);
+    ASSERT_EQ(manifestIndexOf(*m, "rec_2.bin", 9), 3);
+
+    manifestRefreshed(*m, 3, 4096, false, 2);
+    ASSERT_EQ(m->stale, 1);
+    ASSERT_EQ(m->entries[3].size, 4096u);
+    ASSERT_EQ(m->entries[3].flags, 0);
+
+    // Other directories are not cached: nothing happens
+    manifestNoteChanged("/names.log");
+    manifestNoteChanged("/accel/old/x.bin");
+    ASSERT_EQ(m->count, 4);
+}
+
+TEST(notes_remove_and_rename) {
+    DirManifest* m = accelDir();
+    DirManifest* old = manifestClaim("/accel/old");
+
+    manifestNoteRemoved("/accel/rec_1.idx");
+    ASSERT_EQ(m->count, 2);
+    ASSERT_EQ(manifestIndexOf(*m, "rec_1.idx", 9), -1);
+
+    manifestNoteRenamed("/accel/rec_1.bin", "/accel/keep.bin");
+    ASSERT_EQ(manifestIndexOf(*m, "rec_1.bin", 9), -1);
+    ASSERT_EQ(manifestIndexOf(*m, "keep.bin", 8), 1);
+    ASSERT(m->entries[1].flags & MANIFEST_STALE);
+
+    // A removed directory takes its own manifest with it
+    ASSERT(old->used);
+    manifestNoteRemoved("/accel/old");
+    ASSERT(!old->used);
+    ASSERT_EQ(manifestIndexOf(*m, "old", 3), -1);
+}
+
+TEST(entry_paths) {
+    DirManifest* m = accelDir();
+    char path[64];
+    ASSERT(manifestEntryPath(*m, 1, path, sizeof(path)));
+    ASSERT_EQ(std::string(path), std::string("/accel/rec_1.idx"));
+
+    DirManifest* root = manifestClaim("/");
+    manifestAdd(*root, "log.txt", 10, 0, 0);
+    ASSERT(manifestEntryPath(*root, 0, path, sizeof(path)));
+    ASSERT_EQ(std::string(path), std::string("/log.txt"));
+    ASSERT(!manifestEntryPath(*root, 0, path, 5));
+}
+
+TEST(version_follows_contents) {
+    DirManifest* m = accelDir();
+    uint32_t v = manifestVersion(*m);
+    ASSERT_EQ(manifestVersion(*m), v);
+
+    // Same entries in another slot (as after a reboot): same stamp
+    DirManifest* copy = manifestClaim("/copy");
+    manifestAdd(*copy, "rec_1.bin", 61440, 0, 2);
+    manifestAdd(*copy, "rec_1.idx", 480, 0, 0);
+    manifestAdd(*copy, "old", 0, MANIFEST_DIR, 0);
+    ASSERT_EQ(manifestVersion(*copy), v);
+
+    manifestRefreshed(*m, 1, 481, false, 0);
+    ASSERT(manifestVersion(*m) != v);
+    manifestRefreshed(*m, 1, 480, false, 0);
+    ASSERT_EQ(manifestVersion(*m), v);
+
+    manifestNoteChanged("/accel/rec_1.idx");   // Pending re-read: not the same
+    ASSERT(manifestVersion(*m) != v);
+}
+
+TEST(pack_small_directory) {
+    DirManifest* m = accelDir();
+    char frame[FRAME_SIZE];
+    ASSERT_EQ(manifestPack(*m, "LS:", 0, m->count, false, frame, sizeof(frame)), 3);
+
+    char header[32];
+    snprintf(header, sizeof(header), "LS:%08lX,0,3|", (unsigned long)manifestVersion(*m));
+    ASSERT(strncmp(frame, header, strlen(header)) == 0);
+    ASSERT_EQ(body(frame), std::string("|F:rec_1.bin,61440,v2|F:rec_1.idx,480|D:old|END"));
+
+    // Files only (AccelList), a page in the middle
+    ASSERT_EQ(manifestPack(*m, "ACCEL:LS:", 0, 3, true, frame, sizeof(frame)), 3);
+    ASSERT_EQ(body(frame), std::string("|F:rec_1.bin,61440,v2|F:rec_1.idx,480|END"));
+    ASSERT_EQ(manifestPack(*m, "LS:", 1, 2, false, frame, sizeof(frame)), 2);
+    ASSERT_EQ(body(frame), std::string("|F:rec_1.idx,480|NEXT:2"));
+}
+
+TEST(pack_fills_frames) {
+    DirManifest* m = manifestClaim("/names");
+    char name[32];
+    for (int i = 0; i < MANIFEST_MAX_ENTRIES; i++) {
+        snprintf(name, sizeof(name), "person_%03d.txt", i);
+        manifestAdd(*m, name, 1000 + i, 0, 0);
+    }
+
+    // Every entry exactly once, frames as full as they can be
+    char frame[FRAME_SIZE];
+    uint16_t next = 0;
+    int frames = 0;
+    int entries = 0;
+    while (next < m->count) {
+        uint16_t after = manifestPack(*m, "LS:", next, m->count, false, frame, sizeof(frame));
+        ASSERT(after > next);
+        ASSERT(strlen(frame) < FRAME_SIZE);
+        for (const char* p = frame; (p = strstr(p, "|F:")) != NULL; p++) entries++;
+        if (after < m->count) {
+            ASSERT(strlen(frame) > FRAME_SIZE - 1 - MANIFEST_FOOTER_MAX - 30);
+            ASSERT(strstr(frame, "|END") == NULL);
+        }
+        next = after;
+        frames++;
+    }
+    ASSERT_EQ(entries, MANIFEST_MAX_ENTRIES);
+    ASSERT(strstr(frame, "|END") != NULL);
+    ASSERT(frames <= 11);                   // 100 packets before
+    std::cout << "(" << MANIFEST_MAX_ENTRIES << " entries in " << frames << " frames) ";
+}
+
+TEST(pack_reports_truncation_and_empty) {
+    DirManifest* m = manifestClaim("/full");
+    char frame[FRAME_SIZE];
+    ASSERT_EQ(manifestPack(*m, "LS:", 0, 0, false, frame, sizeof(frame)), 0);
+    ASSERT_EQ(body(frame), std::string("|END"));
+
+    std::string longName(MANIFEST_NAME_MAX + 1, 'x');
+    ASSERT(!manifestAdd(*m, longName.c_str(), 1, 0, 0));
+    ASSERT(m->truncated);
+    manifestPack(*m, "LS:", 0, 10, false, frame, sizeof(frame));
+    ASSERT_EQ(body(frame), std::string("|END:TRUNCATED"));
+    ASSERT(strstr(frame, ",0,0|") != NULL);
+
+    // The longest name fits with room for the footer
+    DirManifest* w = manifestClaim("/wide");
+    std::string widest(MANIFEST_NAME_MAX, 'y');
+    ASSERT(manifestAdd(*w, widest.c_str(), 4000000000u, 0, 99));
+    ASSERT_EQ(manifestPack(*w, "ACCEL:LS:", 0, 1, false, frame, sizeof(frame)), 1);
+    ASSERT(strstr(frame, "|END") != NULL);
+}
+
+TEST(pool_limit) {
+    DirManifest* m = manifestClaim("/pool");
+    std::string name(MANIFEST_NAME_MAX, 'a');
+    int added = 0;
+    for (int i = 0; i < MANIFEST_MAX_ENTRIES; i++) {
+        name[0] = (char)('A' + i % 26);
+        name[1] = (char)('A' + i / 26);
+        if (manifestAdd(*m, name.c_str(), 0, 0, 0)) added++;
+    }
+    ASSERT_EQ(added, MANIFEST_POOL_SIZE / MANIFEST_NAME_MAX);
+    ASSERT(m->truncated);
+    ASSERT(m->poolUsed <= MANIFEST_POOL_SIZE);
+}
+
+// ==================== MAIN ====================
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "  ORBITAL TEMPLE MANIFEST UNIT TESTS" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << std::endl;
+
+    crc32Init();
+
+    RUN_TEST(claim_and_find_normalize_paths);
+    RUN_TEST(least_recently_used_evicted);
+    RUN_TEST(remove_compacts_names);
+    RUN_TEST(notes_mark_and_add_stale);
+    RUN_TEST(notes_remove_and_rename);
+    RUN_TEST(entry_paths);
+    RUN_TEST(version_follows_contents);
+    RUN_TEST(pack_small_directory);
+    RUN_TEST(pack_fills_frames);
+    RUN_TEST(pack_reports_truncation_and_empty);
+    RUN_TEST(pool_limit);
+
+    std::cout << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "  RESULTS: " << tests_passed << " passed, "
+              << tests_failed << " failed" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,217 @@
+/*
+ * Orbital Temple - Message Builder Unit Tests
+ *
+ * Tests msgbuf.cpp: appends, number formatting, truncation at the
+ * capacity and that nothing is written past the buffer.
+ *
+ * Compile: g++ -std=c++11 -O2 -o test_msgbuf test_msgbuf.cpp
+ * Run: ./test_msgbuf
+ */
+
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <climits>
+#include <chrono>
+#include <string>
+#include <stdexcept>
+
+// Module under test
+#include "../msgbuf.cpp"
+
+// ==================== TEST FRAMEWORK ====================
+
+int tests_passed = 0;
+int tests_failed = 0;
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Test: " << #name << "... "; \
+    try { \
+        test_##name(); \
+        std::cout << "PASS" << std::endl; \
+        tests_passed++; \
+    } catch (const std::exception& e) { \
+        std::cout << "FAIL: " << e.what() << std::endl; \
+        tests_failed++; \
+    } \
+} while(0)
+
+#define ASSERT(condition) do { \
+    if (!(condition)) { \
+        throw std::runtime_error("Assertion failed: " #condition); \
+    } \
+} while(0)
+
+#define ASSERT_STR(builder, expected) do { \
+    if (strcmp((builder).c_str(), (expected)) != 0) { \
+        throw std::runtime_error(std::string("Got \"") + (builder).c_str() + \
+                                 "\", expected \"" + (expected) + "\""); \
+    } \
+    ASSERT((builder).length() == strlen(expected)); \
+} while(0)
+
+// ==================== TESTS ====================
+
+TEST(starts_empty) {
+    MsgBuf<16> m;
+    ASSERT_STR(m, "");
+    ASSERT(!m.overflowed());
+    ASSERT(m.space() == 15);
+}
+
+TEST(chained_reply) {
+    // The reply sendMessage("OK:WRITTEN:" + String(n) + "B") used to build
+    MsgBuf<32> m;
+    m.add("OK:WRITTEN:").addU(1234).add('B');
+    ASSERT_STR(m, "OK:WRITTEN:1234B");
+}
+
+TEST(unsigned_values) {
+    MsgBuf<32> m;
+    m.addU(0).add(',').addU(7).add(',').addU(4294967295UL);
+    ASSERT_STR(m, "0,7,4294967295");
+}
+
+TEST(signed_values) {
+    MsgBuf<48> m;
+    m.addI(-42).add(',').addI(0).add(',').addI(LONG_MIN);
+    char expected[48];
+    snprintf(expected, sizeof(expected), "-42,0,%ld", LONG_MIN);
+    ASSERT_STR(m, expected);
+}
+
+TEST(float_like_string) {
+    // String(VT, 1) in the beacon
+    MsgBuf<32> m;
+    m.addF(3.86f, 1).add('|').addF(-0.25f, 2).add('|').addF(12.0f, 0);
+    ASSERT_STR(m, "3.9|-0.25|12");
+}
+
+TEST(printf_append) {
+    MsgBuf<32> m;
+    m.add("T+").addf("%02lu:%02lu", 3UL, 7UL).add("|B:").addU(2);
+    ASSERT_STR(m, "T+03:07|B:2");
+}
+
+TEST(add_with_length) {
+    MsgBuf<16> m;
+    m.add("CID:QmXYZ|rest", 9);
+    ASSERT_STR(m, "CID:QmXYZ");
+    m.add((const char*)NULL);
+    ASSERT_STR(m, "CID:QmXYZ");
+}
+
+TEST(truncates_at_capacity) {
+    MsgBuf<8> m;
+    m.add("ABCDE").add("FGHIJ");
+    ASSERT_STR(m, "ABCDEFG");
+    ASSERT(m.overflowed());
+    ASSERT(m.space() == 0);
+
+    m.add('X').addU(99);
+    ASSERT_STR(m, "ABCDEFG");
+}
+
+TEST(printf_truncates) {
+    MsgBuf<8> m;
+    m.add("ab").addf("%s", "cdefghijk");
+    ASSERT_STR(m, "abcdefg");
+    ASSERT(m.overflowed());
+}
+
+TEST(number_truncates) {
+    MsgBuf<6> m;
+    m.add("N:").addU(123456);
+    ASSERT_STR(m, "N:123");
+    ASSERT(m.overflowed());
+}
+
+TEST(no_write_past_buffer) {
+    // Caller-owned buffer with guard bytes on both sides
+    char raw[24];
+    memset(raw, 0x5A, sizeof(raw));
+    MsgBuilder m(raw + 4, 16);
+    m.add("0123456789").addf("%d%d%d%d%d%d%d%d", 1, 2, 3, 4, 5, 6, 7, 8).addU(4294967295UL);
+
+    ASSERT(m.length() == 15);
+    ASSERT(raw[4 + 15] == '\0');
+    for (int i = 0; i < 4; i++) ASSERT(raw[i] == 0x5A);
+    for (size_t i = 4 + 16; i < sizeof(raw); i++) ASSERT(raw[i] == 0x5A);
+}
+
+TEST(clear_resets) {
+    MsgBuf<4> m;
+    m.add("TOOLONG");
+    ASSERT(m.overflowed());
+    m.clear();
+    ASSERT_STR(m, "");
+    ASSERT(!m.overflowed());
+    m.add("OK");
+    ASSERT_STR(m, "OK");
+}
+
+// Filled through the base class, as getAccelStatus() and friends are
+static void addStatus(MsgBuilder& status) {
+    status.add("SEU:").addU(3);
+}
+
+TEST(append_through_base) {
+    Reply m;
+    m.add("RAD|");
+    addStatus(m);
+    ASSERT_STR(m, "RAD|SEU:3");
+    ASSERT(m.space() == MSG_REPLY_SIZE - 1 - 9);
+}
+
+// ==================== BENCHMARK ====================
+
+static void benchmarkReply() {
+    const int iterations = 1000000;
+    size_t sink = 0;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        MsgBuf<32> m;
+        m.add("OK:WRITTEN:").addU((unsigned long)i).add('B');
+        sink += m.length();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+
+    printf("\n  \"OK:WRITTEN:<n>B\" reply: %.1f ns (%lu chars built)\n", ns, (unsigned long)sink);
+}
+
+// ==================== MAIN ====================
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "  ORBITAL TEMPLE MSGBUF UNIT TESTS" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << std::endl;
+
+    RUN_TEST(starts_empty);
+    RUN_TEST(chained_reply);
+    RUN_TEST(unsigned_values);
+    RUN_TEST(signed_values);
+    RUN_TEST(float_like_string);
+    RUN_TEST(printf_append);
+    RUN_TEST(add_with_length);
+    RUN_TEST(truncates_at_capacity);
+    RUN_TEST(printf_truncates);
+    RUN_TEST(number_truncates);
+    RUN_TEST(no_write_past_buffer);
+    RUN_TEST(clear_resets);
+    RUN_TEST(append_through_base);
+
+    benchmarkReply();
+
+    std::cout << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "  RESULTS: " << tests_passed << " passed, "
+              << tests_failed << " failed" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -13,137 +13,241 @@
 #include <vector>
 #include <cstring>
 
-// Mock Arduino String class for PC testing
-class String {
-public:
-    std::string data;
-
-    String() {}
-    String(const char* s) : data(s) {}
-    String(const std::string& s) : data(s) {}
-
-    int indexOf(char c) const {
-        size_t pos = data.find(c);
-        return (pos == std::string::npos) ? -1 : (int)pos;
-    }
+// Test satellite ID
+const char* sat_id = "SAT001";
 
-    int indexOf(const char* s) const {
-        size_t pos = data.find(s);
-        return (pos == std::string::npos) ? -1 : (int)pos;
-    }
+// Mock functions
+bool verifyHMAC(const uint8_t* message, size_t length, const char* hmac, size_t hmacLength) {
+    // For testing, accept any 16-char hex string
+    return hmacLength == 16;
+}
 
-    String substring(int start, int end) const {
-        if (start < 0) start = 0;
-        if (end > (int)data.length()) end = data.length();
-        if (start >= end) return String("");
-        return String(data.substr(start, end - start));
-    }
+void sendMessage(const char* msg) {
+    std::cout << "  -> Response: " << msg << std::endl;
+}
 
-    String substring(int start) const {
-        return substring(start, data.length());
-    }
+// ==================== ACTUAL PARSER CODE (from loop.h / loop.cpp) ====================
 
-    size_t length() const { return data.length(); }
+#define RX_MAX_PACKET 255
 
-    bool equals(const String& other) const {
-        return data == other.data;
-    }
+struct StrView {
+    const char* ptr;
+    size_t len;
 
-    char charAt(unsigned int i) const {
-        if (i >= data.length()) return 0;
-        return data[i];
+    bool equals(const char* s) const {
+        return strlen(s) == len && memcmp(ptr, s, len) == 0;
     }
-
-    const char* c_str() const { return data.c_str(); }
 };
 
-// Test satellite ID
-String sat_id = "SAT001";
-
-// Mock functions
-bool verifyHMAC(const String& message, const String& hmac) {
-    // For testing, accept any 16-char hex string
-    return hmac.length() == 16;
-}
-
-void sendMessage(const String& msg) {
-    std::cout << "  -> Response: " << msg.data << std::endl;
-}
-
-// ==================== ACTUAL PARSER CODE (from loop.cpp) ====================
+struct ParsedMessage {
+    StrView satId;
+    StrView command;
+    StrView path;
+    StrView data;
+    StrView hmac;
+};
 
-bool validateMessage(const String& msg, String& satId, String& command,
-                     String& path, String& data, String& hmac) {
+bool validateMessage(char* buffer, size_t length, ParsedMessage& msg) {
     // Message format: SAT_ID-COMMAND&PATH@DATA#HMAC
     // Minimum valid message: "X-Y&@#Z" = 7 characters
 
-    if (msg.length() < 7) {
+    if (length < 7) {
         std::cout << "  [PARSE] Message too short" << std::endl;
         return false;
     }
 
-    if (msg.length() > 500) {
+    if (length > RX_MAX_PACKET) {
         std::cout << "  [PARSE] Message too long" << std::endl;
         return false;
     }
 
+    // Cheap rejection first: noise and other satellites on 401.5 MHz
+    // must not reach the delimiter scan or the HMAC
+    size_t idLength = strlen(sat_id);
+    if (length <= idLength || buffer[idLength] != '-' ||
+        memcmp(buffer, sat_id, idLength) != 0) {
+        std::cout << "  [PARSE] Wrong satellite ID" << std::endl;
+        return false;
+    }
+
     // Find all delimiters
-    int dashIdx = msg.indexOf('-');
-    int ampIdx = msg.indexOf('&');
-    int atIdx = msg.indexOf('@');
-    int hashIdx = msg.indexOf('#');
+    const char* dash = (const char*)memchr(buffer, '-', length);
+    const char* amp = (const char*)memchr(buffer, '&', length);
+    const char* at = (const char*)memchr(buffer, '@', length);
+    const char* hash = (const char*)memchr(buffer, '#', length);
 
     // Validate all delimiters present and in correct order
-    if (dashIdx == -1 || ampIdx == -1 || atIdx == -1 || hashIdx == -1) {
+    if (!dash || !amp || !at || !hash) {
         std::cout << "  [PARSE] Missing delimiter(s)" << std::endl;
         return false;
     }
 
-    if (!(dashIdx < ampIdx && ampIdx < atIdx && atIdx < hashIdx)) {
+    if (!(dash < amp && amp < at && at < hash)) {
         std::cout << "  [PARSE] Delimiters in wrong order" << std::endl;
         return false;
     }
 
-    // Extract parts
-    satId = msg.substring(0, dashIdx);
-    command = msg.substring(dashIdx + 1, ampIdx);
-    path = msg.substring(ampIdx + 1, atIdx);
-    data = msg.substring(atIdx + 1, hashIdx);
-    hmac = msg.substring(hashIdx + 1);
-
-    // Validate satellite ID
-    if (!satId.equals(sat_id)) {
-        std::cout << "  [PARSE] Wrong satellite ID: " << satId.data << std::endl;
+    // Extract parts (views only)
+    const char* end = buffer + length;
+    msg.satId.ptr = buffer;       msg.satId.len = dash - buffer;
+    msg.command.ptr = dash + 1;   msg.command.len = amp - (dash + 1);
+    msg.path.ptr = amp + 1;       msg.path.len = at - (amp + 1);
+    msg.data.ptr = at + 1;        msg.data.len = hash - (at + 1);
+    msg.hmac.ptr = hash + 1;      msg.hmac.len = end - (hash + 1);
+
+    // Truncated tag is always 16 hex chars
+    if (msg.hmac.len != 16) {
+        std::cout << "  [PARSE] Bad HMAC length" << std::endl;
         return false;
     }
 
     // Validate command is alphanumeric
-    for (unsigned int i = 0; i < command.length(); i++) {
-        char c = command.charAt(i);
-        if (!isalnum(c)) {
+    for (size_t i = 0; i < msg.command.len; i++) {
+        if (!isalnum((unsigned char)msg.command.ptr[i])) {
             std::cout << "  [PARSE] Invalid command characters" << std::endl;
             return false;
         }
     }
 
     // Validate path (no directory traversal)
-    if (path.indexOf("..") != -1) {
-        std::cout << "  [PARSE] Path traversal blocked!" << std::endl;
-        sendMessage("ERR:PATH_TRAVERSAL_BLOCKED");
-        return false;
+    for (size_t i = 0; i + 1 < msg.path.len; i++) {
+        if (msg.path.ptr[i] == '.' && msg.path.ptr[i + 1] == '.') {
+            std::cout << "  [PARSE] Path traversal blocked!" << std::endl;
+            sendMessage("ERR:PATH_TRAVERSAL_BLOCKED");
+            return false;
+        }
     }
 
-    // Verify HMAC
-    String messageToVerify = msg.substring(0, hashIdx);
-    if (!verifyHMAC(messageToVerify, hmac)) {
+    // Verify HMAC over SAT_ID-COMMAND&PATH@DATA
+    if (!verifyHMAC((const uint8_t*)buffer, hash - buffer, msg.hmac.ptr, msg.hmac.len)) {
         std::cout << "  [AUTH] HMAC verification failed!" << std::endl;
         sendMessage("ERR:AUTH_FAILED");
         return false;
     }
 
+    // Authentic - terminate fields in place
+    buffer[dash - buffer] = '\0';
+    buffer[amp - buffer] = '\0';
+    buffer[at - buffer] = '\0';
+    buffer[hash - buffer] = '\0';
+    buffer[length] = '\0';
+
     return true;
 }
 
+#define BATCH_MAX_COMMANDS  8
+#define BATCH_SEPARATOR     ';'
+
+// Entries are only split here; the envelope HMAC already covered them
+int splitBatch(char* data, size_t length, ParsedMessage* out, size_t maxCommands) {
+    char* end = data + length;
+    char* entry = data;
+    size_t count = 0;
+
+    while (entry < end) {
+        char* sep = (char*)memchr(entry, BATCH_SEPARATOR, end - entry);
+        char* entryEnd = sep ? sep : end;
+
+        if (entryEnd > entry) {
+            int index = (int)count;
+            if (count >= maxCommands) {
+                return -1 - index;
+            }
+
+            // COMMAND&PATH@DATA, same rules as a single command
+            char* amp = (char*)memchr(entry, '&', entryEnd - entry);
+            char* at = amp ? (char*)memchr(amp, '@', entryEnd - amp) : NULL;
+            if (!amp || !at || amp == entry) {
+                return -1 - index;
+            }
+            for (const char* c = entry; c < amp; c++) {
+                if (!isalnum((unsigned char)*c)) return -1 - index;
+            }
+            for (const char* c = amp + 1; c + 1 < at; c++) {
+                if (c[0] == '.' && c[1] == '.') {
+                    std::cout << "  [PARSE] Path traversal blocked!" << std::endl;
+                    return -1 - index;
+                }
+            }
+
+            ParsedMessage& msg = out[count++];
+            msg.command.ptr = entry;    msg.command.len = amp - entry;
+            msg.path.ptr = amp + 1;     msg.path.len = at - (amp + 1);
+            msg.data.ptr = at + 1;      msg.data.len = entryEnd - (at + 1);
+            *amp = '\0';
+            *at = '\0';
+        }
+
+        if (!sep) break;
+        *sep = '\0';
+        entry = sep + 1;
+    }
+
+    return (int)count;
+}
+
+// Command table lookup (names only - handlers are not needed here)
+struct CommandEntry {
+    const char* name;
+};
+
+static constexpr CommandEntry COMMAND_TABLE[] = {
+    { "AccelAnalyze" }, { "AccelCancel" }, { "AccelList" }, { "AccelRecord" }, { "AccelStatus" },
+    { "AppendFile" }, { "Batch" }, { "CreateDir" }, { "DeleteFile" }, { "ForceOperational" },
+    { "GetPerf" }, { "GetRadStatus" }, { "GetState" }, { "ListDir" }, { "MCURestart" },
+    { "NameBatch" }, { "NameQuery" }, { "Ping" }, { "ReadFile" }, { "ReadFileRange" }, { "RemoveDir" },
+    { "RenameFile" }, { "SetLinkProfile" }, { "SetTelemetryFormat" }, { "Status" }, { "TestFileIO" },
+    { "UploadAbort" }, { "UploadBegin" }, { "UploadChunk" }, { "UploadStatus" },
+    { "WriteFile" }, { "artworkAscension" }, { "artworkGet" }, { "artworkList" },
+};
+
+static constexpr size_t COMMAND_COUNT = sizeof(COMMAND_TABLE) / sizeof(COMMAND_TABLE[0]);
+
+static constexpr int constStrCmp(const char* a, const char* b) {
+    return (*a != *b || *a == '\0')
+        ? (int)(unsigned char)*a - (int)(unsigned char)*b
+        : constStrCmp(a + 1, b + 1);
+}
+
+static constexpr bool commandTableSorted(size_t i) {
+    return (i + 1 >= COMMAND_COUNT)
+        ? true
+        : (constStrCmp(COMMAND_TABLE[i].name, COMMAND_TABLE[i + 1].name) < 0 &&
+           commandTableSorted(i + 1));
+}
+
+static_assert(commandTableSorted(0), "COMMAND_TABLE must be sorted by name (strcmp order)");
+
+static int compareCommand(const char* name, const StrView& cmd) {
+    int r = strncmp(name, cmd.ptr, cmd.len);
+    if (r != 0) return r;
+    return name[cmd.len] == '\0' ? 0 : 1;   // Longer table name sorts after
+}
+
+const CommandEntry* findCommand(const StrView& name) {
+    size_t lo = 0;
+    size_t hi = COMMAND_COUNT;
+
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        int r = compareCommand(COMMAND_TABLE[mid].name, name);
+        if (r == 0) return &COMMAND_TABLE[mid];
+        if (r < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return NULL;
+}
+
+// Parse a std::string through a writable RX-style buffer
+static bool parse(const std::string& input, ParsedMessage& msg, std::vector<char>& buffer) {
+    buffer.assign(input.begin(), input.end());
+    buffer.push_back('\0');
+    return validateMessage(buffer.data(), input.length(), msg);
+}
+
 // ==================== TEST CASES ====================
 
 struct TestCase {
@@ -163,6 +267,7 @@ int main() {
         {"Valid Ping", "SAT001-Ping&@#1234567890abcdef", true},
         {"Valid Status", "SAT001-Status&@#1234567890abcdef", true},
         {"Valid WriteFile", "SAT001-WriteFile&/names.txt@John Doe#1234567890abcdef", true},
+        {"Valid Batch envelope", "SAT001-Batch&@Ping&@;GetState&@#1234567890abcdef", true},
 
         // Empty and short
         {"Empty string", "", false},
@@ -184,6 +289,8 @@ int main() {
         // Wrong satellite ID
         {"Wrong ID", "SAT002-Ping&@#1234567890abcdef", false},
         {"Empty ID", "-Ping&@#1234567890abcdef", false},
+        {"ID prefix only", "SAT0011-Ping&@#1234567890abcdef", false},
+        {"Foreign noise", "\x7f\x01garbage-from-another-sat#", false},
 
         // Invalid command characters
         {"Command with space", "SAT001-Ping Me&@#1234567890abcdef", false},
@@ -198,11 +305,14 @@ int main() {
         // Invalid HMAC
         {"Short HMAC", "SAT001-Ping&@#123", false},
         {"Empty HMAC", "SAT001-Ping&@#", false},
+        {"Long HMAC", "SAT001-Ping&@#1234567890abcdef0", false},
 
         // Very long inputs
         {"Long command", "SAT001-" + std::string(100, 'A') + "&@#1234567890abcdef", true},
         {"Long path", "SAT001-Ping&" + std::string(200, '/') + "@#1234567890abcdef", true},
-        {"Long data", "SAT001-WriteFile&/f@" + std::string(300, 'X') + "#1234567890abcdef", true},
+        {"Long data", "SAT001-WriteFile&/f@" + std::string(200, 'X') + "#1234567890abcdef", true},
+        {"Max packet (255)", "SAT001-Ping&@" + std::string(225, 'X') + "#1234567890abcdef", true},
+        {"Too long (>255)", "SAT001-Ping&@" + std::string(226, 'X') + "#1234567890abcdef", false},
         {"Too long (>500)", "SAT001-Ping&@" + std::string(500, 'X') + "#1234567890abcdef", false},
 
         // Edge cases with multiple delimiters
@@ -223,13 +333,14 @@ int main() {
     int failed = 0;
 
     for (const auto& test : tests) {
-        String satId, command, path, data, hmac;
+        ParsedMessage msg;
+        std::vector<char> buffer;
 
         std::cout << "Test: " << test.name << std::endl;
         std::cout << "  Input: \"" << test.input.substr(0, 60)
                   << (test.input.length() > 60 ? "..." : "") << "\"" << std::endl;
 
-        bool result = validateMessage(String(test.input), satId, command, path, data, hmac);
+        bool result = parse(test.input, msg, buffer);
 
         bool success = (result == test.shouldPass);
 
@@ -246,6 +357,93 @@ int main() {
         std::cout << std::endl;
     }
 
+    // In-place field termination
+    {
+        std::cout << "Test: Fields NUL-terminated in place" << std::endl;
+        ParsedMessage msg;
+        std::vector<char> buffer;
+        bool ok = parse("SAT001-WriteFile&/names.txt@John Doe#1234567890abcdef", msg, buffer) &&
+                  strcmp(msg.command.ptr, "WriteFile") == 0 &&
+                  strcmp(msg.path.ptr, "/names.txt") == 0 &&
+                  strcmp(msg.data.ptr, "John Doe") == 0 &&
+                  msg.path.ptr >= buffer.data() && msg.path.ptr < buffer.data() + buffer.size();
+        std::cout << "  Result: " << (ok ? "PASS" : "*** FAIL ***") << std::endl << std::endl;
+        ok ? passed++ : failed++;
+    }
+
+    // Command table lookup
+    {
+        struct LookupCase { const char* name; bool found; };
+        const LookupCase lookups[] = {
+            {"AccelCancel", true}, {"artworkList", true}, {"ReadFile", true},
+            {"ReadFileRange", true}, {"Status", true}, {"Ping", true},
+            {"ReadFil", false}, {"ReadFileR", false}, {"ping", false},
+            {"", false}, {"Zzz", false}, {"artworkListX", false},
+        };
+        for (const auto& c : lookups) {
+            StrView name = { c.name, strlen(c.name) };
+            const CommandEntry* entry = findCommand(name);
+            bool ok = c.found ? (entry != NULL && strcmp(entry->name, c.name) == 0) : (entry == NULL);
+            std::cout << "Test: Lookup \"" << c.name << "\" -> "
+                      << (ok ? "PASS" : "*** FAIL ***") << std::endl;
+            ok ? passed++ : failed++;
+        }
+
+        // Every table entry must be reachable
+        bool all = true;
+        for (size_t i = 0; i < COMMAND_COUNT; i++) {
+            StrView name = { COMMAND_TABLE[i].name, strlen(COMMAND_TABLE[i].name) };
+            all = all && (findCommand(name) == &COMMAND_TABLE[i]);
+        }
+        std::cout << "Test: All table entries found -> " << (all ? "PASS" : "*** FAIL ***") << std::endl;
+        all ? passed++ : failed++;
+        std::cout << std::endl;
+    }
+
+    // Batch envelope splitting
+    {
+        struct BatchCase { const char* name; const char* data; int expected; };
+        const BatchCase cases[] = {
+            {"Single entry", "Ping&@", 1},
+            {"Five entries", "Ping&@;GetState&@;GetRadStatus&@;AccelStatus&@;Status&@", 5},
+            {"Trailing separator", "Ping&@;GetState&@;", 2},
+            {"Empty entries skipped", ";;Ping&@;;", 1},
+            {"Empty batch", "", 0},
+            {"Missing at in entry 1", "Ping&@;GetState&", -2},
+            {"Missing amp in entry 0", "Ping@x", -1},
+            {"Empty command", "&@;Ping&@", -1},
+            {"Bad command chars", "Ping&@;Get-State&@", -2},
+            {"Traversal in entry 2", "Ping&@;Ping&@;ReadFile&/../x@", -3},
+            {"Nine entries", "A&@;B&@;C&@;D&@;E&@;F&@;G&@;H&@;I&@", -9},
+            {"Eight entries", "A&@;B&@;C&@;D&@;E&@;F&@;G&@;H&@", 8},
+        };
+        for (const auto& c : cases) {
+            std::vector<char> buffer(c.data, c.data + strlen(c.data));
+            buffer.push_back('\0');
+            ParsedMessage commands[BATCH_MAX_COMMANDS];
+            int n = splitBatch(buffer.data(), strlen(c.data), commands, BATCH_MAX_COMMANDS);
+            bool ok = (n == c.expected);
+            std::cout << "Test: Batch " << c.name << " -> " << n << " "
+                      << (ok ? "PASS" : "*** FAIL ***") << std::endl;
+            ok ? passed++ : failed++;
+        }
+
+        // Fields are NUL-terminated views in place
+        std::string data = "ReadFile&/a.txt@B;WriteFile&/n.txt@John Doe";
+        std::vector<char> buffer(data.begin(), data.end());
+        buffer.push_back('\0');
+        ParsedMessage commands[BATCH_MAX_COMMANDS];
+        int n = splitBatch(buffer.data(), data.length(), commands, BATCH_MAX_COMMANDS);
+        bool ok = n == 2 &&
+                  commands[0].command.equals("ReadFile") && strcmp(commands[0].path.ptr, "/a.txt") == 0 &&
+                  strcmp(commands[0].data.ptr, "B") == 0 &&
+                  commands[1].command.equals("WriteFile") && strcmp(commands[1].data.ptr, "John Doe") == 0 &&
+                  commands[1].data.len == 8;
+        std::cout << "Test: Batch fields terminated in place -> " << (ok ? "PASS" : "*** FAIL ***") << std::endl;
+        ok ? passed++ : failed++;
+        std::cout << std::endl;
+    }
+
     std::cout << "========================================" << std::endl;
     std::cout << "  RESULTS: " << passed << " passed, " << failed << " failed" << std::endl;
     std::cout << "========================================" << std::endl;
@@ -0,0 +1,205 @@
+/*
+ * Orbital Temple - Latency Histogram Unit Tests
+ *
+ * Feeds known durations into the log2 histograms (perf.cpp) and checks
+ * bucketing, min/max/mean, the conservative percentiles, the summary
+ * format and the scoped timer.
+ *
+ * Compile: g++ -std=c++11 -O2 -o test_perf test_perf.cpp
+ * Run: ./test_perf
+ */
+
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <stdexcept>
+
+// Histograms under test
+#include "../perf.cpp"
+
+// ==================== TEST FRAMEWORK ====================
+
+int tests_passed = 0;
+int tests_failed = 0;
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Test: " << #name << "... "; \
+    perfReset(); \
+    try { \
+        test_##name(); \
+        std::cout << "PASS" << std::endl; \
+        tests_passed++; \
+    } catch (const std::exception& e) { \
+        std::cout << "FAIL: " << e.what() << std::endl; \
+        tests_failed++; \
+    } \
+} while(0)
+
+#define ASSERT_EQ(expected, actual) do { \
+    if ((expected) != (actual)) { \
+        throw std::runtime_error("Expected " + std::to_string(expected) + " but got " + std::to_string(actual)); \
+    } \
+} while(0)
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        throw std::runtime_error("Assertion failed: " #cond); \
+    } \
+} while(0)
+
+// ==================== TESTS ====================
+
+TEST(empty_probe_has_no_stats) {
+    PerfStats s;
+    ASSERT_TRUE(!perfStats(PERF_LOOP, s));
+    ASSERT_EQ(0u, s.count);
+}
+
+TEST(bucket_boundaries) {
+    ASSERT_EQ(0, perfBucket(0));
+    ASSERT_EQ(0, perfBucket(1));
+    ASSERT_EQ(1, perfBucket(2));
+    ASSERT_EQ(1, perfBucket(3));
+    ASSERT_EQ(10, perfBucket(1024));
+    ASSERT_EQ(10, perfBucket(2047));
+    ASSERT_EQ(PERF_BUCKETS - 1, perfBucket(1u << (PERF_BUCKETS - 1)));
+    ASSERT_EQ(PERF_BUCKETS - 1, perfBucket(0xFFFFFFFFu));
+}
+
+TEST(min_max_mean_exact) {
+    perfRecord(PERF_HMAC, 120);
+    perfRecord(PERF_HMAC, 80);
+    perfRecord(PERF_HMAC, 400);
+    PerfStats s;
+    ASSERT_TRUE(perfStats(PERF_HMAC, s));
+    ASSERT_EQ(3u, s.count);
+    ASSERT_EQ(80u, s.minUs);
+    ASSERT_EQ(400u, s.maxUs);
+    ASSERT_EQ(200u, s.meanUs);
+}
+
+TEST(single_value_percentiles_are_exact) {
+    for (int i = 0; i < 50; i++) perfRecord(PERF_SEND, 700);
+    PerfStats s;
+    perfStats(PERF_SEND, s);
+    ASSERT_EQ(700u, s.p50Us);
+    ASSERT_EQ(700u, s.p99Us);
+}
+
+TEST(p99_catches_the_tail) {
+    // 990 fast iterations and 10 slow ones: p99 is the last fast one
+    for (int i = 0; i < 990; i++) perfRecord(PERF_LOOP, 100);
+    for (int i = 0; i < 10; i++) perfRecord(PERF_LOOP, 50000);
+    PerfStats s;
+    perfStats(PERF_LOOP, s);
+    ASSERT_EQ(127u, s.p99Us);                  // Upper bound of [64, 128)
+    ASSERT_EQ(127u, s.p50Us);
+
+    // One more slow one pushes the 99th percentile into the tail
+    perfRecord(PERF_LOOP, 50000);
+    perfStats(PERF_LOOP, s);
+    ASSERT_EQ(50000u, s.p99Us);                // Bucket bound clamped to max
+}
+
+TEST(percentile_never_optimistic) {
+    uint32_t values[] = { 3, 17, 250, 251, 999, 4096, 70000, 123456 };
+    for (uint32_t v : values) perfRecord(PERF_SD_WRITE, v);
+    PerfStats s;
+    perfStats(PERF_SD_WRITE, s);
+    // Nearest rank 4 of 8 is 251; reported bound is >= it and < 2x
+    ASSERT_TRUE(s.p50Us >= 251 && s.p50Us < 502);
+    ASSERT_EQ(123456u, s.p99Us);
+}
+
+TEST(probes_are_independent) {
+    perfRecord(PERF_SCRUB, 10);
+    PerfStats s;
+    ASSERT_TRUE(perfStats(PERF_SCRUB, s));
+    ASSERT_TRUE(!perfStats(PERF_PROCESS, s));
+}
+
+TEST(summary_format) {
+    perfRecord(PERF_LOOP, 5);
+    perfRecord(PERF_LOOP, 900);
+    perfRecord(PERF_HMAC, 64);
+    char buf[PERF_SUMMARY_MAX];
+    size_t len = perfSummary(buf, sizeof(buf));
+    ASSERT_EQ(strlen(buf), len);
+    std::string s(buf);
+    ASSERT_TRUE(s.compare(0, 5, "PERF|") == 0);
+    ASSERT_TRUE(s.find("|LOOP:2/5/900/900") != std::string::npos);
+    ASSERT_TRUE(s.find("|HMAC:1/64/64/64") != std::string::npos);
+    ASSERT_TRUE(s.find("|SCRUB:0/0/0/0") != std::string::npos);
+}
+
+TEST(summary_fits_a_soak_week) {
+    // 7 days of 1 ms loops, 10 s outliers everywhere
+    for (int p = 0; p < PERF_PROBE_COUNT; p++) {
+        perfRecord((PerfProbe)p, 1);
+        perfRecord((PerfProbe)p, 9999999);
+        hists[p].count = 100000;
+    }
+    hists[PERF_LOOP].count = 604800000;
+    char buf[PERF_SUMMARY_MAX];
+    size_t len = perfSummary(buf, sizeof(buf));
+    ASSERT_TRUE(len < sizeof(buf));
+    ASSERT_EQ(strlen(buf), len);
+}
+
+TEST(summary_truncates_safely) {
+    perfRecord(PERF_LOOP, 1);
+    char buf[12];
+    size_t len = perfSummary(buf, sizeof(buf));
+    ASSERT_EQ(sizeof(buf) - 1, len);
+    ASSERT_EQ(strlen(buf), len);
+}
+
+TEST(scope_records_on_exit) {
+    {
+        PerfScope perf(PERF_PROCESS);
+        volatile uint32_t spin = 0;
+        for (int i = 0; i < 100000; i++) spin += i;
+    }
+    PerfStats s;
+    ASSERT_TRUE(perfStats(PERF_PROCESS, s));
+    ASSERT_EQ(1u, s.count);
+}
+
+TEST(reset_clears_everything) {
+    perfRecord(PERF_SEND, 1);
+    perfRecord(PERF_LOOP, 1);
+    perfReset();
+    PerfStats s;
+    ASSERT_TRUE(!perfStats(PERF_LOOP, s));
+}
+
+// ==================== MAIN ====================
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "  ORBITAL TEMPLE PERF HISTOGRAM TESTS" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << std::endl;
+
+    RUN_TEST(empty_probe_has_no_stats);
+    RUN_TEST(bucket_boundaries);
+    RUN_TEST(min_max_mean_exact);
+    RUN_TEST(single_value_percentiles_are_exact);
+    RUN_TEST(p99_catches_the_tail);
+    RUN_TEST(percentile_never_optimistic);
+    RUN_TEST(probes_are_independent);
+    RUN_TEST(summary_format);
+    RUN_TEST(summary_fits_a_soak_week);
+    RUN_TEST(summary_truncates_safely);
+    RUN_TEST(scope_records_on_exit);
+    RUN_TEST(reset_clears_everything);
+
+    std::cout << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "  RESULTS: " << tests_passed << " passed, " << tests_failed << " failed" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,279 @@
+/*
+ * Orbital Temple - Scheduler Unit Tests
+ *
+ * Drives the deadline scheduler (scheduler.cpp) with a virtual clock:
+ * ordering, fixed-phase periodic jobs, one-shots, re-arming from a
+ * callback and millis() wrap-around.
+ *
+ * Compile: g++ -std=c++11 -O2 -o test_scheduler test_scheduler.cpp
+ * Run: ./test_scheduler
+ */
+
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// Scheduler under test
+#include "../scheduler.cpp"
+
+// ==================== TEST FRAMEWORK ====================
+
+int tests_passed = 0;
+int tests_failed = 0;
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Test: " << #name << "... "; \
+    schedReset(); \
+    events.clear(); \
+    try { \
+        test_##name(); \
+        std::cout << "PASS" << std::endl; \
+        tests_passed++; \
+    } catch (const std::exception& e) { \
+        std::cout << "FAIL: " << e.what() << std::endl; \
+        tests_failed++; \
+    } \
+} while(0)
+
+#define ASSERT_EQ(expected, actual) do { \
+    if ((expected) != (actual)) { \
+        throw std::runtime_error("Expected " + std::to_string(expected) + " but got " + std::to_string(actual)); \
+    } \
+} while(0)
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        throw std::runtime_error("Assertion failed: " #cond); \
+    } \
+} while(0)
+
+// ==================== HELPERS ====================
+
+struct Event {
+    char job;
+    unsigned long at;
+};
+
+static std::vector<Event> events;
+
+static void jobA(unsigned long now) { events.push_back({ 'A', now }); }
+static void jobB(unsigned long now) { events.push_back({ 'B', now }); }
+static void jobC(unsigned long now) { events.push_back({ 'C', now }); }
+
+// Step a virtual clock from start to end in 1 ms increments
+static void runClock(unsigned long start, unsigned long end) {
+    for (unsigned long t = start; t != end; t++) {
+        schedRun(t);
+    }
+}
+
+// ==================== TESTS ====================
+
+TEST(nothing_armed) {
+    ASSERT_EQ(SCHED_IDLE_MAX, schedRun(0));
+    SchedJob a = schedRegister("a", jobA, 100);
+    ASSERT_TRUE(!schedArmed(a));
+    ASSERT_EQ(SCHED_IDLE_MAX, schedRun(1000));
+    ASSERT_EQ(0u, events.size());
+}
+
+TEST(periodic_fixed_phase) {
+    schedEvery("a", jobA, 100, 0);
+    runClock(0, 1001);
+    ASSERT_EQ(10u, events.size());
+    for (size_t i = 0; i < events.size(); i++) {
+        ASSERT_EQ((i + 1) * 100, events[i].at);
+    }
+}
+
+TEST(late_run_keeps_phase) {
+    SchedJob a = schedEvery("a", jobA, 100, 0);
+    schedRun(130);                      // 30 ms late
+    ASSERT_EQ(70ul, schedRun(130));     // Next at 200, not 230
+    ASSERT_EQ(30ul, schedJobMaxLate(a));
+}
+
+TEST(missed_periods_not_replayed) {
+    schedEvery("a", jobA, 100, 0);
+    schedRun(1050);                     // Stalled for ten periods
+    ASSERT_EQ(1u, events.size());
+    ASSERT_EQ(100ul, schedNextDelay(1050));
+}
+
+TEST(earliest_first_and_delay) {
+    SchedJob a = schedRegister("a", jobA, 0);
+    SchedJob b = schedRegister("b", jobB, 0);
+    SchedJob c = schedRegister("c", jobC, 0);
+    schedAfter(a, 300, 0);
+    schedAfter(b, 100, 0);
+    schedAfter(c, 200, 0);
+    ASSERT_EQ(100ul, schedNextDelay(0));
+    ASSERT_EQ(100ul, schedRun(100));    // b ran, c due in 100
+    schedRun(500);
+    ASSERT_EQ(3u, events.size());
+    ASSERT_EQ('B', events[0].job);
+    ASSERT_EQ('C', events[1].job);
+    ASSERT_EQ('A', events[2].job);
+    ASSERT_TRUE(!schedArmed(a) && !schedArmed(b) && !schedArmed(c));
+}
+
+TEST(cancel_and_rearm) {
+    SchedJob a = schedEvery("a", jobA, 50, 0);
+    SchedJob b = schedEvery("b", jobB, 70, 0);
+    schedCancel(a);
+    runClock(0, 200);
+    ASSERT_EQ(2u, events.size());       // b at 70 and 140
+    schedAfter(a, 5, 200);              // One early run, then every 50
+    runClock(200, 256);
+    ASSERT_EQ('A', events[2].job);
+    ASSERT_EQ(205ul, events[2].at);
+    ASSERT_EQ('B', events[3].job);
+    ASSERT_EQ('A', events[4].job);
+    ASSERT_EQ(255ul, events[4].at);
+    ASSERT_EQ(3u, schedJobRuns(b));
+}
+
+static SchedJob selfJob;
+static int selfRuns = 0;
+static void jobSelf(unsigned long now) {
+    selfRuns++;
+    // Back-off: 10, 20, 40 ... then stop
+    if (selfRuns < 5) {
+        schedAfter(selfJob, 10UL << selfRuns, now);
+    }
+}
+
+TEST(callback_rearms_itself) {
+    selfRuns = 0;
+    selfJob = schedRegister("self", jobSelf, 0);
+    schedAfter(selfJob, 0, 0);
+    runClock(0, 1000);
+    ASSERT_EQ(5, selfRuns);
+    ASSERT_TRUE(!schedArmed(selfJob));
+}
+
+static SchedJob spinJob;
+static void jobSpin(unsigned long now) {
+    events.push_back({ 'S', now });
+    schedAfter(spinJob, 0, now);
+}
+
+TEST(zero_delay_loop_is_bounded) {
+    spinJob = schedRegister("spin", jobSpin, 0);
+    schedAfter(spinJob, 0, 0);
+    ASSERT_EQ(0ul, schedRun(0));
+    ASSERT_EQ((size_t)SCHED_MAX_JOBS, events.size());
+}
+
+TEST(millis_wraparound) {
+    unsigned long start = (unsigned long)(uint32_t)0xFFFFFF00u;
+    if (sizeof(unsigned long) > 4) {
+        start = ~0UL - 0xFF;            // Same edge on a 64-bit host
+    }
+    schedEvery("a", jobA, 100, start);
+    runClock(start, start + 1001);
+    ASSERT_EQ(10u, events.size());
+    ASSERT_EQ(start + 1000, events[9].at);
+}
+
+TEST(table_full) {
+    for (int i = 0; i < SCHED_MAX_JOBS; i++) {
+        ASSERT_TRUE(schedRegister("x", jobA, 10) != SCHED_NONE);
+    }
+    ASSERT_EQ(0, schedRejected());
+    ASSERT_EQ(SCHED_NONE, schedRegister("y", jobA, 10));
+    ASSERT_EQ(SCHED_MAX_JOBS, schedJobCount());
+    ASSERT_EQ(1, schedRejected());
+    schedAfter(SCHED_NONE, 0, 0);      // Ignored
+
+    schedReset();
+    ASSERT_EQ(0, schedRejected());
+}
+
+// Many random jobs against a brute-force model
+static unsigned long modelDeadline[SCHED_MAX_JOBS];
+static bool modelArmed[SCHED_MAX_JOBS];
+static int lastRun = -1;
+static unsigned long lastRunAt = 0;
+static void jobRecord(unsigned long now) { lastRun = 0; lastRunAt = now; }
+
+TEST(heap_matches_model) {
+    srand(7);
+    for (int i = 0; i < SCHED_MAX_JOBS; i++) {
+        schedRegister("r", jobRecord, 0);
+        modelArmed[i] = false;
+    }
+    unsigned long now = 0;
+    for (int step = 0; step < 20000; step++) {
+        int job = rand() % SCHED_MAX_JOBS;
+        int op = rand() % 4;
+        if (op == 0) {
+            schedCancel(job);
+            modelArmed[job] = false;
+        } else if (op < 3) {
+            unsigned long delay = rand() % 500;
+            schedAfter(job, delay, now);
+            modelDeadline[job] = now + delay;
+            modelArmed[job] = true;
+        } else {
+            now += rand() % 50;
+            // Expected: every armed job with deadline <= now runs and disarms
+            size_t due = 0;
+            for (int i = 0; i < SCHED_MAX_JOBS; i++) {
+                if (modelArmed[i] && (long)(now - modelDeadline[i]) >= 0) {
+                    due++;
+                    modelArmed[i] = false;
+                }
+            }
+            uint32_t before = 0, after = 0;
+            for (int i = 0; i < SCHED_MAX_JOBS; i++) before += schedJobRuns(i);
+            schedRun(now);
+            for (int i = 0; i < SCHED_MAX_JOBS; i++) after += schedJobRuns(i);
+            ASSERT_EQ(due, (size_t)(after - before));
+        }
+
+        // Next delay agrees with the model
+        unsigned long expected = SCHED_IDLE_MAX;
+        for (int i = 0; i < SCHED_MAX_JOBS; i++) {
+            if (!modelArmed[i]) continue;
+            unsigned long d = (long)(modelDeadline[i] - now) > 0 ? modelDeadline[i] - now : 0;
+            if (d < expected) expected = d;
+        }
+        ASSERT_EQ(expected, schedNextDelay(now));
+        for (int i = 0; i < SCHED_MAX_JOBS; i++) {
+            ASSERT_EQ(modelArmed[i], schedArmed(i));
+        }
+    }
+}
+
+// ==================== MAIN ====================
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "  ORBITAL TEMPLE SCHEDULER UNIT TESTS" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << std::endl;
+
+    RUN_TEST(nothing_armed);
+    RUN_TEST(periodic_fixed_phase);
+    RUN_TEST(late_run_keeps_phase);
+    RUN_TEST(missed_periods_not_replayed);
+    RUN_TEST(earliest_first_and_delay);
+    RUN_TEST(cancel_and_rearm);
+    RUN_TEST(callback_rearms_itself);
+    RUN_TEST(zero_delay_loop_is_bounded);
+    RUN_TEST(millis_wraparound);
+    RUN_TEST(table_full);
+    RUN_TEST(heap_matches_model);
+
+    std::cout << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "  RESULTS: " << tests_passed << " passed, " << tests_failed << " failed" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    return tests_failed > 0 ? 1 : 0;
+}
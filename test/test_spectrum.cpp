@@ -0,0 +1,212 @@
+/*
+ * Orbital Temple - Accelerometer Spectrum Unit Tests
+ *
+ * Feeds synthetic recordings through the on-board analysis kernel
+ * (spectrum.cpp) the way accel.cpp does - in 42-sample chunks - and checks
+ * statistics, vibration peaks and the tumble line.
+ *
+ * Compile: g++ -std=c++11 -O2 -o test_spectrum test_spectrum.cpp
+ * Run: ./test_spectrum
+ */
+
+#include <iostream>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+#include <string>
+#include <vector>
+
+// Kernel under test
+#include "../spectrum.cpp"
+
+// ==================== TEST FRAMEWORK ====================
+
+int tests_passed = 0;
+int tests_failed = 0;
+
+#define TEST(name) void test_##name()
+#define RUN_TEST(name) do { \
+    std::cout << "Test: " << #name << "... "; \
+    try { \
+        test_##name(); \
+        std::cout << "PASS" << std::endl; \
+        tests_passed++; \
+    } catch (const std::exception& e) { \
+        std::cout << "FAIL: " << e.what() << std::endl; \
+        tests_failed++; \
+    } \
+} while(0)
+
+#define ASSERT_NEAR(expected, actual, tol) do { \
+    if (std::fabs((double)(expected) - (double)(actual)) > (tol)) { \
+        throw std::runtime_error("Expected " + std::to_string(expected) + " but got " + std::to_string(actual)); \
+    } \
+} while(0)
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        throw std::runtime_error("Assertion failed: " #cond); \
+    } \
+} while(0)
+
+// ==================== HELPERS ====================
+
+static SpectrumAnalyzer analyzer;
+
+struct Tone {
+    float hz;
+    float amp;
+};
+
+// One 60 s recording: offset + tones per axis, optional noise
+static void analyse(float rate, const float offset[3], const std::vector<Tone> tones[3],
+                    AxisResult out[3], float noise = 0.0f) {
+    uint32_t n = (uint32_t)(rate * 60);
+    std::vector<float> xyz(n * 3);
+    uint32_t seed = 12345;
+    for (uint32_t i = 0; i < n; i++) {
+        float t = i / rate;
+        for (int a = 0; a < 3; a++) {
+            float v = offset[a];
+            for (const Tone& tone : tones[a]) {
+                v += tone.amp * std::sin(2 * (float)M_PI * tone.hz * t);
+            }
+            seed = seed * 1103515245u + 12345u;
+            v += noise * (((seed >> 16) & 0x7FFF) / 16384.0f - 1.0f);
+            xyz[i * 3 + a] = v;
+        }
+    }
+
+    spectrumBegin(analyzer, rate, n);
+    for (uint32_t i = 0; i < n; i += 42) {
+        uint32_t chunk = n - i < 42 ? n - i : 42;
+        spectrumAdd(analyzer, &xyz[i * 3], chunk);
+    }
+    spectrumFinish(analyzer, out);
+}
+
+// ==================== TESTS ====================
+
+TEST(statistics_of_static_gravity) {
+    const float offset[3] = { 0.0f, 0.0f, 1.0f };
+    std::vector<Tone> tones[3];
+    tones[0].push_back({ 10.0f, 0.5f });
+    AxisResult r[3];
+    analyse(119, offset, tones, r);
+
+    ASSERT_TRUE(analyzer.count == 7140);
+    ASSERT_NEAR(0.0, r[0].mean, 1e-3);
+    ASSERT_NEAR(0.5 / std::sqrt(2.0), r[0].rms, 1e-3);
+    ASSERT_NEAR(-0.5, r[0].min, 1e-2);
+    ASSERT_NEAR(0.5, r[0].max, 1e-2);
+    ASSERT_NEAR(1.0, r[2].mean, 1e-4);
+    ASSERT_NEAR(1.0, r[2].rms, 1e-4);
+    ASSERT_NEAR(1.0, r[2].min, 1e-6);
+    ASSERT_NEAR(1.0, r[2].max, 1e-6);
+}
+
+TEST(vibration_peak_frequency_and_amplitude) {
+    const float offset[3] = { 0.0f, 0.0f, 1.0f };
+    std::vector<Tone> tones[3];
+    tones[0].push_back({ 12.3f, 0.2f });
+    AxisResult r[3];
+    analyse(119, offset, tones, r);
+
+    // Bin is 0.46 Hz; interpolation gets well inside it
+    ASSERT_NEAR(12.3, r[0].peakHz[0], 0.1);
+    ASSERT_NEAR(0.2, r[0].peakAmp[0], 0.03);
+}
+
+TEST(xy_packing_keeps_axes_apart) {
+    const float offset[3] = { 0.1f, -0.2f, 1.0f };
+    std::vector<Tone> tones[3];
+    tones[0].push_back({ 8.0f, 0.3f });
+    tones[1].push_back({ 25.0f, 0.1f });
+    tones[2].push_back({ 40.0f, 0.05f });
+    AxisResult r[3];
+    analyse(119, offset, tones, r);
+
+    ASSERT_NEAR(8.0, r[0].peakHz[0], 0.1);
+    ASSERT_NEAR(25.0, r[1].peakHz[0], 0.1);
+    ASSERT_NEAR(40.0, r[2].peakHz[0], 0.1);
+    // A strong X tone must not show up as Y's dominant line
+    ASSERT_TRUE(std::fabs(r[1].peakHz[0] - 8.0f) > 1.0f);
+}
+
+TEST(three_peaks_strongest_first) {
+    const float offset[3] = { 0.0f, 0.0f, 1.0f };
+    std::vector<Tone> tones[3];
+    tones[2].push_back({ 5.0f, 0.05f });
+    tones[2].push_back({ 30.0f, 0.2f });
+    tones[2].push_back({ 50.0f, 0.1f });
+    AxisResult r[3];
+    analyse(119, offset, tones, r, 0.01f);
+
+    ASSERT_NEAR(30.0, r[2].peakHz[0], 0.1);
+    ASSERT_NEAR(50.0, r[2].peakHz[1], 0.1);
+    ASSERT_NEAR(5.0, r[2].peakHz[2], 0.1);
+    ASSERT_TRUE(r[2].peakAmp[0] > r[2].peakAmp[1] && r[2].peakAmp[1] > r[2].peakAmp[2]);
+}
+
+TEST(tumble_rate_from_full_recording) {
+    // 0.1 Hz spin (one turn every 10 s) swapping gravity between X and Y
+    const float offset[3] = { 0.0f, 0.0f, 0.0f };
+    std::vector<Tone> tones[3];
+    tones[0].push_back({ 0.1f, 1.0f });
+    tones[1].push_back({ 0.1f, 0.8f });
+    tones[1].push_back({ 20.0f, 0.05f });
+    AxisResult r[3];
+    analyse(476, offset, tones, r, 0.02f);
+
+    ASSERT_NEAR(0.1, r[0].tumbleHz, 0.01);
+    ASSERT_NEAR(1.0, r[0].tumbleAmp, 0.2);
+    ASSERT_NEAR(0.1, r[1].tumbleHz, 0.01);
+    // Vibration stage still sees the 20 Hz line on Y
+    ASSERT_NEAR(20.0, r[1].peakHz[0], 0.1);
+}
+
+TEST(short_recording_has_no_spectrum) {
+    const float xyz[6] = { 0.0f, 0.0f, 1.0f, 0.2f, 0.0f, 1.0f };
+    AxisResult r[3];
+    spectrumBegin(analyzer, 119, 2);
+    spectrumAdd(analyzer, xyz, 2);
+    spectrumFinish(analyzer, r);
+
+    ASSERT_NEAR(0.1, r[0].mean, 1e-6);
+    ASSERT_NEAR(0.2, r[0].max, 1e-6);
+    ASSERT_NEAR(0.0, r[0].peakHz[0], 0.0);
+    ASSERT_NEAR(0.0, r[0].tumbleHz, 0.0);
+}
+
+TEST(empty_recording) {
+    AxisResult r[3];
+    spectrumBegin(analyzer, 119, 7140);
+    spectrumFinish(analyzer, r);
+    ASSERT_NEAR(0.0, r[2].mean, 0.0);
+    ASSERT_NEAR(0.0, r[2].rms, 0.0);
+}
+
+// ==================== MAIN ====================
+
+int main() {
+    std::cout << "========================================" << std::endl;
+    std::cout << "  ORBITAL TEMPLE SPECTRUM UNIT TESTS" << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << std::endl;
+
+    RUN_TEST(statistics_of_static_gravity);
+    RUN_TEST(vibration_peak_frequency_and_amplitude);
+    RUN_TEST(xy_packing_keeps_axes_apart);
+    RUN_TEST(three_peaks_strongest_first);
+    RUN_TEST(tumble_rate_from_full_recording);
+    RUN_TEST(short_recording_has_no_spectrum);
+    RUN_TEST(empty_recording);
+
+    std::cout << std::endl;
+    std::cout << "========================================" << std::endl;
+    std::cout << "  RESULTS: " << tests_passed << " passed, " << tests_failed << " failed" << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    return tests_failed > 0 ? 1 : 0;
+}
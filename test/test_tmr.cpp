@@ -1,73 +1,55 @@
 /*
  * Orbital Temple - TMR (Triple Modular Redundancy) Unit Tests
  *
- * Tests the radiation protection voting logic.
+ * Tests the TMR region (tmr.cpp): registration, write-through, bitwise
+ * majority voting, incremental scrubbing and the correction counters.
  *
- * Compile: g++ -std=c++11 -o test_tmr test_tmr.cpp
+ * Compile: g++ -std=c++11 -O2 -o test_tmr test_tmr.cpp
  * Run: ./test_tmr
  */
 
 #include <iostream>
 #include <cstdint>
+#include <cstring>
 #include <cassert>
+#include <cstdio>
+#include <chrono>
+#include <stdexcept>
 
-// ==================== TMR IMPLEMENTATION (from radiation.h) ====================
+// Region under test
+#include "../tmr.cpp"
 
-template<typename T>
-struct TMR {
-    T copy1;
-    T copy2;
-    T copy3;
-};
-
-template<typename T>
-void tmrWrite(TMR<T>& tmr, T value) {
-    tmr.copy1 = value;
-    tmr.copy2 = value;
-    tmr.copy3 = value;
-}
+// ==================== PROTECTED VARIABLES ====================
+// Registered at static init, like config.cpp and memor.cpp do
 
-// Modified for testing - doesn't restart, returns sentinel value
-template<typename T>
-T tmrRead(TMR<T>& tmr, bool& catastrophic) {
-    catastrophic = false;
+struct Header {
+    uint32_t count;
+    uint16_t flags;
+    uint8_t version;
+};
 
-    // 2-out-of-3 voting
-    if (tmr.copy1 == tmr.copy2) return tmr.copy1;
-    if (tmr.copy1 == tmr.copy3) return tmr.copy1;
-    if (tmr.copy2 == tmr.copy3) return tmr.copy2;
+static const uint8_t& tByte = tmrNew("byte", (uint8_t)42);
+static const bool& tFlagA = tmrNew("flagA", true);
+static const bool& tFlagB = tmrNew("flagB", false);
+static const uint32_t& tWord = tmrNew("word", (uint32_t)0xDEADBEEF);
+static Header& tHeader = tmrNew("header", Header());
+static const uint32_t& tCounter = tmrNew("counter", (uint32_t)0);
 
-    // All three different - CATASTROPHIC FAILURE
-    catastrophic = true;
-    return tmr.copy1;  // Would restart in real code
+// Word of a registered variable, and a bit flip in one copy of it
+static uint32_t wordOf(const void* live) {
+    return (uint32_t)(((const uint8_t*)live - (const uint8_t*)tmrCopy(0)) / 4);
 }
 
-template<typename T>
-bool tmrScrub(TMR<T>& tmr) {
-    bool catastrophic;
-    T correct = tmrRead(tmr, catastrophic);
-
-    if (catastrophic) {
-        // In real code, this would restart
-        return true;  // Indicate failure
-    }
-
-    bool corrected = false;
+static void flip(const void* live, uint8_t copy, uint32_t mask) {
+    tmrCopy(copy)[wordOf(live)] ^= mask;
+}
 
-    if (tmr.copy1 != correct) {
-        tmr.copy1 = correct;
-        corrected = true;
-    }
-    if (tmr.copy2 != correct) {
-        tmr.copy2 = correct;
-        corrected = true;
-    }
-    if (tmr.copy3 != correct) {
-        tmr.copy3 = correct;
-        corrected = true;
-    }
+static uint32_t copyWord(const void* live, uint8_t copy) {
+    return tmrCopy(copy)[wordOf(live)];
+}
 
-    return corrected;
+static bool copiesAgree(const void* live) {
+    return copyWord(live, 0) == copyWord(live, 1) && copyWord(live, 1) == copyWord(live, 2);
 }
 
 // ==================== TEST FRAMEWORK ====================
@@ -102,180 +84,205 @@ int tests_failed = 0;
 
 // ==================== TESTS ====================
 
-TEST(write_sets_all_copies) {
-    TMR<uint8_t> tmr;
-    tmrWrite(tmr, (uint8_t)42);
-
-    ASSERT_EQ(tmr.copy1, 42);
-    ASSERT_EQ(tmr.copy2, 42);
-    ASSERT_EQ(tmr.copy3, 42);
+TEST(registered_with_initial_values) {
+    ASSERT_EQ(tByte, 42);
+    ASSERT_EQ(tFlagA, true);
+    ASSERT_EQ(tFlagB, false);
+    ASSERT_EQ(tWord, 0xDEADBEEF);
+    ASSERT_EQ(tmrBlockCount(), 6u);
+    ASSERT(!tmrOverflowed());
 }
 
-TEST(read_all_same) {
-    TMR<uint8_t> tmr = {10, 10, 10};
-    bool catastrophic;
-
-    uint8_t result = tmrRead(tmr, catastrophic);
-
-    ASSERT_EQ(result, 10);
-    ASSERT(!catastrophic);
+TEST(each_variable_owns_its_words) {
+    // Two bools never share a word, so a vote on one cannot touch the other
+    ASSERT(wordOf(&tFlagA) != wordOf(&tFlagB));
+    ASSERT_EQ(((uintptr_t)&tFlagB) % 4, 0u);
+    ASSERT_EQ(((uintptr_t)tmrCopy(0)) % 32, 0u);
+    ASSERT_EQ(tmrBlockAt(4)->words, (sizeof(Header) + 3) / 4);
 }
 
-TEST(read_copy1_corrupted) {
-    // SEU flipped copy1
-    TMR<uint8_t> tmr = {99, 10, 10};  // copy1 is wrong
-    bool catastrophic;
-
-    uint8_t result = tmrRead(tmr, catastrophic);
+TEST(write_sets_all_copies) {
+    tmrWrite(tByte, 7);
 
-    ASSERT_EQ(result, 10);  // Majority wins
-    ASSERT(!catastrophic);
+    ASSERT_EQ(tByte, 7);
+    ASSERT(copiesAgree(&tByte));
+    tmrWrite(tByte, 42);
 }
 
-TEST(read_copy2_corrupted) {
-    // SEU flipped copy2
-    TMR<uint8_t> tmr = {10, 99, 10};  // copy2 is wrong
-    bool catastrophic;
-
-    uint8_t result = tmrRead(tmr, catastrophic);
-
-    ASSERT_EQ(result, 10);  // Majority wins
-    ASSERT(!catastrophic);
+TEST(scrub_clean_region) {
+    tmrScrub(tmrUsedWords());
+    ASSERT_EQ(tmrScrub(tmrUsedWords()), 0u);
 }
 
-TEST(read_copy3_corrupted) {
-    // SEU flipped copy3
-    TMR<uint8_t> tmr = {10, 10, 99};  // copy3 is wrong
-    bool catastrophic;
-
-    uint8_t result = tmrRead(tmr, catastrophic);
+TEST(scrub_fixes_copy_a) {
+    // SEU in the live copy: the reads see it until the scrub
+    flip(&tWord, 0, 0x00000001);
+    ASSERT_EQ(tWord, 0xDEADBEEE);
 
-    ASSERT_EQ(result, 10);  // Majority wins
-    ASSERT(!catastrophic);
+    ASSERT_EQ(tmrScrub(tmrUsedWords()), 1u);
+    ASSERT_EQ(tWord, 0xDEADBEEF);
+    ASSERT(copiesAgree(&tWord));
 }
 
-TEST(read_all_different_catastrophic) {
-    // Multi-bit upset - all copies different
-    TMR<uint8_t> tmr = {1, 2, 3};
-    bool catastrophic;
-
-    tmrRead(tmr, catastrophic);
+TEST(scrub_fixes_copy_b) {
+    flip(&tWord, 1, 0x80000000);
 
-    ASSERT(catastrophic);  // Should trigger restart in real code
+    ASSERT_EQ(tmrScrub(tmrUsedWords()), 1u);
+    ASSERT_EQ(tWord, 0xDEADBEEF);
+    ASSERT(copiesAgree(&tWord));
 }
 
-TEST(scrub_fixes_copy1) {
-    TMR<uint8_t> tmr = {99, 10, 10};
+TEST(scrub_fixes_copy_c) {
+    flip(&tWord, 2, 0x00FF0000);      // Multi-bit upset in one copy
 
-    bool corrected = tmrScrub(tmr);
-
-    ASSERT(corrected);
-    ASSERT_EQ(tmr.copy1, 10);
-    ASSERT_EQ(tmr.copy2, 10);
-    ASSERT_EQ(tmr.copy3, 10);
+    ASSERT_EQ(tmrScrub(tmrUsedWords()), 1u);
+    ASSERT_EQ(tWord, 0xDEADBEEF);
+    ASSERT(copiesAgree(&tWord));
 }
 
-TEST(scrub_fixes_copy2) {
-    TMR<uint8_t> tmr = {10, 99, 10};
-
-    bool corrected = tmrScrub(tmr);
+TEST(different_bits_in_all_three_copies) {
+    // Whole-value voting had no majority here and restarted; bitwise it does
+    flip(&tWord, 0, 0x00000010);
+    flip(&tWord, 1, 0x00001000);
+    flip(&tWord, 2, 0x00100000);
 
-    ASSERT(corrected);
-    ASSERT_EQ(tmr.copy1, 10);
-    ASSERT_EQ(tmr.copy2, 10);
-    ASSERT_EQ(tmr.copy3, 10);
+    ASSERT_EQ(tmrScrub(tmrUsedWords()), 1u);
+    ASSERT_EQ(tWord, 0xDEADBEEF);
+    ASSERT(copiesAgree(&tWord));
 }
 
-TEST(scrub_fixes_copy3) {
-    TMR<uint8_t> tmr = {10, 10, 99};
+TEST(same_bit_in_two_copies_is_not_recoverable) {
+    // The documented limit: two copies agreeing on a flipped bit outvote the third
+    flip(&tWord, 1, 0x00000100);
+    flip(&tWord, 2, 0x00000100);
 
-    bool corrected = tmrScrub(tmr);
-
-    ASSERT(corrected);
-    ASSERT_EQ(tmr.copy1, 10);
-    ASSERT_EQ(tmr.copy2, 10);
-    ASSERT_EQ(tmr.copy3, 10);
+    tmrScrub(tmrUsedWords());
+    ASSERT_EQ(tWord, 0xDEADBEEF ^ 0x00000100);
+    ASSERT(copiesAgree(&tWord));
+    tmrWrite(tWord, 0xDEADBEEF);
 }
 
-TEST(scrub_no_correction_needed) {
-    TMR<uint8_t> tmr = {10, 10, 10};
-
-    bool corrected = tmrScrub(tmr);
+TEST(bool_corrected) {
+    flip(&tFlagA, 2, 0x01);
+    tmrScrub(tmrUsedWords());
 
-    ASSERT(!corrected);
-    ASSERT_EQ(tmr.copy1, 10);
-    ASSERT_EQ(tmr.copy2, 10);
-    ASSERT_EQ(tmr.copy3, 10);
+    ASSERT_EQ(tFlagA, true);
+    ASSERT(copiesAgree(&tFlagA));
 }
 
-TEST(tmr_with_bool) {
-    TMR<bool> tmr;
-    tmrWrite(tmr, true);
-
-    ASSERT_EQ(tmr.copy1, true);
-    ASSERT_EQ(tmr.copy2, true);
-    ASSERT_EQ(tmr.copy3, true);
+TEST(edge_zero_and_max) {
+    tmrWrite(tByte, 0);
+    ASSERT_EQ(tmrScrub(tmrUsedWords()), 0u);
+    ASSERT_EQ(tByte, 0);
 
-    // Corrupt one copy
-    tmr.copy2 = false;
+    tmrWrite(tByte, 255);
+    flip(&tByte, 0, 0x80);
+    tmrScrub(tmrUsedWords());
+    ASSERT_EQ(tByte, 255);
+    tmrWrite(tByte, 42);
+}
 
-    bool catastrophic;
-    bool result = tmrRead(tmr, catastrophic);
+TEST(struct_commit) {
+    tHeader.count = 12;
+    tHeader.version = 3;
+    tmrCommit(&tHeader, sizeof(tHeader));
 
-    ASSERT_EQ(result, true);  // Majority wins
-    ASSERT(!catastrophic);
+    // Copy A alone would have been outvoted: the commit must reach B and C
+    ASSERT_EQ(tmrScrub(tmrUsedWords()), 0u);
+    ASSERT_EQ(tHeader.count, 12u);
+    ASSERT_EQ(tHeader.version, 3);
 }
 
-TEST(tmr_with_uint32) {
-    TMR<uint32_t> tmr;
-    tmrWrite(tmr, (uint32_t)0xDEADBEEF);
+TEST(uncommitted_write_is_reverted) {
+    // What the const references guard against
+    const_cast<uint32_t&>(tCounter) = 5;
+    tmrScrub(tmrUsedWords());
+    ASSERT_EQ(tCounter, 0u);
+}
 
-    ASSERT_EQ(tmr.copy1, 0xDEADBEEF);
-    ASSERT_EQ(tmr.copy2, 0xDEADBEEF);
-    ASSERT_EQ(tmr.copy3, 0xDEADBEEF);
+TEST(write_promoted_expression) {
+    tmrWrite(tCounter, tCounter + 1);
+    tmrWrite(tCounter, tCounter + 1);
+    ASSERT_EQ(tCounter, 2u);
+    ASSERT(copiesAgree(&tCounter));
+}
 
-    // Corrupt with single bit flip
-    tmr.copy1 = 0xDEADBEEE;  // Last bit flipped
+TEST(repeated_scrub_stable) {
+    flip(&tWord, 2, 0x4);
 
-    bool catastrophic;
-    uint32_t result = tmrRead(tmr, catastrophic);
+    ASSERT_EQ(tmrScrub(tmrUsedWords()), 1u);
+    ASSERT_EQ(tmrScrub(tmrUsedWords()), 0u);
+}
 
-    ASSERT_EQ(result, 0xDEADBEEF);  // Majority wins
-    ASSERT(!catastrophic);
+TEST(incremental_scrub_wraps) {
+    // Finish any pass in progress so the cursor is at word 0
+    tmrScrub(tmrPassRemaining());
+    uint32_t passes = tmrPassCount();
+    uint32_t used = tmrUsedWords();
+    ASSERT_EQ(tmrPassRemaining(), used);
+
+    // Last word: only reached once the cursor gets there
+    flip(&tCounter, 1, 0x2);
+    ASSERT_EQ(tmrScrub(used - 1), 0u);
+    ASSERT_EQ(tmrPassRemaining(), 1u);
+    ASSERT_EQ(tmrPassCount(), passes);
+
+    ASSERT_EQ(tmrScrub(1), 1u);
+    ASSERT_EQ(tmrPassCount(), passes + 1);
+    ASSERT_EQ(tmrPassRemaining(), used);
+
+    // A step larger than the region wraps and keeps counting passes
+    tmrScrub(2 * used + 1);
+    ASSERT_EQ(tmrPassCount(), passes + 3);
+    ASSERT_EQ(tmrPassRemaining(), used - 1);
+    tmrScrub(tmrPassRemaining());
 }
 
-TEST(tmr_edge_zero) {
-    TMR<uint8_t> tmr;
-    tmrWrite(tmr, (uint8_t)0);
+TEST(corrections_counted_per_word) {
+    uint32_t w = wordOf(&tFlagB);
+    uint16_t before = tmrWordCorrections(w);
+    uint32_t blockBefore = tmrBlockCorrections(2);
 
-    bool catastrophic;
-    uint8_t result = tmrRead(tmr, catastrophic);
+    for (int i = 0; i < 3; i++) {
+        flip(&tFlagB, (uint8_t)i, 0x01);
+        tmrScrub(tmrUsedWords());
+    }
 
-    ASSERT_EQ(result, 0);
-    ASSERT(!catastrophic);
+    ASSERT_EQ(tmrWordCorrections(w), before + 3);
+    ASSERT_EQ(tmrBlockCorrections(2), blockBefore + 3);
+    ASSERT(strcmp(tmrBlockAt(2)->name, "flagB") == 0);
+    ASSERT_EQ(tFlagB, false);
 }
 
-TEST(tmr_edge_max) {
-    TMR<uint8_t> tmr;
-    tmrWrite(tmr, (uint8_t)255);
-
-    bool catastrophic;
-    uint8_t result = tmrRead(tmr, catastrophic);
+TEST(overflow_falls_back_unprotected) {
+    uint32_t used = tmrUsedWords();
+    const uint32_t& big = *(const uint32_t*)tmrAlloc("big", TMR_REGION_BYTES);
 
-    ASSERT_EQ(result, 255);
-    ASSERT(!catastrophic);
+    ASSERT(tmrOverflowed());
+    ASSERT_EQ(tmrUsedWords(), used);
+    tmrWrite(big, 99);
+    ASSERT_EQ(big, 99u);
 }
 
-TEST(repeated_scrub_stable) {
-    TMR<uint8_t> tmr = {10, 10, 99};
+// ==================== BENCHMARK ====================
+
+static void benchmarkScrub() {
+    // Fill what is left of the region and time a clean pass
+    size_t freeBytes = (TMR_REGION_WORDS - tmrUsedWords()) * 4;
+    tmrAlloc("fill", freeBytes);
+    uint32_t words = tmrUsedWords();
 
-    // First scrub fixes it
-    tmrScrub(tmr);
-    ASSERT_EQ(tmr.copy3, 10);
+    const int iterations = 20000;
+    auto start = std::chrono::high_resolution_clock::now();
+    uint32_t sink = 0;
+    for (int i = 0; i < iterations; i++) {
+        sink += tmrScrub(words);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count() / iterations;
 
-    // Second scrub should find nothing to fix
-    bool corrected = tmrScrub(tmr);
-    ASSERT(!corrected);
+    printf("\n  Clean pass over %lu words (%lu B per copy): %.0f ns, %.2f ns/word%s\n",
+           (unsigned long)words, (unsigned long)words * 4, ns, ns / words, sink ? " (!)" : "");
 }
 
 // ==================== MAIN ====================
@@ -286,21 +293,26 @@ int main() {
     std::cout << "========================================" << std::endl;
     std::cout << std::endl;
 
+    RUN_TEST(registered_with_initial_values);
+    RUN_TEST(each_variable_owns_its_words);
     RUN_TEST(write_sets_all_copies);
-    RUN_TEST(read_all_same);
-    RUN_TEST(read_copy1_corrupted);
-    RUN_TEST(read_copy2_corrupted);
-    RUN_TEST(read_copy3_corrupted);
-    RUN_TEST(read_all_different_catastrophic);
-    RUN_TEST(scrub_fixes_copy1);
-    RUN_TEST(scrub_fixes_copy2);
-    RUN_TEST(scrub_fixes_copy3);
-    RUN_TEST(scrub_no_correction_needed);
-    RUN_TEST(tmr_with_bool);
-    RUN_TEST(tmr_with_uint32);
-    RUN_TEST(tmr_edge_zero);
-    RUN_TEST(tmr_edge_max);
+    RUN_TEST(scrub_clean_region);
+    RUN_TEST(scrub_fixes_copy_a);
+    RUN_TEST(scrub_fixes_copy_b);
+    RUN_TEST(scrub_fixes_copy_c);
+    RUN_TEST(different_bits_in_all_three_copies);
+    RUN_TEST(same_bit_in_two_copies_is_not_recoverable);
+    RUN_TEST(bool_corrected);
+    RUN_TEST(edge_zero_and_max);
+    RUN_TEST(struct_commit);
+    RUN_TEST(uncommitted_write_is_reverted);
+    RUN_TEST(write_promoted_expression);
     RUN_TEST(repeated_scrub_stable);
+    RUN_TEST(incremental_scrub_wraps);
+    RUN_TEST(corrections_counted_per_word);
+    RUN_TEST(overflow_falls_back_unprotected);
+
+    benchmarkScrub();
 
     std::cout << std::endl;
     std::cout << "========================================" << std::endl;
@@ -0,0 +1,153 @@
+/*
+ * Orbital Temple Satellite - TMR Region Implementation
+ * Version: 1.21
+ *
+ * Replaces the per-variable TMR<T> structs, which voted whole values and
+ * had to be synced with the plain globals in both directions. Here the
+ * globals live in copy A, so there is nothing to sync.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "tmr.h"
+
+// ==================== REGION ====================
+
+static uint32_t tmrRegion[3][TMR_REGION_WORDS] __attribute__((aligned(32)));
+static uint16_t tmrCorrections[TMR_REGION_WORDS];
+
+static TmrBlock tmrBlocks[TMR_MAX_BLOCKS];
+static uint32_t tmrBlocksUsed = 0;
+static uint32_t tmrWordsUsed = 0;
+static bool tmrFull = false;
+
+static uint32_t tmrCursor = 0;
+static uint32_t tmrPasses = 0;
+
+// Word index of a pointer into copy A, or -1 if it is not in the region
+static int32_t tmrWordOf(const void* live) {
+    uintptr_t base = (uintptr_t)tmrRegion[0];
+    uintptr_t p = (uintptr_t)live;
+    if (p < base || p >= base + TMR_REGION_BYTES) return -1;
+    return (int32_t)((p - base) / 4);
+}
+
+// ==================== REGISTRATION ====================
+
+void* tmrAlloc(const char* name, size_t size) {
+    uint32_t words = (uint32_t)((size + 3) / 4);
+
+    if (tmrWordsUsed + words > TMR_REGION_WORDS || tmrBlocksUsed >= TMR_MAX_BLOCKS) {
+        tmrFull = true;
+        return calloc(1, words * 4);
+    }
+
+    TmrBlock& b = tmrBlocks[tmrBlocksUsed++];
+    b.name = name;
+    b.firstWord = (uint16_t)tmrWordsUsed;
+    b.words = (uint16_t)words;
+    tmrWordsUsed += words;
+    return &tmrRegion[0][b.firstWord];
+}
+
+// ==================== WRITES ====================
+
+void tmrWriteBytes(const void* live, const void* value, size_t size) {
+    if (tmrWordOf(live) < 0) {
+        memcpy((void*)live, value, size);
+        return;
+    }
+
+    // Copy A last: a scrub running between these writes can put the old
+    // value back into C, but not into the live copy; the next pass repairs C
+    size_t offset = (const uint8_t*)live - (const uint8_t*)tmrRegion[0];
+    memcpy((uint8_t*)tmrRegion[2] + offset, value, size);
+    memcpy((uint8_t*)tmrRegion[1] + offset, value, size);
+    memcpy((uint8_t*)tmrRegion[0] + offset, value, size);
+}
+
+void tmrCommit(const void* live, size_t size) {
+    if (tmrWordOf(live) < 0) return;
+    size_t offset = (const uint8_t*)live - (const uint8_t*)tmrRegion[0];
+    memcpy((uint8_t*)tmrRegion[2] + offset, live, size);
+    memcpy((uint8_t*)tmrRegion[1] + offset, live, size);
+}
+
+// ==================== SCRUB ====================
+
+uint32_t tmrScrub(uint32_t maxWords) {
+    uint32_t corrected = 0;
+    uint32_t* a = tmrRegion[0];
+    uint32_t* b = tmrRegion[1];
+    uint32_t* c = tmrRegion[2];
+
+    if (tmrWordsUsed == 0) return 0;
+
+    while (maxWords > 0) {
+        uint32_t end = tmrCursor + maxWords;
+        if (end > tmrWordsUsed) end = tmrWordsUsed;
+        maxWords -= end - tmrCursor;
+
+        for (uint32_t i = tmrCursor; i < end; i++) {
+            uint32_t x = a[i], y = b[i], z = c[i];
+            if (x == y && y == z) continue;     // Common case: all three agree
+
+            uint32_t m = (x & y) | (y & z) | (x & z);
+            if (x != m) a[i] = m;
+            if (y != m) b[i] = m;
+            if (z != m) c[i] = m;
+            if (tmrCorrections[i] < 0xFFFF) tmrCorrections[i]++;
+            corrected++;
+        }
+
+        tmrCursor = end;
+        if (tmrCursor >= tmrWordsUsed) {
+            tmrCursor = 0;
+            tmrPasses++;
+        }
+    }
+    return corrected;
+}
+
+uint32_t tmrUsedWords() {
+    return tmrWordsUsed;
+}
+
+uint32_t tmrPassRemaining() {
+    return tmrWordsUsed - tmrCursor;
+}
+
+uint32_t tmrPassCount() {
+    return tmrPasses;
+}
+
+bool tmrOverflowed() {
+    return tmrFull;
+}
+
+// ==================== STATISTICS ====================
+
+uint32_t tmrBlockCount() {
+    return tmrBlocksUsed;
+}
+
+const TmrBlock* tmrBlockAt(uint32_t index) {
+    return index < tmrBlocksUsed ? &tmrBlocks[index] : NULL;
+}
+
+uint16_t tmrWordCorrections(uint32_t word) {
+    return word < TMR_REGION_WORDS ? tmrCorrections[word] : 0;
+}
+
+uint32_t tmrBlockCorrections(uint32_t index) {
+    if (index >= tmrBlocksUsed) return 0;
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < tmrBlocks[index].words; i++) {
+        total += tmrCorrections[tmrBlocks[index].firstWord + i];
+    }
+    return total;
+}
+
+uint32_t* tmrCopy(uint8_t copy) {
+    return copy < 3 ? tmrRegion[copy] : NULL;
+}
@@ -0,0 +1,116 @@
+#ifndef TMR_H
+#define TMR_H
+
+/*
+ * Orbital Temple Satellite - TMR Region
+ * Version: 1.21
+ *
+ * One contiguous block of RAM holding every TMR-protected variable, kept
+ * in three copies. Modules register their variables at static init:
+ *
+ *   const MissionState& currentState = tmrNew("state", STATE_BOOT);
+ *
+ * The reference points into copy A, so reads are plain loads and need no
+ * voting. It is const so that an ordinary assignment does not compile -
+ * a write must reach all three copies, or the next scrub reverts it:
+ *
+ *   tmrWrite(currentState, STATE_OPERATIONAL);
+ *
+ * A registered struct may be changed in place through a non-const
+ * reference, followed by tmrCommit() on the changed bytes.
+ *
+ * LAYOUT:
+ *    - Each copy is TMR_REGION_BYTES, 32-byte aligned, and the copies sit
+ *      back to back: the three copies of a word are a whole region apart,
+ *      so one multi-cell upset cannot hit two of them
+ *    - Every variable starts on a word boundary and is padded to whole
+ *      words, so no word is shared between two variables
+ *
+ * SCRUB:
+ *    - Word-wide bitwise majority (a&b)|(b&c)|(a&c): any set of flipped
+ *      bits is corrected as long as no bit is flipped in two copies
+ *    - Incremental: tmrScrub(n) votes the next n words and wraps, so a
+ *      pass can be spread over many loop ticks
+ *    - Cost is linear in the registered words, not TMR_REGION_BYTES
+ *    - Corrections are counted per word (and per registered variable)
+ *
+ * The ESP32 has no SIMD lanes for this; 32-bit words are the widest
+ * native operation. Writers in other tasks need no lock: copy A is
+ * written last, so a concurrent scrub does not revert the live value.
+ *
+ * Host-portable: no Arduino dependencies, so the test suite compiles it
+ * directly (test/test_tmr.cpp).
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ==================== CONFIGURATION ====================
+
+#define TMR_REGION_BYTES  1024  // Per copy; three copies are allocated
+#define TMR_REGION_WORDS  (TMR_REGION_BYTES / 4)
+#define TMR_MAX_BLOCKS    32    // Registered variables
+
+// ==================== REGISTRATION ====================
+
+struct TmrBlock {
+    const char* name;
+    uint16_t firstWord;
+    uint16_t words;
+};
+
+// Reserve size bytes (zeroed) in all three copies; returns copy A.
+// Static init or setup only. When the region is full the memory comes
+// from the heap, unprotected, and tmrOverflowed() reports it.
+void* tmrAlloc(const char* name, size_t size);
+
+// ==================== WRITES ====================
+
+// Copy size bytes into a registered variable, all three copies
+void tmrWriteBytes(const void* live, const void* value, size_t size);
+
+// Propagate bytes already changed in copy A to copies B and C
+void tmrCommit(const void* live, size_t size);
+
+// Value argument in a non-deduced context, so tmrWrite(bootCount, bootCount + 1)
+// compiles whatever integer type the expression promotes to
+template<typename T>
+struct TmrValue {
+    typedef T type;
+};
+
+template<typename T>
+void tmrWrite(const T& live, typename TmrValue<T>::type value) {
+    tmrWriteBytes(&live, &value, sizeof(T));
+}
+
+// Register a variable with its initial value
+template<typename T>
+T& tmrNew(const char* name, const T& initial) {
+    T* live = (T*)tmrAlloc(name, sizeof(T));
+    tmrWriteBytes(live, &initial, sizeof(T));
+    return *live;
+}
+
+// ==================== SCRUB ====================
+
+// Vote the next maxWords words from the scrub cursor, wrapping at the end
+// of the registered words. Returns the number of words corrected.
+uint32_t tmrScrub(uint32_t maxWords);
+
+uint32_t tmrUsedWords();        // Registered words per copy
+uint32_t tmrPassRemaining();    // Words left before the current pass completes
+uint32_t tmrPassCount();        // Completed passes since boot
+bool tmrOverflowed();           // A registration did not fit the region
+
+// ==================== STATISTICS ====================
+
+uint32_t tmrBlockCount();
+const TmrBlock* tmrBlockAt(uint32_t index);
+uint16_t tmrWordCorrections(uint32_t word);     // Saturates at 65535
+uint32_t tmrBlockCorrections(uint32_t index);
+
+// Base of copy 0-2 (fault injection in the tests)
+uint32_t* tmrCopy(uint8_t copy);
+
+#endif // TMR_H
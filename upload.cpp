@@ -0,0 +1,483 @@
+/*
+ * Orbital Temple Satellite - Chunked Upload Sessions Implementation
+ * Version: 1.21
+ */
+
+#include <Arduino.h>
+#include "SD.h"
+#include "config.h"
+#include "log.h"
+#include "upload.h"
+#include "lora.h"
+#include "memor.h"
+#include "crc32.h"
+#include "perf.h"
+#include "manifest.h"
+
+#define UPLOAD_STATE_MAGIC  0x55504C31UL   // "UPL1"
+#define UPLOAD_BITMAP_BYTES (UPLOAD_MAX_CHUNKS / 8)
+
+// Saved to UPLOAD_STATE_PATH whenever the card has caught up
+struct UploadState {
+    uint32_t magic;
+    uint8_t id;
+    uint8_t reserved[3];
+    uint32_t size;                      // File size announced by UploadBegin
+    uint32_t crc;                       // Its CRC32
+    char path[UPLOAD_PATH_MAX];         // Target, renamed to on commit
+    uint8_t bitmap[UPLOAD_BITMAP_BYTES];
+    uint32_t check;                     // CRC32 of everything above
+};
+
+static UploadState session;
+static bool active = false;
+static bool committed = false;          // session describes the last finished upload
+static uint16_t chunkCount = 0;
+static uint16_t received = 0;
+static uint8_t nextId = 1;
+static File tmp;
+static uint32_t tmpEnd = 0;             // Bytes of the temp file written so far
+
+// Write-behind: consecutive chunks collected into whole sectors
+static uint8_t buffer[UPLOAD_BUFFER_SIZE];
+static size_t bufLen = 0;
+static uint16_t bufFirst = 0;           // Chunk at buffer[0]
+
+static uint16_t sinceAck = 0;
+static unsigned long lastChunkAt = 0;
+static bool dirty = false;              // Bitmap ahead of the saved state
+
+// ==================== HELPERS ====================
+
+static bool bitTest(uint16_t seq) {
+    return (session.bitmap[seq / 8] >> (seq % 8)) & 1;
+}
+
+static void bitSet(uint16_t seq, bool on) {
+    if (on) {
+        session.bitmap[seq / 8] |= (uint8_t)(1 << (seq % 8));
+    } else {
+        session.bitmap[seq / 8] &= (uint8_t)~(1 << (seq % 8));
+    }
+}
+
+static uint16_t chunkLength(uint16_t seq) {
+    uint32_t start = (uint32_t)seq * UPLOAD_CHUNK_SIZE;
+    uint32_t left = session.size - start;
+    return left < UPLOAD_CHUNK_SIZE ? (uint16_t)left : UPLOAD_CHUNK_SIZE;
+}
+
+static uint32_t stateCheck() {
+    return crc32Final(crc32Update(crc32Begin(), (const uint8_t*)&session,
+                                  offsetof(UploadState, check)));
+}
+
+static int base64Value(char c) {
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    if (c == '+') return 62;
+    if (c == '/') return 63;
+    return -1;
+}
+
+// Standard alphabet, padding optional; returns bytes decoded, -1 if invalid
+static int base64Decode(const char* in, size_t length, uint8_t* out, size_t maxOut) {
+    while (length > 0 && in[length - 1] == '=') length--;
+    if (length % 4 == 1) return -1;
+
+    size_t n = 0;
+    uint32_t acc = 0;
+    int bits = 0;
+    for (size_t i = 0; i < length; i++) {
+        int v = base64Value(in[i]);
+        if (v < 0) return -1;
+        acc = (acc << 6) | (uint32_t)v;
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            if (n >= maxOut) return -1;
+            out[n++] = (uint8_t)(acc >> bits);
+        }
+    }
+    return (int)n;
+}
+
+// "<id>" or "<id>,<seq>" from the path field
+static bool parseIds(const char* path, uint8_t &id, uint16_t *seq) {
+    char* end;
+    unsigned long v = strtoul(path, &end, 10);
+    if (end == path || v > 0xFF) return false;
+    id = (uint8_t)v;
+    if (seq == NULL) return *end == '\0';
+    if (*end != ',') return false;
+    const char* s = end + 1;
+    v = strtoul(s, &end, 10);
+    if (end == s || *end != '\0' || v > 0xFFFF) return false;
+    *seq = (uint16_t)v;
+    return true;
+}
+
+static bool sessionMatches(uint8_t id) {
+    if (active && id == session.id) return true;
+    sendMessage("ERR:UPLOAD_NO_SESSION");
+    return false;
+}
+
+static void sendDone() {
+    Reply done;
+    done.add("OK:UPLOAD_DONE:").addU(session.id).add(',').add(session.path)
+        .add(',').addU(session.size);
+    sendMessage(done);
+}
+
+// ==================== CARD ====================
+
+static bool flushBuffer() {
+    if (bufLen == 0) return true;
+
+    uint32_t offset = (uint32_t)bufFirst * UPLOAD_CHUNK_SIZE;
+    size_t written = 0;
+    if (tmp.seek(offset)) {
+        PerfScope perf(PERF_SD_WRITE);
+        written = tmp.write(buffer, bufLen);
+        tmp.flush();
+    }
+
+    if (written != bufLen) {
+        // Not on the card: those chunks count as missing again
+        LOG_E("UPLOAD", "Write at %lu failed (%u of %u bytes)",
+              (unsigned long)offset, (unsigned)written, (unsigned)bufLen);
+        for (size_t done = 0; done < bufLen; done += UPLOAD_CHUNK_SIZE) {
+            bitSet(bufFirst + done / UPLOAD_CHUNK_SIZE, false);
+            received--;
+        }
+        bufLen = 0;
+        return false;
+    }
+
+    if (offset + bufLen > tmpEnd) {
+        sdSpaceAccount(offset + bufLen - tmpEnd);
+        tmpEnd = offset + bufLen;
+        manifestNoteChanged(UPLOAD_TMP_PATH);
+    }
+    bufLen = 0;
+    return true;
+}
+
+static bool saveSession() {
+    bool ok = flushBuffer();
+
+    session.check = stateCheck();
+    File f = SD.open(UPLOAD_STATE_PATH, FILE_WRITE);
+    if (!f || f.write((const uint8_t*)&session, sizeof(session)) != sizeof(session)) {
+        LOG_E("UPLOAD", "Session save failed");
+        ok = false;
+    }
+    if (f) f.close();
+    manifestNoteChanged(UPLOAD_STATE_PATH);
+    dirty = false;
+    return ok;
+}
+
+static void closeSession() {
+    if (tmp) tmp.close();
+    active = false;
+    committed = false;
+    bufLen = 0;
+    dirty = false;
+}
+
+static void removeSession() {
+    closeSession();
+    SD.remove(UPLOAD_TMP_PATH);
+    SD.remove(UPLOAD_STATE_PATH);
+    manifestNoteRemoved(UPLOAD_TMP_PATH);
+    manifestNoteRemoved(UPLOAD_STATE_PATH);
+    sdSpaceInvalidate();
+}
+
+static uint16_t countReceived() {
+    uint16_t n = 0;
+    for (uint16_t i = 0; i < chunkCount; i++) {
+        if (bitTest(i)) n++;
+    }
+    return n;
+}
+
+static void sendAck() {
+    if (!saveSession()) {
+        sendMessage("ERR:UPLOAD_WRITE_FAILED");
+    }
+    sinceAck = 0;
+
+    Reply ack;
+    ack.add("UPACK:").addU(session.id).add(',').addU(received).add('/').addU(chunkCount).add(',');
+    for (uint16_t i = 0; i < (chunkCount + 7) / 8; i++) {
+        ack.addf("%02X", session.bitmap[i]);
+    }
+    sendMessage(ack);
+}
+
+// ==================== COMMIT ====================
+
+// Read the temp file back, check the CRC, rename it over the target
+static bool commit(bool reply) {
+    flushBuffer();
+    tmp.close();
+
+    File f = SD.open(UPLOAD_TMP_PATH, FILE_READ);
+    uint32_t crc = crc32Begin();
+    uint32_t total = 0;
+    if (f) {
+        uint8_t block[512];
+        size_t n;
+        while ((n = f.read(block, sizeof(block))) > 0) {
+            crc = crc32Update(crc, block, n);
+            total += n;
+            feedWatchdog();
+        }
+        f.close();
+    }
+    crc = crc32Final(crc);
+
+    if (total != session.size || crc != session.crc) {
+        LOG_E("UPLOAD", "Upload %u CRC %08lX vs %08lX (%lu of %lu bytes), resend all",
+              session.id, (unsigned long)crc, (unsigned long)session.crc,
+              (unsigned long)total, (unsigned long)session.size);
+        memset(session.bitmap, 0, sizeof(session.bitmap));
+        received = 0;
+        tmp = SD.open(UPLOAD_TMP_PATH, "r+");
+        saveSession();
+        if (reply) {
+            char msg[48];
+            snprintf(msg, sizeof(msg), "ERR:UPLOAD_CRC:%u,%08lX", session.id, (unsigned long)crc);
+            sendMessage(msg);
+        }
+        return false;
+    }
+
+    // FAT cannot rename over a file. A reset between the two steps leaves
+    // the complete temp file and the session, and uploadInit() redoes this.
+    if (SD.exists(session.path)) {
+        SD.remove(session.path);
+        manifestNoteRemoved(session.path);
+    }
+    if (!SD.rename(UPLOAD_TMP_PATH, session.path)) {
+        LOG_E("UPLOAD", "Rename to %s failed", session.path);
+        tmp = SD.open(UPLOAD_TMP_PATH, "r+");
+        if (reply) sendMessage("ERR:UPLOAD_RENAME_FAILED");
+        return false;
+    }
+    manifestNoteRenamed(UPLOAD_TMP_PATH, session.path);
+    burstForget(session.path);
+    SD.remove(UPLOAD_STATE_PATH);
+    manifestNoteRemoved(UPLOAD_STATE_PATH);
+    sdSpaceInvalidate();
+    active = false;
+    committed = true;
+
+    LOG_I("UPLOAD", "Upload %u committed: %s, %lu bytes",
+          session.id, session.path, (unsigned long)session.size);
+    if (reply) sendDone();
+    return true;
+}
+
+// ==================== SESSION ====================
+
+void uploadInit() {
+    if (!SDOK) return;
+
+    File f = SD.open(UPLOAD_STATE_PATH, FILE_READ);
+    if (!f) return;
+    size_t n = f.read((uint8_t*)&session, sizeof(session));
+    f.close();
+
+    if (n != sizeof(session) || session.magic != UPLOAD_STATE_MAGIC ||
+        session.check != stateCheck() || session.size == 0 || session.size > UPLOAD_MAX_SIZE) {
+        LOG_W("UPLOAD", "Discarding unreadable upload session");
+        removeSession();
+        return;
+    }
+    session.path[UPLOAD_PATH_MAX - 1] = '\0';
+
+    tmp = SD.open(UPLOAD_TMP_PATH, "r+");
+    if (!tmp) {
+        LOG_W("UPLOAD", "Upload temp file missing, discarding session");
+        removeSession();
+        return;
+    }
+
+    active = true;
+    nextId = session.id + 1;
+    chunkCount = (uint16_t)((session.size + UPLOAD_CHUNK_SIZE - 1) / UPLOAD_CHUNK_SIZE);
+    received = countReceived();
+    tmpEnd = tmp.size();
+    LOG_I("UPLOAD", "Resuming upload %u: %s, %u/%u chunks",
+          session.id, session.path, received, chunkCount);
+
+    if (received == chunkCount) {
+        commit(false);      // Reset landed between the CRC check and the rename
+    }
+}
+
+void uploadBegin(const char* path, const char* data) {
+    char* end;
+    unsigned long size = strtoul(data, &end, 10);
+    if (end == data || *end != ',') {
+        sendMessage("ERR:UPLOAD_BAD_ARGS");
+        return;
+    }
+    const char* crcText = end + 1;
+    uint32_t crc = strtoul(crcText, &end, 16);
+    size_t pathLen = strlen(path);
+    if (end == crcText || *end != '\0' || pathLen == 0 || path[0] != '/' ||
+        pathLen >= UPLOAD_PATH_MAX) {
+        sendMessage("ERR:UPLOAD_BAD_ARGS");
+        return;
+    }
+    if (size == 0 || size > UPLOAD_MAX_SIZE) {
+        sendMessage("ERR:UPLOAD_TOO_LARGE");
+        return;
+    }
+
+    bool resume = active && session.size == size && session.crc == crc &&
+                  strcmp(session.path, path) == 0;
+
+    if (resume) {
+        LOG_I("UPLOAD", "Upload %u resumed at %u/%u chunks", session.id, received, chunkCount);
+    } else {
+        if (!hasSDSpace(size)) {
+            sendMessage("ERR:SD_FULL");
+            return;
+        }
+        if (active) {
+            LOG_W("UPLOAD", "Upload %u (%s) replaced", session.id, session.path);
+        }
+        removeSession();
+
+        if (!SD.exists(UPLOAD_DIR)) {
+            SD.mkdir(UPLOAD_DIR);
+            manifestNoteChanged(UPLOAD_DIR);
+        }
+        File create = SD.open(UPLOAD_TMP_PATH, FILE_WRITE);
+        if (create) create.close();
+        manifestNoteChanged(UPLOAD_TMP_PATH);
+        tmp = SD.open(UPLOAD_TMP_PATH, "r+");
+        if (!tmp) {
+            sendMessage("ERR:OPEN_FILE_FAILED");
+            return;
+        }
+
+        memset(&session, 0, sizeof(session));
+        session.magic = UPLOAD_STATE_MAGIC;
+        session.id = nextId++;
+        if (nextId == 0) nextId = 1;
+        session.size = size;
+        session.crc = crc;
+        memcpy(session.path, path, pathLen + 1);
+        chunkCount = (uint16_t)((size + UPLOAD_CHUNK_SIZE - 1) / UPLOAD_CHUNK_SIZE);
+        received = 0;
+        tmpEnd = 0;
+        active = true;
+        saveSession();
+        LOG_I("UPLOAD", "Upload %u: %s, %lu bytes in %u chunks",
+              session.id, path, size, chunkCount);
+    }
+    sinceAck = 0;
+
+    MsgBuf<64> reply;
+    reply.add("OK:UPLOAD:").addU(session.id).add(',').addU(UPLOAD_CHUNK_SIZE)
+         .add(',').addU(chunkCount).add(',').addU(received);
+    sendMessage(reply);
+
+    // A resumed session tells ground what is still missing
+    if (resume && received > 0) {
+        sendAck();
+    }
+}
+
+void uploadChunk(const char* path, const char* data, size_t dataLength) {
+    uint8_t id;
+    uint16_t seq;
+    if (!parseIds(path, id, &seq)) {
+        sendMessage("ERR:UPLOAD_BAD_ARGS");
+        return;
+    }
+    if (!sessionMatches(id)) return;
+
+    uint8_t chunk[UPLOAD_CHUNK_SIZE];
+    int n = seq < chunkCount ? base64Decode(data, dataLength, chunk, sizeof(chunk)) : -1;
+    if (n < 0 || n != chunkLength(seq)) {
+        char reply[40];
+        snprintf(reply, sizeof(reply), "ERR:UPLOAD_BAD_CHUNK:%u", seq);
+        sendMessage(reply);
+        return;
+    }
+
+    // Resent after a lost UPACK: already on the card (or in the buffer)
+    if (bitTest(seq)) return;
+
+    if (bufLen > 0 && (seq != bufFirst + bufLen / UPLOAD_CHUNK_SIZE ||
+                       bufLen + n > UPLOAD_BUFFER_SIZE)) {
+        flushBuffer();
+    }
+    if (bufLen == 0) bufFirst = seq;
+    memcpy(buffer + bufLen, chunk, n);
+    bufLen += n;
+
+    bitSet(seq, true);
+    received++;
+    sinceAck++;
+    dirty = true;
+    lastChunkAt = millis();
+
+    if (bufLen == UPLOAD_BUFFER_SIZE) {
+        flushBuffer();
+    }
+
+    if (received == chunkCount) {
+        commit(true);
+    } else if (sinceAck >= UPLOAD_ACK_EVERY) {
+        sendAck();
+    }
+}
+
+void uploadStatus(const char* path) {
+    uint8_t id;
+    if (!parseIds(path, id, NULL)) {
+        sendMessage("ERR:UPLOAD_BAD_ARGS");
+        return;
+    }
+    // The DONE reply may have been lost: asking again repeats it
+    if (committed && id == session.id) {
+        sendDone();
+        return;
+    }
+    if (!sessionMatches(id)) return;
+    sendAck();
+}
+
+void uploadAbort(const char* path) {
+    uint8_t id;
+    if (!parseIds(path, id, NULL)) {
+        sendMessage("ERR:UPLOAD_BAD_ARGS");
+        return;
+    }
+    if (!sessionMatches(id)) return;
+    LOG_I("UPLOAD", "Upload %u aborted at %u/%u chunks", session.id, received, chunkCount);
+    removeSession();
+    sendMessage("OK:UPLOAD_ABORTED");
+}
+
+void uploadTick(unsigned long now) {
+    // End of a pass: put what arrived on the card, so it survives a reset
+    if (active && dirty && now - lastChunkAt >= UPLOAD_FLUSH_MS) {
+        saveSession();
+        LOG_D("UPLOAD", "Upload %u idle, %u/%u chunks saved", session.id, received, chunkCount);
+    }
+}
+
+bool uploadActive() {
+    return active;
+}
@@ -0,0 +1,78 @@
+#ifndef UPLOAD_H
+#define UPLOAD_H
+
+/*
+ * Orbital Temple Satellite - Chunked Upload Sessions
+ * Version: 1.21
+ *
+ * WriteFile/AppendFile carry one packet's worth of data each and reply
+ * to every packet. An upload session moves a whole file (a batch of
+ * names, an artwork manifest) in numbered chunks instead, acknowledges
+ * them in batches and survives the end of a pass or a reboot.
+ *
+ * PROTOCOL:
+ *   UploadBegin&/names/batch.txt@<size>,<crc32 hex>
+ *       -> "OK:UPLOAD:<id>,<chunk size>,<chunks>,<received>"
+ *       The same path, size and CRC as the open session resumes it
+ *       (received > 0, an UPACK follows); anything else replaces it.
+ *   UploadChunk&<id>,<seq>@<base64 of chunk bytes>
+ *       No reply. Chunk seq holds file bytes [seq * UPLOAD_CHUNK_SIZE,
+ *       (seq + 1) * UPLOAD_CHUNK_SIZE). Base64 because data cannot
+ *       contain '#' (the HMAC delimiter).
+ *   UploadStatus&<id>   -> UPACK ("OK:UPLOAD_DONE:..." again once committed)
+ *   UploadAbort&<id>    -> "OK:UPLOAD_ABORTED"
+ *
+ *   "UPACK:<id>,<received>/<chunks>,<bitmap hex>" goes out after every
+ *   UPLOAD_ACK_EVERY new chunks; bit (seq % 8) of byte (seq / 8) is set
+ *   for each chunk on the card. Ground resends the clear bits.
+ *
+ * COMMIT:
+ *   Chunks go to UPLOAD_TMP_PATH, kept open, through a write-behind
+ *   buffer that collects consecutive chunks into whole SD sectors. When
+ *   the last chunk is in, the temp file is read back and its CRC32
+ *   checked; only then is it renamed over the target, so the target is
+ *   either the old file or the complete new one:
+ *       -> "OK:UPLOAD_DONE:<id>,<path>,<size>"
+ *       -> "ERR:UPLOAD_CRC:<id>,<crc32 hex>" (bitmap cleared, resend all)
+ *
+ * RESUME:
+ *   Before each UPACK (and from uploadTick() once chunks stop arriving)
+ *   the buffer is flushed and the session - path, size, CRC, bitmap - is
+ *   saved to UPLOAD_STATE_PATH. An acknowledged chunk is therefore always
+ *   on the card; after a reboot the session reloads at uploadInit().
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ==================== CONFIGURATION ====================
+
+#define UPLOAD_CHUNK_SIZE     128       // Bytes per chunk (172 base64 chars)
+#define UPLOAD_MAX_SIZE       65536     // Largest upload (512 chunks)
+#define UPLOAD_MAX_CHUNKS     (UPLOAD_MAX_SIZE / UPLOAD_CHUNK_SIZE)
+#define UPLOAD_PATH_MAX       64        // Target path incl. terminator
+#define UPLOAD_ACK_EVERY      16        // New chunks per UPACK
+#define UPLOAD_BUFFER_SIZE    1024      // Write-behind buffer (8 chunks, 2 sectors)
+#define UPLOAD_FLUSH_MS       3000UL    // Idle time before buffered chunks go to the card
+#define UPLOAD_DIR            "/upload"
+#define UPLOAD_TMP_PATH       "/upload/data.tmp"
+#define UPLOAD_STATE_PATH     "/upload/session"
+
+// ==================== API ====================
+
+// Reload an interrupted session (call after SDBegin())
+void uploadInit();
+
+// Flush chunks that stopped arriving (scheduler job)
+void uploadTick(unsigned long now);
+
+// Command handlers (path/data as parsed from the uplink)
+void uploadBegin(const char* path, const char* data);
+void uploadChunk(const char* path, const char* data, size_t dataLength);
+void uploadStatus(const char* path);
+void uploadAbort(const char* path);
+
+// True while a session is open
+bool uploadActive();
+
+#endif // UPLOAD_H